@@ -8,12 +8,26 @@ cd $DEVA2560/lib_graphics
 
 # copy latest version of headers to VBCC
 cp lib_graphics.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_tiled_bitmap.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_bitmap_file.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_asset_pack.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_gif.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_palette.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_font.h $VBCC/targets/a2560-micah/include/mb/
+cp lib_display_list.h $VBCC/targets/a2560-micah/include/mb/
 
 # copy headers to easy-to-share for-vbcc folder
 cp lib_graphics.h for_vbcc/include/mb/
+cp lib_tiled_bitmap.h for_vbcc/include/mb/
+cp lib_bitmap_file.h for_vbcc/include/mb/
+cp lib_asset_pack.h for_vbcc/include/mb/
+cp lib_gif.h for_vbcc/include/mb/
+cp lib_palette.h for_vbcc/include/mb/
+cp lib_font.h for_vbcc/include/mb/
+cp lib_display_list.h for_vbcc/include/mb/
 
 # make graphics as static lib
-vc +/opt/vbcc/config/a2560-4lib-micah -o a2560_graphics.lib lib_graphics.c
+vc +/opt/vbcc/config/a2560-4lib-micah -o a2560_graphics.lib lib_graphics.c lib_tiled_bitmap.c lib_bitmap_file.c lib_asset_pack.c lib_gif.c lib_palette.c lib_font.c lib_display_list.c
 cp a2560_graphics.lib for_vbcc/lib/
 mv a2560_graphics.lib $VBCC/targets/a2560-micah/lib/
 
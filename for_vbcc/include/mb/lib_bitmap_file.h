@@ -0,0 +1,220 @@
+//! @file lib_bitmap_file.h
+
+/*
+ * lib_bitmap_file.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_BITMAP_FILE_H_
+#define LIB_BITMAP_FILE_H_
+
+
+/* about this library: BitmapFile
+ *
+ * This provides functions for getting Bitmaps into and out of files.
+ *
+ *** loading
+ * Bitmap_LoadFromFile and Bitmap_LoadFileIntoBitmap read 8-bit BMP (uncompressed), PCX (RLE), and raw bitmap files.
+ * Files are streamed through one small fixed-size read buffer, and each row is decoded straight into the destination bitmap's memory:
+ * no copy of the whole file, compressed or decoded, is ever held in memory.
+ *
+ *** saving
+ * Bitmap_SaveToFile writes all or part of a bitmap as an 8-bit BMP, PCX, or raw bitmap file. Rows are read straight from the bitmap's memory (VRAM or not),
+ * encoded, and written through one small fixed-size output buffer. Bitmap_SaveScreenToFile does the same for a screen, using the screen's current LUT as the palette.
+ *
+ *** raw bitmap format
+ * The library's own raw bitmap format is a fixed-size header followed by the pixels, 1 byte per pixel, row by row.
+ * All multi-byte header fields are big-endian (68000 byte order), so files are identical whether written on the A2560 or on a host machine.
+ *   offset  size  field
+ *   0       4     magic: 'A' '2' 'B' 'M'
+ *   4       2     version: BITMAP_RAW_VERSION
+ *   6       2     width in pixels
+ *   8       2     height in pixels
+ *   10      2     reserved, 0
+ *   12      4     stride: bytes from the start of one row to the start of the next
+ *   16      4     offset from the start of the file to the first pixel
+ *   20      1024  palette: 256 LUT entries of 4 bytes each (B, G, R, A), the same layout as the VICKY's LUT
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define BITMAP_PALETTE_BYTES		1024	//!< size of a palette: 256 LUT entries of 4 bytes each (B, G, R, A)
+
+#define BITMAP_RAW_MAGIC			"A2BM"	//!< first 4 bytes of every raw bitmap file
+#define BITMAP_RAW_VERSION			1		//!< raw bitmap format version written by Bitmap_SaveRawFile
+#define BITMAP_RAW_HEADER_SIZE		(20 + BITMAP_PALETTE_BYTES)	//!< size of the raw bitmap header, in bytes
+
+#define BITMAP_FILE_READ_BUFFER_SIZE	512		//!< size, in bytes, of the buffer files are streamed through when loading
+#define BITMAP_FILE_NUM_PASSES		4		//!< number of interlaced passes Bitmap_LoadFileProgressive loads an image in
+#define BITMAP_FILE_WRITE_BUFFER_SIZE	512		//!< size, in bytes, of the buffer files are streamed through when saving
+
+#define PARAM_MAP_READ_ONLY			false	//!< for Bitmap_MapFile: the bitmap can only be read from. Drawing functions will refuse to draw into it.
+#define PARAM_MAP_COPY_ON_WRITE		true	//!< for Bitmap_MapFile: the bitmap can be drawn into. Changed pages are private copies: the file itself is never modified.
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum bitmap_file_format
+{
+	BITMAP_FILE_UNKNOWN = 0,
+	BITMAP_FILE_RAW,		//!< the library's own raw bitmap format
+	BITMAP_FILE_BMP,		//!< Windows BMP, 8 bits per pixel, uncompressed. Bottom-up or top-down.
+	BITMAP_FILE_PCX,		//!< ZSoft PCX, 8 bits per pixel, 1 plane, RLE compressed
+} bitmap_file_format;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct BitmapFileReader BitmapFileReader;
+
+//! Called by Bitmap_LoadFileProgressive after each pass
+//! @param	the_bitmap: the bitmap being loaded into
+//! @param	the_pass: the pass just finished, from 0 to BITMAP_FILE_NUM_PASSES - 1
+//! @param	the_user_data: whatever was passed to Bitmap_LoadFileProgressive
+//! @return	return false to stop loading
+typedef boolean (*BitmapFilePassCallback)(Bitmap* the_bitmap, signed int the_pass, void* the_user_data);
+
+//! The state of a file being streamed in by one of the loaders
+struct BitmapFileReader
+{
+	FILE*			file_;
+	uint8_t			format_;		//!< a bitmap_file_format value
+	signed int		width_;			//!< width of the image in pixels
+	signed int		height_;		//!< height of the image in pixels
+	signed int		stride_;		//!< bytes in one row of the file, including any padding
+	unsigned long	data_offset_;	//!< offset of the first row from the start of the file
+	boolean			bottom_up_;		//!< true if the file stores the bottom row first
+	signed int		pos_;			//!< index of the next unread byte in buffer_
+	signed int		len_;			//!< number of valid bytes in buffer_
+	signed int		run_len_;		//!< PCX only: pixels left in the current run. Runs can continue from one row to the next.
+	uint8_t			run_value_;		//!< PCX only: color of the current run
+	uint8_t			buffer_[BITMAP_FILE_READ_BUFFER_SIZE];
+};
+
+typedef struct BitmapFileWriter BitmapFileWriter;
+
+//! The state of a file being streamed out by one of the save functions
+struct BitmapFileWriter
+{
+	FILE*			file_;
+	signed int		pos_;			//!< number of bytes waiting in buffer_
+	boolean			failed_;		//!< true once any write to the file has failed
+	uint8_t			buffer_[BITMAP_FILE_WRITE_BUFFER_SIZE];
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** Load functions ****
+
+//! Create a new bitmap and load an 8-bit BMP, PCX, or raw bitmap file into it
+//! The image must be within the normal Bitmap size limits. The bitmap is created with BITMAP_FLAG_UNINITIALIZED, as every pixel is loaded from the file.
+//! @param	the_path: path of the file to load
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette, in LUT order (B, G, R, A). Entries the file doesn't define are set to 0. Can be NULL.
+//! @return	returns NULL on any error
+Bitmap* Bitmap_LoadFromFile(const char* the_path, uint8_t* the_palette);
+
+//! Load an 8-bit BMP, PCX, or raw bitmap file into an existing bitmap, with its top left corner at x, y
+//! The image is clipped to the destination bitmap: only the rows and columns that land inside it are written.
+//! @param	the_path: path of the file to load
+//! @param	the_bitmap: reference to a valid Bitmap object to load into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. Can be negative.
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. Can be NULL.
+//! @return	returns false on any error
+boolean Bitmap_LoadFileIntoBitmap(const char* the_path, Bitmap* the_bitmap, signed int x, signed int y, uint8_t* the_palette);
+
+//! Load an 8-bit BMP, PCX, or raw bitmap file into an existing bitmap progressively, so a rough version of the whole image appears quickly
+//! Rows are loaded in 4 interlaced passes, as in GIF: every 8th row first, with each row copied down over the 7 rows below it, then the rows halfway between those, and so on.
+//! After each pass, the_callback is called, so the app can present the bitmap. The image is clipped to the bitmap as in Bitmap_LoadFileIntoBitmap().
+//! PCX files are RLE compressed, and so can only be read from top to bottom: they are loaded in one pass, and the_callback is called once, with the last pass number.
+//! @param	the_path: path of the file to load
+//! @param	the_bitmap: reference to a valid Bitmap object to load into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. Can be negative.
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. It is filled in before the first pass. Can be NULL.
+//! @param	the_callback: function to call after each pass. Can be NULL.
+//! @param	the_user_data: passed to the_callback
+//! @return	returns false on any error, or if the_callback returned false
+boolean Bitmap_LoadFileProgressive(const char* the_path, Bitmap* the_bitmap, signed int x, signed int y, uint8_t* the_palette, BitmapFilePassCallback the_callback, void* the_user_data);
+
+
+// **** Save functions ****
+
+//! Write all or part of a bitmap to an 8-bit BMP, PCX, or raw bitmap file
+//! The rectangle is clipped to the bitmap.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_format: BITMAP_FILE_BMP, BITMAP_FILE_PCX, or BITMAP_FILE_RAW
+//! @param	x, y, width, height: the rectangle of the bitmap to save
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES palette to store with the pixels, in LUT order (B, G, R, A). If NULL, the palette is written as all 0s.
+//! @return	returns false on any error
+boolean Bitmap_SaveToFile(Bitmap* the_bitmap, const char* the_path, uint8_t the_format, signed int x, signed int y, signed int width, signed int height, const uint8_t* the_palette);
+
+//! Write all or part of a screen to an 8-bit BMP, PCX, or raw bitmap file, with the screen's current graphics LUT as the palette
+//! @param	the_screen: reference to a valid Screen object, with a bitmap.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_format: BITMAP_FILE_BMP, BITMAP_FILE_PCX, or BITMAP_FILE_RAW
+//! @param	x, y, width, height: the rectangle of the screen to save
+//! @return	returns false on any error
+boolean Bitmap_SaveScreenToFile(Screen* the_screen, const char* the_path, uint8_t the_format, signed int x, signed int y, signed int width, signed int height);
+
+
+// **** Raw bitmap file functions ****
+
+//! Write a bitmap to a file in the raw bitmap format
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES palette to store with the pixels. If NULL, the palette is written as all 0s.
+//! @return	returns false on any error
+boolean Bitmap_SaveRawFile(Bitmap* the_bitmap, const char* the_path, const uint8_t* the_palette);
+
+#if defined(__linux__)
+
+	//! Create a bitmap whose pixels are a raw bitmap file, mapped into memory instead of loaded (host builds only)
+	//! Nothing is read until a primitive touches it, so bitmaps of any file size open instantly. All primitives and Graphics_BlitBitMap work on the result.
+	//! The file's stride must equal its width, and its width and height must be within the normal Bitmap limits.
+	//! Free with Bitmap_Destroy(), which unmaps the file.
+	//! @param	the_path: path of a raw bitmap file
+	//! @param	copy_on_write: PARAM_MAP_COPY_ON_WRITE if the bitmap will be drawn into, PARAM_MAP_READ_ONLY if it will only be read from
+	//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. Can be NULL.
+	//! @return	returns NULL on any error
+	Bitmap* Bitmap_MapFile(const char* the_path, boolean copy_on_write, uint8_t* the_palette);
+
+#endif
+
+
+
+#endif /* LIB_BITMAP_FILE_H_ */
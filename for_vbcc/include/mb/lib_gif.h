@@ -0,0 +1,163 @@
+//! @file lib_gif.h
+
+/*
+ * lib_gif.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_GIF_H_
+#define LIB_GIF_H_
+
+
+/* about this library: Gif
+ *
+ * This decodes GIF87a and GIF89a files into Bitmaps, one frame at a time.
+ *
+ * The LZW code table is a fixed GIF_MAX_CODES entries (a 2-byte prefix and a 1-byte suffix each, about 12KB), allocated once with the decoder,
+ * so memory use doesn't depend on the size of the image. Each row is written into the bitmap as soon as it is decoded.
+ *
+ * Interlaced frames are supported. Pixels of a frame's transparent color are not written, so each frame is drawn over the ones before it, as the
+ * GIF format intends. A mask bitmap can also be kept, showing which pixels any frame has drawn, for use with transparent blits.
+ * Frame disposal (restore to background, restore to previous) is done at the start of the next frame.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define GIF_MAX_CODES				4096	//!< LZW codes are at most 12 bits
+#define GIF_READ_BUFFER_SIZE		256		//!< size, in bytes, of the buffer the file is streamed through
+#define GIF_PALETTE_BYTES			1024	//!< size of a palette: 256 LUT entries of 4 bytes each (B, G, R, A). Same as BITMAP_PALETTE_BYTES.
+#define GIF_NO_TRANSPARENCY			-1		//!< value of transparent_ when the frame has no transparent color
+
+#define GIF_MASK_OPAQUE				0xFF	//!< mask bitmap value for pixels a frame has drawn
+#define GIF_MASK_TRANSPARENT		0x00	//!< mask bitmap value for pixels no frame has drawn
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum gif_disposal
+{
+	GIF_DISPOSAL_NONE = 0,			//!< no disposal specified: leave the frame in place
+	GIF_DISPOSAL_KEEP,				//!< leave the frame in place
+	GIF_DISPOSAL_BACKGROUND,		//!< before the next frame, fill the frame's area with the background color
+	GIF_DISPOSAL_PREVIOUS,			//!< before the next frame, put back what was under the frame
+} gif_disposal;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct GifDecoder GifDecoder;
+
+struct GifDecoder
+{
+	FILE*			file_;
+	signed int		width_;			//!< width of the GIF's logical screen, in pixels
+	signed int		height_;		//!< height of the GIF's logical screen, in pixels
+	uint8_t			background_;	//!< LUT index of the background color
+	boolean			finished_;		//!< true once the last frame has been decoded
+	signed int		frame_count_;	//!< number of frames decoded so far
+	// the frame most recently decoded
+	signed int		frame_x_;		//!< left edge of the frame within the logical screen
+	signed int		frame_y_;		//!< top edge of the frame within the logical screen
+	signed int		frame_width_;
+	signed int		frame_height_;
+	signed int		delay_;			//!< how long to show the frame, in 1/100ths of a second
+	signed int		transparent_;	//!< LUT index of the frame's transparent color, or GIF_NO_TRANSPARENCY
+	uint8_t			disposal_;		//!< a gif_disposal value
+	boolean			interlaced_;
+	// disposal of the previous frame, done at the start of the next one
+	Bitmap*			prev_bitmap_;	//!< bitmap the previous frame was decoded into
+	Bitmap*			prev_mask_;		//!< mask the previous frame was decoded with, or NULL
+	signed int		prev_x_;		//!< where the logical screen was placed in prev_bitmap_
+	signed int		prev_y_;
+	BitmapSnapshot*	prev_snapshot_;	//!< for GIF_DISPOSAL_PREVIOUS: prev_bitmap_ as it was before the previous frame
+	BitmapSnapshot*	prev_mask_snapshot_;	//!< for GIF_DISPOSAL_PREVIOUS: prev_mask_ as it was before the previous frame
+	Rectangle		mask_rect_;		//!< the part of the current frame written to the mask: the frame, clipped to both the bitmap and the mask. Inclusive. Empty if MinX > MaxX.
+	// file reading
+	signed int		pos_;			//!< index of the next unread byte in buffer_
+	signed int		len_;			//!< number of valid bytes in buffer_
+	signed int		block_left_;	//!< bytes left in the current data sub-block
+	uint32_t		bits_;			//!< LZW bits read but not yet used, lowest first
+	signed int		num_bits_;		//!< number of valid bits in bits_
+	uint8_t			buffer_[GIF_READ_BUFFER_SIZE];
+	uint8_t			global_palette_[GIF_PALETTE_BYTES];	//!< global color table, in LUT order
+	// LZW code table
+	uint16_t		prefix_[GIF_MAX_CODES];	//!< code of the string each code extends
+	uint8_t			suffix_[GIF_MAX_CODES];	//!< last pixel of the string for each code
+	uint8_t			stack_[GIF_MAX_CODES];	//!< a decoded string, last pixel first
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Open a GIF file and read its header and global palette
+//! @param	the_path: path of the GIF file
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the global palette, in LUT order (B, G, R, A). Entries the file doesn't define are set to 0. Can be NULL.
+//! @return	returns NULL on any error
+GifDecoder* Gif_Open(const char* the_path, uint8_t* the_palette);
+
+// destructor
+// closes the file, and frees all allocated memory associated with the passed object, and the object itself. Decoded bitmaps are not affected.
+boolean Gif_Close(GifDecoder** the_gif);
+
+
+// **** Decode functions ****
+
+//! Decode the next frame of the GIF into a bitmap
+//! Before decoding, the previous frame is disposed of, as it asked to be. For animations, pass the same bitmap (and mask) for every frame.
+//! Pixels of the frame's transparent color are left untouched. The frame is clipped to the bitmap.
+//! After the call, the frame_ fields, delay_, transparent_, and disposal_ describe the frame just decoded.
+//! @param	the_bitmap: reference to a valid Bitmap object to decode into
+//! @param	x, y: where in the_bitmap the top left corner of the GIF's logical screen should go
+//! @param	the_mask: optional bitmap, laid out like the_bitmap, in which every pixel the frame draws is set to GIF_MASK_OPAQUE. Pixels disposed of with GIF_DISPOSAL_BACKGROUND are set back to GIF_MASK_TRANSPARENT. Can be NULL.
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the frame's palette: its local palette if it has one, otherwise the global palette. Can be NULL.
+//! @return	returns false on any error, or if there are no more frames (in which case finished_ is set)
+boolean Gif_DecodeNextFrame(GifDecoder* the_gif, Bitmap* the_bitmap, signed int x, signed int y, Bitmap* the_mask, uint8_t* the_palette);
+
+//! Create a new bitmap the size of a GIF's logical screen, and decode its first frame into it
+//! The bitmap is first filled with the GIF's background color.
+//! @param	the_path: path of the GIF file
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the first frame's palette. Can be NULL.
+//! @return	returns NULL on any error
+Bitmap* Gif_LoadFromFile(const char* the_path, uint8_t* the_palette);
+
+
+
+#endif /* LIB_GIF_H_ */
@@ -0,0 +1,192 @@
+//! @file lib_tiled_bitmap.h
+
+/*
+ * lib_tiled_bitmap.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_TILED_BITMAP_H_
+#define LIB_TILED_BITMAP_H_
+
+
+/* about this library: TiledBitmap
+ *
+ * A TiledBitmap is a virtual canvas that can be far larger than a Bitmap (which is limited to BITMAP_MAX_WIDTH x BITMAP_MAX_HEIGHT),
+ * and far larger than the memory available to hold it.
+ *
+ * The canvas is divided into TILED_BITMAP_TILE_SIZE x TILED_BITMAP_TILE_SIZE tiles. Each tile is a small Bitmap, and lives in one of 3 places:
+ *   - VRAM (most recently used tiles)
+ *   - standard RAM (tiles pushed out of VRAM)
+ *   - a backing file (tiles pushed out of standard RAM)
+ * Tiles are loaded on demand, as the drawing, blitting, and rendering functions touch them. When a memory budget is full,
+ * the least recently used tile is moved down to the next place. Tiles that have never been drawn into take no memory or file space.
+ *
+ * Drawing straight onto the canvas is limited to pixels, filled boxes, lines, box outlines, and circle outlines, all clipped to the canvas.
+ * Round boxes (whose fill reads back pixels) and text are not supported: draw them into a normal Bitmap, then copy it in with TiledBitmap_BlitFromBitmap().
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define TILED_BITMAP_TILE_SIZE		64		//!< width and height, in pixels, of each tile of a TiledBitmap
+#define TILED_BITMAP_TILE_BYTES		(TILED_BITMAP_TILE_SIZE * TILED_BITMAP_TILE_SIZE)	//!< bytes used by one tile, in memory or in the backing file
+#define TILED_BITMAP_NO_TILE		-1		//!< end of list marker for the LRU lists
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum tile_location
+{
+	TILE_NOT_LOADED = 0,	//!< the tile is only in the backing file, or has never been drawn into
+	TILE_IN_VRAM,			//!< the tile's bitmap is in VRAM
+	TILE_IN_RAM,			//!< the tile's bitmap is in standard RAM
+	TILE_NUM_LOCATIONS,
+} tile_location;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct TiledBitmap TiledBitmap;
+typedef struct TiledBitmapTile TiledBitmapTile;
+
+struct TiledBitmapTile
+{
+	Bitmap*			bitmap_;		//!< the tile's pixels, when loaded. Always a full TILED_BITMAP_TILE_SIZE square, even at the right and bottom edges of the canvas.
+	uint8_t			location_;		//!< a tile_location value
+	boolean			dirty_;			//!< true if the tile has been drawn into since it was last written to the backing file
+	boolean			in_file_;		//!< true if the tile has ever been written to the backing file. If false and not loaded, the tile is blank (all 0).
+	signed int		lru_newer_;		//!< index of the next more recently used tile in the same location, or TILED_BITMAP_NO_TILE
+	signed int		lru_older_;		//!< index of the next less recently used tile in the same location, or TILED_BITMAP_NO_TILE
+};
+
+struct TiledBitmap
+{
+	signed int		width_;			//!< width of the canvas in pixels
+	signed int		height_;		//!< height of the canvas in pixels
+	signed int		tiles_across_;	//!< number of tiles needed to cover the canvas's width
+	signed int		tiles_down_;	//!< number of tiles needed to cover the canvas's height
+	TiledBitmapTile*	tile_;		//!< tiles_across_ * tiles_down_ tiles, in rows
+	FILE*			file_;			//!< the backing file tiles are paged out to, or NULL if everything must fit in memory
+	signed int		max_loaded_[TILE_NUM_LOCATIONS];	//!< memory budget, in tiles, for each location. (TILE_NOT_LOADED entry is unused)
+	signed int		num_loaded_[TILE_NUM_LOCATIONS];	//!< number of tiles currently loaded in each location
+	signed int		lru_newest_[TILE_NUM_LOCATIONS];	//!< index of the most recently used tile in each location, or TILED_BITMAP_NO_TILE
+	signed int		lru_oldest_[TILE_NUM_LOCATIONS];	//!< index of the least recently used tile in each location, or TILED_BITMAP_NO_TILE
+	signed int		last_tile_;		//!< index of the tile most recently touched, to skip the LRU update when drawing stays within one tile
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a new virtual canvas. No tile memory is allocated until something is drawn.
+//! @param	width, height: size of the canvas in pixels. Can be larger than BITMAP_MAX_WIDTH x BITMAP_MAX_HEIGHT.
+//! @param	backing_file_path: path of a scratch file that tiles will be paged out to when the memory budgets are full. The file will be created or overwritten. Can be NULL if the budgets are big enough to hold every tile.
+//! @param	max_vram_tiles: maximum number of tiles to keep in VRAM. Can be 0.
+//! @param	max_ram_tiles: maximum number of tiles to keep in standard RAM. Can be 0. max_vram_tiles + max_ram_tiles must be at least 1.
+//! @return	returns NULL on any error
+TiledBitmap* TiledBitmap_New(signed int width, signed int height, const char* backing_file_path, signed int max_vram_tiles, signed int max_ram_tiles);
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. closes (but does not delete) the backing file.
+boolean TiledBitmap_Destroy(TiledBitmap** the_tiled_bitmap);
+
+
+// **** Drawing functions *****
+
+//! Set a pixel at a specified x, y coord of the canvas
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_SetPixelAtXY(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, unsigned char the_color);
+
+//! Get the pixel at a specified x, y coord of the canvas
+//! @return	returns a 1-byte index to the current LUT, or 0 on any error
+unsigned char TiledBitmap_GetPixelAtXY(TiledBitmap* the_tiled_bitmap, signed int x, signed int y);
+
+//! Fill a width x height box of the canvas with the specified LUT value
+//! The box is clipped to the canvas. Only the tiles it touches are loaded.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input, or if no part of the box was on the canvas.
+boolean TiledBitmap_FillBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+//! Draw a line between 2 coordinates of the canvas, stepping through the same pixels as Graphics_DrawLine
+//! The line is clipped to the canvas. Horizontal and vertical lines are drawn as fills; other lines pixel by pixel.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input, or if no part of the line was on the canvas.
+boolean TiledBitmap_DrawLine(TiledBitmap* the_tiled_bitmap, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color);
+
+//! Draw a rectangle on the canvas, as Graphics_DrawBox draws it, and optionally fill it
+//! The rectangle is clipped to the canvas.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input, or if no part of the box was on the canvas.
+boolean TiledBitmap_DrawBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, boolean do_fill);
+
+//! Draw a circle outline on the canvas, stepping through the same pixels as Graphics_DrawCircle
+//! The circle is clipped to the canvas: its center can be off the canvas.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_DrawCircle(TiledBitmap* the_tiled_bitmap, signed int x1, signed int y1, signed int radius, unsigned char the_color);
+
+
+// **** Block copy functions ****
+
+//! Blit a rectangle of pixels from a normal bitmap into the canvas
+//! The copy is clipped to both the source bitmap and the canvas. Only the tiles it touches are loaded.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_BlitFromBitmap(Bitmap* src_bm, signed int src_x, signed int src_y, TiledBitmap* dst_tb, signed int dst_x, signed int dst_y, signed int width, signed int height);
+
+//! Blit a rectangle of pixels from the canvas into a normal bitmap
+//! The copy is clipped to both the canvas and the destination bitmap. Only the tiles it touches are loaded.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_BlitToBitmap(TiledBitmap* src_tb, signed int src_x, signed int src_y, Bitmap* dst_bm, signed int dst_x, signed int dst_y, signed int width, signed int height);
+
+//! Render the part of the canvas that starts at view_x, view_y into the entire destination bitmap, such as a screen's bitmap
+//! Areas of the destination that fall outside the canvas are not touched.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_RenderViewport(TiledBitmap* the_tiled_bitmap, signed int view_x, signed int view_y, Bitmap* dst_bm);
+
+//! Write every tile that has changed since it was loaded out to the backing file
+//! Tiles stay loaded. Does nothing if the canvas has no backing file.
+//! @return	returns false on any error
+boolean TiledBitmap_Flush(TiledBitmap* the_tiled_bitmap);
+
+
+
+#endif /* LIB_TILED_BITMAP_H_ */
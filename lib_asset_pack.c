@@ -0,0 +1,1195 @@
+/*
+ * lib_asset_pack.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_asset_pack.h"
+#include "lib_byte_order.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define ASSET_PACK_LZ_BOUND(len)	((len) + (len) / 255 + 16)	//!< worst case size of the compressed form of len bytes
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// write the length continuation bytes of an LZ sequence
+uint8_t* AssetPack_PutLength(uint8_t* the_write_loc, unsigned long the_len);
+
+// compress the_len bytes into the_dest, which must be at least ASSET_PACK_LZ_BOUND(the_len) long
+unsigned long AssetPack_Compress(const uint8_t* the_src, unsigned long the_len, uint8_t* the_dest, signed long* the_hash);
+
+// decompress the_src_len bytes into exactly the_dest_len bytes at the_dest
+boolean AssetPack_Decompress(const uint8_t* the_src, unsigned long the_src_len, uint8_t* the_dest, unsigned long the_dest_len);
+
+// get a valid entry for the id, or log an error and return NULL
+AssetPackEntry* AssetPack_GetEntryOfType(AssetPack* the_pack, signed int the_id, boolean want_bitmap);
+
+// claim the next index entry of a pack being written
+AssetPackEntry* AssetPack_AddEntry(AssetPackWriter* the_writer, const char* the_name, uint8_t the_type);
+
+//! \endcond
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Write the length continuation bytes of an LZ sequence: as many 255s as needed, then the remainder
+//! @param	the_len: the length, minus the 15 already given by the token
+//! @return	returns the location after the last byte written
+uint8_t* AssetPack_PutLength(uint8_t* the_write_loc, unsigned long the_len)
+{
+	while (the_len >= 255)
+	{
+		*the_write_loc++ = 255;
+		the_len -= 255;
+	}
+
+	*the_write_loc++ = (uint8_t)the_len;
+
+	return the_write_loc;
+}
+
+
+//! Compress the_len bytes into the_dest, which must be at least ASSET_PACK_LZ_BOUND(the_len) long
+//! Output is an LZ4 block: a series of sequences, each a token byte (high nibble literal count, low nibble match length - 4),
+//!   optional literal count continuation bytes, the literals, a 2-byte little-endian match offset, and optional match length continuation bytes.
+//!   The last sequence has literals only. Like LZ4, the last 5 bytes are always literals, and no match starts in the last 12 bytes.
+//! @param	the_hash: scratch table of (1 << ASSET_PACK_LZ_HASH_BITS) entries
+//! @return	returns the compressed length
+unsigned long AssetPack_Compress(const uint8_t* the_src, unsigned long the_len, uint8_t* the_dest, signed long* the_hash)
+{
+	uint8_t*		the_write_loc = the_dest;
+	uint8_t*		the_token;
+	unsigned long	the_pos = 0;
+	unsigned long	the_anchor = 0;
+	unsigned long	match_len;
+	unsigned long	lit_len;
+	signed long		the_ref;
+	uint32_t		the_sequence;
+	uint32_t		the_hash_index;
+	signed int		i;
+
+	for (i = 0; i < (1 << ASSET_PACK_LZ_HASH_BITS); i++)
+	{
+		the_hash[i] = -1;
+	}
+
+	// LOGIC:
+	//   greedy matching: hash the 4 bytes at each position, and look up the last position that hashed the same.
+	//   if those 4 bytes really match and are close enough, extend the match as far as it goes and emit a sequence.
+
+	while (the_len >= 13 && the_pos < the_len - 12)
+	{
+		memcpy(&the_sequence, &the_src[the_pos], 4);
+		the_hash_index = (uint32_t)(the_sequence * 2654435761UL) >> (32 - ASSET_PACK_LZ_HASH_BITS);
+		the_ref = the_hash[the_hash_index];
+		the_hash[the_hash_index] = the_pos;
+
+		if (the_ref < 0 || the_pos - the_ref > ASSET_PACK_LZ_MAX_OFFSET || memcmp(&the_src[the_ref], &the_src[the_pos], ASSET_PACK_LZ_MIN_MATCH) != 0)
+		{
+			the_pos++;
+			continue;
+		}
+
+		for (match_len = ASSET_PACK_LZ_MIN_MATCH; the_pos + match_len < the_len - 5 && the_src[the_ref + match_len] == the_src[the_pos + match_len]; match_len++)
+		{
+		}
+
+		lit_len = the_pos - the_anchor;
+		the_token = the_write_loc++;
+		*the_token = (uint8_t)(((lit_len < 15) ? lit_len : 15) << 4);
+
+		if (lit_len >= 15)
+		{
+			the_write_loc = AssetPack_PutLength(the_write_loc, lit_len - 15);
+		}
+
+		memcpy(the_write_loc, &the_src[the_anchor], lit_len);
+		the_write_loc += lit_len;
+
+		*the_write_loc++ = (uint8_t)(the_pos - the_ref);
+		*the_write_loc++ = (uint8_t)((the_pos - the_ref) >> 8);
+
+		match_len -= ASSET_PACK_LZ_MIN_MATCH;
+		*the_token |= (uint8_t)((match_len < 15) ? match_len : 15);
+
+		if (match_len >= 15)
+		{
+			the_write_loc = AssetPack_PutLength(the_write_loc, match_len - 15);
+		}
+
+		the_pos += match_len + ASSET_PACK_LZ_MIN_MATCH;
+		the_anchor = the_pos;
+	}
+
+	lit_len = the_len - the_anchor;
+	*the_write_loc++ = (uint8_t)(((lit_len < 15) ? lit_len : 15) << 4);
+
+	if (lit_len >= 15)
+	{
+		the_write_loc = AssetPack_PutLength(the_write_loc, lit_len - 15);
+	}
+
+	memcpy(the_write_loc, &the_src[the_anchor], lit_len);
+	the_write_loc += lit_len;
+
+	return the_write_loc - the_dest;
+}
+
+
+//! Decompress the_src_len bytes of LZ4 block data into exactly the_dest_len bytes at the_dest
+//! Every length and offset is checked, so a damaged file can't write outside the_dest.
+//! @return	returns false if the data is damaged, or doesn't decompress to exactly the_dest_len bytes
+boolean AssetPack_Decompress(const uint8_t* the_src, unsigned long the_src_len, uint8_t* the_dest, unsigned long the_dest_len)
+{
+	const uint8_t*	the_read_loc = the_src;
+	const uint8_t*	the_src_end = the_src + the_src_len;
+	uint8_t*		the_write_loc = the_dest;
+	uint8_t*		the_dest_end = the_dest + the_dest_len;
+	const uint8_t*	the_match;
+	unsigned long	the_len;
+	unsigned long	the_offset;
+	uint8_t			the_token;
+	uint8_t			the_byte;
+
+	while (the_read_loc < the_src_end)
+	{
+		the_token = *the_read_loc++;
+		the_len = the_token >> 4;
+
+		if (the_len == 15)
+		{
+			do
+			{
+				if (the_read_loc >= the_src_end)
+				{
+					return false;
+				}
+
+				the_byte = *the_read_loc++;
+				the_len += the_byte;
+			} while (the_byte == 255);
+		}
+
+		if (the_len > (unsigned long)(the_src_end - the_read_loc) || the_len > (unsigned long)(the_dest_end - the_write_loc))
+		{
+			return false;
+		}
+
+		memcpy(the_write_loc, the_read_loc, the_len);
+		the_write_loc += the_len;
+		the_read_loc += the_len;
+
+		if (the_read_loc >= the_src_end)
+		{
+			break;
+		}
+
+		if (the_src_end - the_read_loc < 2)
+		{
+			return false;
+		}
+
+		the_offset = the_read_loc[0] | (the_read_loc[1] << 8);
+		the_read_loc += 2;
+
+		if (the_offset == 0 || the_offset > (unsigned long)(the_write_loc - the_dest))
+		{
+			return false;
+		}
+
+		the_len = the_token & 0x0F;
+
+		if (the_len == 15)
+		{
+			do
+			{
+				if (the_read_loc >= the_src_end)
+				{
+					return false;
+				}
+
+				the_byte = *the_read_loc++;
+				the_len += the_byte;
+			} while (the_byte == 255);
+		}
+
+		the_len += ASSET_PACK_LZ_MIN_MATCH;
+
+		if (the_len > (unsigned long)(the_dest_end - the_write_loc))
+		{
+			return false;
+		}
+
+		// LOGIC:
+		//   a match that overlaps the bytes it produces (offset < length) repeats a pattern, and has to be copied a byte at a time.
+
+		the_match = the_write_loc - the_offset;
+
+		if (the_offset >= the_len)
+		{
+			memcpy(the_write_loc, the_match, the_len);
+			the_write_loc += the_len;
+		}
+		else
+		{
+			while (the_len--)
+			{
+				*the_write_loc++ = *the_match++;
+			}
+		}
+	}
+
+	return (the_write_loc == the_dest_end);
+}
+
+
+//! Get a valid entry for the id, or log an error and return NULL
+//! @param	want_bitmap: if true, the asset must be a bitmap
+AssetPackEntry* AssetPack_GetEntryOfType(AssetPack* the_pack, signed int the_id, boolean want_bitmap)
+{
+	if (the_pack == NULL)
+	{
+		LOG_ERR(("%s %d: passed pack was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_id < 0 || the_id >= the_pack->num_assets_)
+	{
+		LOG_ERR(("%s %d: invalid asset id (%i)", __func__, __LINE__, the_id));
+		return NULL;
+	}
+
+	if (want_bitmap && the_pack->entry_[the_id].type_ != ASSET_TYPE_BITMAP)
+	{
+		LOG_ERR(("%s %d: asset '%s' is not a bitmap", __func__, __LINE__, the_pack->entry_[the_id].name_));
+		return NULL;
+	}
+
+	return &the_pack->entry_[the_id];
+}
+
+
+//! Claim the next index entry of a pack being written, and position the file where its data will go
+//! @return	returns NULL if the pack is full or the name is invalid
+AssetPackEntry* AssetPack_AddEntry(AssetPackWriter* the_writer, const char* the_name, uint8_t the_type)
+{
+	AssetPackEntry*	the_entry;
+
+	if (the_name == NULL || the_name[0] == 0 || strlen(the_name) > ASSET_PACK_NAME_LEN)
+	{
+		LOG_ERR(("%s %d: asset name missing or longer than %i characters", __func__, __LINE__, ASSET_PACK_NAME_LEN));
+		return NULL;
+	}
+
+	if (the_writer->num_assets_ >= the_writer->max_assets_)
+	{
+		LOG_ERR(("%s %d: pack already has its maximum of %i assets", __func__, __LINE__, the_writer->max_assets_));
+		return NULL;
+	}
+
+	if (fseek(the_writer->file_, the_writer->next_offset_, SEEK_SET) != 0)
+	{
+		LOG_ERR(("%s %d: Couldn't seek in pack file", __func__, __LINE__));
+		return NULL;
+	}
+
+	the_entry = &the_writer->entry_[the_writer->num_assets_];
+	memset(the_entry, 0, sizeof(AssetPackEntry));
+	strcpy(the_entry->name_, the_name);
+	the_entry->type_ = the_type;
+	the_entry->offset_ = the_writer->next_offset_;
+
+	return the_entry;
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Open an asset pack and read its index
+//! The file stays open until AssetPack_Close(), so assets can be loaded from it as they are needed.
+//! @param	the_path: path of the asset pack file
+//! @return	returns NULL on any error
+AssetPack* AssetPack_Open(const char* the_path)
+{
+	AssetPack*		the_pack;
+	AssetPackEntry*	the_entry;
+	uint8_t			the_buffer[ASSET_PACK_ENTRY_SIZE];
+	signed int		i;
+
+	if (the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed path was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_pack = f_calloc(1, sizeof(AssetPack), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for asset pack", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_pack	%p	size	%i", __func__ , __LINE__, the_pack, sizeof(AssetPack)));
+
+	if ((the_pack->file_ = fopen(the_path, "rb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't open file '%s'", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	if (fread(the_buffer, ASSET_PACK_HEADER_SIZE, 1, the_pack->file_) != 1 || memcmp(the_buffer, ASSET_PACK_MAGIC, 4) != 0 || BYTES_GET_BE16(&the_buffer[4]) != ASSET_PACK_VERSION)
+	{
+		LOG_ERR(("%s %d: '%s' is not an asset pack", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	the_pack->num_assets_ = BYTES_GET_BE16(&the_buffer[6]);
+
+	// LOGIC:
+	//   the whole index is read now, so finding and loading assets later never has to search the file.
+
+	if ((the_pack->entry_ = f_calloc((the_pack->num_assets_ > 0) ? the_pack->num_assets_ : 1, sizeof(AssetPackEntry), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i index entries", __func__, __LINE__, the_pack->num_assets_));
+		goto error;
+	}
+
+	if (fseek(the_pack->file_, BYTES_GET_BE32(&the_buffer[8]), SEEK_SET) != 0)
+	{
+		goto read_error;
+	}
+
+	for (i = 0; i < the_pack->num_assets_; i++)
+	{
+		if (fread(the_buffer, ASSET_PACK_ENTRY_SIZE, 1, the_pack->file_) != 1)
+		{
+			goto read_error;
+		}
+
+		the_entry = &the_pack->entry_[i];
+		memcpy(the_entry->name_, the_buffer, ASSET_PACK_NAME_LEN);
+		the_entry->type_ = the_buffer[20];
+		the_entry->compression_ = the_buffer[21];
+		the_entry->width_ = BYTES_GET_BE16(&the_buffer[22]);
+		the_entry->height_ = BYTES_GET_BE16(&the_buffer[24]);
+		the_entry->offset_ = BYTES_GET_BE32(&the_buffer[28]);
+		the_entry->stored_len_ = BYTES_GET_BE32(&the_buffer[32]);
+		the_entry->unpacked_len_ = BYTES_GET_BE32(&the_buffer[36]);
+	}
+
+	return the_pack;
+
+read_error:
+	LOG_ERR(("%s %d: Couldn't read index of '%s'", __func__, __LINE__, the_path));
+
+error:
+	AssetPack_Close(&the_pack);
+	return NULL;
+}
+
+
+// destructor
+// closes the file, and frees all allocated memory associated with the passed object, and the object itself. Assets already loaded are not affected.
+boolean AssetPack_Close(AssetPack** the_pack)
+{
+	if (the_pack == NULL || *the_pack == NULL)
+	{
+		LOG_ERR(("%s %d: passed pack was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_pack)->file_)
+	{
+		fclose((*the_pack)->file_);
+	}
+
+	if ((*the_pack)->entry_)
+	{
+		f_free((*the_pack)->entry_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_pack	%p	size	%i", __func__ , __LINE__, *the_pack, sizeof(AssetPack)));
+	f_free(*the_pack, MEM_STANDARD);
+	*the_pack = NULL;
+
+	return true;
+}
+
+
+
+
+// **** Getter functions ****
+
+//! Find an asset by name
+//! @param	the_name: name of the asset. Compared case-sensitively.
+//! @return	returns the asset's id, or ASSET_PACK_NOT_FOUND if the pack has no asset with that name
+signed int AssetPack_FindAsset(AssetPack* the_pack, const char* the_name)
+{
+	signed int		i;
+
+	if (the_pack == NULL || the_name == NULL)
+	{
+		LOG_ERR(("%s %d: passed pack or name was NULL", __func__, __LINE__));
+		return ASSET_PACK_NOT_FOUND;
+	}
+
+	for (i = 0; i < the_pack->num_assets_; i++)
+	{
+		if (strcmp(the_pack->entry_[i].name_, the_name) == 0)
+		{
+			return i;
+		}
+	}
+
+	return ASSET_PACK_NOT_FOUND;
+}
+
+
+//! Get the index entry of an asset, to check its type and sizes before loading it
+//! @param	the_id: an asset id, between 0 and the number of assets - 1
+//! @return	returns NULL if the id is not valid
+AssetPackEntry* AssetPack_GetEntry(AssetPack* the_pack, signed int the_id)
+{
+	return AssetPack_GetEntryOfType(the_pack, the_id, false);
+}
+
+
+
+
+// **** Load functions ****
+
+//! Create a new bitmap and load a bitmap asset into it
+//! @param	the_id: id of a bitmap asset
+//! @return	returns NULL on any error
+Bitmap* AssetPack_LoadBitmap(AssetPack* the_pack, signed int the_id)
+{
+	AssetPackEntry*	the_entry;
+	Bitmap*			the_bitmap;
+
+	if ((the_entry = AssetPack_GetEntryOfType(the_pack, the_id, true)) == NULL)
+	{
+		return NULL;
+	}
+
+	if ((the_bitmap = Bitmap_NewWithFlags(the_entry->width_, the_entry->height_, NULL, BITMAP_FLAG_UNINITIALIZED)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create a %i x %i bitmap for '%s'", __func__, __LINE__, the_entry->width_, the_entry->height_, the_entry->name_));
+		return NULL;
+	}
+
+	if (!AssetPack_LoadBitmapRect(the_pack, the_id, 0, 0, the_entry->width_, the_entry->height_, the_bitmap, 0, 0))
+	{
+		Bitmap_Destroy(&the_bitmap);
+	}
+
+	return the_bitmap;
+}
+
+
+//! Load a rectangle of a bitmap asset into an existing bitmap
+//! Only the bands of the asset that the rectangle touches are read and decompressed. The rectangle is clipped to both the asset and the destination bitmap.
+//! @param	the_id: id of a bitmap asset
+//! @param	src_x, src_y, width, height: the rectangle of the asset to load
+//! @param	dst_bm: reference to a valid Bitmap object to load into
+//! @param	dst_x, dst_y: where in dst_bm the top left corner of the rectangle should go
+//! @return	returns false on any error
+boolean AssetPack_LoadBitmapRect(AssetPack* the_pack, signed int the_id, signed int src_x, signed int src_y, signed int width, signed int height, Bitmap* dst_bm, signed int dst_x, signed int dst_y)
+{
+	AssetPackEntry*	the_entry;
+	unsigned char*	the_write_loc;
+	unsigned char*	the_target;
+	uint8_t*		the_band_buffer = NULL;
+	uint8_t*		the_stored_buffer = NULL;
+	unsigned long*	the_band_offset = NULL;
+	unsigned long	max_stored_len = 0;
+	unsigned long	stored_len;
+	uint8_t			the_bytes[4];
+	boolean			the_result = false;
+	boolean			direct;
+	signed int		first_band;
+	signed int		num_bands;
+	signed int		the_band;
+	signed int		band_top;
+	signed int		band_rows;
+	signed int		the_row;
+	signed int		last_row;
+	signed int		i;
+
+	if ((the_entry = AssetPack_GetEntryOfType(the_pack, the_id, true)) == NULL)
+	{
+		return false;
+	}
+
+	if (dst_bm == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	// LOGIC:
+	//   clip the rectangle to the asset, then to the destination, moving the other side's origin along with it
+
+	if (src_x < 0)
+	{
+		width += src_x;
+		dst_x -= src_x;
+		src_x = 0;
+	}
+
+	if (src_y < 0)
+	{
+		height += src_y;
+		dst_y -= src_y;
+		src_y = 0;
+	}
+
+	if (dst_x < 0)
+	{
+		width += dst_x;
+		src_x -= dst_x;
+		dst_x = 0;
+	}
+
+	if (dst_y < 0)
+	{
+		height += dst_y;
+		src_y -= dst_y;
+		dst_y = 0;
+	}
+
+	width = (src_x + width > the_entry->width_) ? the_entry->width_ - src_x : width;
+	width = (dst_x + width > dst_bm->width_) ? dst_bm->width_ - dst_x : width;
+	height = (src_y + height > the_entry->height_) ? the_entry->height_ - src_y : height;
+	height = (dst_y + height > dst_bm->height_) ? dst_bm->height_ - dst_y : height;
+
+	if (width <= 0 || height <= 0)
+	{
+		LOG_WARN(("%s %d: rectangle is entirely outside the asset or the bitmap", __func__, __LINE__));
+		return true;
+	}
+
+	if ((the_write_loc = Bitmap_GetMemLocForWrite(dst_bm, dst_x, dst_y, width, height)) == NULL)
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   read just the part of the band table covering the bands we need. those bands are contiguous in the file, so after one seek they are read in order.
+	//   a band that is needed in full, and whose rows are full rows of the destination, is decompressed straight into the destination.
+	//   any other band is decompressed into a scratch band, and the wanted part of each row copied out of it.
+
+	first_band = src_y / ASSET_PACK_BAND_HEIGHT;
+	num_bands = (src_y + height - 1) / ASSET_PACK_BAND_HEIGHT - first_band + 1;
+
+	if ((the_band_offset = f_calloc(num_bands + 1, sizeof(unsigned long), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for band table", __func__, __LINE__));
+		return false;
+	}
+
+	if (fseek(the_pack->file_, the_entry->offset_ + first_band * 4, SEEK_SET) != 0)
+	{
+		goto read_error;
+	}
+
+	for (i = 0; i <= num_bands; i++)
+	{
+		if (fread(the_bytes, 4, 1, the_pack->file_) != 1)
+		{
+			goto read_error;
+		}
+
+		the_band_offset[i] = BYTES_GET_BE32(the_bytes);
+
+		if (i > 0)
+		{
+			stored_len = the_band_offset[i] - the_band_offset[i - 1];
+			max_stored_len = (stored_len > max_stored_len) ? stored_len : max_stored_len;
+		}
+	}
+
+	if ((the_band_buffer = f_calloc(the_entry->width_ * ASSET_PACK_BAND_HEIGHT, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for band buffer", __func__, __LINE__));
+		goto done;
+	}
+
+	if (the_entry->compression_ != ASSET_COMPRESSION_NONE && (the_stored_buffer = f_calloc(max_stored_len, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for compressed band buffer", __func__, __LINE__));
+		goto done;
+	}
+
+	if (fseek(the_pack->file_, the_entry->offset_ + the_band_offset[0], SEEK_SET) != 0)
+	{
+		goto read_error;
+	}
+
+	for (i = 0; i < num_bands; i++)
+	{
+		the_band = first_band + i;
+		band_top = the_band * ASSET_PACK_BAND_HEIGHT;
+		band_rows = (band_top + ASSET_PACK_BAND_HEIGHT > the_entry->height_) ? the_entry->height_ - band_top : ASSET_PACK_BAND_HEIGHT;
+		stored_len = the_band_offset[i + 1] - the_band_offset[i];
+
+		direct = (src_x == 0 && width == the_entry->width_ && dst_bm->width_ == the_entry->width_ && band_top >= src_y && band_top + band_rows <= src_y + height);
+		the_target = direct ? the_write_loc + (band_top - src_y) * dst_bm->width_ : the_band_buffer;
+
+		if (the_entry->compression_ == ASSET_COMPRESSION_NONE)
+		{
+			if (stored_len != (unsigned long)(band_rows * the_entry->width_) || fread(the_target, stored_len, 1, the_pack->file_) != 1)
+			{
+				goto read_error;
+			}
+		}
+		else
+		{
+			if (fread(the_stored_buffer, stored_len, 1, the_pack->file_) != 1)
+			{
+				goto read_error;
+			}
+
+			if (!AssetPack_Decompress(the_stored_buffer, stored_len, the_target, band_rows * the_entry->width_))
+			{
+				LOG_ERR(("%s %d: band %i of '%s' is damaged", __func__, __LINE__, the_band, the_entry->name_));
+				goto done;
+			}
+		}
+
+		if (!direct)
+		{
+			the_row = (band_top > src_y) ? band_top : src_y;
+			last_row = (band_top + band_rows < src_y + height) ? band_top + band_rows : src_y + height;
+
+			for (; the_row < last_row; the_row++)
+			{
+				memcpy(the_write_loc + (the_row - src_y) * dst_bm->width_, the_band_buffer + (the_row - band_top) * the_entry->width_ + src_x, width);
+			}
+		}
+	}
+
+	the_result = true;
+	goto done;
+
+read_error:
+	LOG_ERR(("%s %d: Couldn't read asset '%s'", __func__, __LINE__, the_entry->name_));
+
+done:
+	f_free(the_band_offset, MEM_STANDARD);
+
+	if (the_band_buffer)
+	{
+		f_free(the_band_buffer, MEM_STANDARD);
+	}
+
+	if (the_stored_buffer)
+	{
+		f_free(the_stored_buffer, MEM_STANDARD);
+	}
+
+	return the_result;
+}
+
+
+//! Load any type of asset as bytes into a buffer
+//! For palettes, fonts, and other data. Bitmap assets are loaded as their band table plus bands, which is only useful for copying them.
+//! @param	the_id: id of an asset
+//! @param	the_buffer: the buffer to load into
+//! @param	buffer_len: size of the_buffer. Must be at least the asset's unpacked_len_.
+//! @return	returns false on any error
+boolean AssetPack_LoadData(AssetPack* the_pack, signed int the_id, void* the_buffer, unsigned long buffer_len)
+{
+	AssetPackEntry*	the_entry;
+	uint8_t*		the_stored_buffer;
+	boolean			the_result;
+
+	if ((the_entry = AssetPack_GetEntryOfType(the_pack, the_id, false)) == NULL)
+	{
+		return false;
+	}
+
+	if (the_buffer == NULL || buffer_len < the_entry->unpacked_len_)
+	{
+		LOG_ERR(("%s %d: buffer is NULL or too small for asset '%s' (%lu bytes)", __func__, __LINE__, the_entry->name_, the_entry->unpacked_len_));
+		return false;
+	}
+
+	if (fseek(the_pack->file_, the_entry->offset_, SEEK_SET) != 0)
+	{
+		LOG_ERR(("%s %d: Couldn't read asset '%s'", __func__, __LINE__, the_entry->name_));
+		return false;
+	}
+
+	if (the_entry->compression_ == ASSET_COMPRESSION_NONE || the_entry->type_ == ASSET_TYPE_BITMAP)
+	{
+		if (fread(the_buffer, the_entry->stored_len_, 1, the_pack->file_) != 1)
+		{
+			LOG_ERR(("%s %d: Couldn't read asset '%s'", __func__, __LINE__, the_entry->name_));
+			return false;
+		}
+
+		return true;
+	}
+
+	if ((the_stored_buffer = f_calloc(the_entry->stored_len_, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for compressed asset", __func__, __LINE__));
+		return false;
+	}
+
+	the_result = (fread(the_stored_buffer, the_entry->stored_len_, 1, the_pack->file_) == 1 && AssetPack_Decompress(the_stored_buffer, the_entry->stored_len_, the_buffer, the_entry->unpacked_len_));
+
+	if (!the_result)
+	{
+		LOG_ERR(("%s %d: Couldn't read asset '%s', or it is damaged", __func__, __LINE__, the_entry->name_));
+	}
+
+	f_free(the_stored_buffer, MEM_STANDARD);
+
+	return the_result;
+}
+
+
+//! Load a font asset
+//! The font file is loaded into one allocation that the font owns and uses in place. See Font_NewFromMemory().
+//! @param	the_id: id of a font asset
+//! @return	returns NULL on any error
+Font* AssetPack_LoadFont(AssetPack* the_pack, signed int the_id)
+{
+	AssetPackEntry*	the_entry;
+	Font*			the_font;
+	uint8_t*		the_data;
+
+	if ((the_entry = AssetPack_GetEntryOfType(the_pack, the_id, false)) == NULL)
+	{
+		return NULL;
+	}
+
+	if (the_entry->type_ != ASSET_TYPE_FONT)
+	{
+		LOG_ERR(("%s %d: asset '%s' is not a font", __func__, __LINE__, the_entry->name_));
+		return NULL;
+	}
+
+	if ((the_data = f_calloc(the_entry->unpacked_len_, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate %lu bytes for font asset", __func__, __LINE__, the_entry->unpacked_len_));
+		return NULL;
+	}
+
+	if (!AssetPack_LoadData(the_pack, the_id, the_data, the_entry->unpacked_len_) || (the_font = Font_NewFromMemory(the_data, the_entry->unpacked_len_)) == NULL)
+	{
+		f_free(the_data, MEM_STANDARD);
+		return NULL;
+	}
+
+	// the font uses the data in place, so it takes ownership of it
+	the_font->data_ = the_data;
+
+	return the_font;
+}
+
+
+
+
+// **** Pack creation functions ****
+
+//! Start writing a new asset pack
+//! @param	the_path: path of the file to create or overwrite
+//! @param	max_assets: the most assets that will be added, up to ASSET_PACK_MAX_ASSETS
+//! @return	returns NULL on any error
+AssetPackWriter* AssetPack_NewWriter(const char* the_path, signed int max_assets)
+{
+	AssetPackWriter*	the_writer;
+	uint8_t				the_header[ASSET_PACK_HEADER_SIZE];
+
+	if (the_path == NULL || max_assets < 1 || max_assets > ASSET_PACK_MAX_ASSETS)
+	{
+		LOG_ERR(("%s %d: passed path was NULL or max assets (%i) was invalid", __func__, __LINE__, max_assets));
+		return NULL;
+	}
+
+	if ((the_writer = f_calloc(1, sizeof(AssetPackWriter), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for asset pack writer", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_writer	%p	size	%i", __func__ , __LINE__, the_writer, sizeof(AssetPackWriter)));
+
+	if ((the_writer->entry_ = f_calloc(max_assets, sizeof(AssetPackEntry), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i index entries", __func__, __LINE__, max_assets));
+		goto error;
+	}
+
+	if ((the_writer->file_ = fopen(the_path, "wb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create file '%s'", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	// LOGIC:
+	//   the header is written blank for now: the index goes at the end, once every asset's offset and size is known,
+	//     and AssetPack_FinishWriter fills in the header to point at it.
+
+	memset(the_header, 0, ASSET_PACK_HEADER_SIZE);
+
+	if (fwrite(the_header, ASSET_PACK_HEADER_SIZE, 1, the_writer->file_) != 1)
+	{
+		LOG_ERR(("%s %d: Couldn't write to file '%s'", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	the_writer->max_assets_ = max_assets;
+	the_writer->next_offset_ = ASSET_PACK_HEADER_SIZE;
+
+	return the_writer;
+
+error:
+	if (the_writer->file_)
+	{
+		fclose(the_writer->file_);
+	}
+
+	if (the_writer->entry_)
+	{
+		f_free(the_writer->entry_, MEM_STANDARD);
+	}
+
+	f_free(the_writer, MEM_STANDARD);
+	return NULL;
+}
+
+
+//! Add a bitmap to an asset pack being written
+//! @param	the_name: name of the asset, up to ASSET_PACK_NAME_LEN characters
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	compress: PARAM_COMPRESS or PARAM_DO_NOT_COMPRESS
+//! @return	returns the new asset's id, or ASSET_PACK_NOT_FOUND on any error
+signed int AssetPack_AddBitmap(AssetPackWriter* the_writer, const char* the_name, Bitmap* the_bitmap, boolean compress)
+{
+	AssetPackEntry*	the_entry;
+	uint8_t*		the_band_buffer = NULL;
+	uint8_t*		the_out_buffer = NULL;
+	uint8_t*		the_table = NULL;
+	signed long*	the_hash = NULL;
+	uint8_t*		the_band_data;
+	unsigned long	the_len;
+	unsigned long	table_len;
+	unsigned long	the_offset;
+	signed int		the_id = ASSET_PACK_NOT_FOUND;
+	signed int		num_bands;
+	signed int		the_band;
+	signed int		band_rows;
+	signed int		the_row;
+
+	if (the_writer == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed writer or bitmap was NULL", __func__, __LINE__));
+		return ASSET_PACK_NOT_FOUND;
+	}
+
+	if ((the_entry = AssetPack_AddEntry(the_writer, the_name, ASSET_TYPE_BITMAP)) == NULL)
+	{
+		return ASSET_PACK_NOT_FOUND;
+	}
+
+	num_bands = (the_bitmap->height_ + ASSET_PACK_BAND_HEIGHT - 1) / ASSET_PACK_BAND_HEIGHT;
+	table_len = (num_bands + 1) * 4;
+
+	the_table = f_calloc(table_len, 1, MEM_STANDARD);
+	the_band_buffer = f_calloc(the_bitmap->width_ * ASSET_PACK_BAND_HEIGHT, 1, MEM_STANDARD);
+
+	if (compress)
+	{
+		the_out_buffer = f_calloc(ASSET_PACK_LZ_BOUND(the_bitmap->width_ * ASSET_PACK_BAND_HEIGHT), 1, MEM_STANDARD);
+		the_hash = f_calloc(1 << ASSET_PACK_LZ_HASH_BITS, sizeof(signed long), MEM_STANDARD);
+	}
+
+	if (the_table == NULL || the_band_buffer == NULL || (compress && (the_out_buffer == NULL || the_hash == NULL)))
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for compressing bitmap", __func__, __LINE__));
+		goto done;
+	}
+
+	// LOGIC:
+	//   the band table is written blank first, then each band after it, then the table is rewritten with the real offsets.
+	//   rows are copied into a band buffer with Bitmap_GetMemLocForXY, so lazily-cleared bands are cleared before they are read.
+
+	if (fwrite(the_table, table_len, 1, the_writer->file_) != 1)
+	{
+		goto write_error;
+	}
+
+	the_offset = table_len;
+
+	for (the_band = 0; the_band < num_bands; the_band++)
+	{
+		band_rows = (the_band * ASSET_PACK_BAND_HEIGHT + ASSET_PACK_BAND_HEIGHT > the_bitmap->height_) ? the_bitmap->height_ - the_band * ASSET_PACK_BAND_HEIGHT : ASSET_PACK_BAND_HEIGHT;
+
+		for (the_row = 0; the_row < band_rows; the_row++)
+		{
+			memcpy(the_band_buffer + the_row * the_bitmap->width_, Bitmap_GetMemLocForXY(the_bitmap, 0, the_band * ASSET_PACK_BAND_HEIGHT + the_row), the_bitmap->width_);
+		}
+
+		the_len = band_rows * the_bitmap->width_;
+		the_band_data = the_band_buffer;
+
+		if (compress)
+		{
+			the_len = AssetPack_Compress(the_band_buffer, the_len, the_out_buffer, the_hash);
+			the_band_data = the_out_buffer;
+		}
+
+		if (fwrite(the_band_data, the_len, 1, the_writer->file_) != 1)
+		{
+			goto write_error;
+		}
+
+		BYTES_PUT_BE32(&the_table[the_band * 4], the_offset);
+		the_offset += the_len;
+	}
+
+	BYTES_PUT_BE32(&the_table[num_bands * 4], the_offset);
+
+	if (fseek(the_writer->file_, the_entry->offset_, SEEK_SET) != 0 || fwrite(the_table, table_len, 1, the_writer->file_) != 1)
+	{
+		goto write_error;
+	}
+
+	the_entry->compression_ = compress ? ASSET_COMPRESSION_LZ : ASSET_COMPRESSION_NONE;
+	the_entry->width_ = the_bitmap->width_;
+	the_entry->height_ = the_bitmap->height_;
+	the_entry->stored_len_ = the_offset;
+	the_entry->unpacked_len_ = the_bitmap->width_ * the_bitmap->height_;
+	the_writer->next_offset_ += the_offset;
+	the_id = the_writer->num_assets_++;
+	goto done;
+
+write_error:
+	LOG_ERR(("%s %d: Couldn't write bitmap '%s' to pack", __func__, __LINE__, the_name));
+
+done:
+	if (the_table)
+	{
+		f_free(the_table, MEM_STANDARD);
+	}
+
+	if (the_band_buffer)
+	{
+		f_free(the_band_buffer, MEM_STANDARD);
+	}
+
+	if (the_out_buffer)
+	{
+		f_free(the_out_buffer, MEM_STANDARD);
+	}
+
+	if (the_hash)
+	{
+		f_free(the_hash, MEM_STANDARD);
+	}
+
+	return the_id;
+}
+
+
+//! Add a palette, font, or any other data to an asset pack being written
+//! @param	the_name: name of the asset, up to ASSET_PACK_NAME_LEN characters
+//! @param	the_type: an asset_type value other than ASSET_TYPE_BITMAP
+//! @param	the_data, the_len: the bytes to add
+//! @param	compress: PARAM_COMPRESS or PARAM_DO_NOT_COMPRESS. If compressing would not make the data smaller, it is stored as-is regardless.
+//! @return	returns the new asset's id, or ASSET_PACK_NOT_FOUND on any error
+signed int AssetPack_AddData(AssetPackWriter* the_writer, const char* the_name, uint8_t the_type, const void* the_data, unsigned long the_len, boolean compress)
+{
+	AssetPackEntry*	the_entry;
+	uint8_t*		the_out_buffer = NULL;
+	signed long*	the_hash = NULL;
+	const void*		the_stored_data = the_data;
+	unsigned long	stored_len = the_len;
+	signed int		the_id = ASSET_PACK_NOT_FOUND;
+
+	if (the_writer == NULL || the_data == NULL || the_len == 0 || the_type == ASSET_TYPE_BITMAP)
+	{
+		LOG_ERR(("%s %d: passed writer or data was NULL, or type was bitmap", __func__, __LINE__));
+		return ASSET_PACK_NOT_FOUND;
+	}
+
+	if ((the_entry = AssetPack_AddEntry(the_writer, the_name, the_type)) == NULL)
+	{
+		return ASSET_PACK_NOT_FOUND;
+	}
+
+	the_entry->compression_ = ASSET_COMPRESSION_NONE;
+
+	if (compress)
+	{
+		the_out_buffer = f_calloc(ASSET_PACK_LZ_BOUND(the_len), 1, MEM_STANDARD);
+		the_hash = f_calloc(1 << ASSET_PACK_LZ_HASH_BITS, sizeof(signed long), MEM_STANDARD);
+
+		if (the_out_buffer == NULL || the_hash == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for compressing data", __func__, __LINE__));
+			goto done;
+		}
+
+		stored_len = AssetPack_Compress(the_data, the_len, the_out_buffer, the_hash);
+
+		if (stored_len < the_len)
+		{
+			the_stored_data = the_out_buffer;
+			the_entry->compression_ = ASSET_COMPRESSION_LZ;
+		}
+		else
+		{
+			stored_len = the_len;
+		}
+	}
+
+	if (fwrite(the_stored_data, stored_len, 1, the_writer->file_) != 1)
+	{
+		LOG_ERR(("%s %d: Couldn't write asset '%s' to pack", __func__, __LINE__, the_name));
+		goto done;
+	}
+
+	the_entry->stored_len_ = stored_len;
+	the_entry->unpacked_len_ = the_len;
+	the_writer->next_offset_ += stored_len;
+	the_id = the_writer->num_assets_++;
+
+done:
+	if (the_out_buffer)
+	{
+		f_free(the_out_buffer, MEM_STANDARD);
+	}
+
+	if (the_hash)
+	{
+		f_free(the_hash, MEM_STANDARD);
+	}
+
+	return the_id;
+}
+
+
+//! Write the index of an asset pack being written, close the file, and free the writer
+//! @return	returns false on any error. The file is not a valid asset pack in that case.
+boolean AssetPack_FinishWriter(AssetPackWriter** the_writer)
+{
+	AssetPackWriter*	the_pack;
+	AssetPackEntry*		the_entry;
+	uint8_t				the_buffer[ASSET_PACK_ENTRY_SIZE];
+	boolean				the_result = true;
+	signed int			i;
+
+	if (the_writer == NULL || *the_writer == NULL)
+	{
+		LOG_ERR(("%s %d: passed writer was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	the_pack = *the_writer;
+
+	if (fseek(the_pack->file_, the_pack->next_offset_, SEEK_SET) != 0)
+	{
+		the_result = false;
+	}
+
+	for (i = 0; i < the_pack->num_assets_ && the_result; i++)
+	{
+		the_entry = &the_pack->entry_[i];
+		memset(the_buffer, 0, ASSET_PACK_ENTRY_SIZE);
+		memcpy(the_buffer, the_entry->name_, strlen(the_entry->name_));
+		the_buffer[20] = the_entry->type_;
+		the_buffer[21] = the_entry->compression_;
+		BYTES_PUT_BE16(&the_buffer[22], the_entry->width_);
+		BYTES_PUT_BE16(&the_buffer[24], the_entry->height_);
+		BYTES_PUT_BE32(&the_buffer[28], the_entry->offset_);
+		BYTES_PUT_BE32(&the_buffer[32], the_entry->stored_len_);
+		BYTES_PUT_BE32(&the_buffer[36], the_entry->unpacked_len_);
+
+		the_result = (fwrite(the_buffer, ASSET_PACK_ENTRY_SIZE, 1, the_pack->file_) == 1);
+	}
+
+	memset(the_buffer, 0, ASSET_PACK_HEADER_SIZE);
+	memcpy(the_buffer, ASSET_PACK_MAGIC, 4);
+	BYTES_PUT_BE16(&the_buffer[4], ASSET_PACK_VERSION);
+	BYTES_PUT_BE16(&the_buffer[6], the_pack->num_assets_);
+	BYTES_PUT_BE32(&the_buffer[8], the_pack->next_offset_);
+
+	if (the_result)
+	{
+		the_result = (fseek(the_pack->file_, 0, SEEK_SET) == 0 && fwrite(the_buffer, ASSET_PACK_HEADER_SIZE, 1, the_pack->file_) == 1);
+	}
+
+	if (fclose(the_pack->file_) != 0 || !the_result)
+	{
+		LOG_ERR(("%s %d: Couldn't finish writing asset pack", __func__, __LINE__));
+		the_result = false;
+	}
+
+	f_free(the_pack->entry_, MEM_STANDARD);
+	LOG_ALLOC(("%s %d:	__FREE__	*the_writer	%p	size	%i", __func__ , __LINE__, *the_writer, sizeof(AssetPackWriter)));
+	f_free(the_pack, MEM_STANDARD);
+	*the_writer = NULL;
+
+	return the_result;
+}
@@ -0,0 +1,243 @@
+//! @file lib_asset_pack.h
+
+/*
+ * lib_asset_pack.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_ASSET_PACK_H_
+#define LIB_ASSET_PACK_H_
+
+
+/* about this library: AssetPack
+ *
+ * An asset pack is a single file holding any number of bitmaps, palettes, fonts, and other data, so an app can open one file at startup instead of dozens.
+ * The index of every asset is read once, when the pack is opened. Assets can then be found by name, and loaded by id (their position in the pack).
+ *
+ * Bitmaps are stored in bands of ASSET_PACK_BAND_HEIGHT rows, each compressed separately, with a table of where each band starts.
+ * Loading part of a bitmap only reads and decompresses the bands that part touches.
+ *
+ * Compression is the LZ4 block format: byte-oriented literal runs and back-references with no tables or bit fiddling, so it decompresses quickly on a 68000.
+ *
+ *** file format
+ * All multi-byte fields are big-endian.
+ *   header (ASSET_PACK_HEADER_SIZE bytes):
+ *     0   4   magic: 'A' '2' 'P' 'K'
+ *     4   2   version: ASSET_PACK_VERSION
+ *     6   2   number of assets
+ *     8   4   offset of the index from the start of the file
+ *     12  4   reserved, 0
+ *   index: 1 entry of ASSET_PACK_ENTRY_SIZE bytes per asset:
+ *     0   20  name, 0-padded. Need not be 0-terminated if it is exactly 20 characters long.
+ *     20  1   type: an asset_type value
+ *     21  1   compression: an asset_compression value
+ *     22  2   width (bitmaps only)
+ *     24  2   height (bitmaps only)
+ *     26  2   reserved, 0
+ *     28  4   offset of the asset data from the start of the file
+ *     32  4   stored size of the asset data, in bytes
+ *     36  4   unpacked size of the asset, in bytes
+ *   bitmap asset data:
+ *     a band table of (number of bands + 1) 4-byte offsets, from the start of the asset data, to the start of each band. The last entry is the end of the last band.
+ *     each band: ASSET_PACK_BAND_HEIGHT rows (fewer for the last band) of width pixels, compressed or not as given in the index.
+ *   all other asset data:
+ *     the asset's bytes, compressed or not as given in the index.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define ASSET_PACK_MAGIC			"A2PK"	//!< first 4 bytes of every asset pack
+#define ASSET_PACK_VERSION			1		//!< asset pack format version written by AssetPack_NewWriter
+#define ASSET_PACK_HEADER_SIZE		16		//!< size of the pack header, in bytes
+#define ASSET_PACK_ENTRY_SIZE		40		//!< size of one index entry, in bytes
+#define ASSET_PACK_NAME_LEN			20		//!< maximum length of an asset name
+#define ASSET_PACK_BAND_HEIGHT		16		//!< number of rows in each separately-compressed band of a bitmap asset
+#define ASSET_PACK_MAX_ASSETS		65535	//!< maximum number of assets in one pack
+#define ASSET_PACK_NOT_FOUND		-1		//!< returned by AssetPack_FindAsset when there is no asset with the passed name
+
+#define ASSET_PACK_LZ_MIN_MATCH		4		//!< shortest back-reference the compressor will emit
+#define ASSET_PACK_LZ_HASH_BITS		12		//!< the compressor finds matches with a table of 2^this recent positions
+#define ASSET_PACK_LZ_MAX_OFFSET	65535	//!< farthest back a back-reference can reach
+
+#define PARAM_COMPRESS				true	//!< for AssetPack_AddBitmap and AssetPack_AddData: compress the asset
+#define PARAM_DO_NOT_COMPRESS		false	//!< for AssetPack_AddBitmap and AssetPack_AddData: store the asset as-is
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum asset_type
+{
+	ASSET_TYPE_DATA = 0,	//!< bytes with no meaning to the library
+	ASSET_TYPE_BITMAP,		//!< an 8-bit bitmap, stored in bands
+	ASSET_TYPE_PALETTE,		//!< a BITMAP_PALETTE_BYTES palette, in LUT order (B, G, R, A)
+	ASSET_TYPE_FONT,		//!< a font file
+} asset_type;
+
+typedef enum asset_compression
+{
+	ASSET_COMPRESSION_NONE = 0,
+	ASSET_COMPRESSION_LZ,	//!< LZ4 block format
+} asset_compression;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct AssetPack AssetPack;
+typedef struct AssetPackEntry AssetPackEntry;
+typedef struct AssetPackWriter AssetPackWriter;
+
+//! One asset's index entry, as read from the file
+struct AssetPackEntry
+{
+	char			name_[ASSET_PACK_NAME_LEN + 1];
+	uint8_t			type_;			//!< an asset_type value
+	uint8_t			compression_;	//!< an asset_compression value
+	signed int		width_;			//!< bitmaps only: width in pixels
+	signed int		height_;		//!< bitmaps only: height in pixels
+	unsigned long	offset_;		//!< offset of the asset data from the start of the file
+	unsigned long	stored_len_;	//!< bytes the asset data takes up in the file
+	unsigned long	unpacked_len_;	//!< bytes the asset takes up once loaded
+};
+
+struct AssetPack
+{
+	FILE*			file_;
+	signed int		num_assets_;
+	AssetPackEntry*	entry_;			//!< num_assets_ index entries, in id order
+};
+
+struct AssetPackWriter
+{
+	FILE*			file_;
+	signed int		num_assets_;
+	signed int		max_assets_;
+	AssetPackEntry*	entry_;			//!< max_assets_ index entries, filled in as assets are added
+	unsigned long	next_offset_;	//!< where the next asset's data will be written
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Open an asset pack and read its index
+//! The file stays open until AssetPack_Close(), so assets can be loaded from it as they are needed.
+//! @param	the_path: path of the asset pack file
+//! @return	returns NULL on any error
+AssetPack* AssetPack_Open(const char* the_path);
+
+// destructor
+// closes the file, and frees all allocated memory associated with the passed object, and the object itself. Assets already loaded are not affected.
+boolean AssetPack_Close(AssetPack** the_pack);
+
+
+// **** Getter functions ****
+
+//! Find an asset by name
+//! @param	the_name: name of the asset. Compared case-sensitively.
+//! @return	returns the asset's id, or ASSET_PACK_NOT_FOUND if the pack has no asset with that name
+signed int AssetPack_FindAsset(AssetPack* the_pack, const char* the_name);
+
+//! Get the index entry of an asset, to check its type and sizes before loading it
+//! @param	the_id: an asset id, between 0 and the number of assets - 1
+//! @return	returns NULL if the id is not valid
+AssetPackEntry* AssetPack_GetEntry(AssetPack* the_pack, signed int the_id);
+
+
+// **** Load functions ****
+
+//! Create a new bitmap and load a bitmap asset into it
+//! @param	the_id: id of a bitmap asset
+//! @return	returns NULL on any error
+Bitmap* AssetPack_LoadBitmap(AssetPack* the_pack, signed int the_id);
+
+//! Load a rectangle of a bitmap asset into an existing bitmap
+//! Only the bands of the asset that the rectangle touches are read and decompressed. The rectangle is clipped to both the asset and the destination bitmap.
+//! @param	the_id: id of a bitmap asset
+//! @param	src_x, src_y, width, height: the rectangle of the asset to load
+//! @param	dst_bm: reference to a valid Bitmap object to load into
+//! @param	dst_x, dst_y: where in dst_bm the top left corner of the rectangle should go
+//! @return	returns false on any error
+boolean AssetPack_LoadBitmapRect(AssetPack* the_pack, signed int the_id, signed int src_x, signed int src_y, signed int width, signed int height, Bitmap* dst_bm, signed int dst_x, signed int dst_y);
+
+//! Load any type of asset as bytes into a buffer
+//! For palettes, fonts, and other data. Bitmap assets are loaded as their band table plus bands, which is only useful for copying them.
+//! @param	the_id: id of an asset
+//! @param	the_buffer: the buffer to load into
+//! @param	buffer_len: size of the_buffer. Must be at least the asset's unpacked_len_.
+//! @return	returns false on any error
+boolean AssetPack_LoadData(AssetPack* the_pack, signed int the_id, void* the_buffer, unsigned long buffer_len);
+
+//! Load a font asset
+//! The font file is loaded into one allocation that the font owns and uses in place. See Font_NewFromMemory().
+//! @param	the_id: id of a font asset
+//! @return	returns NULL on any error
+Font* AssetPack_LoadFont(AssetPack* the_pack, signed int the_id);
+
+
+// **** Pack creation functions ****
+
+//! Start writing a new asset pack
+//! @param	the_path: path of the file to create or overwrite
+//! @param	max_assets: the most assets that will be added, up to ASSET_PACK_MAX_ASSETS
+//! @return	returns NULL on any error
+AssetPackWriter* AssetPack_NewWriter(const char* the_path, signed int max_assets);
+
+//! Add a bitmap to an asset pack being written
+//! @param	the_name: name of the asset, up to ASSET_PACK_NAME_LEN characters
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	compress: PARAM_COMPRESS or PARAM_DO_NOT_COMPRESS
+//! @return	returns the new asset's id, or ASSET_PACK_NOT_FOUND on any error
+signed int AssetPack_AddBitmap(AssetPackWriter* the_writer, const char* the_name, Bitmap* the_bitmap, boolean compress);
+
+//! Add a palette, font, or any other data to an asset pack being written
+//! @param	the_name: name of the asset, up to ASSET_PACK_NAME_LEN characters
+//! @param	the_type: an asset_type value other than ASSET_TYPE_BITMAP
+//! @param	the_data, the_len: the bytes to add
+//! @param	compress: PARAM_COMPRESS or PARAM_DO_NOT_COMPRESS. If compressing would not make the data smaller, it is stored as-is regardless.
+//! @return	returns the new asset's id, or ASSET_PACK_NOT_FOUND on any error
+signed int AssetPack_AddData(AssetPackWriter* the_writer, const char* the_name, uint8_t the_type, const void* the_data, unsigned long the_len, boolean compress);
+
+//! Write the index of an asset pack being written, close the file, and free the writer
+//! @return	returns false on any error. The file is not a valid asset pack in that case.
+boolean AssetPack_FinishWriter(AssetPackWriter** the_writer);
+
+
+
+#endif /* LIB_ASSET_PACK_H_ */
@@ -0,0 +1,1146 @@
+/*
+ * lib_bitmap_file.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_bitmap_file.h"
+#include "lib_byte_order.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+// host-build includes
+#if defined(__linux__)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// open a BMP, PCX, or raw bitmap file, read its header and palette, and leave it positioned at the first pixel
+BitmapFileReader* BitmapFile_Open(const char* the_path, uint8_t* the_palette);
+
+// close the file and free the reader
+void BitmapFile_Close(BitmapFileReader** the_reader);
+
+// refill the read buffer from the file
+boolean BitmapFile_FillBuffer(BitmapFileReader* the_reader);
+
+// get the next byte of the file
+boolean BitmapFile_GetByte(BitmapFileReader* the_reader, uint8_t* the_byte);
+
+// copy the next the_count bytes of the file to the_dest, or skip over them if the_dest is NULL
+boolean BitmapFile_ReadBytes(BitmapFileReader* the_reader, uint8_t* the_dest, signed int the_count);
+
+// decode the next row of the file, writing the_count pixels starting at column first_col to the_row_loc, or discarding the row if the_row_loc is NULL
+boolean BitmapFile_DecodeRow(BitmapFileReader* the_reader, unsigned char* the_row_loc, signed int first_col, signed int the_count);
+
+// decode every row of the file into the bitmap, with the top left corner of the image at x, y, clipping to the bitmap
+boolean BitmapFile_Decode(BitmapFileReader* the_reader, Bitmap* the_bitmap, signed int x, signed int y);
+
+// position the file at the start of the passed image row
+boolean BitmapFile_SeekRow(BitmapFileReader* the_reader, signed int image_row);
+
+// decode the rows of the file into the bitmap in interlaced order, replicating each row down until the rows below it are decoded
+boolean BitmapFile_DecodeProgressive(BitmapFileReader* the_reader, Bitmap* the_bitmap, signed int x, signed int y, BitmapFilePassCallback the_callback, void* the_user_data);
+
+// write out whatever is waiting in the write buffer
+void BitmapFile_FlushWriter(BitmapFileWriter* the_writer);
+
+// add one byte to the file being written
+void BitmapFile_WriteByte(BitmapFileWriter* the_writer, uint8_t the_byte);
+
+// add the_count bytes to the file being written
+void BitmapFile_WriteBytes(BitmapFileWriter* the_writer, const uint8_t* the_src, signed int the_count);
+
+// RLE encode one row of pixels, padded with 0s to the_stride, into a PCX file being written
+void BitmapFile_EncodePCXRow(BitmapFileWriter* the_writer, const unsigned char* the_row_loc, signed int the_width, signed int the_stride);
+
+//! \endcond
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Open a BMP, PCX, or raw bitmap file, read its header and palette, and leave it positioned at the first pixel
+//! @return	returns NULL if the file can't be opened, or is not in a supported format
+BitmapFileReader* BitmapFile_Open(const char* the_path, uint8_t* the_palette)
+{
+	BitmapFileReader*	the_reader;
+	uint8_t*			the_header;
+	uint8_t*			the_entry;
+	signed int			header_len;
+	signed int			num_colors = 0;
+	signed int			i;
+	int32_t				bmp_height;
+
+	if ((the_reader = f_calloc(1, sizeof(BitmapFileReader), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for file reader", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_reader	%p	size	%i", __func__ , __LINE__, the_reader, sizeof(BitmapFileReader)));
+
+	if ((the_reader->file_ = fopen(the_path, "rb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't open file '%s'", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	// LOGIC:
+	//   the read buffer isn't in use yet, so the header is read into it. all 3 headers fit in the first 128 bytes.
+	//   BMP palettes are already in LUT order (B, G, R, unused). PCX and raw palettes are elsewhere in the file, so they are read with a seek.
+
+	the_header = the_reader->buffer_;
+	header_len = fread(the_header, 1, 128, the_reader->file_);
+
+	if (the_palette)
+	{
+		memset(the_palette, 0, BITMAP_PALETTE_BYTES);
+	}
+
+	if (header_len >= BITMAP_RAW_HEADER_SIZE - BITMAP_PALETTE_BYTES && memcmp(the_header, BITMAP_RAW_MAGIC, 4) == 0)
+	{
+		if (BYTES_GET_BE16(&the_header[4]) != BITMAP_RAW_VERSION)
+		{
+			LOG_ERR(("%s %d: '%s' is raw bitmap version %u, not %u", __func__, __LINE__, the_path, BYTES_GET_BE16(&the_header[4]), BITMAP_RAW_VERSION));
+			goto error;
+		}
+
+		the_reader->format_ = BITMAP_FILE_RAW;
+		the_reader->width_ = BYTES_GET_BE16(&the_header[6]);
+		the_reader->height_ = BYTES_GET_BE16(&the_header[8]);
+		the_reader->stride_ = BYTES_GET_BE32(&the_header[12]);
+		the_reader->data_offset_ = BYTES_GET_BE32(&the_header[16]);
+
+		if (the_palette)
+		{
+			if (fseek(the_reader->file_, 20, SEEK_SET) != 0 || fread(the_palette, BITMAP_PALETTE_BYTES, 1, the_reader->file_) != 1)
+			{
+				goto read_error;
+			}
+		}
+	}
+	else if (header_len >= 54 && the_header[0] == 'B' && the_header[1] == 'M')
+	{
+		if (BYTES_GET_LE16(&the_header[28]) != 8 || BYTES_GET_LE32(&the_header[30]) != 0)
+		{
+			LOG_ERR(("%s %d: '%s' is not an uncompressed 8-bit BMP", __func__, __LINE__, the_path));
+			goto error;
+		}
+
+		the_reader->format_ = BITMAP_FILE_BMP;
+		the_reader->width_ = (int32_t)BYTES_GET_LE32(&the_header[18]);
+		bmp_height = (int32_t)BYTES_GET_LE32(&the_header[22]);
+
+		// a negative height means rows are stored top-down. the most negative value has no positive counterpart
+		if (bmp_height == 0 || bmp_height == INT32_MIN)
+		{
+			LOG_ERR(("%s %d: '%s' has an invalid height (%li)", __func__, __LINE__, the_path, (long)bmp_height));
+			goto error;
+		}
+
+		the_reader->bottom_up_ = (bmp_height > 0);
+		the_reader->height_ = (bmp_height > 0) ? bmp_height : -bmp_height;
+		the_reader->stride_ = (the_reader->width_ + 3) & ~3;
+		the_reader->data_offset_ = BYTES_GET_LE32(&the_header[10]);
+		num_colors = BYTES_GET_LE32(&the_header[46]);
+		num_colors = (num_colors == 0 || num_colors > 256) ? 256 : num_colors;
+
+		if (the_palette)
+		{
+			if (fseek(the_reader->file_, 14 + BYTES_GET_LE32(&the_header[14]), SEEK_SET) != 0 || fread(the_palette, 4, num_colors, the_reader->file_) != (size_t)num_colors)
+			{
+				goto read_error;
+			}
+
+			for (i = 0; i < num_colors; i++)
+			{
+				the_palette[i * 4 + 3] = 0xFF;
+			}
+		}
+	}
+	else if (header_len == 128 && the_header[0] == 0x0A && the_header[2] == 1 && the_header[3] == 8)
+	{
+		if (the_header[65] != 1)
+		{
+			LOG_ERR(("%s %d: '%s' is not a 1-plane 8-bit PCX", __func__, __LINE__, the_path));
+			goto error;
+		}
+
+		the_reader->format_ = BITMAP_FILE_PCX;
+		the_reader->width_ = BYTES_GET_LE16(&the_header[8]) - BYTES_GET_LE16(&the_header[4]) + 1;
+		the_reader->height_ = BYTES_GET_LE16(&the_header[10]) - BYTES_GET_LE16(&the_header[6]) + 1;
+		the_reader->stride_ = BYTES_GET_LE16(&the_header[66]);
+		the_reader->data_offset_ = 128;
+
+		// LOGIC:
+		//   a 256 color PCX palette is the last 769 bytes of the file: a 0x0C marker, then 256 x (R, G, B).
+		//   it is read in 2 halves, as the whole thing is bigger than the read buffer.
+
+		if (the_palette)
+		{
+			if (fseek(the_reader->file_, -769, SEEK_END) != 0 || fgetc(the_reader->file_) != 0x0C)
+			{
+				LOG_WARN(("%s %d: '%s' has no 256 color palette", __func__, __LINE__, the_path));
+			}
+			else
+			{
+				for (i = 0; i < 2; i++)
+				{
+					if (fread(the_reader->buffer_, 384, 1, the_reader->file_) != 1)
+					{
+						goto read_error;
+					}
+
+					for (num_colors = 0; num_colors < 128; num_colors++)
+					{
+						the_entry = &the_palette[(i * 128 + num_colors) * 4];
+						the_entry[0] = the_reader->buffer_[num_colors * 3 + 2];
+						the_entry[1] = the_reader->buffer_[num_colors * 3 + 1];
+						the_entry[2] = the_reader->buffer_[num_colors * 3];
+						the_entry[3] = 0xFF;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		LOG_ERR(("%s %d: '%s' is not a BMP, PCX, or raw bitmap file", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	if (the_reader->width_ < 1 || the_reader->height_ < 1 || the_reader->stride_ < the_reader->width_)
+	{
+		LOG_ERR(("%s %d: '%s' has an invalid width (%i), height (%i), or stride (%i)", __func__, __LINE__, the_path, the_reader->width_, the_reader->height_, the_reader->stride_));
+		goto error;
+	}
+
+	if (fseek(the_reader->file_, the_reader->data_offset_, SEEK_SET) != 0)
+	{
+		goto read_error;
+	}
+
+	return the_reader;
+
+read_error:
+	LOG_ERR(("%s %d: Couldn't read from file '%s'", __func__, __LINE__, the_path));
+
+error:
+	BitmapFile_Close(&the_reader);
+	return NULL;
+}
+
+
+//! Close the file and free the reader
+void BitmapFile_Close(BitmapFileReader** the_reader)
+{
+	if ((*the_reader)->file_)
+	{
+		fclose((*the_reader)->file_);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_reader	%p	size	%i", __func__ , __LINE__, *the_reader, sizeof(BitmapFileReader)));
+	f_free(*the_reader, MEM_STANDARD);
+	*the_reader = NULL;
+}
+
+
+//! Refill the read buffer from the file
+//! @return	returns false if there was nothing left to read
+boolean BitmapFile_FillBuffer(BitmapFileReader* the_reader)
+{
+	the_reader->pos_ = 0;
+	the_reader->len_ = fread(the_reader->buffer_, 1, BITMAP_FILE_READ_BUFFER_SIZE, the_reader->file_);
+
+	return (the_reader->len_ > 0);
+}
+
+
+//! Get the next byte of the file
+//! @return	returns false if the end of the file was reached
+boolean BitmapFile_GetByte(BitmapFileReader* the_reader, uint8_t* the_byte)
+{
+	if (the_reader->pos_ >= the_reader->len_ && !BitmapFile_FillBuffer(the_reader))
+	{
+		return false;
+	}
+
+	*the_byte = the_reader->buffer_[the_reader->pos_++];
+
+	return true;
+}
+
+
+//! Copy the next the_count bytes of the file to the_dest, or skip over them if the_dest is NULL
+//! @return	returns false if the end of the file was reached first
+boolean BitmapFile_ReadBytes(BitmapFileReader* the_reader, uint8_t* the_dest, signed int the_count)
+{
+	signed int		the_chunk;
+
+	// LOGIC:
+	//   whatever is already in the buffer is used first. after that, anything at least a buffer long is read (or skipped)
+	//     straight from the file, so big rows go directly into the bitmap without passing through the buffer.
+
+	the_chunk = the_reader->len_ - the_reader->pos_;
+	the_chunk = (the_count < the_chunk) ? the_count : the_chunk;
+
+	if (the_dest)
+	{
+		memcpy(the_dest, &the_reader->buffer_[the_reader->pos_], the_chunk);
+		the_dest += the_chunk;
+	}
+
+	the_reader->pos_ += the_chunk;
+	the_count -= the_chunk;
+
+	if (the_count >= BITMAP_FILE_READ_BUFFER_SIZE)
+	{
+		if (the_dest)
+		{
+			if (fread(the_dest, the_count, 1, the_reader->file_) != 1)
+			{
+				return false;
+			}
+		}
+		else if (fseek(the_reader->file_, the_count, SEEK_CUR) != 0)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	if (the_count > 0)
+	{
+		if (!BitmapFile_FillBuffer(the_reader) || the_reader->len_ < the_count)
+		{
+			return false;
+		}
+
+		if (the_dest)
+		{
+			memcpy(the_dest, the_reader->buffer_, the_count);
+		}
+
+		the_reader->pos_ = the_count;
+	}
+
+	return true;
+}
+
+
+//! Decode the next row of the file, writing the_count pixels starting at column first_col to the_row_loc, or discarding the row if the_row_loc is NULL
+//! @return	returns false if the file ended before the row did
+boolean BitmapFile_DecodeRow(BitmapFileReader* the_reader, unsigned char* the_row_loc, signed int first_col, signed int the_count)
+{
+	signed int		the_col;
+	signed int		the_len;
+	signed int		span_start;
+	signed int		span_end;
+	uint8_t			the_byte;
+
+	if (the_reader->format_ != BITMAP_FILE_PCX)
+	{
+		if (the_row_loc == NULL)
+		{
+			return BitmapFile_ReadBytes(the_reader, NULL, the_reader->stride_);
+		}
+
+		return BitmapFile_ReadBytes(the_reader, NULL, first_col) && 
+			BitmapFile_ReadBytes(the_reader, the_row_loc, the_count) && 
+			BitmapFile_ReadBytes(the_reader, NULL, the_reader->stride_ - first_col - the_count);
+	}
+
+	// LOGIC:
+	//   PCX RLE: a byte with the top 2 bits set is a run: the low 6 bits are a count, and the next byte is the color.
+	//   any other byte is a single pixel. each run is clipped to the columns wanted and memset into the row.
+
+	for (the_col = 0; the_col < the_reader->stride_; the_col += the_len)
+	{
+		if (the_reader->run_len_ == 0)
+		{
+			if (!BitmapFile_GetByte(the_reader, &the_byte))
+			{
+				return false;
+			}
+
+			if ((the_byte & 0xC0) == 0xC0)
+			{
+				the_reader->run_len_ = the_byte & 0x3F;
+
+				if (!BitmapFile_GetByte(the_reader, &the_reader->run_value_))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				the_reader->run_len_ = 1;
+				the_reader->run_value_ = the_byte;
+			}
+		}
+
+		the_len = the_reader->stride_ - the_col;
+		the_len = (the_reader->run_len_ < the_len) ? the_reader->run_len_ : the_len;
+		the_reader->run_len_ -= the_len;
+
+		if (the_row_loc)
+		{
+			span_start = (the_col > first_col) ? the_col : first_col;
+			span_end = (the_col + the_len < first_col + the_count) ? the_col + the_len : first_col + the_count;
+
+			if (span_start < span_end)
+			{
+				memset(the_row_loc + span_start - first_col, the_reader->run_value_, span_end - span_start);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+//! Decode every row of the file into the bitmap, with the top left corner of the image at x, y, clipping to the bitmap
+//! @return	returns false on any read error, or if the bitmap is read-only
+boolean BitmapFile_Decode(BitmapFileReader* the_reader, Bitmap* the_bitmap, signed int x, signed int y)
+{
+	unsigned char*	the_write_loc;
+	signed int		the_row;
+	signed int		image_row;
+	signed int		rows_left;
+	signed int		left;
+	signed int		right;
+	signed int		top;
+	signed int		bottom;
+
+	left = (x < 0) ? -x : 0;
+	top = (y < 0) ? -y : 0;
+	right = (the_reader->width_ < the_bitmap->width_ - x) ? the_reader->width_ : the_bitmap->width_ - x;
+	bottom = (the_reader->height_ < the_bitmap->height_ - y) ? the_reader->height_ : the_bitmap->height_ - y;
+
+	if (left >= right || top >= bottom)
+	{
+		LOG_WARN(("%s %d: image at (%i, %i) is entirely outside the bitmap", __func__, __LINE__, x, y));
+		return true;
+	}
+
+	if ((the_write_loc = Bitmap_GetMemLocForWrite(the_bitmap, x + left, y + top, right - left, bottom - top)) == NULL)
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   rows are decoded in file order. bottom-up BMPs store the last image row first, so for them, rows are written from the bottom up.
+	//   rows clipped off the bitmap are still decoded (PCX) or skipped (uncompressed) to stay in step with the file.
+	//   once the last visible row has been written, the rest of the file is never read.
+
+	rows_left = bottom - top;
+
+	for (the_row = 0; rows_left > 0; the_row++)
+	{
+		image_row = the_reader->bottom_up_ ? the_reader->height_ - 1 - the_row : the_row;
+
+		if (image_row >= top && image_row < bottom)
+		{
+			if (!BitmapFile_DecodeRow(the_reader, the_write_loc + (image_row - top) * the_bitmap->width_, left, right - left))
+			{
+				goto error;
+			}
+
+			rows_left--;
+		}
+		else if (!BitmapFile_DecodeRow(the_reader, NULL, 0, 0))
+		{
+			goto error;
+		}
+	}
+
+	return true;
+
+error:
+	LOG_ERR(("%s %d: file ended early, at row %i", __func__, __LINE__, the_row));
+	return false;
+}
+
+
+//! Position the file at the start of the passed image row, for formats whose rows are all the same length (BMP and raw)
+//! @return	returns false if the seek failed
+boolean BitmapFile_SeekRow(BitmapFileReader* the_reader, signed int image_row)
+{
+	signed int		file_row;
+
+	file_row = the_reader->bottom_up_ ? the_reader->height_ - 1 - image_row : image_row;
+	the_reader->pos_ = 0;
+	the_reader->len_ = 0;
+
+	return (fseek(the_reader->file_, the_reader->data_offset_ + (unsigned long)file_row * the_reader->stride_, SEEK_SET) == 0);
+}
+
+
+//! Decode the rows of the file into the bitmap in interlaced order, replicating each row down until the rows below it are decoded
+//! Only for formats whose rows can be read in any order (BMP and raw).
+//! @return	returns false on any read error, if the bitmap is read-only, or if the callback asked to stop
+boolean BitmapFile_DecodeProgressive(BitmapFileReader* the_reader, Bitmap* the_bitmap, signed int x, signed int y, BitmapFilePassCallback the_callback, void* the_user_data)
+{
+	static const signed int	pass_start[BITMAP_FILE_NUM_PASSES] = {0, 4, 2, 1};
+	static const signed int	pass_step[BITMAP_FILE_NUM_PASSES] = {8, 8, 4, 2};
+	static const signed int	pass_span[BITMAP_FILE_NUM_PASSES] = {8, 4, 2, 1};
+	unsigned char*	the_write_loc;
+	signed int		the_pass;
+	signed int		image_row;
+	signed int		fill_top;
+	signed int		fill_bottom;
+	signed int		copied;
+	signed int		the_len;
+	signed int		left;
+	signed int		right;
+	signed int		top;
+	signed int		bottom;
+
+	left = (x < 0) ? -x : 0;
+	top = (y < 0) ? -y : 0;
+	right = (the_reader->width_ < the_bitmap->width_ - x) ? the_reader->width_ : the_bitmap->width_ - x;
+	bottom = (the_reader->height_ < the_bitmap->height_ - y) ? the_reader->height_ : the_bitmap->height_ - y;
+
+	if (left >= right || top >= bottom)
+	{
+		LOG_WARN(("%s %d: image at (%i, %i) is entirely outside the bitmap", __func__, __LINE__, x, y));
+		return true;
+	}
+
+	if ((the_write_loc = Bitmap_GetMemLocForWrite(the_bitmap, x + left, y + top, right - left, bottom - top)) == NULL)
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   4 passes, as in GIF interlacing: every 8th row starting at 0, then every 8th starting at 4, then every 4th starting at 2, then every 2nd starting at 1.
+	//   each row decoded is copied down over the rows below it that haven't been decoded yet (7, 3, 1, then 0 rows), so after the first pass
+	//     the whole image is there at 1/8 vertical resolution, and each pass after that sharpens it.
+	//   copies use Graphics_BlitBitMap, doubling the block copied each time, so filling 7 rows takes 3 blits.
+	//   if the image is clipped at the top, the first visible row stands in for the first pass row above it.
+
+	for (the_pass = 0; the_pass < BITMAP_FILE_NUM_PASSES; the_pass++)
+	{
+		for (image_row = pass_start[the_pass]; image_row < bottom; image_row += pass_step[the_pass])
+		{
+			fill_top = image_row;
+			fill_bottom = image_row + pass_span[the_pass];
+
+			if (image_row < top)
+			{
+				if (the_pass > 0 || fill_bottom <= top)
+				{
+					continue;
+				}
+
+				fill_top = top;
+			}
+
+			fill_bottom = (fill_bottom > bottom) ? bottom : fill_bottom;
+
+			if (!BitmapFile_SeekRow(the_reader, fill_top) || !BitmapFile_DecodeRow(the_reader, the_write_loc + (fill_top - top) * the_bitmap->width_, left, right - left))
+			{
+				goto error;
+			}
+
+			for (copied = 1; fill_top + copied < fill_bottom; copied += the_len)
+			{
+				the_len = (fill_top + copied * 2 > fill_bottom) ? fill_bottom - fill_top - copied : copied;
+				Graphics_BlitBitMap(the_bitmap, x + left, y + fill_top, the_bitmap, x + left, y + fill_top + copied, right - left, the_len);
+			}
+		}
+
+		if (the_callback && !the_callback(the_bitmap, the_pass, the_user_data))
+		{
+			LOG_INFO(("%s %d: loading stopped by callback after pass %i", __func__, __LINE__, the_pass));
+			return false;
+		}
+	}
+
+	return true;
+
+error:
+	LOG_ERR(("%s %d: couldn't read row %i", __func__, __LINE__, image_row));
+	return false;
+}
+
+
+//! Write out whatever is waiting in the write buffer
+//! Any failure is remembered in failed_, so callers only need to check once, at the end.
+void BitmapFile_FlushWriter(BitmapFileWriter* the_writer)
+{
+	if (the_writer->pos_ > 0 && fwrite(the_writer->buffer_, the_writer->pos_, 1, the_writer->file_) != 1)
+	{
+		the_writer->failed_ = true;
+	}
+
+	the_writer->pos_ = 0;
+}
+
+
+//! Add one byte to the file being written
+void BitmapFile_WriteByte(BitmapFileWriter* the_writer, uint8_t the_byte)
+{
+	if (the_writer->pos_ >= BITMAP_FILE_WRITE_BUFFER_SIZE)
+	{
+		BitmapFile_FlushWriter(the_writer);
+	}
+
+	the_writer->buffer_[the_writer->pos_++] = the_byte;
+}
+
+
+//! Add the_count bytes to the file being written
+//! Anything at least a buffer long is written straight from the_src, so big rows go directly from the bitmap to the file.
+void BitmapFile_WriteBytes(BitmapFileWriter* the_writer, const uint8_t* the_src, signed int the_count)
+{
+	if (the_writer->pos_ + the_count > BITMAP_FILE_WRITE_BUFFER_SIZE)
+	{
+		BitmapFile_FlushWriter(the_writer);
+	}
+
+	if (the_count >= BITMAP_FILE_WRITE_BUFFER_SIZE)
+	{
+		if (fwrite(the_src, the_count, 1, the_writer->file_) != 1)
+		{
+			the_writer->failed_ = true;
+		}
+
+		return;
+	}
+
+	memcpy(&the_writer->buffer_[the_writer->pos_], the_src, the_count);
+	the_writer->pos_ += the_count;
+}
+
+
+//! RLE encode one row of pixels, padded with 0s to the_stride, into a PCX file being written
+//! Runs never cross from one row to the next, as some PCX readers require. A single pixel with the top 2 bits set has to be written as a run of 1.
+void BitmapFile_EncodePCXRow(BitmapFileWriter* the_writer, const unsigned char* the_row_loc, signed int the_width, signed int the_stride)
+{
+	signed int		the_col;
+	signed int		the_len;
+	uint8_t			the_color;
+
+	for (the_col = 0; the_col < the_stride; the_col += the_len)
+	{
+		the_color = (the_col < the_width) ? the_row_loc[the_col] : 0;
+
+		for (the_len = 1; the_col + the_len < the_stride && the_len < 63; the_len++)
+		{
+			if (((the_col + the_len < the_width) ? the_row_loc[the_col + the_len] : 0) != the_color)
+			{
+				break;
+			}
+		}
+
+		if (the_len > 1 || (the_color & 0xC0) == 0xC0)
+		{
+			BitmapFile_WriteByte(the_writer, 0xC0 | the_len);
+		}
+
+		BitmapFile_WriteByte(the_writer, the_color);
+	}
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+// **** Load functions ****
+
+//! Create a new bitmap and load an 8-bit BMP, PCX, or raw bitmap file into it
+//! The image must be within the normal Bitmap size limits. The bitmap is created with BITMAP_FLAG_UNINITIALIZED, as every pixel is loaded from the file.
+//! @param	the_path: path of the file to load
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette, in LUT order (B, G, R, A). Entries the file doesn't define are set to 0. Can be NULL.
+//! @return	returns NULL on any error
+Bitmap* Bitmap_LoadFromFile(const char* the_path, uint8_t* the_palette)
+{
+	BitmapFileReader*	the_reader;
+	Bitmap*				the_bitmap;
+
+	if (the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed path was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_reader = BitmapFile_Open(the_path, the_palette)) == NULL)
+	{
+		return NULL;
+	}
+
+	if ((the_bitmap = Bitmap_NewWithFlags(the_reader->width_, the_reader->height_, NULL, BITMAP_FLAG_UNINITIALIZED)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create a %i x %i bitmap for '%s'", __func__, __LINE__, the_reader->width_, the_reader->height_, the_path));
+		BitmapFile_Close(&the_reader);
+		return NULL;
+	}
+
+	if (!BitmapFile_Decode(the_reader, the_bitmap, 0, 0))
+	{
+		Bitmap_Destroy(&the_bitmap);
+	}
+
+	BitmapFile_Close(&the_reader);
+
+	return the_bitmap;
+}
+
+
+//! Load an 8-bit BMP, PCX, or raw bitmap file into an existing bitmap, with its top left corner at x, y
+//! The image is clipped to the destination bitmap: only the rows and columns that land inside it are written.
+//! @param	the_path: path of the file to load
+//! @param	the_bitmap: reference to a valid Bitmap object to load into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. Can be negative.
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. Can be NULL.
+//! @return	returns false on any error
+boolean Bitmap_LoadFileIntoBitmap(const char* the_path, Bitmap* the_bitmap, signed int x, signed int y, uint8_t* the_palette)
+{
+	BitmapFileReader*	the_reader;
+	boolean				the_result;
+
+	if (the_path == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed path or bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_reader = BitmapFile_Open(the_path, the_palette)) == NULL)
+	{
+		return false;
+	}
+
+	the_result = BitmapFile_Decode(the_reader, the_bitmap, x, y);
+
+	BitmapFile_Close(&the_reader);
+
+	return the_result;
+}
+
+
+//! Load an 8-bit BMP, PCX, or raw bitmap file into an existing bitmap progressively, so a rough version of the whole image appears quickly
+//! Rows are loaded in 4 interlaced passes, as in GIF: every 8th row first, with each row copied down over the 7 rows below it, then the rows halfway between those, and so on.
+//! After each pass, the_callback is called, so the app can present the bitmap. The image is clipped to the bitmap as in Bitmap_LoadFileIntoBitmap().
+//! PCX files are RLE compressed, and so can only be read from top to bottom: they are loaded in one pass, and the_callback is called once, with the last pass number.
+//! @param	the_path: path of the file to load
+//! @param	the_bitmap: reference to a valid Bitmap object to load into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. Can be negative.
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. It is filled in before the first pass. Can be NULL.
+//! @param	the_callback: function to call after each pass. Can be NULL.
+//! @param	the_user_data: passed to the_callback
+//! @return	returns false on any error, or if the_callback returned false
+boolean Bitmap_LoadFileProgressive(const char* the_path, Bitmap* the_bitmap, signed int x, signed int y, uint8_t* the_palette, BitmapFilePassCallback the_callback, void* the_user_data)
+{
+	BitmapFileReader*	the_reader;
+	boolean				the_result;
+
+	if (the_path == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed path or bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_reader = BitmapFile_Open(the_path, the_palette)) == NULL)
+	{
+		return false;
+	}
+
+	if (the_reader->format_ == BITMAP_FILE_PCX)
+	{
+		the_result = BitmapFile_Decode(the_reader, the_bitmap, x, y);
+
+		if (the_result && the_callback)
+		{
+			the_result = the_callback(the_bitmap, BITMAP_FILE_NUM_PASSES - 1, the_user_data);
+		}
+	}
+	else
+	{
+		the_result = BitmapFile_DecodeProgressive(the_reader, the_bitmap, x, y, the_callback, the_user_data);
+	}
+
+	BitmapFile_Close(&the_reader);
+
+	return the_result;
+}
+
+
+// **** Save functions ****
+
+//! Write all or part of a bitmap to an 8-bit BMP, PCX, or raw bitmap file
+//! The rectangle is clipped to the bitmap.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_format: BITMAP_FILE_BMP, BITMAP_FILE_PCX, or BITMAP_FILE_RAW
+//! @param	x, y, width, height: the rectangle of the bitmap to save
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES palette to store with the pixels, in LUT order (B, G, R, A). If NULL, the palette is written as all 0s.
+//! @return	returns false on any error
+boolean Bitmap_SaveToFile(Bitmap* the_bitmap, const char* the_path, uint8_t the_format, signed int x, signed int y, signed int width, signed int height, const uint8_t* the_palette)
+{
+	BitmapFileWriter*	the_writer;
+	uint8_t				the_header[128];
+	static uint8_t		the_padding[4];
+	unsigned char*		the_read_loc;
+	boolean				the_result;
+	signed int			the_stride;
+	signed int			the_row;
+	signed int			i;
+
+	if (the_bitmap == NULL || the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or path was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_format != BITMAP_FILE_BMP && the_format != BITMAP_FILE_PCX && the_format != BITMAP_FILE_RAW)
+	{
+		LOG_ERR(("%s %d: invalid file format (%u)", __func__, __LINE__, the_format));
+		return false;
+	}
+
+	if (x < 0)
+	{
+		width += x;
+		x = 0;
+	}
+
+	if (y < 0)
+	{
+		height += y;
+		y = 0;
+	}
+
+	width = (x + width > the_bitmap->width_) ? the_bitmap->width_ - x : width;
+	height = (y + height > the_bitmap->height_) ? the_bitmap->height_ - y : height;
+
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: rectangle is entirely outside the bitmap", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_writer = f_calloc(1, sizeof(BitmapFileWriter), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for file writer", __func__, __LINE__));
+		return false;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_writer	%p	size	%i", __func__ , __LINE__, the_writer, sizeof(BitmapFileWriter)));
+
+	if ((the_writer->file_ = fopen(the_path, "wb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create file '%s'", __func__, __LINE__, the_path));
+		f_free(the_writer, MEM_STANDARD);
+		return false;
+	}
+
+	// LOGIC:
+	//   header and palette first (BMP and raw), then the rows, then the palette (PCX).
+	//   rows are read through Bitmap_GetMemLocForXY, so any lazily-cleared bands are cleared before they are read.
+	//   BMP rows are written bottom-up, as most readers expect, and padded to 4 bytes. PCX rows are padded to an even length.
+
+	memset(the_header, 0, sizeof(the_header));
+
+	if (the_format == BITMAP_FILE_RAW)
+	{
+		memcpy(the_header, BITMAP_RAW_MAGIC, 4);
+		BYTES_PUT_BE16(&the_header[4], BITMAP_RAW_VERSION);
+		BYTES_PUT_BE16(&the_header[6], width);
+		BYTES_PUT_BE16(&the_header[8], height);
+		BYTES_PUT_BE32(&the_header[12], width);
+		BYTES_PUT_BE32(&the_header[16], BITMAP_RAW_HEADER_SIZE);
+		BitmapFile_WriteBytes(the_writer, the_header, 20);
+
+		for (i = 0; i < BITMAP_PALETTE_BYTES; i++)
+		{
+			BitmapFile_WriteByte(the_writer, the_palette ? the_palette[i] : 0);
+		}
+
+		for (the_row = y; the_row < y + height; the_row++)
+		{
+			BitmapFile_WriteBytes(the_writer, Bitmap_GetMemLocForXY(the_bitmap, x, the_row), width);
+		}
+	}
+	else if (the_format == BITMAP_FILE_BMP)
+	{
+		the_stride = (width + 3) & ~3;
+		the_header[0] = 'B';
+		the_header[1] = 'M';
+		BYTES_PUT_LE32(&the_header[2], 14 + 40 + BITMAP_PALETTE_BYTES + the_stride * height);
+		BYTES_PUT_LE32(&the_header[10], 14 + 40 + BITMAP_PALETTE_BYTES);
+		BYTES_PUT_LE32(&the_header[14], 40);
+		BYTES_PUT_LE32(&the_header[18], width);
+		BYTES_PUT_LE32(&the_header[22], height);
+		BYTES_PUT_LE16(&the_header[26], 1);
+		BYTES_PUT_LE16(&the_header[28], 8);
+		BYTES_PUT_LE32(&the_header[34], the_stride * height);
+		BYTES_PUT_LE32(&the_header[46], 256);
+		BitmapFile_WriteBytes(the_writer, the_header, 14 + 40);
+
+		for (i = 0; i < BITMAP_PALETTE_BYTES; i++)
+		{
+			BitmapFile_WriteByte(the_writer, (the_palette && (i & 3) != 3) ? the_palette[i] : 0);
+		}
+
+		for (the_row = y + height - 1; the_row >= y; the_row--)
+		{
+			BitmapFile_WriteBytes(the_writer, Bitmap_GetMemLocForXY(the_bitmap, x, the_row), width);
+			BitmapFile_WriteBytes(the_writer, the_padding, the_stride - width);
+		}
+	}
+	else
+	{
+		the_stride = (width + 1) & ~1;
+		the_header[0] = 0x0A;
+		the_header[1] = 5;
+		the_header[2] = 1;
+		the_header[3] = 8;
+		BYTES_PUT_LE16(&the_header[8], width - 1);
+		BYTES_PUT_LE16(&the_header[10], height - 1);
+		BYTES_PUT_LE16(&the_header[12], 72);
+		BYTES_PUT_LE16(&the_header[14], 72);
+		the_header[65] = 1;
+		BYTES_PUT_LE16(&the_header[66], the_stride);
+		BYTES_PUT_LE16(&the_header[68], 1);
+		BitmapFile_WriteBytes(the_writer, the_header, 128);
+
+		for (the_row = y; the_row < y + height; the_row++)
+		{
+			the_read_loc = Bitmap_GetMemLocForXY(the_bitmap, x, the_row);
+			BitmapFile_EncodePCXRow(the_writer, the_read_loc, width, the_stride);
+		}
+
+		BitmapFile_WriteByte(the_writer, 0x0C);
+
+		for (i = 0; i < 256; i++)
+		{
+			BitmapFile_WriteByte(the_writer, the_palette ? the_palette[i * 4 + 2] : 0);
+			BitmapFile_WriteByte(the_writer, the_palette ? the_palette[i * 4 + 1] : 0);
+			BitmapFile_WriteByte(the_writer, the_palette ? the_palette[i * 4] : 0);
+		}
+	}
+
+	BitmapFile_FlushWriter(the_writer);
+	the_result = !the_writer->failed_;
+
+	if (fclose(the_writer->file_) != 0 || !the_result)
+	{
+		LOG_ERR(("%s %d: Couldn't write to file '%s'", __func__, __LINE__, the_path));
+		the_result = false;
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	the_writer	%p	size	%i", __func__ , __LINE__, the_writer, sizeof(BitmapFileWriter)));
+	f_free(the_writer, MEM_STANDARD);
+
+	return the_result;
+}
+
+
+//! Write all or part of a screen to an 8-bit BMP, PCX, or raw bitmap file, with the screen's current graphics LUT as the palette
+//! @param	the_screen: reference to a valid Screen object, with a bitmap.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_format: BITMAP_FILE_BMP, BITMAP_FILE_PCX, or BITMAP_FILE_RAW
+//! @param	x, y, width, height: the rectangle of the screen to save
+//! @return	returns false on any error
+boolean Bitmap_SaveScreenToFile(Screen* the_screen, const char* the_path, uint8_t the_format, signed int x, signed int y, signed int width, signed int height)
+{
+	uint8_t				the_palette[BITMAP_PALETTE_BYTES];
+	volatile uint8_t*	the_lut;
+	signed int			i;
+
+	if (the_screen == NULL || the_screen->bitmap_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen was NULL or had no bitmap", __func__, __LINE__));
+		return false;
+	}
+
+	the_lut = (volatile uint8_t*)&R32(the_screen->vicky_ + VICKY_GRAPHICS_LUT0_L);
+
+	for (i = 0; i < BITMAP_PALETTE_BYTES; i++)
+	{
+		the_palette[i] = the_lut[i];
+	}
+
+	return Bitmap_SaveToFile(the_screen->bitmap_, the_path, the_format, x, y, width, height, the_palette);
+}
+
+
+// **** Raw bitmap file functions ****
+
+//! Write a bitmap to a file in the raw bitmap format
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_path: path of the file to create or overwrite
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES palette to store with the pixels. If NULL, the palette is written as all 0s.
+//! @return	returns false on any error
+boolean Bitmap_SaveRawFile(Bitmap* the_bitmap, const char* the_path, const uint8_t* the_palette)
+{
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return Bitmap_SaveToFile(the_bitmap, the_path, BITMAP_FILE_RAW, 0, 0, the_bitmap->width_, the_bitmap->height_, the_palette);
+}
+
+
+#if defined(__linux__)
+
+//! Create a bitmap whose pixels are a raw bitmap file, mapped into memory instead of loaded (host builds only)
+//! Nothing is read until a primitive touches it, so bitmaps of any file size open instantly. All primitives and Graphics_BlitBitMap work on the result.
+//! The file's stride must equal its width, and its width and height must be within the normal Bitmap limits.
+//! Free with Bitmap_Destroy(), which unmaps the file.
+//! @param	the_path: path of a raw bitmap file
+//! @param	copy_on_write: PARAM_MAP_COPY_ON_WRITE if the bitmap will be drawn into, PARAM_MAP_READ_ONLY if it will only be read from
+//! @param	the_palette: optional BITMAP_PALETTE_BYTES buffer to receive the file's palette. Can be NULL.
+//! @return	returns NULL on any error
+Bitmap* Bitmap_MapFile(const char* the_path, boolean copy_on_write, uint8_t* the_palette)
+{
+	Bitmap*			the_bitmap = NULL;
+	uint8_t*		the_map = MAP_FAILED;
+	struct stat		the_stat;
+	int				the_fd;
+	signed int		width;
+	signed int		height;
+	uint32_t		stride;
+	uint32_t		pixel_offset;
+
+	if (the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed path was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_fd = open(the_path, O_RDONLY)) < 0)
+	{
+		LOG_ERR(("%s %d: Couldn't open file '%s'", __func__, __LINE__, the_path));
+		return NULL;
+	}
+
+	// LOGIC:
+	//   a read-only mapping is shared with the page cache, so opening costs nothing but page table setup.
+	//   a copy-on-write mapping is private: pages are only copied when a primitive writes to them, and the file is never changed.
+	//   the mapping stays valid after the file descriptor is closed.
+
+	if (fstat(the_fd, &the_stat) == 0 && the_stat.st_size >= BITMAP_RAW_HEADER_SIZE)
+	{
+		the_map = mmap(NULL, the_stat.st_size, copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ, copy_on_write ? MAP_PRIVATE : MAP_SHARED, the_fd, 0);
+	}
+
+	close(the_fd);
+
+	if (the_map == MAP_FAILED)
+	{
+		LOG_ERR(("%s %d: Couldn't map file '%s'", __func__, __LINE__, the_path));
+		return NULL;
+	}
+
+	width = BYTES_GET_BE16(&the_map[6]);
+	height = BYTES_GET_BE16(&the_map[8]);
+	stride = BYTES_GET_BE32(&the_map[12]);
+	pixel_offset = BYTES_GET_BE32(&the_map[16]);
+
+	if (memcmp(the_map, BITMAP_RAW_MAGIC, 4) != 0 || BYTES_GET_BE16(&the_map[4]) != BITMAP_RAW_VERSION)
+	{
+		LOG_ERR(("%s %d: '%s' is not a raw bitmap file", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	if ( (width < BITMAP_MIN_WIDTH || width > BITMAP_MAX_WIDTH) || (height < BITMAP_MIN_HEIGHT || height > BITMAP_MAX_HEIGHT) || stride != (uint32_t)width)
+	{
+		LOG_ERR(("%s %d: Unsupported width (%i), height (%i), or stride (%lu)", __func__, __LINE__, width, height, (unsigned long)stride));
+		goto error;
+	}
+
+	if (pixel_offset < BITMAP_RAW_HEADER_SIZE || pixel_offset + stride * height > (uint32_t)the_stat.st_size)
+	{
+		LOG_ERR(("%s %d: '%s' is too short for its header", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	if ((the_bitmap = f_calloc(1, sizeof(Bitmap), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for bitmap struct", __func__, __LINE__));
+		goto error;
+	}
+
+	the_bitmap->width_ = width;
+	the_bitmap->height_ = height;
+	the_bitmap->addr_ = the_map + pixel_offset;
+	the_bitmap->flags_ = BITMAP_FLAG_STANDARD_RAM | BITMAP_FLAG_MAPPED | (copy_on_write ? 0 : BITMAP_FLAG_READ_ONLY);
+	the_bitmap->map_base_ = the_map;
+	the_bitmap->map_len_ = the_stat.st_size;
+	Bitmap_ClearDirtyRect(the_bitmap);
+
+	if (the_palette)
+	{
+		memcpy(the_palette, &the_map[20], BITMAP_PALETTE_BYTES);
+	}
+
+	return the_bitmap;
+
+error:
+	munmap(the_map, the_stat.st_size);
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,57 @@
+//! @file lib_byte_order.h
+
+/*
+ * lib_byte_order.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_BYTE_ORDER_H_
+#define LIB_BYTE_ORDER_H_
+
+
+/* about this header: byte order
+ *
+ * Reads and writes of big- and little-endian 16 and 32 bit values in byte buffers, for the file formats the library loads and saves.
+ *
+ * Every access is done a byte at a time, so it works regardless of the host's byte order or alignment rules: the same code runs on the 68000 and on host builds.
+ * The buffer argument is evaluated more than once: pass a plain pointer, not an expression with side effects.
+ *
+ * This header is private to the library. It is not copied to the vbcc include folder.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// C includes
+#include <stdint.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define BYTES_GET_BE16(the_bytes)	((uint16_t)(((uint16_t)(the_bytes)[0] << 8) | (uint16_t)(the_bytes)[1]))	//!< read a big-endian 16 bit value from a byte buffer
+#define BYTES_GET_BE32(the_bytes)	(((uint32_t)(the_bytes)[0] << 24) | ((uint32_t)(the_bytes)[1] << 16) | ((uint32_t)(the_bytes)[2] << 8) | (uint32_t)(the_bytes)[3])	//!< read a big-endian 32 bit value from a byte buffer
+#define BYTES_GET_LE16(the_bytes)	((uint16_t)(((uint16_t)(the_bytes)[1] << 8) | (uint16_t)(the_bytes)[0]))	//!< read a little-endian 16 bit value from a byte buffer
+#define BYTES_GET_LE32(the_bytes)	(((uint32_t)(the_bytes)[3] << 24) | ((uint32_t)(the_bytes)[2] << 16) | ((uint32_t)(the_bytes)[1] << 8) | (uint32_t)(the_bytes)[0])	//!< read a little-endian 32 bit value from a byte buffer
+
+//! write a big-endian 16 bit value to a byte buffer
+#define BYTES_PUT_BE16(the_bytes, the_value)	do { (the_bytes)[0] = (uint8_t)((uint16_t)(the_value) >> 8); (the_bytes)[1] = (uint8_t)(the_value); } while (0)
+
+//! write a big-endian 32 bit value to a byte buffer
+#define BYTES_PUT_BE32(the_bytes, the_value)	do { (the_bytes)[0] = (uint8_t)((uint32_t)(the_value) >> 24); (the_bytes)[1] = (uint8_t)((uint32_t)(the_value) >> 16); (the_bytes)[2] = (uint8_t)((uint32_t)(the_value) >> 8); (the_bytes)[3] = (uint8_t)(the_value); } while (0)
+
+//! write a little-endian 16 bit value to a byte buffer
+#define BYTES_PUT_LE16(the_bytes, the_value)	do { (the_bytes)[0] = (uint8_t)(the_value); (the_bytes)[1] = (uint8_t)((uint16_t)(the_value) >> 8); } while (0)
+
+//! write a little-endian 32 bit value to a byte buffer
+#define BYTES_PUT_LE32(the_bytes, the_value)	do { (the_bytes)[0] = (uint8_t)(the_value); (the_bytes)[1] = (uint8_t)((uint32_t)(the_value) >> 8); (the_bytes)[2] = (uint8_t)((uint32_t)(the_value) >> 16); (the_bytes)[3] = (uint8_t)((uint32_t)(the_value) >> 24); } while (0)
+
+
+
+#endif /* LIB_BYTE_ORDER_H_ */
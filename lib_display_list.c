@@ -0,0 +1,1406 @@
+/*
+ * lib_display_list.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_display_list.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+// claim the next tile to draw. On host builds, several threads claim tiles at once.
+#if defined(__linux__)
+	#define TILE_RENDERER_CLAIM_TILE(the_renderer)	__sync_fetch_and_add(&(the_renderer)->next_tile_, 1)
+#else
+	#define TILE_RENDERER_CLAIM_TILE(the_renderer)	((the_renderer)->next_tile_++)
+#endif
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// check that a rectangle has a size, and that all of it can be stored in a command
+boolean DisplayList_CheckRect(signed int x, signed int y, signed int width, signed int height);
+
+// make room for one more command at the end of the list, and return it
+DisplayCommand* DisplayList_AddCommand(DisplayList* the_list);
+
+// work out every pixel a command can touch
+void DisplayList_GetCommandBounds(DisplayCommand* the_command, Rectangle* the_bounds);
+
+// grow the list's bounding rectangle to take in a command
+void DisplayList_AddBounds(DisplayList* the_list, DisplayCommand* the_command);
+
+// if a rectangle touches or overlaps the rectangle of the command before it, along a whole edge, grow that command to cover both
+boolean DisplayList_MergeRect(DisplayCommand* the_command, signed int x, signed int y, signed int width, signed int height);
+
+// record a filled rectangle, merging it into the command before it if possible
+boolean DisplayList_AddFill(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+// work out the part of the bitmap a list, moved by the drawing offset, covers, and prepare it for commands to be drawn straight to memory
+boolean DisplayList_PrepareForDraw(DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset, Rectangle* the_bounds);
+
+// set a pixel straight in the bitmap's memory, if it is inside the clip rectangle
+void DisplayList_PlotInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x, signed int y, unsigned char the_color);
+
+// fill the part of a rectangle that is inside the clip rectangle, straight in the bitmap's memory
+void DisplayList_FillInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+// draw a line, as Graphics_DrawLine does, keeping only the pixels inside the clip rectangle
+void DisplayList_DrawLineInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color);
+
+// draw circle quadrants, as Graphics_DrawCircleQuadrants does, keeping only the pixels inside the clip rectangle
+void DisplayList_DrawQuadrantsInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x1, signed int y1, signed int radius, unsigned char the_color, boolean ne, boolean se, boolean sw, boolean nw);
+
+// draw one command, moved by the drawing offset, keeping only the pixels inside the clip rectangle
+void DisplayList_DrawCommandInRect(Bitmap* the_bitmap, DisplayCommand* the_command, signed int x_offset, signed int y_offset, Rectangle* the_clip);
+
+
+// **** Tile renderer functions *****
+
+// true if a command has to be drawn on its own, across the whole bitmap, rather than tile by tile
+boolean TileRenderer_IsWholeBitmapCommand(DisplayCommand* the_command);
+
+// work out the part of the bitmap a command, moved by the render offset, can touch
+boolean TileRenderer_GetClippedBounds(TileRenderer* the_renderer, DisplayCommand* the_command, Rectangle* the_bounds);
+
+// sort the commands of the list being drawn into the tiles they touch
+boolean TileRenderer_Bin(TileRenderer* the_renderer);
+
+// draw one tile's commands, up to the end of the current phase
+void TileRenderer_DrawTile(TileRenderer* the_renderer, signed long the_tile);
+
+// claim and draw tiles until none are left. the argument is the TileRenderer.
+void TileRenderer_DrawTiles(void* the_arg);
+
+// draw every tile's commands up to the end of the current phase, on every worker thread
+void TileRenderer_RunPhase(TileRenderer* the_renderer, signed long the_end);
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Check that a rectangle has a size, and that all of it can be stored in a command
+//! @return	returns false if the rectangle is empty, or reaches past DISPLAY_LIST_MAX_COORD in any direction
+boolean DisplayList_CheckRect(signed int x, signed int y, signed int width, signed int height)
+{
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: invalid size (%i x %i)", __func__, __LINE__, width, height));
+		return false;
+	}
+
+	if (x < -DISPLAY_LIST_MAX_COORD || y < -DISPLAY_LIST_MAX_COORD || (signed long)x + width - 1 > DISPLAY_LIST_MAX_COORD || (signed long)y + height - 1 > DISPLAY_LIST_MAX_COORD)
+	{
+		LOG_ERR(("%s %d: coordinates out of range (%i, %i, %i x %i)", __func__, __LINE__, x, y, width, height));
+		return false;
+	}
+
+	return true;
+}
+
+
+//! Make room for one more command at the end of the list
+//! @return	returns the new command, zeroed, or NULL if the list couldn't grow
+DisplayCommand* DisplayList_AddCommand(DisplayList* the_list)
+{
+	DisplayCommand*	the_commands;
+	DisplayCommand*	the_command;
+	signed long		new_max;
+
+	if (the_list->num_commands_ == the_list->max_commands_)
+	{
+		new_max = the_list->max_commands_ * 2;
+
+		if ((the_commands = f_calloc(new_max, sizeof(DisplayCommand), MEM_STANDARD)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for %li display commands", __func__, __LINE__, new_max));
+			return NULL;
+		}
+
+		memcpy(the_commands, the_list->command_, the_list->num_commands_ * sizeof(DisplayCommand));
+		f_free(the_list->command_, MEM_STANDARD);
+		the_list->command_ = the_commands;
+		the_list->max_commands_ = new_max;
+	}
+
+	the_command = &the_list->command_[the_list->num_commands_++];
+	memset(the_command, 0, sizeof(DisplayCommand));
+
+	return the_command;
+}
+
+
+//! Work out every pixel a command can touch
+//! @param	the_bounds: set to the bounding rectangle. MaxX and MaxY are inclusive.
+void DisplayList_GetCommandBounds(DisplayCommand* the_command, Rectangle* the_bounds)
+{
+	the_bounds->MinX = the_command->x_;
+	the_bounds->MinY = the_command->y_;
+	the_bounds->MaxX = the_command->x_ + the_command->width_ - 1;
+	the_bounds->MaxY = the_command->y_ + the_command->height_ - 1;
+
+	// Graphics_DrawRoundBox's right and bottom edges land 1 pixel past width and height
+	if (the_command->type_ == DISPLAY_CMD_ROUND_BOX)
+	{
+		the_bounds->MaxX++;
+		the_bounds->MaxY++;
+	}
+}
+
+
+//! Grow the list's bounding rectangle to take in a command
+void DisplayList_AddBounds(DisplayList* the_list, DisplayCommand* the_command)
+{
+	Rectangle	the_bounds;
+
+	DisplayList_GetCommandBounds(the_command, &the_bounds);
+
+	if (the_list->bounds_.MinX > the_list->bounds_.MaxX)
+	{
+		the_list->bounds_ = the_bounds;
+		return;
+	}
+
+	the_list->bounds_.MinX = (the_bounds.MinX < the_list->bounds_.MinX) ? the_bounds.MinX : the_list->bounds_.MinX;
+	the_list->bounds_.MinY = (the_bounds.MinY < the_list->bounds_.MinY) ? the_bounds.MinY : the_list->bounds_.MinY;
+	the_list->bounds_.MaxX = (the_bounds.MaxX > the_list->bounds_.MaxX) ? the_bounds.MaxX : the_list->bounds_.MaxX;
+	the_list->bounds_.MaxY = (the_bounds.MaxY > the_list->bounds_.MaxY) ? the_bounds.MaxY : the_list->bounds_.MaxY;
+}
+
+
+//! If a rectangle touches or overlaps the rectangle of the command before it, along a whole edge, grow that command to cover both
+//! The caller must already know the two are compatible: fills of the same color, or blits from the same place in the same source.
+//! @return	returns true if the rectangle was merged into the_command, and needs no command of its own
+boolean DisplayList_MergeRect(DisplayCommand* the_command, signed int x, signed int y, signed int width, signed int height)
+{
+	signed int	left;
+	signed int	top;
+	signed int	right;
+	signed int	bottom;
+
+	// LOGIC:
+	//   two rectangles of the same width, in the same columns, that touch or overlap top to bottom, make one taller rectangle. likewise side to side.
+	//   a rectangle entirely inside the one before it adds nothing.
+	//   only the command just before can be merged with: anything recorded in between could have drawn over it.
+
+	if (x >= the_command->x_ && y >= the_command->y_ && x + width <= the_command->x_ + the_command->width_ && y + height <= the_command->y_ + the_command->height_)
+	{
+		return true;
+	}
+
+	if (x == the_command->x_ && width == the_command->width_ && y <= the_command->y_ + the_command->height_ && y + height >= the_command->y_)
+	{
+		top = (y < the_command->y_) ? y : the_command->y_;
+		bottom = (y + height > the_command->y_ + the_command->height_) ? y + height : the_command->y_ + the_command->height_;
+		the_command->src_y_ += top - the_command->y_;
+		the_command->y_ = top;
+		the_command->height_ = bottom - top;
+
+		return true;
+	}
+
+	if (y == the_command->y_ && height == the_command->height_ && x <= the_command->x_ + the_command->width_ && x + width >= the_command->x_)
+	{
+		left = (x < the_command->x_) ? x : the_command->x_;
+		right = (x + width > the_command->x_ + the_command->width_) ? x + width : the_command->x_ + the_command->width_;
+		the_command->src_x_ += left - the_command->x_;
+		the_command->x_ = left;
+		the_command->width_ = right - left;
+
+		return true;
+	}
+
+	return false;
+}
+
+
+//! Record a filled rectangle, merging it into the command before it if possible
+//! @return	returns false if the list couldn't grow
+boolean DisplayList_AddFill(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	DisplayCommand*	the_command;
+
+	if (the_list->num_commands_ > 0)
+	{
+		the_command = &the_list->command_[the_list->num_commands_ - 1];
+
+		if (the_command->type_ == DISPLAY_CMD_FILL && the_command->color_ == the_color && DisplayList_MergeRect(the_command, x, y, width, height))
+		{
+			DisplayList_AddBounds(the_list, the_command);
+			return true;
+		}
+	}
+
+	if ((the_command = DisplayList_AddCommand(the_list)) == NULL)
+	{
+		return false;
+	}
+
+	the_command->type_ = DISPLAY_CMD_FILL;
+	the_command->color_ = the_color;
+	the_command->x_ = x;
+	the_command->y_ = y;
+	the_command->width_ = width;
+	the_command->height_ = height;
+
+	DisplayList_AddBounds(the_list, the_command);
+
+	return true;
+}
+
+
+//! Work out the part of the bitmap a list, moved by the drawing offset, covers, and prepare it for commands to be drawn straight to memory
+//! Everything a normal drawing call does to the bitmap itself (lazily clearing bands, growing the dirty rect, saving tiles for snapshots) is done here, once,
+//! for the whole area. Lazily-cleared blit sources get the rows being copied cleared, too. The list must be at least partly inside the bitmap.
+//! @param	the_bounds: set to the area the list covers, clipped to the bitmap. MaxX and MaxY are inclusive.
+//! @return	returns false if the bitmap couldn't be prepared
+boolean DisplayList_PrepareForDraw(DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset, Rectangle* the_bounds)
+{
+	DisplayCommand*	the_command;
+	signed long		i;
+	signed int		y;
+
+	the_bounds->MinX = the_list->bounds_.MinX + x_offset;
+	the_bounds->MinY = the_list->bounds_.MinY + y_offset;
+	the_bounds->MinX = (the_bounds->MinX < 0) ? 0 : the_bounds->MinX;
+	the_bounds->MinY = (the_bounds->MinY < 0) ? 0 : the_bounds->MinY;
+	the_bounds->MaxX = (the_list->bounds_.MaxX + x_offset >= the_bitmap->width_) ? the_bitmap->width_ - 1 : the_list->bounds_.MaxX + x_offset;
+	the_bounds->MaxY = (the_list->bounds_.MaxY + y_offset >= the_bitmap->height_) ? the_bitmap->height_ - 1 : the_list->bounds_.MaxY + y_offset;
+
+	if (Bitmap_GetMemLocForWrite(the_bitmap, the_bounds->MinX, the_bounds->MinY, the_bounds->MaxX - the_bounds->MinX + 1, the_bounds->MaxY - the_bounds->MinY + 1) == NULL)
+	{
+		return false;
+	}
+
+	for (i = 0, the_command = the_list->command_; i < the_list->num_commands_; i++, the_command++)
+	{
+		if (the_command->type_ == DISPLAY_CMD_BLIT && the_command->src_bm_->bands_pending_ > 0)
+		{
+			for (y = the_command->src_y_; y < the_command->src_y_ + the_command->height_; y++)
+			{
+				Bitmap_GetMemLocForXY(the_command->src_bm_, the_command->src_x_, y);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+//! Set a pixel straight in the bitmap's memory, if it is inside the clip rectangle
+void DisplayList_PlotInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x, signed int y, unsigned char the_color)
+{
+	if (x >= the_clip->MinX && x <= the_clip->MaxX && y >= the_clip->MinY && y <= the_clip->MaxY)
+	{
+		the_bitmap->addr_[(signed long)the_bitmap->width_ * y + x] = the_color;
+	}
+}
+
+
+//! Fill the part of a rectangle that is inside the clip rectangle, straight in the bitmap's memory
+void DisplayList_FillInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	unsigned char*	the_write_loc;
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+
+	left = (x < the_clip->MinX) ? the_clip->MinX : x;
+	top = (y < the_clip->MinY) ? the_clip->MinY : y;
+	right = (x + width - 1 > the_clip->MaxX) ? the_clip->MaxX : x + width - 1;
+	bottom = (y + height - 1 > the_clip->MaxY) ? the_clip->MaxY : y + height - 1;
+
+	if (left > right || top > bottom)
+	{
+		return;
+	}
+
+	the_write_loc = the_bitmap->addr_ + (signed long)the_bitmap->width_ * top + left;
+
+	for (; top <= bottom; top++)
+	{
+		memset(the_write_loc, the_color, right - left + 1);
+		the_write_loc += the_bitmap->width_;
+	}
+}
+
+
+//! Draw a line, as Graphics_DrawLine does, keeping only the pixels inside the clip rectangle
+void DisplayList_DrawLineInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color)
+{
+	signed int dx;
+	signed int sx;
+	signed int dy;
+	signed int sy;
+	signed int err;
+	signed int e2;
+
+	dx = abs(x2 - x1);
+	sx = x1 < x2 ? 1 : -1;
+	dy = abs(y2 - y1);
+	sy = y1 < y2 ? 1 : -1;
+	err = (dx > dy ? dx : -dy)/2;
+
+	for(;;)
+	{
+		DisplayList_PlotInRect(the_bitmap, the_clip, x1, y1, the_color);
+
+		if (x1==x2 && y1==y2)
+		{
+			break;
+		}
+
+		e2 = err;
+
+		if (e2 >-dx)
+		{
+			err -= dy;
+			x1 += sx;
+		}
+
+		if (e2 < dy)
+		{
+			err += dx;
+			y1 += sy;
+		}
+	}
+}
+
+
+//! Draw circle quadrants, as Graphics_DrawCircleQuadrants does, keeping only the pixels inside the clip rectangle
+void DisplayList_DrawQuadrantsInRect(Bitmap* the_bitmap, Rectangle* the_clip, signed int x1, signed int y1, signed int radius, unsigned char the_color, boolean ne, boolean se, boolean sw, boolean nw)
+{
+	signed int	f;
+	signed int	ddF_x;
+	signed int	ddF_y;
+	signed int	x;
+	signed int	y;
+
+	f = 1 - radius;
+	ddF_x = 0;
+	ddF_y = -2 * radius;
+	x = 0;
+	y = radius;
+
+	if (se || sw)
+	{
+		DisplayList_PlotInRect(the_bitmap, the_clip, x1, y1 + radius, the_color);
+	}
+
+	if (ne || nw)
+	{
+		DisplayList_PlotInRect(the_bitmap, the_clip, x1, y1 - radius, the_color);
+	}
+
+	if (se || ne)
+	{
+		DisplayList_PlotInRect(the_bitmap, the_clip, x1 + radius, y1, the_color);
+	}
+
+	if (nw || sw)
+	{
+		DisplayList_PlotInRect(the_bitmap, the_clip, x1 - radius, y1, the_color);
+	}
+
+	while (x < y)
+	{
+		if (f >= 0)
+		{
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+
+		x++;
+		ddF_x += 2;
+		f += ddF_x + 1;
+
+		if (se)
+		{
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 + x, y1 + y, the_color);
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 + y, y1 + x, the_color);
+		}
+
+		if (sw)
+		{
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 - x, y1 + y, the_color);
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 - y, y1 + x, the_color);
+		}
+
+		if (ne)
+		{
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 + x, y1 - y, the_color);
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 + y, y1 - x, the_color);
+		}
+
+		if (nw)
+		{
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 - x, y1 - y, the_color);
+			DisplayList_PlotInRect(the_bitmap, the_clip, x1 - y, y1 - x, the_color);
+		}
+	}
+}
+
+
+//! Draw one command, moved by the drawing offset, keeping only the pixels inside the clip rectangle
+//! Pixels are written straight to memory: the bitmap (and any blit source) must already have been prepared with DisplayList_PrepareForDraw().
+void DisplayList_DrawCommandInRect(Bitmap* the_bitmap, DisplayCommand* the_command, signed int x_offset, signed int y_offset, Rectangle* the_clip)
+{
+	unsigned char*	the_read_loc;
+	unsigned char*	the_write_loc;
+	signed int		x;
+	signed int		y;
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+	signed int		radius;
+	signed int		inner_width;
+	signed int		inner_height;
+
+	x = the_command->x_ + x_offset;
+	y = the_command->y_ + y_offset;
+
+	switch (the_command->type_)
+	{
+		case DISPLAY_CMD_FILL:
+			DisplayList_FillInRect(the_bitmap, the_clip, x, y, the_command->width_, the_command->height_, the_command->color_);
+			break;
+
+		case DISPLAY_CMD_BLIT:
+			left = (x < the_clip->MinX) ? the_clip->MinX : x;
+			top = (y < the_clip->MinY) ? the_clip->MinY : y;
+			right = (x + the_command->width_ - 1 > the_clip->MaxX) ? the_clip->MaxX : x + the_command->width_ - 1;
+			bottom = (y + the_command->height_ - 1 > the_clip->MaxY) ? the_clip->MaxY : y + the_command->height_ - 1;
+
+			if (left > right || top > bottom)
+			{
+				break;
+			}
+
+			// whatever was clipped off the destination's left and top is skipped in the source, too
+			the_read_loc = the_command->src_bm_->addr_ + (signed long)the_command->src_bm_->width_ * (the_command->src_y_ + top - y) + the_command->src_x_ + left - x;
+			the_write_loc = the_bitmap->addr_ + (signed long)the_bitmap->width_ * top + left;
+
+			for (; top <= bottom; top++)
+			{
+				memcpy(the_write_loc, the_read_loc, right - left + 1);
+				the_write_loc += the_bitmap->width_;
+				the_read_loc += the_command->src_bm_->width_;
+			}
+			break;
+
+		case DISPLAY_CMD_LINE:
+			DisplayList_DrawLineInRect(the_bitmap, the_clip, the_command->x1_ + x_offset, the_command->y1_ + y_offset, the_command->x2_ + x_offset, the_command->y2_ + y_offset, the_command->color_);
+			break;
+
+		case DISPLAY_CMD_CIRCLE:
+			DisplayList_DrawQuadrantsInRect(the_bitmap, the_clip, the_command->x1_ + x_offset, the_command->y1_ + y_offset, the_command->radius_, the_command->color_, PARAM_DRAW_NE, PARAM_DRAW_SE, PARAM_DRAW_SW, PARAM_DRAW_NW);
+			break;
+
+		case DISPLAY_CMD_ROUND_BOX:
+			// the same arcs and shortened edges as Graphics_DrawRoundBox. filled round boxes never get here.
+			radius = the_command->radius_;
+			inner_width = the_command->width_ - radius * 2;
+			inner_height = the_command->height_ - radius * 2;
+			x += radius;
+			y += radius;
+
+			DisplayList_DrawQuadrantsInRect(the_bitmap, the_clip, x, y, radius, the_command->color_, PARAM_SKIP_NE, PARAM_SKIP_SE, PARAM_SKIP_SW, PARAM_DRAW_NW);
+			DisplayList_DrawQuadrantsInRect(the_bitmap, the_clip, x + inner_width, y, radius, the_command->color_, PARAM_DRAW_NE, PARAM_SKIP_SE, PARAM_SKIP_SW, PARAM_SKIP_NW);
+			DisplayList_DrawQuadrantsInRect(the_bitmap, the_clip, x, y + inner_height, radius, the_command->color_, PARAM_SKIP_NE, PARAM_SKIP_SE, PARAM_DRAW_SW, PARAM_SKIP_NW);
+			DisplayList_DrawQuadrantsInRect(the_bitmap, the_clip, x + inner_width, y + inner_height, radius, the_command->color_, PARAM_SKIP_NE, PARAM_DRAW_SE, PARAM_SKIP_SW, PARAM_SKIP_NW);
+
+			DisplayList_FillInRect(the_bitmap, the_clip, x, y - radius, inner_width, 1, the_command->color_);
+			DisplayList_FillInRect(the_bitmap, the_clip, x + inner_width + radius, y, 1, inner_height, the_command->color_);
+			DisplayList_FillInRect(the_bitmap, the_clip, x, y + inner_height + radius, inner_width, 1, the_command->color_);
+			DisplayList_FillInRect(the_bitmap, the_clip, x - radius, y, 1, inner_height, the_command->color_);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// **** Tile renderer functions *****
+
+//! True if a command has to be drawn on its own, across the whole bitmap, rather than tile by tile
+//! Filled round boxes are flood filled: the fill reads back pixels, and can't be stopped at a tile's edge.
+boolean TileRenderer_IsWholeBitmapCommand(DisplayCommand* the_command)
+{
+	return (the_command->type_ == DISPLAY_CMD_ROUND_BOX && the_command->fill_);
+}
+
+
+//! Work out the part of the bitmap a command, moved by the render offset, can touch
+//! @param	the_bounds: set to the bounding rectangle, clipped to the bitmap. MaxX and MaxY are inclusive.
+//! @return	returns false if the command is entirely outside the bitmap
+boolean TileRenderer_GetClippedBounds(TileRenderer* the_renderer, DisplayCommand* the_command, Rectangle* the_bounds)
+{
+	DisplayList_GetCommandBounds(the_command, the_bounds);
+
+	the_bounds->MinX += the_renderer->x_offset_;
+	the_bounds->MaxX += the_renderer->x_offset_;
+	the_bounds->MinY += the_renderer->y_offset_;
+	the_bounds->MaxY += the_renderer->y_offset_;
+
+	if (the_bounds->MaxX < 0 || the_bounds->MaxY < 0 || the_bounds->MinX >= the_renderer->bitmap_->width_ || the_bounds->MinY >= the_renderer->bitmap_->height_)
+	{
+		return false;
+	}
+
+	the_bounds->MinX = (the_bounds->MinX < 0) ? 0 : the_bounds->MinX;
+	the_bounds->MinY = (the_bounds->MinY < 0) ? 0 : the_bounds->MinY;
+	the_bounds->MaxX = (the_bounds->MaxX >= the_renderer->bitmap_->width_) ? the_renderer->bitmap_->width_ - 1 : the_bounds->MaxX;
+	the_bounds->MaxY = (the_bounds->MaxY >= the_renderer->bitmap_->height_) ? the_renderer->bitmap_->height_ - 1 : the_bounds->MaxY;
+
+	return true;
+}
+
+
+//! Sort the commands of the list being drawn into the tiles they touch
+//! @return	returns false if the bins couldn't grow
+boolean TileRenderer_Bin(TileRenderer* the_renderer)
+{
+	DisplayCommand*	the_command;
+	Rectangle		the_bounds;
+	signed long		num_tiles;
+	signed long		num_entries;
+	signed long		i;
+	signed long		the_tile;
+	signed int		tile_x;
+	signed int		tile_y;
+	signed int		pass;
+
+	the_renderer->tiles_across_ = (the_renderer->bitmap_->width_ + TILE_RENDERER_TILE_SIZE - 1) / TILE_RENDERER_TILE_SIZE;
+	num_tiles = (signed long)the_renderer->tiles_across_ * ((the_renderer->bitmap_->height_ + TILE_RENDERER_TILE_SIZE - 1) / TILE_RENDERER_TILE_SIZE);
+	the_renderer->num_tiles_ = num_tiles;
+
+	if (num_tiles > the_renderer->max_tiles_)
+	{
+		if (the_renderer->bin_start_)
+		{
+			f_free(the_renderer->bin_start_, MEM_STANDARD);
+		}
+
+		if (the_renderer->bin_next_)
+		{
+			f_free(the_renderer->bin_next_, MEM_STANDARD);
+		}
+
+		the_renderer->bin_next_ = NULL;
+		the_renderer->max_tiles_ = 0;
+
+		if ((the_renderer->bin_start_ = f_calloc(num_tiles + 1, sizeof(signed long), MEM_STANDARD)) == NULL || (the_renderer->bin_next_ = f_calloc(num_tiles, sizeof(signed long), MEM_STANDARD)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for %li tile bins", __func__, __LINE__, num_tiles));
+			return false;
+		}
+
+		the_renderer->max_tiles_ = num_tiles;
+	}
+
+	// LOGIC:
+	//   2 passes over the commands. the first counts the commands touching each tile, so each tile's bin can be given its place in one shared array.
+	//   the second writes the command indexes into the bins. commands are visited in order, so each bin ends up in drawing order.
+	//   bin_next_ is the write position of each bin during the second pass, then is reset to be the draw position.
+
+	memset(the_renderer->bin_start_, 0, (num_tiles + 1) * sizeof(signed long));
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		for (i = 0, the_command = the_renderer->list_->command_; i < the_renderer->list_->num_commands_; i++, the_command++)
+		{
+			if (TileRenderer_IsWholeBitmapCommand(the_command) || !TileRenderer_GetClippedBounds(the_renderer, the_command, &the_bounds))
+			{
+				continue;
+			}
+
+			for (tile_y = the_bounds.MinY / TILE_RENDERER_TILE_SIZE; tile_y <= the_bounds.MaxY / TILE_RENDERER_TILE_SIZE; tile_y++)
+			{
+				for (tile_x = the_bounds.MinX / TILE_RENDERER_TILE_SIZE; tile_x <= the_bounds.MaxX / TILE_RENDERER_TILE_SIZE; tile_x++)
+				{
+					the_tile = (signed long)tile_y * the_renderer->tiles_across_ + tile_x;
+
+					if (pass == 0)
+					{
+						the_renderer->bin_start_[the_tile + 1]++;
+					}
+					else
+					{
+						the_renderer->bin_command_[the_renderer->bin_next_[the_tile]++] = i;
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (the_tile = 0; the_tile < num_tiles; the_tile++)
+			{
+				the_renderer->bin_start_[the_tile + 1] += the_renderer->bin_start_[the_tile];
+				the_renderer->bin_next_[the_tile] = the_renderer->bin_start_[the_tile];
+			}
+
+			num_entries = the_renderer->bin_start_[num_tiles];
+
+			if (num_entries > the_renderer->max_entries_)
+			{
+				if (the_renderer->bin_command_)
+				{
+					f_free(the_renderer->bin_command_, MEM_STANDARD);
+				}
+
+				the_renderer->max_entries_ = 0;
+
+				if ((the_renderer->bin_command_ = f_calloc(num_entries, sizeof(signed long), MEM_STANDARD)) == NULL)
+				{
+					LOG_ERR(("%s %d: Couldn't allocate space for %li tile bin entries", __func__, __LINE__, num_entries));
+					return false;
+				}
+
+				the_renderer->max_entries_ = num_entries;
+			}
+		}
+	}
+
+	memcpy(the_renderer->bin_next_, the_renderer->bin_start_, num_tiles * sizeof(signed long));
+
+	return true;
+}
+
+
+//! Draw one tile's commands, up to the end of the current phase
+//! Each tile is only ever drawn by one thread at a time, and only writes inside itself, so tiles need no locking.
+void TileRenderer_DrawTile(TileRenderer* the_renderer, signed long the_tile)
+{
+	Rectangle		the_clip;
+	signed long		i;
+	signed long		the_end;
+
+	i = the_renderer->bin_next_[the_tile];
+	the_end = the_renderer->bin_start_[the_tile + 1];
+
+	if (i == the_end || the_renderer->bin_command_[i] >= the_renderer->phase_end_)
+	{
+		return;
+	}
+
+	the_clip.MinX = (the_tile % the_renderer->tiles_across_) * TILE_RENDERER_TILE_SIZE;
+	the_clip.MinY = (the_tile / the_renderer->tiles_across_) * TILE_RENDERER_TILE_SIZE;
+	the_clip.MaxX = the_clip.MinX + TILE_RENDERER_TILE_SIZE - 1;
+	the_clip.MaxY = the_clip.MinY + TILE_RENDERER_TILE_SIZE - 1;
+	the_clip.MaxX = (the_clip.MaxX >= the_renderer->bitmap_->width_) ? the_renderer->bitmap_->width_ - 1 : the_clip.MaxX;
+	the_clip.MaxY = (the_clip.MaxY >= the_renderer->bitmap_->height_) ? the_renderer->bitmap_->height_ - 1 : the_clip.MaxY;
+
+	for (; i < the_end && the_renderer->bin_command_[i] < the_renderer->phase_end_; i++)
+	{
+		DisplayList_DrawCommandInRect(the_renderer->bitmap_, &the_renderer->list_->command_[the_renderer->bin_command_[i]], the_renderer->x_offset_, the_renderer->y_offset_, &the_clip);
+	}
+
+	the_renderer->bin_next_[the_tile] = i;
+}
+
+
+//! Claim and draw tiles until none are left
+//! On host builds, this is run on every thread of the renderer's worker pool at once.
+//! @param	the_arg: the TileRenderer
+void TileRenderer_DrawTiles(void* the_arg)
+{
+	TileRenderer*	the_renderer;
+	signed long		the_tile;
+
+	the_renderer = (TileRenderer*)the_arg;
+
+	while ((the_tile = TILE_RENDERER_CLAIM_TILE(the_renderer)) < the_renderer->num_tiles_)
+	{
+		TileRenderer_DrawTile(the_renderer, the_tile);
+	}
+}
+
+
+//! Draw every tile's commands up to the end of the current phase, on every worker thread
+//! Returns once every tile has been drawn.
+void TileRenderer_RunPhase(TileRenderer* the_renderer, signed long the_end)
+{
+	the_renderer->phase_end_ = the_end;
+	the_renderer->next_tile_ = 0;
+
+	#if defined(__linux__)
+		if (the_renderer->pool_ != NULL && the_renderer->num_tiles_ > 1 && WorkerPool_Run(the_renderer->pool_, TileRenderer_DrawTiles, the_renderer))
+		{
+			return;
+		}
+	#endif
+
+	TileRenderer_DrawTiles(the_renderer);
+}
+
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a new, empty display list
+//! @return	returns NULL on any error
+DisplayList* DisplayList_New(void)
+{
+	DisplayList*	the_list;
+
+	if ((the_list = f_calloc(1, sizeof(DisplayList), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for display list", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_list	%p	size	%i", __func__ , __LINE__, the_list, sizeof(DisplayList)));
+
+	if ((the_list->command_ = f_calloc(DISPLAY_LIST_INITIAL_COMMANDS, sizeof(DisplayCommand), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for display commands", __func__, __LINE__));
+		DisplayList_Destroy(&the_list);
+		return NULL;
+	}
+
+	the_list->max_commands_ = DISPLAY_LIST_INITIAL_COMMANDS;
+	DisplayList_Clear(the_list);
+
+	return the_list;
+}
+
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. Bitmaps used by blit commands are not affected.
+boolean DisplayList_Destroy(DisplayList** the_list)
+{
+	if (the_list == NULL || *the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_list)->command_)
+	{
+		f_free((*the_list)->command_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_list	%p	size	%i", __func__ , __LINE__, *the_list, sizeof(DisplayList)));
+	f_free(*the_list, MEM_STANDARD);
+	*the_list = NULL;
+
+	return true;
+}
+
+
+
+
+// **** Recording functions *****
+
+//! Remove every command from a display list, so it can be recorded again. Its memory is kept for the new commands.
+//! @return	returns false on any error/invalid input.
+boolean DisplayList_Clear(DisplayList* the_list)
+{
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	the_list->num_commands_ = 0;
+	the_list->bounds_.MinX = 1;
+	the_list->bounds_.MinY = 1;
+	the_list->bounds_.MaxX = 0;
+	the_list->bounds_.MaxY = 0;
+
+	return true;
+}
+
+
+//! Record a filled box, width x height pixels
+//! On replay, the box is clipped to the bitmap.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_FillBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!DisplayList_CheckRect(x, y, width, height))
+	{
+		return false;
+	}
+
+	return DisplayList_AddFill(the_list, x, y, width, height, the_color);
+}
+
+
+//! Record a single pixel
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_SetPixelAtXY(DisplayList* the_list, signed int x, signed int y, unsigned char the_color)
+{
+	return DisplayList_FillBox(the_list, x, y, 1, 1, the_color);
+}
+
+
+//! Record a line between 2 coordinates
+//! Horizontal and vertical lines are recorded as fills. Diagonal lines step through the same pixels as Graphics_DrawLine, and are clipped pixel by pixel if they cross the bitmap's edge.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawLine(DisplayList* the_list, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color)
+{
+	DisplayCommand*	the_command;
+	signed int		left = (x1 < x2) ? x1 : x2;
+	signed int		top = (y1 < y2) ? y1 : y2;
+	signed int		width = abs(x2 - x1) + 1;
+	signed int		height = abs(y2 - y1) + 1;
+
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!DisplayList_CheckRect(left, top, width, height))
+	{
+		return false;
+	}
+
+	// both endpoints are drawn, so a straight line is exactly the box between them
+	if (width == 1 || height == 1)
+	{
+		return DisplayList_AddFill(the_list, left, top, width, height, the_color);
+	}
+
+	if ((the_command = DisplayList_AddCommand(the_list)) == NULL)
+	{
+		return false;
+	}
+
+	the_command->type_ = DISPLAY_CMD_LINE;
+	the_command->color_ = the_color;
+	the_command->x_ = left;
+	the_command->y_ = top;
+	the_command->width_ = width;
+	the_command->height_ = height;
+	the_command->x1_ = x1;
+	the_command->y1_ = y1;
+	the_command->x2_ = x2;
+	the_command->y2_ = y2;
+
+	DisplayList_AddBounds(the_list, the_command);
+
+	return true;
+}
+
+
+//! Record a horizontal line from specified coords, for n pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawHLine(DisplayList* the_list, signed int x, signed int y, signed int the_line_len, unsigned char the_color)
+{
+	return DisplayList_FillBox(the_list, x, y, the_line_len, 1, the_color);
+}
+
+
+//! Record a vertical line from specified coords, for n pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawVLine(DisplayList* the_list, signed int x, signed int y, signed int the_line_len, unsigned char the_color)
+{
+	return DisplayList_FillBox(the_list, x, y, 1, the_line_len, the_color);
+}
+
+
+//! Record a rectangle, outlined or filled, as Graphics_DrawBox draws it
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, boolean do_fill)
+{
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!DisplayList_CheckRect(x, y, width, height))
+	{
+		return false;
+	}
+
+	if (do_fill)
+	{
+		return DisplayList_AddFill(the_list, x, y, width, height, the_color);
+	}
+
+	// same order as Graphics_DrawBox: top, right, bottom, left
+	return (DisplayList_AddFill(the_list, x, y, width, 1, the_color) &&
+		DisplayList_AddFill(the_list, x + width - 1, y, 1, height, the_color) &&
+		DisplayList_AddFill(the_list, x, y + height - 1, width, 1, the_color) &&
+		DisplayList_AddFill(the_list, x, y, 1, height, the_color));
+}
+
+
+//! Record a rounded rectangle, outlined or filled, as Graphics_DrawRoundBox draws it
+//! Graphics_DrawRoundBox only draws boxes that fit entirely in the bitmap: on replay, a round box that doesn't is skipped.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	radius: radius, in pixels, of the corners. Minimum 3, maximum 20.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawRoundBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, signed int radius, unsigned char the_color, boolean do_fill)
+{
+	DisplayCommand*	the_command;
+
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	// 1 extra pixel each way: see DisplayList_GetCommandBounds()
+	if (!DisplayList_CheckRect(x, y, width + 1, height + 1))
+	{
+		return false;
+	}
+
+	if (3 > radius || radius > 20)
+	{
+		LOG_ERR(("%s %d: illegal roundrect radius: %i", __func__, __LINE__, radius));
+		return false;
+	}
+
+	if ((the_command = DisplayList_AddCommand(the_list)) == NULL)
+	{
+		return false;
+	}
+
+	the_command->type_ = DISPLAY_CMD_ROUND_BOX;
+	the_command->color_ = the_color;
+	the_command->radius_ = radius;
+	the_command->fill_ = do_fill;
+	the_command->x_ = x;
+	the_command->y_ = y;
+	the_command->width_ = width;
+	the_command->height_ = height;
+
+	DisplayList_AddBounds(the_list, the_command);
+
+	return true;
+}
+
+
+//! Record a circle outline, as Graphics_DrawCircle draws it
+//! On replay, a circle that doesn't fit entirely in the bitmap is skipped.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawCircle(DisplayList* the_list, signed int x1, signed int y1, signed int radius, unsigned char the_color)
+{
+	DisplayCommand*	the_command;
+
+	if (the_list == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (radius < 0 || !DisplayList_CheckRect(x1 - radius, y1 - radius, radius * 2 + 1, radius * 2 + 1))
+	{
+		LOG_ERR(("%s %d: illegal circle (%i, %i, radius %i)", __func__, __LINE__, x1, y1, radius));
+		return false;
+	}
+
+	if ((the_command = DisplayList_AddCommand(the_list)) == NULL)
+	{
+		return false;
+	}
+
+	the_command->type_ = DISPLAY_CMD_CIRCLE;
+	the_command->color_ = the_color;
+	the_command->radius_ = radius;
+	the_command->x_ = x1 - radius;
+	the_command->y_ = y1 - radius;
+	the_command->width_ = radius * 2 + 1;
+	the_command->height_ = radius * 2 + 1;
+	the_command->x1_ = x1;
+	the_command->y1_ = y1;
+
+	DisplayList_AddBounds(the_list, the_command);
+
+	return true;
+}
+
+
+//! Record a blit from a source bitmap, as Graphics_BlitBitMap does it
+//! The source bitmap is not copied: it must still exist, and hold the pixels wanted, whenever the list is replayed. It must not be the bitmap the list is replayed into.
+//! @param	src_bm: the source bitmap
+//! @param	src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to copy. The rectangle must be entirely within the source bitmap.
+//! @param	dst_x, dst_y: where the rectangle should be copied to. On replay, the copy is clipped to the bitmap.
+//! @param	width, height: the scope of the copy, in pixels
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_BlitBitMap(DisplayList* the_list, Bitmap* src_bm, signed int src_x, signed int src_y, signed int dst_x, signed int dst_y, signed int width, signed int height)
+{
+	DisplayCommand*	the_command;
+
+	if (the_list == NULL || src_bm == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list or source bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!DisplayList_CheckRect(dst_x, dst_y, width, height))
+	{
+		return false;
+	}
+
+	// the source is known now, so it is checked now: replay only has to clip the destination
+	if (src_x < 0 || src_y < 0 || src_x + width > src_bm->width_ || src_y + height > src_bm->height_)
+	{
+		LOG_ERR(("%s %d: source rectangle (%i, %i, %i x %i) is not entirely within the source bitmap", __func__, __LINE__, src_x, src_y, width, height));
+		return false;
+	}
+
+	// LOGIC:
+	//   a blit continues the one before it if it copies from the same source, with the same offset between source and destination:
+	//   then the two rectangles are one rectangle of the source, copied to one rectangle of the destination.
+
+	if (the_list->num_commands_ > 0)
+	{
+		the_command = &the_list->command_[the_list->num_commands_ - 1];
+
+		if (the_command->type_ == DISPLAY_CMD_BLIT && the_command->src_bm_ == src_bm && the_command->src_x_ - the_command->x_ == src_x - dst_x && the_command->src_y_ - the_command->y_ == src_y - dst_y && DisplayList_MergeRect(the_command, dst_x, dst_y, width, height))
+		{
+			DisplayList_AddBounds(the_list, the_command);
+			return true;
+		}
+	}
+
+	if ((the_command = DisplayList_AddCommand(the_list)) == NULL)
+	{
+		return false;
+	}
+
+	the_command->type_ = DISPLAY_CMD_BLIT;
+	the_command->x_ = dst_x;
+	the_command->y_ = dst_y;
+	the_command->width_ = width;
+	the_command->height_ = height;
+	the_command->src_x_ = src_x;
+	the_command->src_y_ = src_y;
+	the_command->src_bm_ = src_bm;
+
+	DisplayList_AddBounds(the_list, the_command);
+
+	return true;
+}
+
+
+
+
+// **** Replay functions *****
+
+//! Draw every command in a display list into a bitmap
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	x_offset, y_offset: added to every coordinate recorded (other than blit source coordinates), so one list can be drawn in many places
+//! @return	returns false on any error/invalid input.
+boolean DisplayList_Replay(DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset)
+{
+	DisplayCommand*	the_command;
+	Rectangle		the_clip;
+	Rectangle		the_bounds;
+	signed long		i;
+	boolean			all_inside;
+
+	if (the_list == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed display list or bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	// LOGIC:
+	//   the list's bounds decide, once, whether any command needs clipping at all.
+	//   a list entirely outside the bitmap draws nothing. a list entirely inside it draws every command as recorded.
+	//   only when the list straddles an edge is each command checked against the bitmap.
+	//   the area the list covers is prepared once, as TileRenderer_Render does, then every command is drawn straight to memory, clipped to that area.
+
+	if (the_list->num_commands_ == 0)
+	{
+		return true;
+	}
+
+	if (the_list->bounds_.MaxX + x_offset < 0 || the_list->bounds_.MaxY + y_offset < 0 || the_list->bounds_.MinX + x_offset >= the_bitmap->width_ || the_list->bounds_.MinY + y_offset >= the_bitmap->height_)
+	{
+		return true;
+	}
+
+	if (!DisplayList_PrepareForDraw(the_list, the_bitmap, x_offset, y_offset, &the_clip))
+	{
+		return false;
+	}
+
+	all_inside = (the_list->bounds_.MinX + x_offset >= 0 && the_list->bounds_.MinY + y_offset >= 0 && the_list->bounds_.MaxX + x_offset < the_bitmap->width_ && the_list->bounds_.MaxY + y_offset < the_bitmap->height_);
+
+	for (i = 0, the_command = the_list->command_; i < the_list->num_commands_; i++, the_command++)
+	{
+		if (!all_inside)
+		{
+			DisplayList_GetCommandBounds(the_command, &the_bounds);
+
+			if (the_bounds.MaxX + x_offset < 0 || the_bounds.MaxY + y_offset < 0 || the_bounds.MinX + x_offset >= the_bitmap->width_ || the_bounds.MinY + y_offset >= the_bitmap->height_)
+			{
+				continue;
+			}
+
+			// Graphics_DrawRoundBox and Graphics_DrawCircle only draw shapes that fit entirely in the bitmap
+			if ((the_command->type_ == DISPLAY_CMD_ROUND_BOX || the_command->type_ == DISPLAY_CMD_CIRCLE) && (the_bounds.MinX + x_offset < 0 || the_bounds.MinY + y_offset < 0 || the_bounds.MaxX + x_offset >= the_bitmap->width_ || the_bounds.MaxY + y_offset >= the_bitmap->height_))
+			{
+				continue;
+			}
+		}
+
+		// filled round boxes are flood filled, which has to read back the bitmap
+		if (the_command->type_ == DISPLAY_CMD_ROUND_BOX && the_command->fill_)
+		{
+			Graphics_DrawRoundBox(the_bitmap, the_command->x_ + x_offset, the_command->y_ + y_offset, the_command->width_, the_command->height_, the_command->radius_, the_command->color_, the_command->fill_);
+			continue;
+		}
+
+		DisplayList_DrawCommandInRect(the_bitmap, the_command, x_offset, y_offset, &the_clip);
+	}
+
+	return true;
+}
+
+
+
+
+// **** Tile renderer functions *****
+
+//! Create a new tile renderer
+//! @param	num_workers: number of threads to draw tiles with, counting the thread that calls TileRenderer_Render(). 1 draws every tile on the calling thread.
+//!   0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS. Ignored on the A2560, which always uses 1.
+//! @return	returns NULL on any error
+TileRenderer* TileRenderer_New(signed int num_workers)
+{
+	TileRenderer*	the_renderer;
+
+	if (num_workers < 0 || num_workers > GRAPHICS_MAX_WORKERS)
+	{
+		LOG_ERR(("%s %d: invalid number of workers (%i)", __func__, __LINE__, num_workers));
+		return NULL;
+	}
+
+	if ((the_renderer = f_calloc(1, sizeof(TileRenderer), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for tile renderer", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_renderer	%p	size	%i", __func__ , __LINE__, the_renderer, sizeof(TileRenderer)));
+
+	the_renderer->num_workers_ = 1;
+
+	#if defined(__linux__)
+		if (num_workers != 1)
+		{
+			if ((the_renderer->pool_ = WorkerPool_New(num_workers)) == NULL)
+			{
+				TileRenderer_Destroy(&the_renderer);
+				return NULL;
+			}
+
+			the_renderer->num_workers_ = the_renderer->pool_->num_workers_;
+		}
+	#endif
+
+	return the_renderer;
+}
+
+
+// destructor
+// stops the renderer's threads, and frees all allocated memory associated with the passed object, and the object itself.
+boolean TileRenderer_Destroy(TileRenderer** the_renderer)
+{
+	if (the_renderer == NULL || *the_renderer == NULL)
+	{
+		LOG_ERR(("%s %d: passed tile renderer was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	#if defined(__linux__)
+		if ((*the_renderer)->pool_)
+		{
+			WorkerPool_Destroy(&(*the_renderer)->pool_);
+		}
+	#endif
+
+	if ((*the_renderer)->bin_start_)
+	{
+		f_free((*the_renderer)->bin_start_, MEM_STANDARD);
+	}
+
+	if ((*the_renderer)->bin_next_)
+	{
+		f_free((*the_renderer)->bin_next_, MEM_STANDARD);
+	}
+
+	if ((*the_renderer)->bin_command_)
+	{
+		f_free((*the_renderer)->bin_command_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_renderer	%p	size	%i", __func__ , __LINE__, *the_renderer, sizeof(TileRenderer)));
+	f_free(*the_renderer, MEM_STANDARD);
+	*the_renderer = NULL;
+
+	return true;
+}
+
+
+//! Draw every command in a display list into a bitmap, tile by tile
+//! The result is the same as DisplayList_Replay, except that round boxes and circles crossing the edge of the bitmap are drawn clipped, not skipped.
+//! The call returns once every tile is drawn. The list, and any bitmaps it blits from, must not be changed by other threads while it runs.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	x_offset, y_offset: added to every coordinate recorded (other than blit source coordinates), so one list can be drawn in many places
+//! @return	returns false on any error/invalid input. If the bins couldn't be allocated, nothing is drawn.
+boolean TileRenderer_Render(TileRenderer* the_renderer, DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset)
+{
+	DisplayCommand*	the_command;
+	Rectangle		the_bounds;
+	signed long		i;
+
+	if (the_renderer == NULL || the_list == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tile renderer, display list, or bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_list->num_commands_ == 0)
+	{
+		return true;
+	}
+
+	the_renderer->list_ = the_list;
+	the_renderer->bitmap_ = the_bitmap;
+	the_renderer->x_offset_ = x_offset;
+	the_renderer->y_offset_ = y_offset;
+
+	if (the_list->bounds_.MaxX + x_offset < 0 || the_list->bounds_.MaxY + y_offset < 0 || the_list->bounds_.MinX + x_offset >= the_bitmap->width_ || the_list->bounds_.MinY + y_offset >= the_bitmap->height_)
+	{
+		return true;
+	}
+
+	if (!TileRenderer_Bin(the_renderer))
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   tiles write pixels straight to memory, from many threads. so the whole area the list covers is prepared here, once, before any tile is drawn.
+
+	if (!DisplayList_PrepareForDraw(the_list, the_bitmap, x_offset, y_offset, &the_bounds))
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   commands that can't be drawn tile by tile split the list into phases. every tile is drawn up to one, then it is drawn on its own,
+	//   across the whole bitmap, and tiling carries on after it. like DisplayList_Replay, they are only drawn if they fit in the bitmap.
+
+	the_renderer->phase_end_ = 0;
+
+	for (i = 0, the_command = the_list->command_; i < the_list->num_commands_; i++, the_command++)
+	{
+		if (!TileRenderer_IsWholeBitmapCommand(the_command))
+		{
+			continue;
+		}
+
+		TileRenderer_RunPhase(the_renderer, i);
+
+		DisplayList_GetCommandBounds(the_command, &the_bounds);
+
+		if (the_bounds.MinX + x_offset >= 0 && the_bounds.MinY + y_offset >= 0 && the_bounds.MaxX + x_offset < the_bitmap->width_ && the_bounds.MaxY + y_offset < the_bitmap->height_)
+		{
+			Graphics_DrawRoundBox(the_bitmap, the_command->x_ + x_offset, the_command->y_ + y_offset, the_command->width_, the_command->height_, the_command->radius_, the_command->color_, the_command->fill_);
+		}
+	}
+
+	TileRenderer_RunPhase(the_renderer, the_list->num_commands_);
+
+	return true;
+}
@@ -0,0 +1,258 @@
+//! @file lib_display_list.h
+
+/*
+ * lib_display_list.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_DISPLAY_LIST_H_
+#define LIB_DISPLAY_LIST_H_
+
+
+/* about this library: DisplayList
+ *
+ * A DisplayList records drawing calls (fills, lines, boxes, round boxes, circles, pixels, and blits) into a compact buffer of commands,
+ * instead of drawing them. The list can then be replayed into any bitmap, as many times as needed, at any offset.
+ *
+ * Use it for anything drawn the same way frame after frame, such as window frames, button outlines, and other static UI chrome.
+ * The work a drawing call normally does every time is done once, when the command is recorded, or once per replay for the whole list:
+ *   - parameters are checked as each command is recorded. Bad calls are refused then, so replay never has to check them.
+ *   - boxes, outlines, horizontal and vertical lines, and pixels are all recorded as plain rectangle fills.
+ *   - a fill or blit that continues the one recorded just before it (same color, or same source image, and touching it edge to edge) is merged into it.
+ *   - the list keeps the bounding rectangle of everything in it. A replay that lands entirely inside the bitmap draws every command with no clipping at all;
+ *     one that lands entirely outside it draws nothing. Only replays that straddle the edge clip command by command.
+ *   - the bitmap is prepared for the area the list covers once per replay, then commands write straight to its memory, rather than each going through a Graphics_ call.
+ *
+ * Commands are always replayed in the order they were recorded, so later commands draw over earlier ones, just as if they had been drawn directly.
+ *
+ * A TileRenderer is a second way to replay a list, for big bitmaps and long lists. It splits the bitmap into TILE_RENDERER_TILE_SIZE square tiles,
+ * sorts ("bins") each command into the tiles it touches, then draws the bitmap one tile at a time: every command touching a tile is drawn into it,
+ * clipped to it, before moving on. A tile's pixels are then fetched into the cache once, rather than once per command.
+ * Each tile is its own memory, so on host (Linux) builds the tiles can be drawn by a pool of threads at the same time. On the A2560, tiles are drawn one after the other.
+ * Unlike DisplayList_Replay, round boxes and circles that cross the edge of the bitmap are drawn clipped, rather than skipped.
+ * Filled round boxes can't be split into tiles (they are flood filled): each one waits for every tile to catch up to it, is drawn on its own, then tiling carries on.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+
+// C includes
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define DISPLAY_LIST_INITIAL_COMMANDS	32		//!< number of commands a new display list has room for. The buffer doubles each time it fills.
+#define DISPLAY_LIST_MAX_COORD			32767	//!< commands store coordinates in 16 bits: everything recorded must lie within +/- this many pixels of the origin
+
+#define TILE_RENDERER_TILE_SIZE			64		//!< width and height, in pixels, of the tiles a TileRenderer draws a bitmap in. 4K of pixels: small enough to stay in the cache while every command touching the tile is drawn.
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum display_command_type
+{
+	DISPLAY_CMD_FILL = 0,		//!< fill a rectangle with a color. Also used for outlines, horizontal and vertical lines, and pixels.
+	DISPLAY_CMD_LINE,			//!< a diagonal line
+	DISPLAY_CMD_ROUND_BOX,		//!< a rounded rectangle, outlined or filled
+	DISPLAY_CMD_CIRCLE,			//!< a circle outline
+	DISPLAY_CMD_BLIT,			//!< copy a rectangle of pixels from another bitmap
+} display_command_type;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct DisplayCommand DisplayCommand;
+typedef struct DisplayList DisplayList;
+typedef struct TileRenderer TileRenderer;
+
+//! One recorded drawing command
+//! x_, y_, width_, and height_ always hold the rectangle the command draws in, whatever its type.
+struct DisplayCommand
+{
+	uint8_t			type_;			//!< a display_command_type value
+	uint8_t			color_;			//!< a 1-byte index to the LUT. Not used by blits.
+	boolean			fill_;			//!< for round boxes: true if filled
+	signed short	radius_;		//!< for round boxes: the corner radius. For circles: the radius.
+	signed short	x_;				//!< left edge
+	signed short	y_;				//!< top edge
+	signed short	width_;			//!< width in pixels. For round boxes, the width passed to Graphics_DrawRoundBox, which draws 1 pixel past it.
+	signed short	height_;		//!< height in pixels. For round boxes, the height passed to Graphics_DrawRoundBox, which draws 1 pixel past it.
+	signed short	x1_;			//!< for lines: the first x. For circles: the center x.
+	signed short	y1_;			//!< for lines: the first y. For circles: the center y.
+	signed short	x2_;			//!< for lines: the second x
+	signed short	y2_;			//!< for lines: the second y
+	signed short	src_x_;			//!< for blits: left edge of the rectangle in the source bitmap
+	signed short	src_y_;			//!< for blits: top edge of the rectangle in the source bitmap
+	Bitmap*			src_bm_;		//!< for blits: the source bitmap
+};
+
+struct DisplayList
+{
+	DisplayCommand*	command_;		//!< num_commands_ commands, in the order they are drawn
+	signed long		num_commands_;	//!< number of commands recorded
+	signed long		max_commands_;	//!< number of commands command_ has room for
+	Rectangle		bounds_;		//!< bounding rectangle of every command. Empty if MinX > MaxX.
+};
+
+//! Draws display lists tile by tile. The bins are kept from one render to the next, so a renderer that is used every frame stops allocating once its bins are big enough.
+struct TileRenderer
+{
+	signed long*	bin_start_;		//!< for each tile, in rows: the index in bin_command_ of the tile's first command. 1 more entry at the end holds the number of entries used.
+	signed long*	bin_next_;		//!< for each tile: the index in bin_command_ of the next command to draw into it
+	signed long*	bin_command_;	//!< the indexes of the commands that touch each tile, tile after tile. Each tile's commands are in the order they are drawn.
+	signed long		max_tiles_;		//!< number of tiles bin_start_ and bin_next_ have room for
+	signed long		max_entries_;	//!< number of entries bin_command_ has room for
+	signed long		num_tiles_;		//!< number of tiles in the bitmap being drawn
+	signed int		tiles_across_;	//!< number of tiles across the bitmap being drawn
+	DisplayList*	list_;			//!< the list being drawn
+	Bitmap*			bitmap_;		//!< the bitmap being drawn into
+	signed int		x_offset_;		//!< added to every coordinate in the list being drawn
+	signed int		y_offset_;		//!< added to every coordinate in the list being drawn
+	signed long		phase_end_;		//!< tiles are drawn up to, but not including, this command. Filled round boxes, which are drawn on their own, end a phase.
+	signed long		next_tile_;		//!< the next tile no thread has started drawing
+	signed int		num_workers_;	//!< number of threads that draw tiles, counting the thread calling TileRenderer_Render(). Always 1 on the A2560.
+#if defined(__linux__)
+	WorkerPool*		pool_;			//!< the threads tiles are drawn on, or NULL if they are all drawn on the calling thread
+#endif
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a new, empty display list
+//! @return	returns NULL on any error
+DisplayList* DisplayList_New(void);
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. Bitmaps used by blit commands are not affected.
+boolean DisplayList_Destroy(DisplayList** the_list);
+
+
+// **** Recording functions *****
+
+//! Remove every command from a display list, so it can be recorded again. Its memory is kept for the new commands.
+//! @return	returns false on any error/invalid input.
+boolean DisplayList_Clear(DisplayList* the_list);
+
+//! Record a filled box, width x height pixels
+//! On replay, the box is clipped to the bitmap.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_FillBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+//! Record a single pixel
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_SetPixelAtXY(DisplayList* the_list, signed int x, signed int y, unsigned char the_color);
+
+//! Record a line between 2 coordinates
+//! Horizontal and vertical lines are recorded as fills. Diagonal lines step through the same pixels as Graphics_DrawLine, and are clipped pixel by pixel if they cross the bitmap's edge.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawLine(DisplayList* the_list, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color);
+
+//! Record a horizontal line from specified coords, for n pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawHLine(DisplayList* the_list, signed int x, signed int y, signed int the_line_len, unsigned char the_color);
+
+//! Record a vertical line from specified coords, for n pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawVLine(DisplayList* the_list, signed int x, signed int y, signed int the_line_len, unsigned char the_color);
+
+//! Record a rectangle, outlined or filled, as Graphics_DrawBox draws it
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, boolean do_fill);
+
+//! Record a rounded rectangle, outlined or filled, as Graphics_DrawRoundBox draws it
+//! Graphics_DrawRoundBox only draws boxes that fit entirely in the bitmap: on replay, a round box that doesn't is skipped.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	radius: radius, in pixels, of the corners. Minimum 3, maximum 20.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawRoundBox(DisplayList* the_list, signed int x, signed int y, signed int width, signed int height, signed int radius, unsigned char the_color, boolean do_fill);
+
+//! Record a circle outline, as Graphics_DrawCircle draws it
+//! On replay, a circle that doesn't fit entirely in the bitmap is skipped.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_DrawCircle(DisplayList* the_list, signed int x1, signed int y1, signed int radius, unsigned char the_color);
+
+//! Record a blit from a source bitmap, as Graphics_BlitBitMap does it
+//! The source bitmap is not copied: it must still exist, and hold the pixels wanted, whenever the list is replayed. It must not be the bitmap the list is replayed into.
+//! @param	src_bm: the source bitmap
+//! @param	src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to copy. The rectangle must be entirely within the source bitmap.
+//! @param	dst_x, dst_y: where the rectangle should be copied to. On replay, the copy is clipped to the bitmap.
+//! @param	width, height: the scope of the copy, in pixels
+//! @return	returns false on any error/invalid input. Nothing is recorded.
+boolean DisplayList_BlitBitMap(DisplayList* the_list, Bitmap* src_bm, signed int src_x, signed int src_y, signed int dst_x, signed int dst_y, signed int width, signed int height);
+
+
+// **** Replay functions *****
+
+//! Draw every command in a display list into a bitmap
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	x_offset, y_offset: added to every coordinate recorded (other than blit source coordinates), so one list can be drawn in many places
+//! @return	returns false on any error/invalid input.
+boolean DisplayList_Replay(DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset);
+
+
+// **** Tile renderer functions *****
+
+//! Create a new tile renderer
+//! @param	num_workers: number of threads to draw tiles with, counting the thread that calls TileRenderer_Render(). 1 draws every tile on the calling thread.
+//!   0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS. Ignored on the A2560, which always uses 1.
+//! @return	returns NULL on any error
+TileRenderer* TileRenderer_New(signed int num_workers);
+
+// destructor
+// stops the renderer's threads, and frees all allocated memory associated with the passed object, and the object itself.
+boolean TileRenderer_Destroy(TileRenderer** the_renderer);
+
+//! Draw every command in a display list into a bitmap, tile by tile
+//! The result is the same as DisplayList_Replay, except that round boxes and circles crossing the edge of the bitmap are drawn clipped, not skipped.
+//! The call returns once every tile is drawn. The list, and any bitmaps it blits from, must not be changed by other threads while it runs.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	x_offset, y_offset: added to every coordinate recorded (other than blit source coordinates), so one list can be drawn in many places
+//! @return	returns false on any error/invalid input. If the bins couldn't be allocated, nothing is drawn.
+boolean TileRenderer_Render(TileRenderer* the_renderer, DisplayList* the_list, Bitmap* the_bitmap, signed int x_offset, signed int y_offset);
+
+
+
+#endif /* LIB_DISPLAY_LIST_H_ */
@@ -0,0 +1,1696 @@
+/*
+ * lib_font.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_font.h"
+#include "lib_byte_order.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define FONT_STRIKE_BIT(the_font, x, y)		((the_font)->strike_[(y) * (the_font)->row_bytes_ + ((x) >> 3)] & (0x80 >> ((x) & 0x07)))
+
+#define STROKE_FONT_HASH(the_char, the_size)	(((the_char) * 31 + (the_size)) & (STROKE_FONT_CACHE_BUCKETS - 1))	// hash bucket for a glyph rasterized at a size
+
+#define FONT_KERN_KEY(the_pair)				(((uint16_t)(the_pair)[0] << 8) | (the_pair)[1])	// left and right characters of a kerning pair, in the order the table is sorted by
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// allocate a font and its glyph table, and fill in everything but the glyphs
+Font* Font_Allocate(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_height, signed int the_ascent);
+
+// find the runs of set pixels in one glyph. if the_spans is NULL, they are only counted.
+signed long Font_FindSpans(Font* the_font, const FontGlyph* the_glyph, FontSpan* the_spans);
+
+// check that a table of kerning pairs is sorted, with no pair listed twice
+boolean Font_CheckKerning(const uint8_t* the_pairs, signed int num_pairs);
+
+// find the kerning adjustment for a pair of characters. 0 if the font has no pair for them.
+signed int Font_KernPair(Font* the_font, unsigned char left_char, unsigned char right_char);
+
+// check that the first FONT_FILE_HEADER_SIZE bytes are a font file header, and work out the size of the whole file
+unsigned long Font_CheckFileHeader(const uint8_t* the_header);
+
+// measure how wide num_chars characters of a string would be, drawn in a font
+signed int Font_MeasureChars(Font* the_font, const char* the_string, signed long num_chars);
+
+// break a text layout's string into lines. if the_lines is NULL, they are only counted. sets *truncated if there was more text than max_lines lines.
+signed int TextLayout_BreakLines(TextLayout* the_layout, TextLine* the_lines, signed int max_lines, boolean* truncated);
+
+// cut a line short, so that it and an ellipsis after it fit the layout's width
+void TextLayout_FitEllipsis(TextLayout* the_layout, TextLine* the_line);
+
+// copy a string into a text layout, and work out its lines
+boolean TextLayout_Build(TextLayout* the_layout, const char* the_string);
+
+// check that a stroke font glyph string is well formed
+boolean StrokeFont_CheckGlyph(const char* the_string);
+
+// get the glyph string a stroke font draws for a character, and the character it belongs to
+const char* StrokeFont_GetString(StrokeFont* the_font, unsigned char* the_char);
+
+// scale a glyph coordinate, relative to an edge of the glyph or line, to pixels at a size
+signed int StrokeFont_Scale(StrokeFont* the_font, signed int the_value, signed int the_size);
+
+// add a cached glyph to the front of the least-recently-used list
+void StrokeFont_LinkLRU(StrokeFont* the_font, StrokeGlyph* the_glyph);
+
+// take a cached glyph out of the least-recently-used list
+void StrokeFont_UnlinkLRU(StrokeFont* the_font, StrokeGlyph* the_glyph);
+
+// throw a glyph out of the cache and free it
+void StrokeFont_FreeGlyph(StrokeFont* the_font, StrokeGlyph* the_glyph);
+
+// throw the least recently used glyphs out of the cache until it is within its budget, never throwing out the_keeper
+void StrokeFont_TrimCache(StrokeFont* the_font, StrokeGlyph* the_keeper);
+
+// find the runs of set pixels in a rasterized glyph. if the_spans is NULL, they are only counted.
+signed int StrokeFont_FindSpans(Bitmap* the_bitmap, signed int width, signed int height, FontSpan* the_spans);
+
+// draw a glyph's lines at a size, and convert them into runs of pixels
+StrokeGlyph* StrokeFont_Rasterize(StrokeFont* the_font, unsigned char the_char, signed int the_size);
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Allocate a font and its glyph table, and fill in everything but the glyphs
+//! @return	returns NULL on any error
+Font* Font_Allocate(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_height, signed int the_ascent)
+{
+	Font*	the_font;
+
+	if (the_strike == NULL)
+	{
+		LOG_ERR(("%s %d: passed strike was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (last_char < first_char || row_bytes < 1 || the_height < 1 || the_height > FONT_MAX_HEIGHT || the_ascent < 0 || the_ascent > the_height)
+	{
+		LOG_ERR(("%s %d: invalid font (chars %u to %u, row bytes %i, height %i, ascent %i)", __func__, __LINE__, first_char, last_char, row_bytes, the_height, the_ascent));
+		return NULL;
+	}
+
+	if ((the_font = f_calloc(1, sizeof(Font), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for font", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_font	%p	size	%i", __func__ , __LINE__, the_font, sizeof(Font)));
+
+	if ((the_font->glyph_ = f_calloc(last_char - first_char + 1, sizeof(FontGlyph), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i glyphs", __func__, __LINE__, last_char - first_char + 1));
+		Font_Destroy(&the_font);
+		return NULL;
+	}
+
+	the_font->first_char_ = first_char;
+	the_font->last_char_ = last_char;
+	the_font->missing_char_ = (FONT_MISSING_CHAR >= first_char && FONT_MISSING_CHAR <= last_char) ? FONT_MISSING_CHAR : first_char;
+	the_font->height_ = the_height;
+	the_font->ascent_ = the_ascent;
+	the_font->descent_ = the_height - the_ascent;
+	the_font->row_bytes_ = row_bytes;
+	the_font->strike_ = the_strike;
+
+	return the_font;
+}
+
+
+//! Find the runs of set pixels in one glyph
+//! @param	the_spans: where to write the runs, or NULL to only count them
+//! @return	returns the number of runs
+signed long Font_FindSpans(Font* the_font, const FontGlyph* the_glyph, FontSpan* the_spans)
+{
+	signed long		num_spans = 0;
+	signed int		the_row;
+	signed int		x;
+	signed int		run_start;
+
+	for (the_row = 0; the_row < the_font->height_; the_row++)
+	{
+		run_start = -1;
+
+		// one step past the right edge of the image, to close a run that reaches it
+		for (x = 0; x <= the_glyph->width_; x++)
+		{
+			if (x < the_glyph->width_ && FONT_STRIKE_BIT(the_font, the_glyph->strike_x_ + x, the_row))
+			{
+				if (run_start < 0)
+				{
+					run_start = x;
+				}
+			}
+			else if (run_start >= 0)
+			{
+				if (the_spans)
+				{
+					the_spans[num_spans].row_ = the_row;
+					the_spans[num_spans].x_ = run_start;
+					the_spans[num_spans].len_ = x - run_start;
+				}
+
+				num_spans++;
+				run_start = -1;
+			}
+		}
+	}
+
+	return num_spans;
+}
+
+
+//! Check that a table of kerning pairs is sorted by left character, then right character, with no pair listed twice
+//! Font_KernPair()'s binary search depends on it.
+//! @return	returns false if the table is out of order
+boolean Font_CheckKerning(const uint8_t* the_pairs, signed int num_pairs)
+{
+	signed int	i;
+
+	for (i = 1; i < num_pairs; i++)
+	{
+		if (FONT_KERN_KEY(&the_pairs[i * FONT_KERN_PAIR_SIZE]) <= FONT_KERN_KEY(&the_pairs[(i - 1) * FONT_KERN_PAIR_SIZE]))
+		{
+			LOG_ERR(("%s %d: kerning pair %i ('%c' '%c') is out of order", __func__, __LINE__, i, the_pairs[i * FONT_KERN_PAIR_SIZE], the_pairs[i * FONT_KERN_PAIR_SIZE + 1]));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! Find the kerning adjustment for a pair of characters
+//! @return	returns the number of pixels to add to the left character's advance, or 0 if the font has no pair for them
+signed int Font_KernPair(Font* the_font, unsigned char left_char, unsigned char right_char)
+{
+	const uint8_t*	the_pair;
+	uint16_t		the_key;
+	uint16_t		pair_key;
+	signed int		low;
+	signed int		high;
+	signed int		mid;
+
+	// most fonts have no kerning at all: keep the cost of asking to a single test
+	if (the_font->num_kern_pairs_ == 0)
+	{
+		return 0;
+	}
+
+	the_key = ((uint16_t)left_char << 8) | right_char;
+	low = 0;
+	high = the_font->num_kern_pairs_ - 1;
+
+	while (low <= high)
+	{
+		mid = (low + high) >> 1;
+		the_pair = &the_font->kern_[mid * FONT_KERN_PAIR_SIZE];
+		pair_key = FONT_KERN_KEY(the_pair);
+
+		if (pair_key == the_key)
+		{
+			return (signed char)the_pair[2];
+		}
+		else if (pair_key < the_key)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return 0;
+}
+
+
+//! Check that the first FONT_FILE_HEADER_SIZE bytes are a font file header, and work out the size of the whole file
+//! @return	returns the number of bytes in the whole file, or 0 if the header isn't valid
+unsigned long Font_CheckFileHeader(const uint8_t* the_header)
+{
+	signed int	num_chars;
+
+	if (memcmp(the_header, FONT_FILE_MAGIC, 4) != 0)
+	{
+		LOG_ERR(("%s %d: not a font file", __func__, __LINE__));
+		return 0;
+	}
+
+	if (BYTES_GET_BE16(&the_header[4]) != FONT_FILE_VERSION)
+	{
+		LOG_ERR(("%s %d: unsupported font file version (%u)", __func__, __LINE__, BYTES_GET_BE16(&the_header[4])));
+		return 0;
+	}
+
+	if (the_header[7] < the_header[6])
+	{
+		LOG_ERR(("%s %d: invalid character range (%u to %u)", __func__, __LINE__, the_header[6], the_header[7]));
+		return 0;
+	}
+
+	num_chars = the_header[7] - the_header[6] + 1;
+
+	return FONT_FILE_HEADER_SIZE + (unsigned long)num_chars * FONT_FILE_GLYPH_SIZE + (unsigned long)BYTES_GET_BE16(&the_header[16]) * FONT_KERN_PAIR_SIZE + (unsigned long)BYTES_GET_BE16(&the_header[8]) * BYTES_GET_BE16(&the_header[14]);
+}
+
+
+//! Measure how wide num_chars characters of a string would be, drawn in a font
+//! @return	returns the total of the characters' advances and kerning, in pixels
+signed int Font_MeasureChars(Font* the_font, const char* the_string, signed long num_chars)
+{
+	signed int		the_width = 0;
+	unsigned char	the_char;
+	unsigned char	prev_char = 0;
+
+	for (; num_chars > 0; num_chars--)
+	{
+		the_char = (unsigned char)*the_string++;
+
+		if (prev_char)
+		{
+			the_width += Font_KernPair(the_font, prev_char, the_char);
+		}
+
+		the_width += Font_GetGlyph(the_font, the_char)->advance_;
+		prev_char = the_char;
+	}
+
+	return the_width;
+}
+
+
+//! Break a text layout's string into lines
+//! @param	the_lines: where to write the lines, or NULL to only count them
+//! @param	max_lines: the most lines to break the string into
+//! @param	truncated: set to true if there was more text than max_lines lines, false otherwise
+//! @return	returns the number of lines
+signed int TextLayout_BreakLines(TextLayout* the_layout, TextLine* the_lines, signed int max_lines, boolean* truncated)
+{
+	const char*	the_string = the_layout->string_;
+	signed long	pos = 0;
+	signed long	i;
+	signed long	line_end;
+	signed long	next;
+	signed long	last_space;
+	signed int	num_lines = 0;
+	signed int	the_width;
+	signed int	the_advance;
+	boolean		wrapped;
+	unsigned char	prev_char;
+
+	// LOGIC:
+	//   each line runs until a '\n', or (when wrapping) until the next character would go past the width.
+	//   a wrapped line breaks at the last space before that point, which is dropped, or, for a word too long for a line of its own, right there.
+	//   the first character of a line is always kept, even if it's wider than the line, so every line moves forward.
+
+	*truncated = false;
+
+	while (pos < the_layout->length_)
+	{
+		if (num_lines == max_lines)
+		{
+			*truncated = true;
+			break;
+		}
+
+		the_width = 0;
+		last_space = -1;
+		line_end = the_layout->length_;
+		next = the_layout->length_;
+		wrapped = false;
+		prev_char = 0;
+
+		for (i = pos; i < the_layout->length_; i++)
+		{
+			if (the_string[i] == '\n')
+			{
+				line_end = i;
+				next = i + 1;
+				break;
+			}
+
+			// kerning against the previous character counts toward this one: it only applies if both end up on the line
+			the_advance = Font_GetGlyph(the_layout->font_, (unsigned char)the_string[i])->advance_;
+
+			if (prev_char)
+			{
+				the_advance += Font_KernPair(the_layout->font_, prev_char, (unsigned char)the_string[i]);
+			}
+
+			if (the_layout->wrap_ && the_width + the_advance > the_layout->width_ && i > pos)
+			{
+				wrapped = true;
+
+				if (the_string[i] == ' ')
+				{
+					line_end = i;
+					next = i + 1;
+				}
+				else if (last_space >= 0)
+				{
+					line_end = last_space;
+					next = last_space + 1;
+				}
+				else
+				{
+					line_end = i;
+					next = i;
+				}
+
+				break;
+			}
+
+			if (the_string[i] == ' ')
+			{
+				last_space = i;
+			}
+
+			the_width += the_advance;
+			prev_char = (unsigned char)the_string[i];
+		}
+
+		// spaces at the end of a wrapped line would only throw off centered and right-aligned text
+		while (wrapped && line_end > pos && the_string[line_end - 1] == ' ')
+		{
+			line_end--;
+		}
+
+		if (the_lines)
+		{
+			the_lines[num_lines].start_ = pos;
+			the_lines[num_lines].num_chars_ = line_end - pos;
+			the_lines[num_lines].width_ = Font_MeasureChars(the_layout->font_, &the_string[pos], line_end - pos);
+			the_lines[num_lines].ellipsis_ = false;
+		}
+
+		num_lines++;
+		pos = next;
+	}
+
+	return num_lines;
+}
+
+
+//! Cut a line short, so that it and an ellipsis after it fit the layout's width
+//! If even the ellipsis alone is too wide, the line is only the ellipsis.
+void TextLayout_FitEllipsis(TextLayout* the_layout, TextLine* the_line)
+{
+	const char*	the_text = &the_layout->string_[the_line->start_];
+	signed int	ellipsis_width;
+	signed int	the_width;
+
+	ellipsis_width = Font_MeasureChars(the_layout->font_, FONT_ELLIPSIS, FONT_ELLIPSIS_LEN);
+	the_width = Font_MeasureChars(the_layout->font_, the_text, the_line->num_chars_);
+
+	while (the_line->num_chars_ > 0 && (the_width + ellipsis_width > the_layout->width_ || the_text[the_line->num_chars_ - 1] == ' '))
+	{
+		the_line->num_chars_--;
+		the_width -= Font_GetGlyph(the_layout->font_, (unsigned char)the_text[the_line->num_chars_])->advance_;
+
+		if (the_line->num_chars_ > 0)
+		{
+			the_width -= Font_KernPair(the_layout->font_, (unsigned char)the_text[the_line->num_chars_ - 1], (unsigned char)the_text[the_line->num_chars_]);
+		}
+	}
+
+	the_line->width_ = the_width + ellipsis_width;
+	the_line->ellipsis_ = true;
+}
+
+
+//! Copy a string into a text layout, and work out its lines
+//! The layout's font, width, height, alignment, and wrap must already be set. Any string and lines it had before are freed.
+//! @return	returns false on any error
+boolean TextLayout_Build(TextLayout* the_layout, const char* the_string)
+{
+	signed int	max_lines;
+	signed int	the_line_height;
+	signed int	i;
+	boolean		truncated;
+
+	if (the_layout->string_)
+	{
+		f_free(the_layout->string_, MEM_STANDARD);
+		the_layout->string_ = NULL;
+	}
+
+	if (the_layout->line_)
+	{
+		f_free(the_layout->line_, MEM_STANDARD);
+		the_layout->line_ = NULL;
+	}
+
+	the_layout->num_lines_ = 0;
+	the_layout->length_ = strlen(the_string);
+
+	if ((the_layout->string_ = f_calloc(the_layout->length_ + 1, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for a string of %li characters", __func__, __LINE__, the_layout->length_));
+		return false;
+	}
+
+	memcpy(the_layout->string_, the_string, the_layout->length_ + 1);
+
+	// lines are separated by the font's leading, but the last line needs no leading after it
+	the_line_height = the_layout->font_->height_ + the_layout->font_->leading_;
+	max_lines = (the_layout->height_ < the_layout->font_->height_) ? 0 : (the_layout->height_ + the_layout->font_->leading_) / the_line_height;
+
+	// two passes: count the lines, so they fit in one allocation, then fill them in
+	the_layout->num_lines_ = TextLayout_BreakLines(the_layout, NULL, max_lines, &truncated);
+
+	if ((the_layout->line_ = f_calloc((the_layout->num_lines_ > 0) ? the_layout->num_lines_ : 1, sizeof(TextLine), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i lines", __func__, __LINE__, the_layout->num_lines_));
+		the_layout->num_lines_ = 0;
+		return false;
+	}
+
+	TextLayout_BreakLines(the_layout, the_layout->line_, max_lines, &truncated);
+
+	for (i = 0; i < the_layout->num_lines_; i++)
+	{
+		if (the_layout->line_[i].width_ > the_layout->width_ && !the_layout->wrap_)
+		{
+			TextLayout_FitEllipsis(the_layout, &the_layout->line_[i]);
+		}
+	}
+
+	if (truncated && the_layout->num_lines_ > 0)
+	{
+		TextLayout_FitEllipsis(the_layout, &the_layout->line_[the_layout->num_lines_ - 1]);
+	}
+
+	return true;
+}
+
+
+//! Check that a stroke font glyph string is well formed
+//! @return	returns false if it is not
+boolean StrokeFont_CheckGlyph(const char* the_string)
+{
+	signed int	the_len = strlen(the_string);
+	signed int	i;
+
+	if (the_len < 2 || (the_len & 1) || the_string[1] < the_string[0])
+	{
+		return false;
+	}
+
+	// a pen-up is the only pair that can have a space in it
+	for (i = 2; i < the_len; i += 2)
+	{
+		if ((the_string[i] == ' ' && the_string[i + 1] != STROKE_FONT_ORIGIN) || the_string[i + 1] == ' ')
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! Get the glyph string a stroke font draws for a character
+//! @param	the_char: the character. Changed to the font's missing character if the font has no glyph for it.
+//! @return	returns the glyph string
+const char* StrokeFont_GetString(StrokeFont* the_font, unsigned char* the_char)
+{
+	if (*the_char < the_font->first_char_ || *the_char > the_font->last_char_ || the_font->glyph_[*the_char - the_font->first_char_] == NULL)
+	{
+		*the_char = the_font->missing_char_;
+	}
+
+	return the_font->glyph_[*the_char - the_font->first_char_];
+}
+
+
+//! Scale a glyph coordinate, relative to an edge of the glyph or line, to pixels at a size
+//! @return	returns the number of pixels, rounded to the nearest. Works for negative values, which strokes outside the glyph's edges have.
+signed int StrokeFont_Scale(StrokeFont* the_font, signed int the_value, signed int the_size)
+{
+	signed long	the_units = the_font->bottom_ - the_font->top_;
+	signed long	the_scaled = (signed long)the_value * the_size * 2 + the_units;
+
+	// C division truncates toward 0: round down instead, so strokes either side of 0 land evenly
+	if (the_scaled >= 0)
+	{
+		return the_scaled / (the_units * 2);
+	}
+
+	return -((-the_scaled + the_units * 2 - 1) / (the_units * 2));
+}
+
+
+//! Add a cached glyph to the front of the least-recently-used list
+void StrokeFont_LinkLRU(StrokeFont* the_font, StrokeGlyph* the_glyph)
+{
+	the_glyph->lru_prev_ = NULL;
+	the_glyph->lru_next_ = the_font->lru_first_;
+
+	if (the_font->lru_first_)
+	{
+		the_font->lru_first_->lru_prev_ = the_glyph;
+	}
+	else
+	{
+		the_font->lru_last_ = the_glyph;
+	}
+
+	the_font->lru_first_ = the_glyph;
+}
+
+
+//! Take a cached glyph out of the least-recently-used list
+void StrokeFont_UnlinkLRU(StrokeFont* the_font, StrokeGlyph* the_glyph)
+{
+	if (the_glyph->lru_prev_)
+	{
+		the_glyph->lru_prev_->lru_next_ = the_glyph->lru_next_;
+	}
+	else
+	{
+		the_font->lru_first_ = the_glyph->lru_next_;
+	}
+
+	if (the_glyph->lru_next_)
+	{
+		the_glyph->lru_next_->lru_prev_ = the_glyph->lru_prev_;
+	}
+	else
+	{
+		the_font->lru_last_ = the_glyph->lru_prev_;
+	}
+
+	the_glyph->lru_prev_ = NULL;
+	the_glyph->lru_next_ = NULL;
+}
+
+
+//! Throw a glyph out of the cache and free it
+void StrokeFont_FreeGlyph(StrokeFont* the_font, StrokeGlyph* the_glyph)
+{
+	StrokeGlyph**	the_link;
+
+	StrokeFont_UnlinkLRU(the_font, the_glyph);
+
+	for (the_link = &the_font->bucket_[STROKE_FONT_HASH(the_glyph->char_, the_glyph->size_)]; *the_link; the_link = &(*the_link)->hash_next_)
+	{
+		if (*the_link == the_glyph)
+		{
+			*the_link = the_glyph->hash_next_;
+			break;
+		}
+	}
+
+	the_font->cache_used_ -= the_glyph->bytes_;
+	f_free(the_glyph, MEM_STANDARD);
+}
+
+
+//! Throw the least recently used glyphs out of the cache until it is within its budget
+//! @param	the_keeper: a glyph that must stay, because it is about to be drawn, or NULL. A glyph bigger than the whole budget is kept until the next one is cached.
+void StrokeFont_TrimCache(StrokeFont* the_font, StrokeGlyph* the_keeper)
+{
+	while (the_font->cache_used_ > the_font->cache_budget_ && the_font->lru_last_ && the_font->lru_last_ != the_keeper)
+	{
+		StrokeFont_FreeGlyph(the_font, the_font->lru_last_);
+	}
+}
+
+
+//! Find the runs of set pixels in a rasterized glyph
+//! @param	width, height: the size of the glyph image in the top left of the_bitmap, which may be bigger
+//! @param	the_spans: where to write the runs, or NULL to only count them
+//! @return	returns the number of runs
+signed int StrokeFont_FindSpans(Bitmap* the_bitmap, signed int width, signed int height, FontSpan* the_spans)
+{
+	unsigned char*	the_row;
+	signed int		num_spans = 0;
+	signed int		y;
+	signed int		x;
+	signed int		run_start;
+
+	for (y = 0, the_row = the_bitmap->addr_; y < height; y++, the_row += the_bitmap->width_)
+	{
+		run_start = -1;
+
+		// one step past the right edge of the image, to close a run that reaches it
+		for (x = 0; x <= width; x++)
+		{
+			if (x < width && the_row[x])
+			{
+				if (run_start < 0)
+				{
+					run_start = x;
+				}
+			}
+			else if (run_start >= 0)
+			{
+				if (the_spans)
+				{
+					the_spans[num_spans].row_ = y;
+					the_spans[num_spans].x_ = run_start;
+					the_spans[num_spans].len_ = x - run_start;
+				}
+
+				num_spans++;
+				run_start = -1;
+			}
+		}
+	}
+
+	return num_spans;
+}
+
+
+//! Draw a glyph's lines at a size, and convert them into runs of pixels
+//! @param	the_char: a character the font has a glyph for
+//! @return	returns a new glyph, not yet in the cache, or NULL on any error
+StrokeGlyph* StrokeFont_Rasterize(StrokeFont* the_font, unsigned char the_char, signed int the_size)
+{
+	const char*		the_string = the_font->glyph_[the_char - the_font->first_char_];
+	const char*		the_point;
+	StrokeGlyph*	the_glyph = NULL;
+	Bitmap*			the_scratch = NULL;
+	signed int		left = the_string[0] - STROKE_FONT_ORIGIN;
+	signed int		min_x = 0;
+	signed int		min_y = 0;
+	signed int		max_x = -1;
+	signed int		max_y = -1;
+	signed int		x;
+	signed int		y;
+	signed int		prev_x = 0;
+	signed int		prev_y = 0;
+	signed int		width = 0;
+	signed int		height = 0;
+	signed int		num_spans = 0;
+	unsigned long	the_bytes;
+	boolean			pen_down;
+
+	// LOGIC:
+	//   two passes over the points: find the bounds of the scaled glyph, so a scratch bitmap just big enough can be drawn into, then draw the lines.
+	//   the scratch bitmap is then scanned twice, to count the runs of pixels so they fit in one allocation with the glyph, then to fill them in.
+
+	for (the_point = &the_string[2]; *the_point; the_point += 2)
+	{
+		if (the_point[0] == ' ')
+		{
+			continue;
+		}
+
+		x = StrokeFont_Scale(the_font, the_point[0] - STROKE_FONT_ORIGIN - left, the_size);
+		y = StrokeFont_Scale(the_font, the_point[1] - STROKE_FONT_ORIGIN - the_font->top_, the_size);
+
+		if (max_x < min_x)
+		{
+			min_x = max_x = x;
+			min_y = max_y = y;
+		}
+
+		min_x = (x < min_x) ? x : min_x;
+		max_x = (x > max_x) ? x : max_x;
+		min_y = (y < min_y) ? y : min_y;
+		max_y = (y > max_y) ? y : max_y;
+	}
+
+	// glyphs with no points, such as space, have no image
+	if (max_x >= min_x)
+	{
+		width = max_x - min_x + 1;
+		height = max_y - min_y + 1;
+
+		if (width > FONT_MAX_GLYPH_WIDTH || height > FONT_MAX_HEIGHT)
+		{
+			LOG_ERR(("%s %d: character %u is too big to draw at size %i (%i x %i)", __func__, __LINE__, the_char, the_size, width, height));
+			return NULL;
+		}
+
+		if ((the_scratch = Bitmap_NewWithFlags((width < BITMAP_MIN_WIDTH) ? BITMAP_MIN_WIDTH : width, (height < BITMAP_MIN_HEIGHT) ? BITMAP_MIN_HEIGHT : height, NULL, BITMAP_FLAG_STANDARD_RAM)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't create scratch bitmap to rasterize character %u", __func__, __LINE__, the_char));
+			return NULL;
+		}
+
+		pen_down = false;
+
+		for (the_point = &the_string[2]; *the_point; the_point += 2)
+		{
+			if (the_point[0] == ' ')
+			{
+				pen_down = false;
+				continue;
+			}
+
+			x = StrokeFont_Scale(the_font, the_point[0] - STROKE_FONT_ORIGIN - left, the_size) - min_x;
+			y = StrokeFont_Scale(the_font, the_point[1] - STROKE_FONT_ORIGIN - the_font->top_, the_size) - min_y;
+
+			// the first point after the pen goes down is a line to itself: a dot, if no line follows it
+			Graphics_DrawLine(the_scratch, pen_down ? prev_x : x, pen_down ? prev_y : y, x, y, 1);
+
+			prev_x = x;
+			prev_y = y;
+			pen_down = true;
+		}
+
+		num_spans = StrokeFont_FindSpans(the_scratch, width, height, NULL);
+	}
+
+	the_bytes = sizeof(StrokeGlyph) + num_spans * sizeof(FontSpan);
+
+	if ((the_glyph = f_calloc(1, the_bytes, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for rasterized glyph", __func__, __LINE__));
+		goto error;
+	}
+
+	the_glyph->char_ = the_char;
+	the_glyph->size_ = the_size;
+	the_glyph->width_ = width;
+	the_glyph->height_ = height;
+	the_glyph->x_ = min_x;
+	the_glyph->y_ = min_y;
+	the_glyph->advance_ = StrokeFont_Scale(the_font, the_string[1] - the_string[0], the_size);
+	the_glyph->num_spans_ = num_spans;
+	the_glyph->span_ = (FontSpan*)(the_glyph + 1);
+	the_glyph->bytes_ = the_bytes;
+
+	if (num_spans > 0)
+	{
+		StrokeFont_FindSpans(the_scratch, width, height, the_glyph->span_);
+	}
+
+error:
+	if (the_scratch)
+	{
+		Bitmap_Destroy(&the_scratch);
+	}
+
+	return the_glyph;
+}
+
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a proportional font over a strike of glyph images
+//! The strike and tables are not copied: they must stay valid until the font is destroyed. The glyph table is built from them.
+//! @param	the_strike: every glyph image, side by side: the_height rows of row_bytes, 1 bit per pixel, leftmost pixel in the high bit
+//! @param	row_bytes: bytes in each row of the strike
+//! @param	first_char, last_char: the first and last characters the font has glyphs for
+//! @param	the_height: rows in the strike, from 1 to FONT_MAX_HEIGHT
+//! @param	the_ascent: rows of the strike above the baseline
+//! @param	the_locations: (last_char - first_char + 2) entries: the left edge of each character's glyph image in the strike, then the right edge of the last one
+//! @param	the_advances: (last_char - first_char + 1) entries: how far the pen moves after each character. If NULL, each character advances by its image width.
+//! @param	the_offsets: (last_char - first_char + 1) entries: pixels from the pen position to the left edge of each character's image. If NULL, all are 0.
+//! @return	returns NULL on any error
+Font* Font_New(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_height, signed int the_ascent, const uint16_t* the_locations, const uint8_t* the_advances, const signed char* the_offsets)
+{
+	Font*		the_font;
+	FontGlyph*	the_glyph;
+	signed int	the_width;
+	signed int	i;
+
+	if (the_locations == NULL)
+	{
+		LOG_ERR(("%s %d: passed locations table was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_font = Font_Allocate(the_strike, row_bytes, first_char, last_char, the_height, the_ascent)) == NULL)
+	{
+		return NULL;
+	}
+
+	for (i = 0, the_glyph = the_font->glyph_; i <= last_char - first_char; i++, the_glyph++)
+	{
+		the_width = the_locations[i + 1] - the_locations[i];
+
+		if (the_width < 0 || the_width > FONT_MAX_GLYPH_WIDTH || the_locations[i + 1] > row_bytes * 8)
+		{
+			LOG_ERR(("%s %d: invalid location for character %i (%u to %u)", __func__, __LINE__, first_char + i, the_locations[i], the_locations[i + 1]));
+			Font_Destroy(&the_font);
+			return NULL;
+		}
+
+		the_glyph->strike_x_ = the_locations[i];
+		the_glyph->width_ = the_width;
+		the_glyph->advance_ = the_advances ? the_advances[i] : the_width;
+		the_glyph->offset_ = the_offsets ? the_offsets[i] : 0;
+	}
+
+	return the_font;
+}
+
+
+//! Create a fixed-width font over a strike of glyph images
+//! The strike is not copied: it must stay valid until the font is destroyed.
+//! @param	the_strike: every glyph image, side by side, each the_width pixels wide
+//! @param	row_bytes: bytes in each row of the strike
+//! @param	first_char, last_char: the first and last characters the font has glyphs for
+//! @param	the_width: width of every glyph, and how far the pen moves after each, from 1 to FONT_MAX_GLYPH_WIDTH
+//! @param	the_height: rows in the strike, from 1 to FONT_MAX_HEIGHT
+//! @param	the_ascent: rows of the strike above the baseline
+//! @return	returns NULL on any error
+Font* Font_NewFixedWidth(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_width, signed int the_height, signed int the_ascent)
+{
+	Font*		the_font;
+	FontGlyph*	the_glyph;
+	signed int	i;
+
+	if (the_width < 1 || the_width > FONT_MAX_GLYPH_WIDTH || (signed long)(last_char - first_char + 1) * the_width > (signed long)row_bytes * 8)
+	{
+		LOG_ERR(("%s %d: invalid glyph width (%i) for a strike of %i bytes per row", __func__, __LINE__, the_width, row_bytes));
+		return NULL;
+	}
+
+	if ((the_font = Font_Allocate(the_strike, row_bytes, first_char, last_char, the_height, the_ascent)) == NULL)
+	{
+		return NULL;
+	}
+
+	for (i = 0, the_glyph = the_font->glyph_; i <= last_char - first_char; i++, the_glyph++)
+	{
+		the_glyph->strike_x_ = i * the_width;
+		the_glyph->width_ = the_width;
+		the_glyph->advance_ = the_width;
+	}
+
+	return the_font;
+}
+
+
+//! Create a font from a font file already in memory
+//! The data is not copied: the strike and kerning table are used where they are, so the data must stay valid until the font is destroyed.
+//! @param	the_data: the contents of a font file. See the file format in lib_font.h.
+//! @param	the_len: number of bytes of the_data
+//! @return	returns NULL on any error, including if the data is not a valid font file
+Font* Font_NewFromMemory(const uint8_t* the_data, unsigned long the_len)
+{
+	Font*			the_font;
+	FontGlyph*		the_glyph;
+	const uint8_t*	the_entry;
+	const uint8_t*	the_pairs;
+	const uint8_t*	the_strike;
+	unsigned long	file_len;
+	signed int		row_bytes;
+	signed int		num_chars;
+	signed int		num_pairs;
+	signed int		i;
+
+	if (the_data == NULL)
+	{
+		LOG_ERR(("%s %d: passed data was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_len < FONT_FILE_HEADER_SIZE || (file_len = Font_CheckFileHeader(the_data)) == 0 || the_len < file_len)
+	{
+		LOG_ERR(("%s %d: font data is invalid or cut short (%lu bytes)", __func__, __LINE__, the_len));
+		return NULL;
+	}
+
+	// LOGIC:
+	//   the glyph table, kerning pairs, and strike follow the header in that order, with nothing between them.
+	//   the kerning pairs and strike are used in place. only the glyph table is unpacked, because the span cache fills in more of each glyph.
+
+	row_bytes = BYTES_GET_BE16(&the_data[14]);
+	num_chars = the_data[7] - the_data[6] + 1;
+	num_pairs = BYTES_GET_BE16(&the_data[16]);
+	the_entry = &the_data[FONT_FILE_HEADER_SIZE];
+	the_pairs = the_entry + num_chars * FONT_FILE_GLYPH_SIZE;
+	the_strike = the_pairs + num_pairs * FONT_KERN_PAIR_SIZE;
+
+	if ((the_font = Font_Allocate(the_strike, row_bytes, the_data[6], the_data[7], BYTES_GET_BE16(&the_data[8]), BYTES_GET_BE16(&the_data[10]))) == NULL)
+	{
+		return NULL;
+	}
+
+	the_font->leading_ = BYTES_GET_BE16(&the_data[12]);
+
+	for (i = 0, the_glyph = the_font->glyph_; i < num_chars; i++, the_glyph++, the_entry += FONT_FILE_GLYPH_SIZE)
+	{
+		the_glyph->strike_x_ = BYTES_GET_BE16(the_entry);
+		the_glyph->width_ = the_entry[2];
+		the_glyph->advance_ = the_entry[3];
+		the_glyph->offset_ = (signed char)the_entry[4];
+
+		if ((signed long)the_glyph->strike_x_ + the_glyph->width_ > (signed long)row_bytes * 8)
+		{
+			LOG_ERR(("%s %d: glyph for character %i runs past the edge of the strike", __func__, __LINE__, the_font->first_char_ + i));
+			Font_Destroy(&the_font);
+			return NULL;
+		}
+	}
+
+	if (!Font_CheckKerning(the_pairs, num_pairs))
+	{
+		Font_Destroy(&the_font);
+		return NULL;
+	}
+
+	the_font->kern_ = (num_pairs > 0) ? the_pairs : NULL;
+	the_font->num_kern_pairs_ = num_pairs;
+
+	return the_font;
+}
+
+
+//! Load a font file
+//! The file is read in one go, into one allocation that the font owns and uses in place.
+//! @param	the_path: path of the font file
+//! @return	returns NULL on any error
+Font* Font_LoadFromFile(const char* the_path)
+{
+	FILE*			the_file;
+	Font*			the_font;
+	uint8_t*		the_data = NULL;
+	uint8_t			the_header[FONT_FILE_HEADER_SIZE];
+	unsigned long	file_len;
+
+	if (the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed path was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_file = fopen(the_path, "rb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't open font file '%s'", __func__, __LINE__, the_path));
+		return NULL;
+	}
+
+	// LOGIC:
+	//   the header gives the size of everything after it, so the whole file goes into one allocation with one more read.
+	//   the font then owns that allocation, and frees it when destroyed.
+
+	if (fread(the_header, FONT_FILE_HEADER_SIZE, 1, the_file) != 1 || (file_len = Font_CheckFileHeader(the_header)) == 0)
+	{
+		LOG_ERR(("%s %d: '%s' is not a font file", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	if ((the_data = f_calloc(file_len, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate %lu bytes for font file", __func__, __LINE__, file_len));
+		goto error;
+	}
+
+	memcpy(the_data, the_header, FONT_FILE_HEADER_SIZE);
+
+	if (fread(&the_data[FONT_FILE_HEADER_SIZE], file_len - FONT_FILE_HEADER_SIZE, 1, the_file) != 1)
+	{
+		LOG_ERR(("%s %d: font file '%s' is cut short", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	fclose(the_file);
+	the_file = NULL;
+
+	if ((the_font = Font_NewFromMemory(the_data, file_len)) == NULL)
+	{
+		goto error;
+	}
+
+	the_font->data_ = the_data;
+
+	return the_font;
+
+error:
+	if (the_file)
+	{
+		fclose(the_file);
+	}
+
+	if (the_data)
+	{
+		f_free(the_data, MEM_STANDARD);
+	}
+
+	return NULL;
+}
+
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. Bitmaps using the font must be given another before drawing text.
+boolean Font_Destroy(Font** the_font)
+{
+	if (the_font == NULL || *the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_font)->glyph_)
+	{
+		f_free((*the_font)->glyph_, MEM_STANDARD);
+	}
+
+	if ((*the_font)->span_)
+	{
+		f_free((*the_font)->span_, MEM_STANDARD);
+	}
+
+	if ((*the_font)->data_)
+	{
+		f_free((*the_font)->data_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_font	%p	size	%i", __func__ , __LINE__, *the_font, sizeof(Font)));
+	f_free(*the_font, MEM_STANDARD);
+	*the_font = NULL;
+
+	return true;
+}
+
+
+
+
+// **** Font file functions ****
+
+//! Write a font to a font file
+//! Use on a host machine to turn a font built from tables with Font_New() into a file the A2560 can load quickly.
+//! @param	the_path: path of the file to create or overwrite
+//! @return	returns false on any error
+boolean Font_SaveToFile(Font* the_font, const char* the_path)
+{
+	FILE*			the_file;
+	FontGlyph*		the_glyph;
+	uint8_t			the_header[FONT_FILE_HEADER_SIZE];
+	uint8_t			the_entry[FONT_FILE_GLYPH_SIZE];
+	signed int		i;
+
+	if (the_font == NULL || the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed font or path was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_font->row_bytes_ > 0xFFFF)
+	{
+		LOG_ERR(("%s %d: font strike is too wide for a font file (%i bytes per row)", __func__, __LINE__, the_font->row_bytes_));
+		return false;
+	}
+
+	if ((the_file = fopen(the_path, "wb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create font file '%s'", __func__, __LINE__, the_path));
+		return false;
+	}
+
+	memset(the_header, 0, FONT_FILE_HEADER_SIZE);
+	memcpy(the_header, FONT_FILE_MAGIC, 4);
+	BYTES_PUT_BE16(&the_header[4], FONT_FILE_VERSION);
+	the_header[6] = the_font->first_char_;
+	the_header[7] = the_font->last_char_;
+	BYTES_PUT_BE16(&the_header[8], the_font->height_);
+	BYTES_PUT_BE16(&the_header[10], the_font->ascent_);
+	BYTES_PUT_BE16(&the_header[12], the_font->leading_);
+	BYTES_PUT_BE16(&the_header[14], the_font->row_bytes_);
+	BYTES_PUT_BE16(&the_header[16], the_font->num_kern_pairs_);
+
+	if (fwrite(the_header, FONT_FILE_HEADER_SIZE, 1, the_file) != 1)
+	{
+		goto error;
+	}
+
+	memset(the_entry, 0, FONT_FILE_GLYPH_SIZE);
+
+	for (i = 0, the_glyph = the_font->glyph_; i <= the_font->last_char_ - the_font->first_char_; i++, the_glyph++)
+	{
+		BYTES_PUT_BE16(the_entry, the_glyph->strike_x_);
+		the_entry[2] = the_glyph->width_;
+		the_entry[3] = the_glyph->advance_;
+		the_entry[4] = (uint8_t)the_glyph->offset_;
+
+		if (fwrite(the_entry, FONT_FILE_GLYPH_SIZE, 1, the_file) != 1)
+		{
+			goto error;
+		}
+	}
+
+	if (the_font->num_kern_pairs_ > 0 && fwrite(the_font->kern_, FONT_KERN_PAIR_SIZE, the_font->num_kern_pairs_, the_file) != (size_t)the_font->num_kern_pairs_)
+	{
+		goto error;
+	}
+
+	if (fwrite(the_font->strike_, the_font->row_bytes_, the_font->height_, the_file) != (size_t)the_font->height_)
+	{
+		goto error;
+	}
+
+	if (fclose(the_file) != 0)
+	{
+		LOG_ERR(("%s %d: Couldn't finish writing font file '%s'", __func__, __LINE__, the_path));
+		return false;
+	}
+
+	return true;
+
+error:
+	LOG_ERR(("%s %d: Couldn't write to font file '%s'", __func__, __LINE__, the_path));
+	fclose(the_file);
+
+	return false;
+}
+
+
+
+
+// **** Glyph functions ****
+
+//! Convert every glyph of a font into runs of set pixels, if that hasn't been done yet
+//! Done automatically the first time the font is drawn. Call ahead of time to keep the cost out of the first frame that draws text.
+//! @return	returns false on any error
+boolean Font_BuildSpanCache(Font* the_font)
+{
+	FontGlyph*		the_glyph;
+	signed long		num_spans;
+	signed long		glyph_spans;
+	signed int		i;
+
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_font->span_)
+	{
+		return true;
+	}
+
+	// LOGIC:
+	//   two passes over the strike: count every glyph's runs, so all of them fit in one allocation, then fill them in.
+	//   the count pass also gives each glyph the index of its first run.
+
+	num_spans = 0;
+
+	for (i = 0, the_glyph = the_font->glyph_; i <= the_font->last_char_ - the_font->first_char_; i++, the_glyph++)
+	{
+		glyph_spans = Font_FindSpans(the_font, the_glyph, NULL);
+		the_glyph->first_span_ = num_spans;
+		the_glyph->num_spans_ = glyph_spans;
+		num_spans += glyph_spans;
+	}
+
+	// a font of nothing but blank glyphs still gets a span table, so it isn't built again on every draw
+	if ((the_font->span_ = f_calloc((num_spans > 0) ? num_spans : 1, sizeof(FontSpan), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %li glyph spans", __func__, __LINE__, num_spans));
+		return false;
+	}
+
+	for (i = 0, the_glyph = the_font->glyph_; i <= the_font->last_char_ - the_font->first_char_; i++, the_glyph++)
+	{
+		Font_FindSpans(the_font, the_glyph, &the_font->span_[the_glyph->first_span_]);
+	}
+
+	the_font->num_spans_ = num_spans;
+
+	return true;
+}
+
+
+//! Get the glyph a font draws for a character
+//! @return	returns the character's glyph, or the glyph of the font's missing character if it has none for it, or NULL if the font was NULL
+const FontGlyph* Font_GetGlyph(Font* the_font, unsigned char the_char)
+{
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed font was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_char < the_font->first_char_ || the_char > the_font->last_char_)
+	{
+		the_char = the_font->missing_char_;
+	}
+
+	return &the_font->glyph_[the_char - the_font->first_char_];
+}
+
+
+//! Give a font a table of kerning pairs
+//! The table is not copied: it must stay valid until the font is destroyed.
+//! @param	the_pairs: num_pairs entries of FONT_KERN_PAIR_SIZE bytes, laid out as in a font file, and sorted by left character, then right character. NULL to remove kerning.
+//! @param	num_pairs: the number of pairs
+//! @return	returns false on any error, including if the pairs are not sorted
+boolean Font_SetKerning(Font* the_font, const uint8_t* the_pairs, signed int num_pairs)
+{
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_pairs == NULL)
+	{
+		num_pairs = 0;
+	}
+
+	if (num_pairs < 0 || num_pairs > 0xFFFF)
+	{
+		LOG_ERR(("%s %d: invalid number of kerning pairs (%i)", __func__, __LINE__, num_pairs));
+		return false;
+	}
+
+	if (!Font_CheckKerning(the_pairs, num_pairs))
+	{
+		return false;
+	}
+
+	the_font->kern_ = (num_pairs > 0) ? the_pairs : NULL;
+	the_font->num_kern_pairs_ = num_pairs;
+
+	return true;
+}
+
+
+//! Get the adjustment to the space between two characters
+//! @return	returns the number of pixels to add to the advance of the left character when followed by the right one (negative moves them closer), or 0 if the font has no pair for them
+signed int Font_GetKerning(Font* the_font, unsigned char left_char, unsigned char right_char)
+{
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed font was NULL", __func__, __LINE__));
+		return 0;
+	}
+
+	return Font_KernPair(the_font, left_char, right_char);
+}
+
+
+//! Measure how wide a string would be, drawn in a font
+//! @param	the_string: the text to measure
+//! @param	num_chars: the number of characters of the_string to measure
+//! @return	returns the total of the characters' advances and kerning, in pixels, or -1 on any error
+signed int Font_MeasureString(Font* the_font, const char* the_string, signed long num_chars)
+{
+	if (the_font == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed font or string was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	return Font_MeasureChars(the_font, the_string, num_chars);
+}
+
+
+
+
+// **** Text layout functions ****
+
+//! Create a text layout: break a string into lines that fit a rectangle
+//! Lines break at '\n', and (with PARAM_WRAP) at spaces, or within words too long for a line of their own. If there are more lines than fit, the last line that fits is cut short with an ellipsis.
+//! @param	the_font: the font the text will be drawn in. It is not copied.
+//! @param	the_string: the text. It is copied.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_align: a font_align value
+//! @param	wrap: PARAM_WRAP or PARAM_NO_WRAP
+//! @return	returns NULL on any error
+TextLayout* TextLayout_New(Font* the_font, const char* the_string, signed int width, signed int height, uint8_t the_align, boolean wrap)
+{
+	TextLayout*	the_layout;
+
+	if (the_font == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed font or string was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (width < 1 || height < 1 || the_align > FONT_ALIGN_RIGHT)
+	{
+		LOG_ERR(("%s %d: invalid rectangle (%i x %i) or alignment (%u)", __func__, __LINE__, width, height, the_align));
+		return NULL;
+	}
+
+	if ((the_layout = f_calloc(1, sizeof(TextLayout), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for text layout", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_layout	%p	size	%i", __func__ , __LINE__, the_layout, sizeof(TextLayout)));
+
+	the_layout->font_ = the_font;
+	the_layout->width_ = width;
+	the_layout->height_ = height;
+	the_layout->align_ = the_align;
+	the_layout->wrap_ = wrap;
+
+	if (!TextLayout_Build(the_layout, the_string))
+	{
+		TextLayout_Destroy(&the_layout);
+		return NULL;
+	}
+
+	return the_layout;
+}
+
+
+//! Free a text layout, and all memory associated with it. The font is not affected.
+boolean TextLayout_Destroy(TextLayout** the_layout)
+{
+	if (the_layout == NULL || *the_layout == NULL)
+	{
+		LOG_ERR(("%s %d: passed layout was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_layout)->string_)
+	{
+		f_free((*the_layout)->string_, MEM_STANDARD);
+	}
+
+	if ((*the_layout)->line_)
+	{
+		f_free((*the_layout)->line_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_layout	%p	size	%i", __func__ , __LINE__, *the_layout, sizeof(TextLayout)));
+	f_free(*the_layout, MEM_STANDARD);
+	*the_layout = NULL;
+
+	return true;
+}
+
+
+//! Change the text, font, or rectangle of a text layout
+//! The lines are only worked out again if something has changed, so this can be called before every redraw of a label whose text might have changed.
+//! @param	the_font: the font the text will be drawn in
+//! @param	the_string: the text. It is copied.
+//! @param	width, height: size of the rectangle, in pixels
+//! @return	returns false on any error
+boolean TextLayout_Update(TextLayout* the_layout, Font* the_font, const char* the_string, signed int width, signed int height)
+{
+	if (the_layout == NULL || the_font == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed layout, font, or string was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: invalid rectangle (%i x %i)", __func__, __LINE__, width, height));
+		return false;
+	}
+
+	if (the_font == the_layout->font_ && width == the_layout->width_ && height == the_layout->height_ && the_layout->string_ && strcmp(the_string, the_layout->string_) == 0)
+	{
+		return true;
+	}
+
+	the_layout->font_ = the_font;
+	the_layout->width_ = width;
+	the_layout->height_ = height;
+
+	return TextLayout_Build(the_layout, the_string);
+}
+
+
+
+
+// **** Stroke font functions ****
+
+//! Create a stroke font from a table of glyph strings
+//! The table and strings are not copied: they must stay valid until the font is destroyed. Each string is checked here, so drawing never has to.
+//! @param	the_glyphs: (last_char - first_char + 1) glyph strings, in the Hershey encoding described in lib_font.h. NULL for characters the font has no glyph for.
+//! @param	first_char, last_char: the first and last characters of the table
+//! @param	the_top, the_bottom: the glyph y coordinates at the top and bottom of a line of text. For Hershey fonts, typically -16 and 16.
+//! @param	cache_budget: the most memory, in bytes, to keep rasterized glyphs in. STROKE_FONT_DEFAULT_BUDGET is a reasonable start.
+//! @return	returns NULL on any error, including if any glyph string is malformed
+StrokeFont* StrokeFont_New(const char* const* the_glyphs, uint8_t first_char, uint8_t last_char, signed int the_top, signed int the_bottom, unsigned long cache_budget)
+{
+	StrokeFont*	the_font;
+	signed int	missing_char = -1;
+	signed int	i;
+
+	if (the_glyphs == NULL)
+	{
+		LOG_ERR(("%s %d: passed glyph table was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (last_char < first_char || the_bottom <= the_top)
+	{
+		LOG_ERR(("%s %d: invalid stroke font (chars %u to %u, top %i, bottom %i)", __func__, __LINE__, first_char, last_char, the_top, the_bottom));
+		return NULL;
+	}
+
+	for (i = 0; i <= last_char - first_char; i++)
+	{
+		if (the_glyphs[i] == NULL)
+		{
+			continue;
+		}
+
+		if (!StrokeFont_CheckGlyph(the_glyphs[i]))
+		{
+			LOG_ERR(("%s %d: glyph string for character %i is malformed", __func__, __LINE__, first_char + i));
+			return NULL;
+		}
+
+		// the missing character is FONT_MISSING_CHAR if the font has it, or else the first character it has
+		if (missing_char < 0 || first_char + i == FONT_MISSING_CHAR)
+		{
+			missing_char = first_char + i;
+		}
+	}
+
+	if (missing_char < 0)
+	{
+		LOG_ERR(("%s %d: stroke font has no glyphs", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_font = f_calloc(1, sizeof(StrokeFont), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for stroke font", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_font	%p	size	%i", __func__ , __LINE__, the_font, sizeof(StrokeFont)));
+
+	the_font->first_char_ = first_char;
+	the_font->last_char_ = last_char;
+	the_font->missing_char_ = missing_char;
+	the_font->top_ = the_top;
+	the_font->bottom_ = the_bottom;
+	the_font->glyph_ = the_glyphs;
+	the_font->cache_budget_ = cache_budget;
+
+	return the_font;
+}
+
+
+//! Free a stroke font, its cache of rasterized glyphs, and the font itself. The glyph strings are not affected.
+boolean StrokeFont_Destroy(StrokeFont** the_font)
+{
+	if (the_font == NULL || *the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed stroke font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	StrokeFont_FlushCache(*the_font);
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_font	%p	size	%i", __func__ , __LINE__, *the_font, sizeof(StrokeFont)));
+	f_free(*the_font, MEM_STANDARD);
+	*the_font = NULL;
+
+	return true;
+}
+
+
+//! Change how much memory a stroke font may keep rasterized glyphs in
+//! If the cache is already over the new budget, the glyphs used least recently are thrown away until it isn't.
+//! @param	cache_budget: the most memory, in bytes. 0 keeps only the glyph most recently rasterized.
+//! @return	returns false on any error
+boolean StrokeFont_SetCacheBudget(StrokeFont* the_font, unsigned long cache_budget)
+{
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed stroke font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	the_font->cache_budget_ = cache_budget;
+	StrokeFont_TrimCache(the_font, the_font->lru_first_);
+
+	return true;
+}
+
+
+//! Throw away every rasterized glyph in a stroke font's cache
+//! @return	returns false on any error
+boolean StrokeFont_FlushCache(StrokeFont* the_font)
+{
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed stroke font was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	while (the_font->lru_last_)
+	{
+		StrokeFont_FreeGlyph(the_font, the_font->lru_last_);
+	}
+
+	return true;
+}
+
+
+//! Get a stroke font's glyph for a character, rasterized at a size
+//! The glyph is rasterized if it isn't already cached. It is only valid until the next glyph is asked for: that may throw it out of the cache.
+//! @param	the_size: pixels per line of text, from 1 to STROKE_FONT_MAX_SIZE
+//! @return	returns the glyph, or the glyph of the font's missing character if it has none for the character, or NULL on any error
+const StrokeGlyph* StrokeFont_GetGlyph(StrokeFont* the_font, unsigned char the_char, signed int the_size)
+{
+	StrokeGlyph*	the_glyph;
+	StrokeGlyph**	the_bucket;
+
+	if (the_font == NULL)
+	{
+		LOG_ERR(("%s %d: passed stroke font was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_size < 1 || the_size > STROKE_FONT_MAX_SIZE)
+	{
+		LOG_ERR(("%s %d: invalid size (%i)", __func__, __LINE__, the_size));
+		return NULL;
+	}
+
+	// characters the font has no glyph for share the missing character's cached glyphs
+	StrokeFont_GetString(the_font, &the_char);
+
+	the_bucket = &the_font->bucket_[STROKE_FONT_HASH(the_char, the_size)];
+
+	for (the_glyph = *the_bucket; the_glyph; the_glyph = the_glyph->hash_next_)
+	{
+		if (the_glyph->char_ == the_char && the_glyph->size_ == the_size)
+		{
+			the_font->cache_hits_++;
+
+			if (the_glyph != the_font->lru_first_)
+			{
+				StrokeFont_UnlinkLRU(the_font, the_glyph);
+				StrokeFont_LinkLRU(the_font, the_glyph);
+			}
+
+			return the_glyph;
+		}
+	}
+
+	the_font->cache_misses_++;
+
+	if ((the_glyph = StrokeFont_Rasterize(the_font, the_char, the_size)) == NULL)
+	{
+		return NULL;
+	}
+
+	the_glyph->hash_next_ = *the_bucket;
+	*the_bucket = the_glyph;
+	StrokeFont_LinkLRU(the_font, the_glyph);
+	the_font->cache_used_ += the_glyph->bytes_;
+
+	StrokeFont_TrimCache(the_font, the_glyph);
+
+	return the_glyph;
+}
+
+
+//! Measure how wide a string would be, drawn in a stroke font at a size
+//! Nothing is rasterized: advances come straight from the glyph strings.
+//! @param	the_size: pixels per line of text, from 1 to STROKE_FONT_MAX_SIZE
+//! @param	the_string: the text to measure
+//! @param	num_chars: the number of characters of the_string to measure
+//! @return	returns the total of the characters' advances, in pixels, or -1 on any error
+signed int StrokeFont_MeasureString(StrokeFont* the_font, signed int the_size, const char* the_string, signed long num_chars)
+{
+	const char*		the_glyph;
+	unsigned char	the_char;
+	signed int		the_width = 0;
+
+	if (the_font == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed stroke font or string was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	if (the_size < 1 || the_size > STROKE_FONT_MAX_SIZE)
+	{
+		LOG_ERR(("%s %d: invalid size (%i)", __func__, __LINE__, the_size));
+		return -1;
+	}
+
+	for (; num_chars > 0; num_chars--)
+	{
+		the_char = (unsigned char)*the_string++;
+		the_glyph = StrokeFont_GetString(the_font, &the_char);
+		the_width += StrokeFont_Scale(the_font, the_glyph[1] - the_glyph[0], the_size);
+	}
+
+	return the_width;
+}
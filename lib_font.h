@@ -0,0 +1,389 @@
+//! @file lib_font.h
+
+/*
+ * lib_font.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_FONT_H_
+#define LIB_FONT_H_
+
+
+/* about this library: Font
+ *
+ * This provides the graphical (proportional width or fixed width) fonts used by the Graphics_DrawString family of functions.
+ *
+ * A font's glyphs are 1-bit images, side by side in one strip (the "strike"), every glyph the same height. Each glyph has its own image width,
+ * an offset from the pen position to the left edge of its image, and an advance: how far the pen moves after it.
+ *
+ * Testing bits is slow, so before a font is first drawn, every glyph is converted once into runs of set pixels (spans), row by row.
+ * Drawing a glyph is then one memset per span, and clipping is done per span.
+ *
+ * Kerning pairs adjust the space between particular pairs of characters (such as "AV"). They are kept sorted, and found with a binary search.
+ *
+ * A text layout breaks a string into lines that fit a rectangle, once, and keeps the line breaks with its own copy of the string.
+ * Static labels are measured when their layout is created or changed, and never again: Graphics_DrawLayout() only draws.
+ * Lines can be aligned left, center, or right, and text that doesn't fit is cut short with an ellipsis.
+ *
+ *** font file format
+ * A font file is laid out so that it can be used where it is loaded: the strike and kerning table are used in place, and only the glyph table is unpacked.
+ * All multi-byte fields are big-endian.
+ *   header (FONT_FILE_HEADER_SIZE bytes):
+ *     0   4   magic: 'A' '2' 'F' 'N'
+ *     4   2   version: FONT_FILE_VERSION
+ *     6   1   first character
+ *     7   1   last character
+ *     8   2   height: rows in every glyph image
+ *     10  2   ascent: rows above the baseline
+ *     12  2   leading: blank rows between lines
+ *     14  2   bytes in each row of the strike
+ *     16  2   number of kerning pairs
+ *     18  2   reserved, 0
+ *   glyph table: 1 entry of FONT_FILE_GLYPH_SIZE bytes per character, from the first to the last:
+ *     0   2   left edge of the glyph image in the strike
+ *     2   1   width of the glyph image
+ *     3   1   advance
+ *     4   1   offset from the pen position to the left edge of the image (signed)
+ *     5   1   reserved, 0
+ *   kerning table: 1 entry of FONT_KERN_PAIR_SIZE bytes per pair, sorted by left character, then right character:
+ *     0   1   left character
+ *     1   1   right character
+ *     2   1   adjustment to the space between them (signed). Negative moves them closer.
+ *     3   1   reserved, 0
+ *   strike: height rows of (bytes in each row) bytes
+ *
+ *** stroke fonts
+ * A stroke font draws text at any size. Its glyphs are lines between points (Hershey-style), scaled to the size asked for and drawn with the library's line code.
+ * Drawing lines is far too slow to do for every glyph of every label on every frame, so each glyph is rasterized once per size, into runs of pixels like a bitmap font's.
+ * The rasterized glyphs are kept in a cache, up to a memory budget. When a new glyph doesn't fit, the glyphs used least recently are thrown away to make room.
+ * Each glyph is a string in the Hershey font encoding, with every coordinate a character whose offset from 'R' is its value:
+ *   the first 2 characters are the left and right edges of the glyph: the pen moves (right - left) units after it.
+ *   every 2 characters after that are the x and y of a point, with y increasing downward. Each point is joined by a line to the one before it.
+ *   " R" lifts the pen: the next point starts a new line. A point on its own is drawn as a dot.
+ *   for example, "I[RFJ[ RRFZ[ RMTWT" is a capital A.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+
+// C includes
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define FONT_MAX_HEIGHT				255		//!< tallest glyph images a font can have
+#define FONT_MAX_GLYPH_WIDTH		255		//!< widest glyph image a font can have
+#define FONT_MISSING_CHAR			'?'		//!< drawn in place of characters the font has no glyph for, if the font has a glyph for it
+#define FONT_FILE_MAGIC				"A2FN"	//!< first 4 bytes of every font file
+#define FONT_FILE_VERSION			1		//!< font file format version written by Font_SaveToFile
+#define FONT_FILE_HEADER_SIZE		20		//!< size of the font file header, in bytes
+#define FONT_FILE_GLYPH_SIZE		6		//!< size of one glyph table entry in a font file, in bytes
+#define FONT_KERN_PAIR_SIZE			4		//!< size of one kerning pair, in a font file or in memory, in bytes
+
+#define FONT_ELLIPSIS				"..."	//!< drawn at the end of text that is cut short by a text layout
+#define FONT_ELLIPSIS_LEN			3		//!< number of characters in FONT_ELLIPSIS
+
+#define PARAM_WRAP					true	//!< for TextLayout_New: break lines between words to fit the width, as well as at line breaks in the text
+#define PARAM_NO_WRAP				false	//!< for TextLayout_New: only break lines at line breaks in the text. Lines too wide for the rectangle are cut short with an ellipsis.
+
+#define STROKE_FONT_ORIGIN			'R'		//!< in a stroke font glyph string, the character for coordinate 0
+#define STROKE_FONT_PEN_UP			" R"	//!< in a stroke font glyph string, lifts the pen between lines
+#define STROKE_FONT_MAX_SIZE		255		//!< largest size, in pixels per line of text, a stroke font can be drawn at
+#define STROKE_FONT_CACHE_BUCKETS	64		//!< number of hash buckets a stroke font finds cached glyphs with. Must be a power of 2.
+#define STROKE_FONT_DEFAULT_BUDGET	16384	//!< a reasonable memory budget, in bytes, for a stroke font's cache of rasterized glyphs
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum font_align
+{
+	FONT_ALIGN_LEFT = 0,	//!< each line starts at the left edge of the rectangle
+	FONT_ALIGN_CENTER,		//!< each line is centered in the rectangle
+	FONT_ALIGN_RIGHT,		//!< each line ends at the right edge of the rectangle
+} font_align;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct FontGlyph FontGlyph;
+typedef struct FontSpan FontSpan;
+typedef struct TextLine TextLine;
+typedef struct TextLayout TextLayout;
+typedef struct StrokeGlyph StrokeGlyph;
+typedef struct StrokeFont StrokeFont;
+
+//! One run of set pixels in one row of a glyph
+struct FontSpan
+{
+	uint8_t			row_;			//!< row of the glyph image, from 0 (the top)
+	uint8_t			x_;				//!< first pixel of the run, from the left edge of the glyph image
+	uint8_t			len_;			//!< number of pixels in the run
+};
+
+struct FontGlyph
+{
+	uint16_t		strike_x_;		//!< left edge of the glyph image within the font's strike
+	uint8_t			width_;			//!< width of the glyph image in pixels. 0 for glyphs with no image, such as space.
+	signed char		offset_;		//!< pixels from the pen position to the left edge of the glyph image. Can be negative.
+	uint8_t			advance_;		//!< pixels the pen moves right after drawing the glyph
+	uint16_t		num_spans_;		//!< number of runs of set pixels in the glyph image
+	signed long		first_span_;	//!< index in the font's span_ of the glyph's first run. Runs are in row order.
+};
+
+struct Font
+{
+	uint8_t			first_char_;	//!< first character the font has a glyph for
+	uint8_t			last_char_;		//!< last character the font has a glyph for
+	uint8_t			missing_char_;	//!< character drawn in place of characters outside first_char_ to last_char_
+	signed int		height_;		//!< rows in every glyph image
+	signed int		ascent_;		//!< rows of the glyph images above the baseline
+	signed int		descent_;		//!< rows of the glyph images below the baseline
+	signed int		leading_;		//!< blank rows between one line of text and the next
+	signed int		row_bytes_;		//!< bytes in each row of the strike
+	const uint8_t*	strike_;		//!< every glyph image, side by side: height_ rows of row_bytes_, 1 bit per pixel, leftmost pixel in the high bit
+	FontGlyph*		glyph_;			//!< one entry per character, from first_char_ to last_char_
+	FontSpan*		span_;			//!< every glyph's runs of set pixels, or NULL until they have been built
+	signed long		num_spans_;		//!< number of entries in span_
+	const uint8_t*	kern_;			//!< num_kern_pairs_ kerning pairs of FONT_KERN_PAIR_SIZE bytes, sorted by left then right character, or NULL
+	signed int		num_kern_pairs_;	//!< number of pairs in kern_
+	void*			data_;			//!< memory owned by the font, such as a file it was loaded from, freed with it. NULL if the strike belongs to the caller.
+};
+
+//! One line of a text layout
+struct TextLine
+{
+	signed long		start_;			//!< index in the layout's string of the line's first character
+	signed int		num_chars_;		//!< number of characters of the string drawn on the line, not counting any ellipsis
+	signed int		width_;			//!< width of the line in pixels, including any ellipsis
+	boolean			ellipsis_;		//!< true if the line is cut short, and ends with FONT_ELLIPSIS
+};
+
+//! A string broken into lines to fit a rectangle
+struct TextLayout
+{
+	Font*			font_;			//!< the font the lines were measured in
+	char*			string_;		//!< the layout's own copy of the string
+	signed long		length_;		//!< number of characters in string_
+	signed int		width_;			//!< width of the rectangle, in pixels
+	signed int		height_;		//!< height of the rectangle, in pixels
+	uint8_t			align_;			//!< a font_align value
+	boolean			wrap_;			//!< PARAM_WRAP or PARAM_NO_WRAP
+	signed int		num_lines_;		//!< number of lines that fit in the rectangle
+	TextLine*		line_;			//!< num_lines_ lines, from the top
+};
+
+//! One glyph of a stroke font, rasterized at one size
+//! It and its runs of pixels are one allocation, which belongs to the font's cache.
+struct StrokeGlyph
+{
+	StrokeGlyph*	lru_prev_;		//!< the cached glyph used just more recently than this one, or NULL if this is the most recently used
+	StrokeGlyph*	lru_next_;		//!< the cached glyph used just less recently than this one, or NULL if this is the least recently used
+	StrokeGlyph*	hash_next_;		//!< next cached glyph in the same hash bucket
+	uint8_t			char_;			//!< the character
+	uint8_t			size_;			//!< the size it was rasterized at, in pixels per line of text
+	uint8_t			width_;			//!< width of the glyph image in pixels
+	uint8_t			height_;		//!< height of the glyph image in pixels
+	signed int		x_;				//!< pixels from the pen position to the left edge of the glyph image. Can be negative.
+	signed int		y_;				//!< pixels from the top of the line to the top of the glyph image. Can be negative.
+	signed int		advance_;		//!< pixels the pen moves right after drawing the glyph
+	signed int		num_spans_;		//!< number of runs of set pixels in the glyph image
+	FontSpan*		span_;			//!< the runs of set pixels, in row order. Part of the same allocation as the glyph.
+	unsigned long	bytes_;			//!< size of the glyph's allocation, counted against the cache's budget
+};
+
+//! A scalable font whose glyphs are lines, with a cache of glyphs rasterized at the sizes drawn
+struct StrokeFont
+{
+	uint8_t			first_char_;	//!< first character the font has a glyph for
+	uint8_t			last_char_;		//!< last character the font has a glyph for
+	uint8_t			missing_char_;	//!< character drawn in place of characters the font has no glyph for
+	signed int		top_;			//!< the glyph coordinate at the top of a line of text
+	signed int		bottom_;		//!< the glyph coordinate at the bottom of a line of text. A line of text at size N is N pixels from top_ to bottom_.
+	const char* const*	glyph_;		//!< one glyph string per character, from first_char_ to last_char_, or NULL for characters the font has no glyph for
+	StrokeGlyph*	bucket_[STROKE_FONT_CACHE_BUCKETS];	//!< cached glyphs, hashed by character and size
+	StrokeGlyph*	lru_first_;		//!< the most recently used cached glyph
+	StrokeGlyph*	lru_last_;		//!< the least recently used cached glyph: the next to be thrown away
+	unsigned long	cache_budget_;	//!< the most memory, in bytes, cached glyphs should use
+	unsigned long	cache_used_;	//!< memory, in bytes, cached glyphs are using now
+	unsigned long	cache_hits_;	//!< number of glyph lookups found in the cache
+	unsigned long	cache_misses_;	//!< number of glyph lookups that had to be rasterized
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a proportional font over a strike of glyph images
+//! The strike and tables are not copied: they must stay valid until the font is destroyed. The glyph table is built from them.
+//! @param	the_strike: every glyph image, side by side: the_height rows of row_bytes, 1 bit per pixel, leftmost pixel in the high bit
+//! @param	row_bytes: bytes in each row of the strike
+//! @param	first_char, last_char: the first and last characters the font has glyphs for
+//! @param	the_height: rows in the strike, from 1 to FONT_MAX_HEIGHT
+//! @param	the_ascent: rows of the strike above the baseline
+//! @param	the_locations: (last_char - first_char + 2) entries: the left edge of each character's glyph image in the strike, then the right edge of the last one
+//! @param	the_advances: (last_char - first_char + 1) entries: how far the pen moves after each character. If NULL, each character advances by its image width.
+//! @param	the_offsets: (last_char - first_char + 1) entries: pixels from the pen position to the left edge of each character's image. If NULL, all are 0.
+//! @return	returns NULL on any error
+Font* Font_New(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_height, signed int the_ascent, const uint16_t* the_locations, const uint8_t* the_advances, const signed char* the_offsets);
+
+//! Create a fixed-width font over a strike of glyph images
+//! The strike is not copied: it must stay valid until the font is destroyed.
+//! @param	the_strike: every glyph image, side by side, each the_width pixels wide
+//! @param	row_bytes: bytes in each row of the strike
+//! @param	first_char, last_char: the first and last characters the font has glyphs for
+//! @param	the_width: width of every glyph, and how far the pen moves after each, from 1 to FONT_MAX_GLYPH_WIDTH
+//! @param	the_height: rows in the strike, from 1 to FONT_MAX_HEIGHT
+//! @param	the_ascent: rows of the strike above the baseline
+//! @return	returns NULL on any error
+Font* Font_NewFixedWidth(const uint8_t* the_strike, signed int row_bytes, uint8_t first_char, uint8_t last_char, signed int the_width, signed int the_height, signed int the_ascent);
+
+//! Create a font from a font file already in memory
+//! The data is not copied: the strike and kerning table are used where they are, so the data must stay valid until the font is destroyed.
+//! @param	the_data: the contents of a font file. See the file format above.
+//! @param	the_len: number of bytes of the_data
+//! @return	returns NULL on any error, including if the data is not a valid font file
+Font* Font_NewFromMemory(const uint8_t* the_data, unsigned long the_len);
+
+//! Load a font file
+//! The file is read in one go, into one allocation that the font owns and uses in place.
+//! @param	the_path: path of the font file
+//! @return	returns NULL on any error
+Font* Font_LoadFromFile(const char* the_path);
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. Bitmaps using the font must be given another before drawing text.
+boolean Font_Destroy(Font** the_font);
+
+
+// **** Font file functions ****
+
+//! Write a font to a font file
+//! Use on a host machine to turn a font built from tables with Font_New() into a file the A2560 can load quickly.
+//! @param	the_path: path of the file to create or overwrite
+//! @return	returns false on any error
+boolean Font_SaveToFile(Font* the_font, const char* the_path);
+
+
+// **** Glyph functions ****
+
+//! Convert every glyph of a font into runs of set pixels, if that hasn't been done yet
+//! Done automatically the first time the font is drawn. Call ahead of time to keep the cost out of the first frame that draws text.
+//! @return	returns false on any error
+boolean Font_BuildSpanCache(Font* the_font);
+
+//! Get the glyph a font draws for a character
+//! @return	returns the character's glyph, or the glyph of the font's missing character if it has none for it, or NULL if the font was NULL
+const FontGlyph* Font_GetGlyph(Font* the_font, unsigned char the_char);
+
+//! Give a font a table of kerning pairs
+//! The table is not copied: it must stay valid until the font is destroyed.
+//! @param	the_pairs: num_pairs entries of FONT_KERN_PAIR_SIZE bytes, laid out as in a font file, and sorted by left character, then right character. NULL to remove kerning.
+//! @param	num_pairs: the number of pairs
+//! @return	returns false on any error, including if the pairs are not sorted
+boolean Font_SetKerning(Font* the_font, const uint8_t* the_pairs, signed int num_pairs);
+
+//! Get the adjustment to the space between two characters
+//! @return	returns the number of pixels to add to the advance of the left character when followed by the right one (negative moves them closer), or 0 if the font has no pair for them
+signed int Font_GetKerning(Font* the_font, unsigned char left_char, unsigned char right_char);
+
+//! Measure how wide a string would be, drawn in a font
+//! @param	the_string: the text to measure
+//! @param	num_chars: the number of characters of the_string to measure
+//! @return	returns the total of the characters' advances and kerning, in pixels, or -1 on any error
+signed int Font_MeasureString(Font* the_font, const char* the_string, signed long num_chars);
+
+
+// **** Text layout functions ****
+
+//! Create a text layout: break a string into lines that fit a rectangle
+//! Lines break at '\n', and (with PARAM_WRAP) at spaces, or within words too long for a line of their own. If there are more lines than fit, the last line that fits is cut short with an ellipsis.
+//! @param	the_font: the font the text will be drawn in. It is not copied.
+//! @param	the_string: the text. It is copied.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_align: a font_align value
+//! @param	wrap: PARAM_WRAP or PARAM_NO_WRAP
+//! @return	returns NULL on any error
+TextLayout* TextLayout_New(Font* the_font, const char* the_string, signed int width, signed int height, uint8_t the_align, boolean wrap);
+
+//! Free a text layout, and all memory associated with it. The font is not affected.
+boolean TextLayout_Destroy(TextLayout** the_layout);
+
+//! Change the text, font, or rectangle of a text layout
+//! The lines are only worked out again if something has changed, so this can be called before every redraw of a label whose text might have changed.
+//! @param	the_font: the font the text will be drawn in
+//! @param	the_string: the text. It is copied.
+//! @param	width, height: size of the rectangle, in pixels
+//! @return	returns false on any error
+boolean TextLayout_Update(TextLayout* the_layout, Font* the_font, const char* the_string, signed int width, signed int height);
+
+
+// **** Stroke font functions ****
+
+//! Create a stroke font from a table of glyph strings
+//! The table and strings are not copied: they must stay valid until the font is destroyed. Each string is checked here, so drawing never has to.
+//! @param	the_glyphs: (last_char - first_char + 1) glyph strings, in the Hershey encoding described above. NULL for characters the font has no glyph for.
+//! @param	first_char, last_char: the first and last characters of the table
+//! @param	the_top, the_bottom: the glyph y coordinates at the top and bottom of a line of text. For Hershey fonts, typically -16 and 16.
+//! @param	cache_budget: the most memory, in bytes, to keep rasterized glyphs in. STROKE_FONT_DEFAULT_BUDGET is a reasonable start.
+//! @return	returns NULL on any error, including if any glyph string is malformed
+StrokeFont* StrokeFont_New(const char* const* the_glyphs, uint8_t first_char, uint8_t last_char, signed int the_top, signed int the_bottom, unsigned long cache_budget);
+
+//! Free a stroke font, its cache of rasterized glyphs, and the font itself. The glyph strings are not affected.
+boolean StrokeFont_Destroy(StrokeFont** the_font);
+
+//! Change how much memory a stroke font may keep rasterized glyphs in
+//! If the cache is already over the new budget, the glyphs used least recently are thrown away until it isn't.
+//! @param	cache_budget: the most memory, in bytes. 0 keeps only the glyph most recently rasterized.
+//! @return	returns false on any error
+boolean StrokeFont_SetCacheBudget(StrokeFont* the_font, unsigned long cache_budget);
+
+//! Throw away every rasterized glyph in a stroke font's cache
+//! @return	returns false on any error
+boolean StrokeFont_FlushCache(StrokeFont* the_font);
+
+//! Get a stroke font's glyph for a character, rasterized at a size
+//! The glyph is rasterized if it isn't already cached. It is only valid until the next glyph is asked for: that may throw it out of the cache.
+//! @param	the_size: pixels per line of text, from 1 to STROKE_FONT_MAX_SIZE
+//! @return	returns the glyph, or the glyph of the font's missing character if it has none for the character, or NULL on any error
+const StrokeGlyph* StrokeFont_GetGlyph(StrokeFont* the_font, unsigned char the_char, signed int the_size);
+
+//! Measure how wide a string would be, drawn in a stroke font at a size
+//! Nothing is rasterized: advances come straight from the glyph strings.
+//! @param	the_size: pixels per line of text, from 1 to STROKE_FONT_MAX_SIZE
+//! @param	the_string: the text to measure
+//! @param	num_chars: the number of characters of the_string to measure
+//! @return	returns the total of the characters' advances, in pixels, or -1 on any error
+signed int StrokeFont_MeasureString(StrokeFont* the_font, signed int the_size, const char* the_string, signed long num_chars);
+
+
+
+#endif /* LIB_FONT_H_ */
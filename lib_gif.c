@@ -0,0 +1,885 @@
+/*
+ * lib_gif.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_gif.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define GIF_BLOCK_EXTENSION			0x21
+#define GIF_BLOCK_IMAGE				0x2C
+#define GIF_BLOCK_TRAILER			0x3B
+#define GIF_EXTENSION_GRAPHIC_CONTROL	0xF9
+
+#define GIF_NUM_PASSES				4		//!< number of passes an interlaced frame's rows are stored in
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// get the next byte of the file
+boolean Gif_GetByte(GifDecoder* the_gif, uint8_t* the_byte);
+
+// get the next the_count bytes of the file
+boolean Gif_GetBytes(GifDecoder* the_gif, uint8_t* the_dest, signed int the_count);
+
+// read a color table of the_count entries into a palette, in LUT order
+boolean Gif_ReadPalette(GifDecoder* the_gif, uint8_t* the_palette, signed int the_count);
+
+// skip data sub-blocks up to and including the 0-length terminator
+boolean Gif_SkipSubBlocks(GifDecoder* the_gif);
+
+// get the next LZW code from the image data sub-blocks
+signed int Gif_GetCode(GifDecoder* the_gif, signed int code_size);
+
+// dispose of the previous frame, as it asked
+void Gif_DisposePrevious(GifDecoder* the_gif, Bitmap* the_bitmap);
+
+// discard the snapshots taken of the previous frame's bitmap and mask, if any
+void Gif_DiscardSnapshots(GifDecoder* the_gif);
+
+// write one decoded row of the frame into the bitmap and mask
+void Gif_WriteRow(GifDecoder* the_gif, uint8_t* the_line, Bitmap* the_bitmap, Bitmap* the_mask, signed int x, signed int y, signed int the_row);
+
+// decode the LZW image data of the frame
+boolean Gif_DecodeImage(GifDecoder* the_gif, Bitmap* the_bitmap, signed int x, signed int y, Bitmap* the_mask);
+
+//! \endcond
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Get the next byte of the file
+//! @return	returns false if the end of the file was reached
+boolean Gif_GetByte(GifDecoder* the_gif, uint8_t* the_byte)
+{
+	if (the_gif->pos_ >= the_gif->len_)
+	{
+		the_gif->pos_ = 0;
+		the_gif->len_ = fread(the_gif->buffer_, 1, GIF_READ_BUFFER_SIZE, the_gif->file_);
+
+		if (the_gif->len_ <= 0)
+		{
+			return false;
+		}
+	}
+
+	*the_byte = the_gif->buffer_[the_gif->pos_++];
+
+	return true;
+}
+
+
+//! Get the next the_count bytes of the file
+//! @return	returns false if the end of the file was reached first
+boolean Gif_GetBytes(GifDecoder* the_gif, uint8_t* the_dest, signed int the_count)
+{
+	while (the_count--)
+	{
+		if (!Gif_GetByte(the_gif, the_dest++))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! Read a color table of the_count entries into a palette, in LUT order
+//! GIF colors are R, G, B; the LUT wants B, G, R, A. Entries past the_count are set to 0.
+boolean Gif_ReadPalette(GifDecoder* the_gif, uint8_t* the_palette, signed int the_count)
+{
+	uint8_t		the_rgb[3];
+	signed int	i;
+
+	memset(the_palette, 0, GIF_PALETTE_BYTES);
+
+	for (i = 0; i < the_count; i++)
+	{
+		if (!Gif_GetBytes(the_gif, the_rgb, 3))
+		{
+			return false;
+		}
+
+		the_palette[i * 4] = the_rgb[2];
+		the_palette[i * 4 + 1] = the_rgb[1];
+		the_palette[i * 4 + 2] = the_rgb[0];
+		the_palette[i * 4 + 3] = 0xFF;
+	}
+
+	return true;
+}
+
+
+//! Skip data sub-blocks up to and including the 0-length terminator
+boolean Gif_SkipSubBlocks(GifDecoder* the_gif)
+{
+	uint8_t		the_len;
+	uint8_t		the_byte;
+
+	for (;;)
+	{
+		if (!Gif_GetByte(the_gif, &the_len))
+		{
+			return false;
+		}
+
+		if (the_len == 0)
+		{
+			return true;
+		}
+
+		while (the_len--)
+		{
+			if (!Gif_GetByte(the_gif, &the_byte))
+			{
+				return false;
+			}
+		}
+	}
+}
+
+
+//! Get the next LZW code from the image data sub-blocks
+//! Codes are packed lowest bit first, and run on from one sub-block to the next.
+//! @return	returns the code, or -1 if the image data ended
+signed int Gif_GetCode(GifDecoder* the_gif, signed int code_size)
+{
+	uint8_t			the_byte;
+	signed int		the_code;
+
+	while (the_gif->num_bits_ < code_size)
+	{
+		if (the_gif->block_left_ == 0)
+		{
+			if (!Gif_GetByte(the_gif, &the_byte) || the_byte == 0)
+			{
+				// the 0-length terminator has been used up: make sure nothing tries to skip past it again
+				the_gif->block_left_ = -1;
+				return -1;
+			}
+
+			the_gif->block_left_ = the_byte;
+		}
+
+		if (the_gif->block_left_ < 0 || !Gif_GetByte(the_gif, &the_byte))
+		{
+			return -1;
+		}
+
+		the_gif->block_left_--;
+		the_gif->bits_ |= (uint32_t)the_byte << the_gif->num_bits_;
+		the_gif->num_bits_ += 8;
+	}
+
+	the_code = the_gif->bits_ & ((1 << code_size) - 1);
+	the_gif->bits_ >>= code_size;
+	the_gif->num_bits_ -= code_size;
+
+	return the_code;
+}
+
+
+//! Dispose of the previous frame, as it asked
+//! Does nothing if the previous frame was decoded into a different bitmap than the next one will be: the app has moved on from it.
+//! @param	the_bitmap: the bitmap the next frame will be decoded into
+void Gif_DisposePrevious(GifDecoder* the_gif, Bitmap* the_bitmap)
+{
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+
+	if (the_gif->prev_bitmap_ == the_bitmap && the_gif->disposal_ == GIF_DISPOSAL_PREVIOUS && the_gif->prev_snapshot_)
+	{
+		if (!Bitmap_Restore(the_gif->prev_bitmap_, the_gif->prev_snapshot_) || (the_gif->prev_mask_snapshot_ && !Bitmap_Restore(the_gif->prev_mask_, the_gif->prev_mask_snapshot_)))
+		{
+			LOG_ERR(("%s %d: Couldn't restore what was under the previous frame; filling it with the background color instead", __func__, __LINE__));
+			the_gif->disposal_ = GIF_DISPOSAL_BACKGROUND;
+		}
+	}
+
+	if (the_gif->prev_bitmap_ != the_bitmap)
+	{
+		// nothing to dispose of
+	}
+	else if (the_gif->disposal_ == GIF_DISPOSAL_BACKGROUND)
+	{
+		left = the_gif->prev_x_ + the_gif->frame_x_;
+		top = the_gif->prev_y_ + the_gif->frame_y_;
+		right = left + the_gif->frame_width_;
+		bottom = top + the_gif->frame_height_;
+		left = (left < 0) ? 0 : left;
+		top = (top < 0) ? 0 : top;
+		right = (right > the_gif->prev_bitmap_->width_) ? the_gif->prev_bitmap_->width_ : right;
+		bottom = (bottom > the_gif->prev_bitmap_->height_) ? the_gif->prev_bitmap_->height_ : bottom;
+
+		if (left < right && top < bottom)
+		{
+			Graphics_FillBox(the_gif->prev_bitmap_, left, top, right - left, bottom - top, the_gif->background_);
+
+			if (the_gif->prev_mask_ && the_gif->mask_rect_.MinX <= the_gif->mask_rect_.MaxX)
+			{
+				Graphics_FillBox(the_gif->prev_mask_, the_gif->mask_rect_.MinX, the_gif->mask_rect_.MinY, the_gif->mask_rect_.MaxX - the_gif->mask_rect_.MinX + 1, the_gif->mask_rect_.MaxY - the_gif->mask_rect_.MinY + 1, GIF_MASK_TRANSPARENT);
+			}
+		}
+	}
+
+	Gif_DiscardSnapshots(the_gif);
+}
+
+
+//! Discard the snapshots taken of the previous frame's bitmap and mask, if any
+void Gif_DiscardSnapshots(GifDecoder* the_gif)
+{
+	if (the_gif->prev_snapshot_)
+	{
+		Bitmap_DiscardSnapshot(&the_gif->prev_snapshot_);
+	}
+
+	if (the_gif->prev_mask_snapshot_)
+	{
+		Bitmap_DiscardSnapshot(&the_gif->prev_mask_snapshot_);
+	}
+}
+
+
+//! Write one decoded row of the frame into the bitmap and mask
+//! @param	the_row: row of the frame, from 0 to frame_height_ - 1
+void Gif_WriteRow(GifDecoder* the_gif, uint8_t* the_line, Bitmap* the_bitmap, Bitmap* the_mask, signed int x, signed int y, signed int the_row)
+{
+	unsigned char*	the_write_loc;
+	unsigned char*	the_mask_loc = NULL;
+	signed int		dst_x;
+	signed int		dst_y;
+	signed int		left;
+	signed int		right;
+	signed int		mask_left;
+	signed int		mask_right;
+	signed int		i;
+
+	dst_x = x + the_gif->frame_x_;
+	dst_y = y + the_gif->frame_y_ + the_row;
+
+	if (dst_y < 0 || dst_y >= the_bitmap->height_)
+	{
+		return;
+	}
+
+	left = (dst_x < 0) ? -dst_x : 0;
+	right = (dst_x + the_gif->frame_width_ > the_bitmap->width_) ? the_bitmap->width_ - dst_x : the_gif->frame_width_;
+
+	if (left >= right)
+	{
+		return;
+	}
+
+	// the frame's rectangle was prepared for writing before decoding started, so rows can be written directly
+	the_write_loc = the_bitmap->addr_ + dst_y * the_bitmap->width_ + dst_x;
+
+	// the mask is only written inside the rectangle that was prepared for it, which can be smaller than the part of the frame in the bitmap
+	mask_left = the_gif->mask_rect_.MinX - dst_x;
+	mask_right = the_gif->mask_rect_.MaxX + 1 - dst_x;
+
+	if (the_mask && dst_y >= the_gif->mask_rect_.MinY && dst_y <= the_gif->mask_rect_.MaxY && mask_left < mask_right)
+	{
+		the_mask_loc = the_mask->addr_ + dst_y * the_mask->width_ + dst_x;
+	}
+
+	if (the_gif->transparent_ == GIF_NO_TRANSPARENCY)
+	{
+		memcpy(the_write_loc + left, the_line + left, right - left);
+
+		if (the_mask_loc)
+		{
+			memset(the_mask_loc + mask_left, GIF_MASK_OPAQUE, mask_right - mask_left);
+		}
+
+		return;
+	}
+
+	for (i = left; i < right; i++)
+	{
+		if (the_line[i] != the_gif->transparent_)
+		{
+			the_write_loc[i] = the_line[i];
+
+			if (the_mask_loc && i >= mask_left && i < mask_right)
+			{
+				the_mask_loc[i] = GIF_MASK_OPAQUE;
+			}
+		}
+	}
+}
+
+
+//! Decode the LZW image data of the frame
+//! Each row is collected in a line buffer, then written into the bitmap in its place, which for interlaced frames is not the order it arrives in.
+//! @return	returns false on any error. A frame whose data ends early is not an error: the rows not reached are left as they were.
+boolean Gif_DecodeImage(GifDecoder* the_gif, Bitmap* the_bitmap, signed int x, signed int y, Bitmap* the_mask)
+{
+	static const signed int	pass_start[GIF_NUM_PASSES] = {0, 4, 2, 1};
+	static const signed int	pass_step[GIF_NUM_PASSES] = {8, 8, 4, 2};
+	uint8_t*		the_line;
+	uint8_t*		the_stack_top;
+	uint8_t			min_code_size;
+	uint8_t			the_byte;
+	uint8_t			first_pixel = 0;
+	signed int		code_size;
+	signed int		clear_code;
+	signed int		next_code;
+	signed int		prev_code = -1;
+	signed int		the_code;
+	signed int		in_code;
+	signed int		the_col = 0;
+	signed int		the_row = 0;
+	signed int		the_pass = 0;
+	signed int		rows_done = 0;
+	signed int		i;
+
+	if (!Gif_GetByte(the_gif, &min_code_size) || min_code_size < 2 || min_code_size > 11)
+	{
+		LOG_ERR(("%s %d: invalid LZW code size", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_line = f_calloc(the_gif->frame_width_, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for a %i pixel row", __func__, __LINE__, the_gif->frame_width_));
+		return false;
+	}
+
+	clear_code = 1 << min_code_size;
+	code_size = min_code_size + 1;
+	next_code = clear_code + 2;
+
+	for (i = 0; i < clear_code; i++)
+	{
+		the_gif->prefix_[i] = 0;
+		the_gif->suffix_[i] = (uint8_t)i;
+	}
+
+	the_gif->block_left_ = 0;
+	the_gif->bits_ = 0;
+	the_gif->num_bits_ = 0;
+
+	// LOGIC:
+	//   standard GIF LZW: each code stands for a string of pixels. a code's string is its prefix code's string plus its suffix pixel.
+	//   strings are unwound onto a stack, last pixel first, then popped off into the line buffer.
+	//   after each code (except the first after a clear), a new code is added: the previous code's string plus the first pixel of this one.
+	//   a code that isn't in the table yet can only be the one about to be added (the "KwKwK" case): the previous string plus its own first pixel.
+
+	while (rows_done < the_gif->frame_height_)
+	{
+		if ((the_code = Gif_GetCode(the_gif, code_size)) < 0 || the_code == clear_code + 1)
+		{
+			break;
+		}
+
+		if (the_code == clear_code)
+		{
+			code_size = min_code_size + 1;
+			next_code = clear_code + 2;
+			prev_code = -1;
+			continue;
+		}
+
+		the_stack_top = the_gif->stack_;
+
+		if (prev_code < 0)
+		{
+			if (the_code >= clear_code)
+			{
+				goto bad_data;
+			}
+
+			first_pixel = (uint8_t)the_code;
+			*the_stack_top++ = first_pixel;
+		}
+		else
+		{
+			in_code = the_code;
+
+			if (the_code >= next_code)
+			{
+				if (the_code > next_code)
+				{
+					goto bad_data;
+				}
+
+				*the_stack_top++ = first_pixel;
+				the_code = prev_code;
+			}
+
+			while (the_code >= clear_code)
+			{
+				if (the_stack_top >= the_gif->stack_ + GIF_MAX_CODES - 1)
+				{
+					goto bad_data;
+				}
+
+				*the_stack_top++ = the_gif->suffix_[the_code];
+				the_code = the_gif->prefix_[the_code];
+			}
+
+			first_pixel = (uint8_t)the_code;
+			*the_stack_top++ = first_pixel;
+
+			if (next_code < GIF_MAX_CODES)
+			{
+				the_gif->prefix_[next_code] = prev_code;
+				the_gif->suffix_[next_code] = first_pixel;
+				next_code++;
+
+				if (next_code == (1 << code_size) && code_size < 12)
+				{
+					code_size++;
+				}
+			}
+
+			the_code = in_code;
+		}
+
+		prev_code = the_code;
+
+		while (the_stack_top > the_gif->stack_ && rows_done < the_gif->frame_height_)
+		{
+			the_line[the_col++] = *--the_stack_top;
+
+			if (the_col == the_gif->frame_width_)
+			{
+				Gif_WriteRow(the_gif, the_line, the_bitmap, the_mask, x, y, the_row);
+				the_col = 0;
+				rows_done++;
+
+				if (the_gif->interlaced_)
+				{
+					the_row += pass_step[the_pass];
+
+					while (the_row >= the_gif->frame_height_ && the_pass < GIF_NUM_PASSES - 1)
+					{
+						the_pass++;
+						the_row = pass_start[the_pass];
+					}
+				}
+				else
+				{
+					the_row++;
+				}
+			}
+		}
+	}
+
+	if (rows_done < the_gif->frame_height_)
+	{
+		LOG_WARN(("%s %d: frame data ended after %i of %i rows", __func__, __LINE__, rows_done, the_gif->frame_height_));
+	}
+
+	f_free(the_line, MEM_STANDARD);
+
+	// skip the end of code, and anything else up to the terminator, unless the terminator has already been read
+	if (the_gif->block_left_ < 0)
+	{
+		return true;
+	}
+
+	while (the_gif->block_left_ > 0)
+	{
+		if (!Gif_GetByte(the_gif, &the_byte))
+		{
+			return false;
+		}
+
+		the_gif->block_left_--;
+	}
+
+	return Gif_SkipSubBlocks(the_gif);
+
+bad_data:
+	LOG_ERR(("%s %d: invalid LZW code (%i)", __func__, __LINE__, the_code));
+	f_free(the_line, MEM_STANDARD);
+	return false;
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Open a GIF file and read its header and global palette
+//! @param	the_path: path of the GIF file
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the global palette, in LUT order (B, G, R, A). Entries the file doesn't define are set to 0. Can be NULL.
+//! @return	returns NULL on any error
+GifDecoder* Gif_Open(const char* the_path, uint8_t* the_palette)
+{
+	GifDecoder*		the_gif;
+	uint8_t			the_header[13];
+
+	if (the_path == NULL)
+	{
+		LOG_ERR(("%s %d: passed path was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_gif = f_calloc(1, sizeof(GifDecoder), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for GIF decoder", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_gif	%p	size	%i", __func__ , __LINE__, the_gif, sizeof(GifDecoder)));
+
+	if ((the_gif->file_ = fopen(the_path, "rb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't open file '%s'", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	// LOGIC:
+	//   6 byte signature, then the logical screen descriptor: width, height (little-endian), flags, background color, aspect ratio.
+	//   if the global color table flag is set, the table follows, 2 ^ (low 3 bits of flags + 1) entries long.
+
+	if (!Gif_GetBytes(the_gif, the_header, 13) || memcmp(the_header, "GIF", 3) != 0 || (memcmp(&the_header[3], "87a", 3) != 0 && memcmp(&the_header[3], "89a", 3) != 0))
+	{
+		LOG_ERR(("%s %d: '%s' is not a GIF file", __func__, __LINE__, the_path));
+		goto error;
+	}
+
+	the_gif->width_ = the_header[6] | (the_header[7] << 8);
+	the_gif->height_ = the_header[8] | (the_header[9] << 8);
+	the_gif->background_ = the_header[11];
+	the_gif->transparent_ = GIF_NO_TRANSPARENCY;
+
+	if (the_header[10] & 0x80)
+	{
+		if (!Gif_ReadPalette(the_gif, the_gif->global_palette_, 2 << (the_header[10] & 0x07)))
+		{
+			LOG_ERR(("%s %d: '%s' ended in its palette", __func__, __LINE__, the_path));
+			goto error;
+		}
+	}
+
+	if (the_palette)
+	{
+		memcpy(the_palette, the_gif->global_palette_, GIF_PALETTE_BYTES);
+	}
+
+	return the_gif;
+
+error:
+	Gif_Close(&the_gif);
+	return NULL;
+}
+
+
+// destructor
+// closes the file, and frees all allocated memory associated with the passed object, and the object itself. Decoded bitmaps are not affected.
+boolean Gif_Close(GifDecoder** the_gif)
+{
+	if (the_gif == NULL || *the_gif == NULL)
+	{
+		LOG_ERR(("%s %d: passed decoder was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_gif)->file_)
+	{
+		fclose((*the_gif)->file_);
+	}
+
+	Gif_DiscardSnapshots(*the_gif);
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_gif	%p	size	%i", __func__ , __LINE__, *the_gif, sizeof(GifDecoder)));
+	f_free(*the_gif, MEM_STANDARD);
+	*the_gif = NULL;
+
+	return true;
+}
+
+
+
+
+// **** Decode functions ****
+
+//! Decode the next frame of the GIF into a bitmap
+//! Before decoding, the previous frame is disposed of, as it asked to be. For animations, pass the same bitmap (and mask) for every frame.
+//! Pixels of the frame's transparent color are left untouched. The frame is clipped to the bitmap.
+//! After the call, the frame_ fields, delay_, transparent_, and disposal_ describe the frame just decoded.
+//! @param	the_bitmap: reference to a valid Bitmap object to decode into
+//! @param	x, y: where in the_bitmap the top left corner of the GIF's logical screen should go
+//! @param	the_mask: optional bitmap, laid out like the_bitmap, in which every pixel the frame draws is set to GIF_MASK_OPAQUE. Pixels disposed of with GIF_DISPOSAL_BACKGROUND are set back to GIF_MASK_TRANSPARENT. Can be NULL.
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the frame's palette: its local palette if it has one, otherwise the global palette. Can be NULL.
+//! @return	returns false on any error, or if there are no more frames (in which case finished_ is set)
+boolean Gif_DecodeNextFrame(GifDecoder* the_gif, Bitmap* the_bitmap, signed int x, signed int y, Bitmap* the_mask, uint8_t* the_palette)
+{
+	uint8_t			the_block[9];
+	uint8_t			the_local_palette[GIF_PALETTE_BYTES];
+	uint8_t			the_byte;
+	uint8_t			the_disposal = GIF_DISPOSAL_NONE;
+	signed int		the_transparent = GIF_NO_TRANSPARENCY;
+	signed int		the_delay = 0;
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+
+	if (the_gif == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed decoder or bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_gif->finished_)
+	{
+		return false;
+	}
+
+	Gif_DisposePrevious(the_gif, the_bitmap);
+
+	// LOGIC:
+	//   blocks until the next image: graphic control extensions set up the frame that follows them. all other extensions are skipped.
+
+	for (;;)
+	{
+		if (!Gif_GetByte(the_gif, &the_byte))
+		{
+			LOG_WARN(("%s %d: file ended without a trailer", __func__, __LINE__));
+			the_gif->finished_ = true;
+			return false;
+		}
+
+		if (the_byte == GIF_BLOCK_TRAILER)
+		{
+			the_gif->finished_ = true;
+			return false;
+		}
+
+		if (the_byte == GIF_BLOCK_IMAGE)
+		{
+			break;
+		}
+
+		if (the_byte != GIF_BLOCK_EXTENSION || !Gif_GetByte(the_gif, &the_byte))
+		{
+			LOG_ERR(("%s %d: unexpected block type (%u)", __func__, __LINE__, the_byte));
+			return false;
+		}
+
+		if (the_byte == GIF_EXTENSION_GRAPHIC_CONTROL)
+		{
+			// size (always 4), flags, delay (2 bytes), transparent color; then the terminator
+			if (!Gif_GetBytes(the_gif, the_block, 5))
+			{
+				return false;
+			}
+
+			the_disposal = (the_block[1] >> 2) & 0x07;
+			the_delay = the_block[2] | (the_block[3] << 8);
+			the_transparent = (the_block[1] & 0x01) ? the_block[4] : GIF_NO_TRANSPARENCY;
+		}
+
+		if (!Gif_SkipSubBlocks(the_gif))
+		{
+			return false;
+		}
+	}
+
+	// image descriptor: left, top, width, height (little-endian), flags
+	if (!Gif_GetBytes(the_gif, the_block, 9))
+	{
+		return false;
+	}
+
+	the_gif->frame_x_ = the_block[0] | (the_block[1] << 8);
+	the_gif->frame_y_ = the_block[2] | (the_block[3] << 8);
+	the_gif->frame_width_ = the_block[4] | (the_block[5] << 8);
+	the_gif->frame_height_ = the_block[6] | (the_block[7] << 8);
+	the_gif->interlaced_ = (the_block[8] & 0x40) != 0;
+	the_gif->disposal_ = (the_disposal > GIF_DISPOSAL_PREVIOUS) ? GIF_DISPOSAL_NONE : the_disposal;
+	the_gif->delay_ = the_delay;
+	the_gif->transparent_ = the_transparent;
+
+	if (the_block[8] & 0x80)
+	{
+		if (!Gif_ReadPalette(the_gif, the_local_palette, 2 << (the_block[8] & 0x07)))
+		{
+			return false;
+		}
+
+		if (the_palette)
+		{
+			memcpy(the_palette, the_local_palette, GIF_PALETTE_BYTES);
+		}
+	}
+	else if (the_palette)
+	{
+		memcpy(the_palette, the_gif->global_palette_, GIF_PALETTE_BYTES);
+	}
+
+	if (the_gif->frame_width_ < 1 || the_gif->frame_height_ < 1)
+	{
+		LOG_ERR(("%s %d: invalid frame size (%i x %i)", __func__, __LINE__, the_gif->frame_width_, the_gif->frame_height_));
+		return false;
+	}
+
+	// LOGIC:
+	//   a frame that will be restored afterwards gets a snapshot first: only the tiles the frame touches are ever copied.
+	//   the frame's rectangle (clipped to the bitmap) is prepared for writing once, then rows are written directly as they are decoded.
+
+	the_gif->prev_bitmap_ = the_bitmap;
+	the_gif->prev_mask_ = the_mask;
+	the_gif->prev_x_ = x;
+	the_gif->prev_y_ = y;
+
+	if (the_gif->disposal_ == GIF_DISPOSAL_PREVIOUS)
+	{
+		the_gif->prev_snapshot_ = Bitmap_Snapshot(the_bitmap);
+		the_gif->prev_mask_snapshot_ = the_mask ? Bitmap_Snapshot(the_mask) : NULL;
+
+		if (the_gif->prev_snapshot_ == NULL || (the_mask && the_gif->prev_mask_snapshot_ == NULL))
+		{
+			LOG_ERR(("%s %d: Couldn't snapshot the bitmap or mask; frame will be disposed of with the background color instead", __func__, __LINE__));
+			Gif_DiscardSnapshots(the_gif);
+			the_gif->disposal_ = GIF_DISPOSAL_BACKGROUND;
+		}
+	}
+
+	left = x + the_gif->frame_x_;
+	top = y + the_gif->frame_y_;
+	right = left + the_gif->frame_width_;
+	bottom = top + the_gif->frame_height_;
+	left = (left < 0) ? 0 : left;
+	top = (top < 0) ? 0 : top;
+	right = (right > the_bitmap->width_) ? the_bitmap->width_ : right;
+	bottom = (bottom > the_bitmap->height_) ? the_bitmap->height_ : bottom;
+
+	if (left < right && top < bottom)
+	{
+		if (Bitmap_GetMemLocForWrite(the_bitmap, left, top, right - left, bottom - top) == NULL)
+		{
+			return false;
+		}
+	}
+
+	// LOGIC:
+	//   the mask can be smaller than the bitmap. the part of the frame written to it is clipped to it as well, and exactly that rectangle
+	//   is prepared for writing (lazy clear, dirty rect, snapshot tiles) and used by Gif_WriteRow() and background disposal.
+
+	the_gif->mask_rect_.MinX = 1;
+	the_gif->mask_rect_.MaxX = 0;
+
+	if (the_mask)
+	{
+		right = (right > the_mask->width_) ? the_mask->width_ : right;
+		bottom = (bottom > the_mask->height_) ? the_mask->height_ : bottom;
+
+		if (left < right && top < bottom && Bitmap_GetMemLocForWrite(the_mask, left, top, right - left, bottom - top) != NULL)
+		{
+			the_gif->mask_rect_.MinX = left;
+			the_gif->mask_rect_.MinY = top;
+			the_gif->mask_rect_.MaxX = right - 1;
+			the_gif->mask_rect_.MaxY = bottom - 1;
+		}
+	}
+
+	if (!Gif_DecodeImage(the_gif, the_bitmap, x, y, the_mask))
+	{
+		return false;
+	}
+
+	the_gif->frame_count_++;
+
+	return true;
+}
+
+
+//! Create a new bitmap the size of a GIF's logical screen, and decode its first frame into it
+//! The bitmap is first filled with the GIF's background color.
+//! @param	the_path: path of the GIF file
+//! @param	the_palette: optional GIF_PALETTE_BYTES buffer to receive the first frame's palette. Can be NULL.
+//! @return	returns NULL on any error
+Bitmap* Gif_LoadFromFile(const char* the_path, uint8_t* the_palette)
+{
+	GifDecoder*		the_gif;
+	Bitmap*			the_bitmap;
+
+	if ((the_gif = Gif_Open(the_path, NULL)) == NULL)
+	{
+		return NULL;
+	}
+
+	if ((the_bitmap = Bitmap_NewWithFlags(the_gif->width_, the_gif->height_, NULL, BITMAP_FLAG_UNINITIALIZED)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't create a %i x %i bitmap for '%s'", __func__, __LINE__, the_gif->width_, the_gif->height_, the_path));
+		Gif_Close(&the_gif);
+		return NULL;
+	}
+
+	Graphics_FillBox(the_bitmap, 0, 0, the_bitmap->width_, the_bitmap->height_, the_gif->background_);
+
+	if (!Gif_DecodeNextFrame(the_gif, the_bitmap, 0, 0, NULL, the_palette))
+	{
+		Bitmap_Destroy(&the_bitmap);
+	}
+
+	Gif_Close(&the_gif);
+
+	return the_bitmap;
+}
@@ -15,6 +15,7 @@
 
 // project includes
 #include "lib_graphics.h"
+#include "lib_font.h"
 
 // C includes
 #include <stdarg.h>
@@ -29,11 +30,20 @@
 #include <mb/lib_text.h>
 #include <mb/lib_sys.h>
 
+// host-build includes
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
 
 /*****************************************************************************/
 /*                               Definitions                                 */
 /*****************************************************************************/
 
+#define BITMAP_BAND_IS_VALID(the_bitmap, the_band)	((the_bitmap)->band_valid_[(the_band) >> 3] & (1 << ((the_band) & 0x07)))
+#define BITMAP_MEM_TYPE(the_bitmap)					(((the_bitmap)->flags_ & BITMAP_FLAG_STANDARD_RAM) ? MEM_STANDARD : MEM_VRAM)
 
 
 /*****************************************************************************/
@@ -46,6 +56,9 @@
 /*                             Global Variables                              */
 /*****************************************************************************/
 
+#if defined(__linux__)
+	static WorkerPool*	global_worker_pool = NULL;	//!< the threads large fills and blits are split between, or NULL if they aren't split. Set by Graphics_SetWorkerThreads().
+#endif
 
 
 /*****************************************************************************/
@@ -60,6 +73,55 @@ boolean Graphics_ValidateXY(Bitmap* the_bitmap, signed int x, signed int y);
 // calculate the VRAM location of the specified coordinate
 unsigned char* Graphics_GetMemLocForXY(Bitmap* the_bitmap, signed int x, signed int y);
 
+// clear (or just mark as cleared) one row band of a lazily-cleared bitmap
+void Bitmap_ValidateBand(Bitmap* the_bitmap, signed int the_band, boolean do_clear);
+
+// make sure every row band touched by a read of the specified rows has been cleared
+void Bitmap_PrepareRowsForRead(Bitmap* the_bitmap, signed int y, signed int height);
+
+// make sure every row band touched by a write to the specified rectangle is valid once the write is done
+void Bitmap_PrepareRectForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height);
+
+// copy each snapshot tile touched by a write to the specified rectangle into the newest snapshot, if it hasn't been copied already
+void Bitmap_SaveTilesForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height);
+
+// copy pixels between one snapshot tile and the bitmap
+void Bitmap_CopyTile(Bitmap* the_bitmap, BitmapSnapshot* the_snapshot, signed int the_tile, unsigned char* the_tile_data, boolean to_bitmap);
+
+// wait until the VICKY starts drawing a new frame
+void Graphics_WaitForVBlank(void);
+
+// copy one row of pixels, using the copy width best suited to the memory involved
+void Graphics_CopyRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, boolean via_vram);
+
+// fill or copy a block of rows on the calling thread. the read location is NULL for a fill.
+void Graphics_DoRows(unsigned char* the_write_loc, signed int write_stride, unsigned char* the_read_loc, signed int read_stride, signed int the_len, signed int num_rows, unsigned char the_color, boolean via_vram);
+
+// fill or copy a block of rows, split between the worker threads on host builds if it is big enough. the read location is NULL for a fill.
+void Graphics_ProcessRows(unsigned char* the_write_loc, signed int write_stride, unsigned char* the_read_loc, signed int read_stride, signed int the_len, signed int num_rows, unsigned char the_color, boolean via_vram);
+
+#if defined(__linux__)
+
+	// claim and do slices of a block of rows until none are left. the argument is a GraphicsRowJob.
+	void Graphics_DoRowSlices(void* the_arg);
+
+	// the body of each worker thread: run each job as it is started, until the pool is destroyed
+	void* WorkerPool_Worker(void* the_arg);
+
+#endif
+
+// copy one row of pixels, translating each through a 256-entry table. the read and write locations can be the same.
+void Graphics_RemapRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, const uint8_t* the_table);
+
+// blend one row of source pixels into a row of destination pixels, through a 256 x 256 blend table
+void Graphics_BlendRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, const uint8_t* the_blend_table);
+
+// check that the source and destination bitmaps of a blit are usable
+boolean Graphics_ValidateBlitBitmaps(Bitmap* src_bm, Bitmap* dst_bm);
+
+// clip a blit's rectangle so that it lies within both the source and the destination bitmaps
+boolean Graphics_ClipBlit(Bitmap* src_bm, signed int* src_x, signed int* src_y, Bitmap* dst_bm, signed int* dst_x, signed int* dst_y, signed int* width, signed int* height);
+
 //! Draw 1 to 4 quadrants of a circle
 //! Only the specified quadrants will be drawn. This makes it possible to use this to make round rects, by only passing 1 quadrant.
 //! Based on http://rosettacode.org/wiki/Bitmap/Midpoint_circle_algorithm#C
@@ -68,6 +130,12 @@ boolean Graphics_DrawCircleQuadrants(Bitmap* the_bitmap, signed int x1, signed i
 //! Perform a flood fill starting at the coordinate passed. 
 boolean Graphics_Fill(Bitmap* the_bitmap, signed int x, signed int y, unsigned char the_color);
 
+// draw a glyph's runs of pixels with its image's top left corner at x, y, clipped to the bitmap
+void Graphics_DrawSpans(Bitmap* the_bitmap, const FontSpan* the_span, signed int num_spans, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+// draw the first num_chars characters of a string in a font, with the top of the line at y. returns the pen position after the last character.
+signed int Graphics_DrawChars(Bitmap* the_bitmap, Font* the_font, signed int x, signed int y, const char* the_string, signed int num_chars, unsigned char the_color);
+
 // **** Debug functions *****
 
 void Bitmap_Print(Bitmap* the_bitmap);
@@ -129,233 +197,955 @@ unsigned char* Graphics_GetMemLocForXY(Bitmap* the_bitmap, signed int x, signed
 }
 
 
-//! Draw 1 to 4 quadrants of a circle
-//! Only the specified quadrants will be drawn. This makes it possible to use this to make round rects, by only passing 1 quadrant.
-//! NO VALIDATION PERFORMEND ON PARAMETERS. CALLING METHOD MUST VALIDATE.
-//! Based on http://rosettacode.org/wiki/Bitmap/Midpoint_circle_algorithm#C
-boolean Graphics_DrawCircleQuadrants(Bitmap* the_bitmap, signed int x1, signed int y1, signed int radius, unsigned char the_color, boolean ne, boolean se, boolean sw, boolean nw)
+//! Clear (or just mark as cleared) one row band of a lazily-cleared bitmap
+//! @param	the_band: the row band number. The band must not already be valid.
+//! @param	do_clear: if false, the band will only be marked valid, because the caller is about to overwrite all of it.
+void Bitmap_ValidateBand(Bitmap* the_bitmap, signed int the_band, boolean do_clear)
 {
-    int	f;
-    int	ddF_x;
-    int	ddF_y;
-    int	x;
-    int	y;
- 
-	f = 1 - radius;
-	ddF_x = 0;
-	ddF_y = -2 * radius;
-	x = 0;
-	y = radius;
-
-	if (se || sw)
+	signed int		band_top;
+	signed int		band_height;
+	
+	if (do_clear)
 	{
-		Graphics_SetPixelAtXY(the_bitmap, x1, y1 + radius, the_color);
+		band_top = the_band * BITMAP_BAND_HEIGHT;
+		band_height = the_bitmap->height_ - band_top;
+		band_height = (band_height > BITMAP_BAND_HEIGHT) ? BITMAP_BAND_HEIGHT : band_height;
+
+		memset(the_bitmap->addr_ + (the_bitmap->width_ * band_top), 0, the_bitmap->width_ * band_height);
 	}
-	if (ne || nw)
+	
+	the_bitmap->band_valid_[the_band >> 3] |= (1 << (the_band & 0x07));
+	the_bitmap->bands_pending_--;
+}
+
+
+//! Make sure every row band touched by a read of the specified rows has been cleared
+//! Rows outside the bitmap are ignored. Does nothing unless the bitmap was created with BITMAP_FLAG_LAZY_CLEAR.
+void Bitmap_PrepareRowsForRead(Bitmap* the_bitmap, signed int y, signed int height)
+{
+	signed int		the_band;
+	signed int		last_band;
+	
+	if (the_bitmap->bands_pending_ == 0)
 	{
-		Graphics_SetPixelAtXY(the_bitmap, x1, y1 - radius, the_color);
+		return;
 	}
-	if (se || ne)
+	
+	if (y < 0)
 	{
-		Graphics_SetPixelAtXY(the_bitmap, x1 + radius, y1, the_color);
+		height += y;
+		y = 0;
 	}
-	if (nw || sw)
+
+	height = (y + height > the_bitmap->height_) ? the_bitmap->height_ - y : height;
+	
+	if (height <= 0)
 	{
-		Graphics_SetPixelAtXY(the_bitmap, x1 - radius, y1, the_color);
+		return;
 	}
- 
-    while(x < y) 
+	
+	last_band = (y + height - 1) / BITMAP_BAND_HEIGHT;
+	
+	for (the_band = y / BITMAP_BAND_HEIGHT; the_band <= last_band; the_band++)
 	{
-		if(f >= 0) 
+		if (!BITMAP_BAND_IS_VALID(the_bitmap, the_band))
 		{
-			y--;
-			ddF_y += 2;
-			f += ddF_y;
+			Bitmap_ValidateBand(the_bitmap, the_band, true);
 		}
-
-		x++;
-		ddF_x += 2;
-		f += ddF_x + 1;  
- 
- 		if (se)
-        {
-			Graphics_SetPixelAtXY(the_bitmap, x1 + x, y1 + y, the_color);
-			Graphics_SetPixelAtXY(the_bitmap, x1 + y, y1 + x, the_color);
-        }
- 
- 		if (sw)
-        {
-			Graphics_SetPixelAtXY(the_bitmap, x1 - x, y1 + y, the_color);
-			Graphics_SetPixelAtXY(the_bitmap, x1 - y, y1 + x, the_color);
-        }
- 
- 		if (ne)
-        {
-			Graphics_SetPixelAtXY(the_bitmap, x1 + x, y1 - y, the_color);
-			Graphics_SetPixelAtXY(the_bitmap, x1 + y, y1 - x, the_color);
-        }
- 
- 		if (nw)
-        {
-			Graphics_SetPixelAtXY(the_bitmap, x1 - x, y1 - y, the_color);
-			Graphics_SetPixelAtXY(the_bitmap, x1 - y, y1 - x, the_color);
-        }
-    }
-    
-    return true;
+	}
 }
 
 
-//! Perform a flood fill starting at the coordinate passed. 
-//! WARNING: this function is recursive, and if applied to a size even 1/10th the size of the screen, it can eat the stack. Either do not use this, or control its usage to just situations you can control. Or set an enormous stack size when building your app.
-//! @param	the_color: a 1-byte index to the current LUT
-boolean Graphics_Fill(Bitmap* the_bitmap, signed int x, signed int y, unsigned char the_color)
-{   
-	int		height;
-	int		width;
-	unsigned char	color_here;
+//! Make sure every row band touched by a write to the specified rectangle is valid once the write is done
+//! Bands the write covers completely are only marked as valid; bands it covers partially are cleared first, so the untouched pixels read back as 0.
+//! Also adds the rectangle to the bitmap's dirty rect, if it is tracking one, and saves the tiles it touches into the newest snapshot, if there is one.
+//! Does nothing unless the bitmap was created with BITMAP_FLAG_LAZY_CLEAR or BITMAP_FLAG_TRACK_DIRTY, or has a snapshot.
+void Bitmap_PrepareRectForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height)
+{
+	signed int		the_band;
+	signed int		last_band;
+	signed int		band_top;
+	signed int		band_bottom;
+	boolean			full_width;
+	Rectangle*		the_dirty;
 	
-	width = the_bitmap->width_;
-	height = the_bitmap->height_;
+	if (the_bitmap->bands_pending_ == 0 && !(the_bitmap->flags_ & BITMAP_FLAG_TRACK_DIRTY) && the_bitmap->snapshot_ == NULL)
+	{
+		return;
+	}
+	
+	if (y < 0)
+	{
+		height += y;
+		y = 0;
+	}
 
-//	color_here = Graphics_GetPixelAtXY(the_bitmap, x, y);
+	height = (y + height > the_bitmap->height_) ? the_bitmap->height_ - y : height;
 	
-// 	DEBUG_OUT(("%s %d: x=%i, y=%i, the_color=%i, value-at-spot=%i", __func__, __LINE__, x, y, the_color, color_here));
+	if (height <= 0 || width <= 0)
+	{
+		return;
+	}
 	
-    if ( 0 <= y && y < height && 0 <= x && x < width && Graphics_GetPixelAtXY(the_bitmap, x, y) != the_color )
-    {
-        Graphics_SetPixelAtXY(the_bitmap, x, y, the_color);
-        Graphics_Fill(the_bitmap, x-1, y, the_color);
-        Graphics_Fill(the_bitmap, x+1, y, the_color);
-        Graphics_Fill(the_bitmap, x, y-1, the_color);
-        Graphics_Fill(the_bitmap, x, y+1, the_color);
-    }
-//     else
-//     {
-// 		DEBUG_OUT(("%s %d: skipping x=%i, y=%i, the_color=%i, value-at-spot=%i", __func__, __LINE__, x, y, the_color, color_here));
-//     }
-    
-    
-    return true;
+	if (the_bitmap->flags_ & BITMAP_FLAG_TRACK_DIRTY)
+	{
+		the_dirty = &the_bitmap->dirty_;
+		
+		the_dirty->MinX = (x < the_dirty->MinX) ? x : the_dirty->MinX;
+		the_dirty->MinY = (y < the_dirty->MinY) ? y : the_dirty->MinY;
+		the_dirty->MaxX = (x + width - 1 > the_dirty->MaxX) ? x + width - 1 : the_dirty->MaxX;
+		the_dirty->MaxY = (y + height - 1 > the_dirty->MaxY) ? y + height - 1 : the_dirty->MaxY;
+	}
+	
+	if (the_bitmap->snapshot_)
+	{
+		Bitmap_SaveTilesForWrite(the_bitmap, x, y, width, height);
+	}
+	
+	if (the_bitmap->bands_pending_ == 0)
+	{
+		return;
+	}
+	
+	full_width = (x <= 0 && x + width >= the_bitmap->width_);
+	last_band = (y + height - 1) / BITMAP_BAND_HEIGHT;
+	
+	for (the_band = y / BITMAP_BAND_HEIGHT; the_band <= last_band; the_band++)
+	{
+		if (!BITMAP_BAND_IS_VALID(the_bitmap, the_band))
+		{
+			band_top = the_band * BITMAP_BAND_HEIGHT;
+			band_bottom = band_top + BITMAP_BAND_HEIGHT;
+			band_bottom = (band_bottom > the_bitmap->height_) ? the_bitmap->height_ : band_bottom;
+			
+			Bitmap_ValidateBand(the_bitmap, the_band, !(full_width && y <= band_top && y + height >= band_bottom));
+		}
+	}
 }
 
 
-
-// **** Debug functions *****
-
-void Bitmap_Print(Bitmap* the_bitmap)
+//! Copy each snapshot tile touched by a write to the specified rectangle into the newest snapshot, if it hasn't been copied already
+//! Rows have already been clipped to the bitmap by the caller; columns have not.
+void Bitmap_SaveTilesForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height)
 {
-	DEBUG_OUT(("Bitmap print out:"));
-	DEBUG_OUT(("  address: %p",			the_bitmap));
-	DEBUG_OUT(("  width_: %i",			the_bitmap->width_));	
-	DEBUG_OUT(("  height_: %i",			the_bitmap->height_));	
-	DEBUG_OUT(("  x_: %i",				the_bitmap->x_));	
-	DEBUG_OUT(("  y_: %i",				the_bitmap->y_));	
-	DEBUG_OUT(("  color_: %u",			the_bitmap->color_));	
-	DEBUG_OUT(("  reserved_: %u",		the_bitmap->reserved_));	
-	DEBUG_OUT(("  font_: %p",			the_bitmap->font_));	
-	DEBUG_OUT(("  addr_: %p",			the_bitmap->addr_));
-}
-
-//! \endcond
-
-
+	BitmapSnapshot*	the_snapshot;
+	signed int		tile_x;
+	signed int		tile_y;
+	signed int		first_tile_x;
+	signed int		last_tile_x;
+	signed int		last_tile_y;
+	signed int		the_tile;
+	
+	if (x < 0)
+	{
+		width += x;
+		x = 0;
+	}
 
-/*****************************************************************************/
-/*                        Public Function Definitions                        */
-/*****************************************************************************/
+	width = (x + width > the_bitmap->width_) ? the_bitmap->width_ - x : width;
+	
+	if (width <= 0)
+	{
+		return;
+	}
 
-// **** CONSTRUCTOR AND DESTRUCTOR *****
+	the_snapshot = the_bitmap->snapshot_;
+	first_tile_x = x / BITMAP_SNAPSHOT_TILE_SIZE;
+	last_tile_x = (x + width - 1) / BITMAP_SNAPSHOT_TILE_SIZE;
+	last_tile_y = (y + height - 1) / BITMAP_SNAPSHOT_TILE_SIZE;
+	
+	for (tile_y = y / BITMAP_SNAPSHOT_TILE_SIZE; tile_y <= last_tile_y; tile_y++)
+	{
+		the_tile = tile_y * the_snapshot->tiles_across_ + first_tile_x;
+		
+		for (tile_x = first_tile_x; tile_x <= last_tile_x; tile_x++, the_tile++)
+		{
+			if (the_snapshot->tile_[the_tile] != NULL)
+			{
+				continue;
+			}
+			
+			if ((the_snapshot->tile_[the_tile] = f_calloc(BITMAP_SNAPSHOT_TILE_SIZE * BITMAP_SNAPSHOT_TILE_SIZE, sizeof(unsigned char), MEM_STANDARD)) == NULL)
+			{
+				LOG_ERR(("%s %d: Couldn't allocate snapshot tile %i; snapshot %p and older snapshots can no longer be restored", __func__, __LINE__, the_tile, the_snapshot));
+				the_snapshot->incomplete_ = true;
+				continue;
+			}
+			
+			Bitmap_CopyTile(the_bitmap, the_snapshot, the_tile, the_snapshot->tile_[the_tile], false);
+		}
+	}
+}
 
-// constructor
 
-//! Create a new bitmap object by allocating space for the bitmap struct in regular memory, and for the graphics, in VRAM
-//! @param	Font: optional font object to associate with the Bitmap. 
-Bitmap* Bitmap_New(signed int width, signed int height, Font* the_font)
+//! Copy pixels between one snapshot tile and the bitmap
+//! Edge tiles are stored packed at their actual (smaller) width.
+//! @param	to_bitmap: if true, copy from the tile data into the bitmap. If false, copy from the bitmap into the tile data.
+void Bitmap_CopyTile(Bitmap* the_bitmap, BitmapSnapshot* the_snapshot, signed int the_tile, unsigned char* the_tile_data, boolean to_bitmap)
 {
-	Bitmap*		the_bitmap;
-
-	DEBUG_OUT(("%s %d: start bitmap creation... (%i, %i, %p)", __func__, __LINE__, width, height, the_font));
-
-	// check width/height for some maximum??
-	// TODO
-	if ( (width < 2 || width > 2000) || (height < 2 || height > 2000) )
+	unsigned char*	the_bitmap_loc;
+	signed int		x;
+	signed int		y;
+	signed int		width;
+	signed int		height;
+	
+	x = (the_tile % the_snapshot->tiles_across_) * BITMAP_SNAPSHOT_TILE_SIZE;
+	y = (the_tile / the_snapshot->tiles_across_) * BITMAP_SNAPSHOT_TILE_SIZE;
+	width = (x + BITMAP_SNAPSHOT_TILE_SIZE > the_bitmap->width_) ? the_bitmap->width_ - x : BITMAP_SNAPSHOT_TILE_SIZE;
+	height = (y + BITMAP_SNAPSHOT_TILE_SIZE > the_bitmap->height_) ? the_bitmap->height_ - y : BITMAP_SNAPSHOT_TILE_SIZE;
+	
+	the_bitmap_loc = Graphics_GetMemLocForXY(the_bitmap, x, y);
+	
+	for (; height > 0; height--)
 	{
-		LOG_ERR(("%s %d: Illegal width (%i) and/or height (%i)", __func__, __LINE__, width, height));
-		goto error;
+		if (to_bitmap)
+		{
+			memcpy(the_bitmap_loc, the_tile_data, width);
+		}
+		else
+		{
+			memcpy(the_tile_data, the_bitmap_loc, width);
+		}
+		
+		the_bitmap_loc += the_bitmap->width_;
+		the_tile_data += width;
 	}
+}
 
-	DEBUG_OUT(("%s %d: allocating struct in normal memory...", __func__, __LINE__));
+
+//! Wait until the VICKY starts drawing a new frame
+//! The MCP counts start-of-frame interrupts as jiffies, so a change in the jiffy count means the vertical blank has just begun.
+void Graphics_WaitForVBlank(void)
+{
+	long	start_jiffies;
 	
-	// LOGIC:
-	//   we have 2 kinds of memory: VRAM and standard RAM
-	//   A bitmap object needs a struct which can and should be allocated in normal memory
-	//   It also needs the actual bytes for the bitmap, which must be allocated in VRAM
+	start_jiffies = sys_time_jiffies();
 	
-	// NOTE: MEM_STANDARD allocations are failing for some reason. until figure it out, allocate everything in VRAM.
-	//if ((the_bitmap = f_calloc(1, sizeof(Bitmap), MEM_STANDARD)) == NULL)
-	if ((the_bitmap = f_calloc(1, sizeof(Bitmap), MEM_VRAM)) == NULL)
+	while (sys_time_jiffies() == start_jiffies)
 	{
-		LOG_ERR(("%s %d: Couldn't allocate space for bitmap struc", __func__, __LINE__));
-		goto error;
 	}
+}
 
-	DEBUG_OUT(("%s %d: Allocating a screen-sized bitmap in VRAM...", __func__, __LINE__));
 
-	if ((the_bitmap->addr_ = f_calloc(sizeof(uint8_t), width * height, MEM_VRAM)) == NULL)
+//! Copy one row of pixels, using the copy width best suited to the memory involved
+//! LOGIC:
+//!   the libc memcpy is the right choice for standard RAM. VRAM sits on the VICKY's bus, where every access is expensive, 
+//!   so when VRAM is on either side, copy a long word (4 pixels) at a time once the pointers are aligned.
+//!   if the source and destination can't both be long-aligned at the same time, fall back to memcpy.
+//! @param	via_vram: true if either the source or destination row is in VRAM
+void Graphics_CopyRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, boolean via_vram)
+{
+	uint32_t*		the_long_write_loc;
+	uint32_t*		the_long_read_loc;
+	signed int		num_longs;
+	
+	if (!via_vram || the_len < GRAPHICS_LONG_COPY_MIN_LEN || ((unsigned long)the_write_loc & 0x03) != ((unsigned long)the_read_loc & 0x03))
 	{
-		LOG_ERR(("%s %d: Couldn't instantiate a bitmap", __func__, __LINE__));
-		goto error;
+		memcpy(the_write_loc, the_read_loc, the_len);
+		return;
 	}
-
-	the_bitmap->width_ = width;
-	the_bitmap->height_ = height;
 	
-	DEBUG_OUT(("%s %d: Bitmap allocated! p=%p, addr=%p", __func__, __LINE__, the_bitmap, the_bitmap->addr_));
-
-	if (the_font)
+	// copy leading bytes until the pointers are long-aligned
+	while ((unsigned long)the_write_loc & 0x03)
 	{
-		if (Bitmap_SetCurrentFont(the_bitmap, the_font) == false)
-		{
-			LOG_ERR(("%s %d: Couldn't assign the font to the bitmap", __func__, __LINE__));
-			goto error;
-		}
+		*the_write_loc++ = *the_read_loc++;
+		the_len--;
 	}
-		
-	Bitmap_Print(the_bitmap);
 	
-	return the_bitmap;
+	the_long_write_loc = (uint32_t*)the_write_loc;
+	the_long_read_loc = (uint32_t*)the_read_loc;
 	
-error:
-	return NULL;
-}
-
-// destructor
-// frees all allocated memory associated with the passed object, and the object itself
-boolean Bitmap_Destroy(Bitmap** the_bitmap)
-{
-	if (*the_bitmap == NULL)
+	for (num_longs = the_len >> 2; num_longs >= 4; num_longs -= 4)
 	{
-		LOG_ERR(("%s %d: passed class object was null", __func__ , __LINE__));
-		return false;
+		*the_long_write_loc++ = *the_long_read_loc++;
+		*the_long_write_loc++ = *the_long_read_loc++;
+		*the_long_write_loc++ = *the_long_read_loc++;
+		*the_long_write_loc++ = *the_long_read_loc++;
 	}
-
-	// LOGIC: 
-	//   Bitmaps optionally have fonts associated with them.
-	//   We do not want to destroy these, because other objects could be using them.
-	//   TODO: notify the system that we are no longer using this font (system needs to be tallying usage count for that to work)
 	
-	if ((*the_bitmap)->font_)
+	for (; num_longs > 0; num_longs--)
 	{
-		(*the_bitmap)->font_ = NULL;
+		*the_long_write_loc++ = *the_long_read_loc++;
 	}
-
-	if ((*the_bitmap)->addr_)
+	
+	// copy any trailing bytes
+	the_write_loc = (unsigned char*)the_long_write_loc;
+	the_read_loc = (unsigned char*)the_long_read_loc;
+	
+	for (the_len &= 0x03; the_len > 0; the_len--)
 	{
-		f_free((*the_bitmap)->addr_, MEM_VRAM);
+		*the_write_loc++ = *the_read_loc++;
 	}
+}
 
-	LOG_ALLOC(("%s %d:	__FREE__	*the_bitmap	%p	size	%i", __func__ , __LINE__, *the_bitmap, sizeof(Bitmap)));
+
+//! Fill or copy a block of rows on the calling thread
+//! @param	the_read_loc: for copies, the first pixel of the first row to read. NULL for fills.
+void Graphics_DoRows(unsigned char* the_write_loc, signed int write_stride, unsigned char* the_read_loc, signed int read_stride, signed int the_len, signed int num_rows, unsigned char the_color, boolean via_vram)
+{
+	if (the_read_loc == NULL)
+	{
+		// rows with no gap between them are one run of memory
+		if (write_stride == the_len && num_rows > 0)
+		{
+			memset(the_write_loc, the_color, (unsigned long)the_len * num_rows);
+			return;
+		}
+
+		for (; num_rows > 0; num_rows--)
+		{
+			memset(the_write_loc, the_color, the_len);
+			the_write_loc += write_stride;
+		}
+
+		return;
+	}
+
+	for (; num_rows > 0; num_rows--)
+	{
+		Graphics_CopyRow(the_write_loc, the_read_loc, the_len, via_vram);
+		the_write_loc += write_stride;
+		the_read_loc += read_stride;
+	}
+}
+
+
+//! Fill or copy a block of rows, split between the worker threads on host builds if it is big enough
+//! Returns once every row is done. On the A2560, or without a worker pool, the rows are simply done on the calling thread.
+//! @param	the_read_loc: for copies, the first pixel of the first row to read. NULL for fills.
+void Graphics_ProcessRows(unsigned char* the_write_loc, signed int write_stride, unsigned char* the_read_loc, signed int read_stride, signed int the_len, signed int num_rows, unsigned char the_color, boolean via_vram)
+{
+	#if defined(__linux__)
+		GraphicsRowJob		the_job;
+		unsigned char*		write_end;
+		unsigned char*		read_end;
+
+		// LOGIC:
+		//   each row is independent, so the rows are split into 1 slice per thread, and the calling thread does a slice alongside the workers.
+		//   small blocks aren't worth waking the workers for.
+		//   a copy whose source and destination memory overlap (a scroll within one bitmap) gives a different result depending on which rows are copied first: never split it.
+		//   the pool does one block at a time. if another thread already has it, do the rows here rather than wait.
+
+		if (global_worker_pool != NULL && global_worker_pool->num_workers_ > 1 && num_rows > 1 && the_len > 0 && (unsigned long)the_len * num_rows >= GRAPHICS_PARALLEL_MIN_BYTES)
+		{
+			write_end = the_write_loc + (unsigned long)write_stride * (num_rows - 1) + the_len;
+			read_end = the_read_loc + (unsigned long)read_stride * (num_rows - 1) + the_len;
+
+			if (the_read_loc == NULL || read_end <= the_write_loc || write_end <= the_read_loc)
+			{
+				the_job.write_loc_ = the_write_loc;
+				the_job.write_stride_ = write_stride;
+				the_job.read_loc_ = the_read_loc;
+				the_job.read_stride_ = read_stride;
+				the_job.len_ = the_len;
+				the_job.num_rows_ = num_rows;
+				the_job.color_ = the_color;
+				the_job.via_vram_ = via_vram;
+				the_job.num_slices_ = global_worker_pool->num_workers_;
+				the_job.next_slice_ = 0;
+
+				if (WorkerPool_Run(global_worker_pool, Graphics_DoRowSlices, &the_job))
+				{
+					return;
+				}
+			}
+		}
+	#endif
+
+	Graphics_DoRows(the_write_loc, write_stride, the_read_loc, read_stride, the_len, num_rows, the_color, via_vram);
+}
+
+
+#if defined(__linux__)
+
+	//! Claim and do slices of a block of rows until none are left
+	//! @param	the_arg: the GraphicsRowJob being done
+	void Graphics_DoRowSlices(void* the_arg)
+	{
+		GraphicsRowJob*		the_job;
+		signed int			the_slice;
+		signed int			first_row;
+		signed int			end_row;
+
+		the_job = (GraphicsRowJob*)the_arg;
+
+		while ((the_slice = __sync_fetch_and_add(&the_job->next_slice_, 1)) < the_job->num_slices_)
+		{
+			first_row = (signed long)the_job->num_rows_ * the_slice / the_job->num_slices_;
+			end_row = (signed long)the_job->num_rows_ * (the_slice + 1) / the_job->num_slices_;
+
+			Graphics_DoRows(the_job->write_loc_ + (unsigned long)the_job->write_stride_ * first_row, the_job->write_stride_, (the_job->read_loc_ == NULL) ? NULL : the_job->read_loc_ + (unsigned long)the_job->read_stride_ * first_row, the_job->read_stride_, the_job->len_, end_row - first_row, the_job->color_, the_job->via_vram_);
+		}
+	}
+
+
+	//! The body of each worker thread: run each job as it is started, until the pool is destroyed
+	void* WorkerPool_Worker(void* the_arg)
+	{
+		WorkerPool*		the_pool;
+		unsigned long	last_job;
+
+		the_pool = (WorkerPool*)the_arg;
+
+		// LOGIC:
+		//   a worker must not read job_ to find where it starts: the thread may not get to run until after the first job has been started,
+		//   and would then wait for the job after it, while the job it missed waits for it. every pool's job_ starts at 0, so every worker starts from 0.
+
+		last_job = 0;
+
+		pthread_mutex_lock(&the_pool->lock_);
+
+		for (;;)
+		{
+			while (the_pool->job_ == last_job && !the_pool->quit_)
+			{
+				pthread_cond_wait(&the_pool->start_cond_, &the_pool->lock_);
+			}
+
+			if (the_pool->quit_)
+			{
+				break;
+			}
+
+			last_job = the_pool->job_;
+			pthread_mutex_unlock(&the_pool->lock_);
+
+			(*the_pool->job_function_)(the_pool->job_arg_);
+
+			pthread_mutex_lock(&the_pool->lock_);
+
+			if (--the_pool->num_busy_ == 0)
+			{
+				pthread_cond_signal(&the_pool->done_cond_);
+			}
+		}
+
+		pthread_mutex_unlock(&the_pool->lock_);
+
+		return NULL;
+	}
+
+#endif
+
+
+//! Copy one row of pixels, translating each through a 256-entry table
+//! The read and write locations can be the same, to remap pixels in place.
+void Graphics_RemapRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, const uint8_t* the_table)
+{
+	for (; the_len >= 4; the_len -= 4)
+	{
+		*the_write_loc++ = the_table[*the_read_loc++];
+		*the_write_loc++ = the_table[*the_read_loc++];
+		*the_write_loc++ = the_table[*the_read_loc++];
+		*the_write_loc++ = the_table[*the_read_loc++];
+	}
+
+	for (; the_len > 0; the_len--)
+	{
+		*the_write_loc++ = the_table[*the_read_loc++];
+	}
+}
+
+
+//! Blend one row of source pixels into a row of destination pixels, through a 256 x 256 blend table
+//! Each destination pixel d, under source pixel s, becomes the_blend_table[s * 256 + d].
+void Graphics_BlendRow(unsigned char* the_write_loc, unsigned char* the_read_loc, signed int the_len, const uint8_t* the_blend_table)
+{
+	for (; the_len >= 4; the_len -= 4)
+	{
+		*the_write_loc = the_blend_table[(*the_read_loc++ << 8) | *the_write_loc];
+		the_write_loc++;
+		*the_write_loc = the_blend_table[(*the_read_loc++ << 8) | *the_write_loc];
+		the_write_loc++;
+		*the_write_loc = the_blend_table[(*the_read_loc++ << 8) | *the_write_loc];
+		the_write_loc++;
+		*the_write_loc = the_blend_table[(*the_read_loc++ << 8) | *the_write_loc];
+		the_write_loc++;
+	}
+
+	for (; the_len > 0; the_len--)
+	{
+		*the_write_loc = the_blend_table[(*the_read_loc++ << 8) | *the_write_loc];
+		the_write_loc++;
+	}
+}
+
+
+//! Check that the source and destination bitmaps of a blit are usable
+//! @return	returns false if either is NULL or has no pixel memory, or if the destination is read-only
+boolean Graphics_ValidateBlitBitmaps(Bitmap* src_bm, Bitmap* dst_bm)
+{
+	if (src_bm == NULL || dst_bm == NULL)
+	{
+		LOG_ERR(("%s %d: passed source or destination bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+	
+	if (src_bm->addr_ == NULL || dst_bm->addr_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed source or destination bitmap had a NULL address", __func__, __LINE__));
+		return false;
+	}
+
+	if (dst_bm->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: destination bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	return true;
+}
+
+
+//! Clip a blit's rectangle so that it lies within both the source and the destination bitmaps
+//! Any part of the rectangle that is off the edge of either bitmap is trimmed from both, so the pixels that remain still line up.
+//! @return	returns false if nothing is left to copy
+boolean Graphics_ClipBlit(Bitmap* src_bm, signed int* src_x, signed int* src_y, Bitmap* dst_bm, signed int* dst_x, signed int* dst_y, signed int* width, signed int* height)
+{
+	signed int		the_trim;
+	
+	// trim the left and top edges, off whichever bitmap they stick out of further
+	the_trim = (*src_x < *dst_x) ? -*src_x : -*dst_x;
+	
+	if (the_trim > 0)
+	{
+		*src_x += the_trim;
+		*dst_x += the_trim;
+		*width -= the_trim;
+	}
+	
+	the_trim = (*src_y < *dst_y) ? -*src_y : -*dst_y;
+	
+	if (the_trim > 0)
+	{
+		*src_y += the_trim;
+		*dst_y += the_trim;
+		*height -= the_trim;
+	}
+	
+	// trim the right and bottom edges
+	if (*src_x + *width > src_bm->width_)
+	{
+		*width = src_bm->width_ - *src_x;
+	}
+	
+	if (*dst_x + *width > dst_bm->width_)
+	{
+		*width = dst_bm->width_ - *dst_x;
+	}
+	
+	if (*src_y + *height > src_bm->height_)
+	{
+		*height = src_bm->height_ - *src_y;
+	}
+	
+	if (*dst_y + *height > dst_bm->height_)
+	{
+		*height = dst_bm->height_ - *dst_y;
+	}
+	
+	return (*width > 0 && *height > 0);
+}
+
+
+//! Draw 1 to 4 quadrants of a circle
+//! Only the specified quadrants will be drawn. This makes it possible to use this to make round rects, by only passing 1 quadrant.
+//! NO VALIDATION PERFORMEND ON PARAMETERS. CALLING METHOD MUST VALIDATE.
+//! Based on http://rosettacode.org/wiki/Bitmap/Midpoint_circle_algorithm#C
+boolean Graphics_DrawCircleQuadrants(Bitmap* the_bitmap, signed int x1, signed int y1, signed int radius, unsigned char the_color, boolean ne, boolean se, boolean sw, boolean nw)
+{
+    int	f;
+    int	ddF_x;
+    int	ddF_y;
+    int	x;
+    int	y;
+ 
+	f = 1 - radius;
+	ddF_x = 0;
+	ddF_y = -2 * radius;
+	x = 0;
+	y = radius;
+
+	if (se || sw)
+	{
+		Graphics_SetPixelAtXY(the_bitmap, x1, y1 + radius, the_color);
+	}
+	if (ne || nw)
+	{
+		Graphics_SetPixelAtXY(the_bitmap, x1, y1 - radius, the_color);
+	}
+	if (se || ne)
+	{
+		Graphics_SetPixelAtXY(the_bitmap, x1 + radius, y1, the_color);
+	}
+	if (nw || sw)
+	{
+		Graphics_SetPixelAtXY(the_bitmap, x1 - radius, y1, the_color);
+	}
+ 
+    while(x < y) 
+	{
+		if(f >= 0) 
+		{
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+
+		x++;
+		ddF_x += 2;
+		f += ddF_x + 1;  
+ 
+ 		if (se)
+        {
+			Graphics_SetPixelAtXY(the_bitmap, x1 + x, y1 + y, the_color);
+			Graphics_SetPixelAtXY(the_bitmap, x1 + y, y1 + x, the_color);
+        }
+ 
+ 		if (sw)
+        {
+			Graphics_SetPixelAtXY(the_bitmap, x1 - x, y1 + y, the_color);
+			Graphics_SetPixelAtXY(the_bitmap, x1 - y, y1 + x, the_color);
+        }
+ 
+ 		if (ne)
+        {
+			Graphics_SetPixelAtXY(the_bitmap, x1 + x, y1 - y, the_color);
+			Graphics_SetPixelAtXY(the_bitmap, x1 + y, y1 - x, the_color);
+        }
+ 
+ 		if (nw)
+        {
+			Graphics_SetPixelAtXY(the_bitmap, x1 - x, y1 - y, the_color);
+			Graphics_SetPixelAtXY(the_bitmap, x1 - y, y1 - x, the_color);
+        }
+    }
+    
+    return true;
+}
+
+
+//! Perform a flood fill starting at the coordinate passed. 
+//! WARNING: this function is recursive, and if applied to a size even 1/10th the size of the screen, it can eat the stack. Either do not use this, or control its usage to just situations you can control. Or set an enormous stack size when building your app.
+//! @param	the_color: a 1-byte index to the current LUT
+boolean Graphics_Fill(Bitmap* the_bitmap, signed int x, signed int y, unsigned char the_color)
+{   
+	int		height;
+	int		width;
+	unsigned char	color_here;
+	
+	width = the_bitmap->width_;
+	height = the_bitmap->height_;
+
+//	color_here = Graphics_GetPixelAtXY(the_bitmap, x, y);
+	
+// 	DEBUG_OUT(("%s %d: x=%i, y=%i, the_color=%i, value-at-spot=%i", __func__, __LINE__, x, y, the_color, color_here));
+	
+    if ( 0 <= y && y < height && 0 <= x && x < width && Graphics_GetPixelAtXY(the_bitmap, x, y) != the_color )
+    {
+        Graphics_SetPixelAtXY(the_bitmap, x, y, the_color);
+        Graphics_Fill(the_bitmap, x-1, y, the_color);
+        Graphics_Fill(the_bitmap, x+1, y, the_color);
+        Graphics_Fill(the_bitmap, x, y-1, the_color);
+        Graphics_Fill(the_bitmap, x, y+1, the_color);
+    }
+//     else
+//     {
+// 		DEBUG_OUT(("%s %d: skipping x=%i, y=%i, the_color=%i, value-at-spot=%i", __func__, __LINE__, x, y, the_color, color_here));
+//     }
+    
+    
+    return true;
+}
+
+
+//! Draw a glyph's runs of pixels with its image's top left corner at x, y, clipped to the bitmap
+//! Used for both bitmap font glyphs and rasterized stroke font glyphs.
+//! @param	the_span: num_spans runs of pixels, in row order
+//! @param	width, height: size of the glyph image
+void Graphics_DrawSpans(Bitmap* the_bitmap, const FontSpan* the_span, signed int num_spans, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	signed int		left;
+	signed int		right;
+	signed int		top;
+	signed int		bottom;
+	signed int		span_left;
+	signed int		span_right;
+	signed int		i;
+
+	if (num_spans == 0)
+	{
+		return;
+	}
+
+	left = (x < 0) ? 0 : x;
+	top = (y < 0) ? 0 : y;
+	right = (x + width < the_bitmap->width_) ? x + width : the_bitmap->width_;
+	bottom = (y + height < the_bitmap->height_) ? y + height : the_bitmap->height_;
+
+	if (left >= right || top >= bottom)
+	{
+		return;
+	}
+
+	Bitmap_PrepareRectForWrite(the_bitmap, left, top, right - left, bottom - top);
+
+	// LOGIC:
+	//   glyphs entirely inside the bitmap (the usual case) are drawn with no clipping checks at all.
+	//   otherwise, each run is checked against the clip rectangle: runs are in row order, so rows below the bitmap end the glyph.
+
+	if (left == x && top == y && right == x + width && bottom == y + height)
+	{
+		for (i = num_spans; i > 0; i--, the_span++)
+		{
+			memset(the_bitmap->addr_ + (the_bitmap->width_ * (y + the_span->row_)) + x + the_span->x_, the_color, the_span->len_);
+		}
+
+		return;
+	}
+
+	for (i = num_spans; i > 0; i--, the_span++)
+	{
+		if (y + the_span->row_ < top)
+		{
+			continue;
+		}
+
+		if (y + the_span->row_ >= bottom)
+		{
+			break;
+		}
+
+		span_left = x + the_span->x_;
+		span_right = span_left + the_span->len_;
+		span_left = (span_left < left) ? left : span_left;
+		span_right = (span_right > right) ? right : span_right;
+
+		if (span_left < span_right)
+		{
+			memset(the_bitmap->addr_ + (the_bitmap->width_ * (y + the_span->row_)) + span_left, the_color, span_right - span_left);
+		}
+	}
+}
+
+
+//! Draw the first num_chars characters of a string in a font, with the top of the line at y
+//! The font's span cache must already be built.
+//! @return	returns the pen position after the last character
+signed int Graphics_DrawChars(Bitmap* the_bitmap, Font* the_font, signed int x, signed int y, const char* the_string, signed int num_chars, unsigned char the_color)
+{
+	const FontGlyph*	the_glyph;
+	unsigned char		the_char;
+	unsigned char		prev_char = 0;
+
+	for (; num_chars > 0; num_chars--)
+	{
+		the_char = (unsigned char)*the_string++;
+		the_glyph = Font_GetGlyph(the_font, the_char);
+
+		// most fonts have no kerning, so skip the search entirely for them
+		if (prev_char && the_font->num_kern_pairs_ > 0)
+		{
+			x += Font_GetKerning(the_font, prev_char, the_char);
+		}
+
+		prev_char = the_char;
+
+		// glyphs that can't reach the bitmap are only advanced past
+		if (x + the_glyph->offset_ < the_bitmap->width_ && x + the_glyph->offset_ + the_glyph->width_ > 0)
+		{
+			Graphics_DrawSpans(the_bitmap, &the_font->span_[the_glyph->first_span_], the_glyph->num_spans_, x + the_glyph->offset_, y, the_glyph->width_, the_font->height_, the_color);
+		}
+
+		x += the_glyph->advance_;
+	}
+
+	return x;
+}
+
+
+
+// **** Debug functions *****
+
+void Bitmap_Print(Bitmap* the_bitmap)
+{
+	DEBUG_OUT(("Bitmap print out:"));
+	DEBUG_OUT(("  address: %p",			the_bitmap));
+	DEBUG_OUT(("  width_: %i",			the_bitmap->width_));	
+	DEBUG_OUT(("  height_: %i",			the_bitmap->height_));	
+	DEBUG_OUT(("  x_: %i",				the_bitmap->x_));	
+	DEBUG_OUT(("  y_: %i",				the_bitmap->y_));	
+	DEBUG_OUT(("  color_: %u",			the_bitmap->color_));	
+	DEBUG_OUT(("  flags_: %u",			the_bitmap->flags_));	
+	DEBUG_OUT(("  font_: %p",			the_bitmap->font_));	
+	DEBUG_OUT(("  addr_: %p",			the_bitmap->addr_));
+	DEBUG_OUT(("  bands_pending_: %i",	the_bitmap->bands_pending_));
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a new bitmap object by allocating space for the bitmap struct in regular memory, and for the graphics, in VRAM
+//! @param	Font: optional font object to associate with the Bitmap. 
+Bitmap* Bitmap_New(signed int width, signed int height, Font* the_font)
+{
+	return Bitmap_NewWithFlags(width, height, the_font, BITMAP_FLAG_NONE);
+}
+
+
+//! Create a new bitmap object, with control over how the pixel memory is prepared
+//! Zeroing a large bitmap is slow, and is wasted work if the first thing you do is fill or blit over it. Pass BITMAP_FLAG_LAZY_CLEAR to defer clearing until a row band is actually read or partially drawn into, or BITMAP_FLAG_UNINITIALIZED to skip clearing entirely.
+//! Bitmaps that will only be drawn into and then blitted to a screen should be placed in standard RAM with BITMAP_FLAG_STANDARD_RAM, leaving VRAM for displayed content. If standard RAM can't be allocated, the bitmap falls back to VRAM: check with Bitmap_IsInVRAM() if it matters.
+//! @param	Font: optional font object to associate with the Bitmap. 
+//! @param	flags: BITMAP_FLAG_NONE, or any combination of BITMAP_FLAG_LAZY_CLEAR or BITMAP_FLAG_UNINITIALIZED, and BITMAP_FLAG_STANDARD_RAM
+Bitmap* Bitmap_NewWithFlags(signed int width, signed int height, Font* the_font, uint8_t flags)
+{
+	Bitmap*		the_bitmap;
+	int			the_mem_type;
+
+	DEBUG_OUT(("%s %d: start bitmap creation... (%i, %i, %p, %u)", __func__, __LINE__, width, height, the_font, flags));
+
+	if ( (width < BITMAP_MIN_WIDTH || width > BITMAP_MAX_WIDTH) || (height < BITMAP_MIN_HEIGHT || height > BITMAP_MAX_HEIGHT) )
+	{
+		LOG_ERR(("%s %d: Illegal width (%i) and/or height (%i)", __func__, __LINE__, width, height));
+		goto error;
+	}
+
+	DEBUG_OUT(("%s %d: allocating struct in normal memory...", __func__, __LINE__));
+	
+	// LOGIC:
+	//   we have 2 kinds of memory: VRAM and standard RAM
+	//   A bitmap object needs a struct which can and should be allocated in normal memory
+	//   It also needs the actual bytes for the bitmap, which must be allocated in VRAM
+	
+	// NOTE: MEM_STANDARD allocations are failing for some reason. until figure it out, allocate everything in VRAM.
+	//if ((the_bitmap = f_calloc(1, sizeof(Bitmap), MEM_STANDARD)) == NULL)
+	if ((the_bitmap = f_calloc(1, sizeof(Bitmap), MEM_VRAM)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for bitmap struc", __func__, __LINE__));
+		goto error;
+	}
+
+	flags &= BITMAP_CREATION_FLAGS;
+	
+	// LOGIC:
+	//   for lazy and uninitialized bitmaps, skip the zero-fill that f_calloc would do. 
+	//   lazy bitmaps start with every row band pending: the primitives clear each band the first time it is read or partially written.
+	//   band_valid_ is already all 0s, because the struct itself was calloc'd.
+	//   if standard RAM was requested but can't be had, fall back to VRAM rather than failing: the bitmap is still usable, just not optimally placed.
+	
+	the_mem_type = (flags & BITMAP_FLAG_STANDARD_RAM) ? MEM_STANDARD : MEM_VRAM;
+	
+	DEBUG_OUT(("%s %d: Allocating a %i x %i bitmap in %s...", __func__, __LINE__, width, height, (the_mem_type == MEM_VRAM) ? "VRAM" : "standard RAM"));
+
+	for (;;)
+	{
+		if (flags & (BITMAP_FLAG_LAZY_CLEAR | BITMAP_FLAG_UNINITIALIZED))
+		{
+			the_bitmap->addr_ = f_malloc(width * height, the_mem_type);
+		}
+		else
+		{
+			the_bitmap->addr_ = f_calloc(sizeof(uint8_t), width * height, the_mem_type);
+		}
+		
+		if (the_bitmap->addr_ != NULL || the_mem_type == MEM_VRAM)
+		{
+			break;
+		}
+		
+		LOG_WARN(("%s %d: Couldn't allocate bitmap in standard RAM; trying VRAM", __func__, __LINE__));
+		flags &= ~BITMAP_FLAG_STANDARD_RAM;
+		the_mem_type = MEM_VRAM;
+	}
+	
+	if (the_bitmap->addr_ == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't instantiate a bitmap", __func__, __LINE__));
+		goto error;
+	}
+
+	the_bitmap->width_ = width;
+	the_bitmap->height_ = height;
+	the_bitmap->flags_ = flags;
+	Bitmap_ClearDirtyRect(the_bitmap);
+	
+	if (flags & BITMAP_FLAG_LAZY_CLEAR)
+	{
+		the_bitmap->bands_pending_ = (height + BITMAP_BAND_HEIGHT - 1) / BITMAP_BAND_HEIGHT;
+	}
+	
+	DEBUG_OUT(("%s %d: Bitmap allocated! p=%p, addr=%p", __func__, __LINE__, the_bitmap, the_bitmap->addr_));
+
+	if (the_font)
+	{
+		if (Bitmap_SetCurrentFont(the_bitmap, the_font) == false)
+		{
+			LOG_ERR(("%s %d: Couldn't assign the font to the bitmap", __func__, __LINE__));
+			goto error;
+		}
+	}
+		
+	Bitmap_Print(the_bitmap);
+	
+	return the_bitmap;
+	
+error:
+	return NULL;
+}
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself
+boolean Bitmap_Destroy(Bitmap** the_bitmap)
+{
+	BitmapSnapshot*		the_snapshot;
+	
+	if (*the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed class object was null", __func__ , __LINE__));
+		return false;
+	}
+
+	// LOGIC: 
+	//   Bitmaps optionally have fonts associated with them.
+	//   We do not want to destroy these, because other objects could be using them.
+	//   TODO: notify the system that we are no longer using this font (system needs to be tallying usage count for that to work)
+	
+	if ((*the_bitmap)->font_)
+	{
+		(*the_bitmap)->font_ = NULL;
+	}
+
+	while ((*the_bitmap)->snapshot_)
+	{
+		the_snapshot = (*the_bitmap)->snapshot_;
+		Bitmap_DiscardSnapshot(&the_snapshot);
+	}
+
+	// LOGIC:
+	//   mapped bitmaps don't own an allocation: their pixels are part of the file mapping, which is released instead.
+	
+	if ((*the_bitmap)->flags_ & BITMAP_FLAG_MAPPED)
+	{
+		#if defined(__linux__)
+			munmap((*the_bitmap)->map_base_, (*the_bitmap)->map_len_);
+		#endif
+	}
+	else if ((*the_bitmap)->addr_)
+	{
+		f_free((*the_bitmap)->addr_, BITMAP_MEM_TYPE(*the_bitmap));
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_bitmap	%p	size	%i", __func__ , __LINE__, *the_bitmap, sizeof(Bitmap)));
 	f_free(*the_bitmap, MEM_STANDARD);
 	*the_bitmap = NULL;
 	
@@ -367,6 +1157,390 @@ boolean Bitmap_Destroy(Bitmap** the_bitmap)
 
 
 
+// **** Double buffer functions ****
+
+//! Create a pair of screen-sized bitmaps in VRAM, and point the screen's bitmap layer at the first of them
+//! Draw into the bitmap returned by DoubleBuffer_GetBackBitmap(), then call Graphics_Flip() to display it. While the double buffer exists, the_screen->bitmap_ is always the displayed (front) bitmap.
+//! The current contents of the screen's bitmap, if any, are copied into both buffers, so nothing visibly changes.
+//! @param	the_screen: the screen to double buffer. Its vicky_ register pointer can be a stand-in block of normal memory, for testing.
+//! @param	copy_dirty: PARAM_COPY_DIRTY if the app draws incrementally and the buffers must be kept in sync, PARAM_DO_NOT_COPY_DIRTY if the app redraws everything every frame.
+//! @return	returns NULL on any error
+DoubleBuffer* DoubleBuffer_New(Screen* the_screen, boolean copy_dirty)
+{
+	DoubleBuffer*	the_buffers;
+	uint8_t			the_flags;
+	int				i;
+	
+	if (the_screen == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen was NULL", __func__, __LINE__));
+		return NULL;
+	}
+	
+	if ((the_buffers = f_calloc(1, sizeof(DoubleBuffer), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for double buffer struct", __func__, __LINE__));
+		goto error;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_buffers	%p	size	%i", __func__ , __LINE__, the_buffers, sizeof(DoubleBuffer)));
+	
+	// LOGIC:
+	//   both buffers must be in VRAM, because the VICKY can only display VRAM.
+	//   dirty tracking is only needed if we will be copying dirty areas forward after each flip.
+	//   no point zeroing the buffers if we are about to copy the current screen into them.
+	
+	the_flags = (copy_dirty ? BITMAP_FLAG_TRACK_DIRTY : BITMAP_FLAG_NONE) | (the_screen->bitmap_ ? BITMAP_FLAG_UNINITIALIZED : BITMAP_FLAG_NONE);
+	
+	for (i = 0; i < 2; i++)
+	{
+		if ((the_buffers->bitmap_[i] = Bitmap_NewWithFlags(the_screen->width_, the_screen->height_, NULL, the_flags)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate screen buffer %i", __func__, __LINE__, i));
+			goto error;
+		}
+		
+		if (the_screen->bitmap_)
+		{
+			Graphics_BlitBitMap(the_screen->bitmap_, 0, 0, the_buffers->bitmap_[i], 0, 0, the_screen->width_, the_screen->height_);
+			Bitmap_ClearDirtyRect(the_buffers->bitmap_[i]);
+		}
+	}
+	
+	the_buffers->screen_ = the_screen;
+	the_buffers->copy_dirty_ = copy_dirty;
+	the_buffers->prev_bitmap_ = the_screen->bitmap_;
+	the_buffers->prev_vram_addr_ = R32(the_screen->vicky_ + BITMAP_L0_VRAM_ADDR_L);
+	
+	// display buffer 0, draw into buffer 1
+	R32(the_screen->vicky_ + BITMAP_L0_VRAM_ADDR_L) = (unsigned long)the_buffers->bitmap_[0]->addr_ - VRAM_BUFFER_A;
+	the_screen->bitmap_ = the_buffers->bitmap_[0];
+	the_buffers->back_ = 1;
+	
+	return the_buffers;
+	
+error:
+	if (the_buffers)
+	{
+		for (i = 0; i < 2; i++)
+		{
+			if (the_buffers->bitmap_[i])
+			{
+				Bitmap_Destroy(&the_buffers->bitmap_[i]);
+			}
+		}
+		
+		f_free(the_buffers, MEM_STANDARD);
+	}
+	
+	return NULL;
+}
+
+
+//! Destroy a double buffer, pointing the screen's bitmap layer back at the bitmap it was using before the double buffer was created
+//! frees the 2 buffer bitmaps and the object itself
+boolean DoubleBuffer_Destroy(DoubleBuffer** the_buffers)
+{
+	Screen*		the_screen;
+	
+	if (*the_buffers == NULL)
+	{
+		LOG_ERR(("%s %d: passed class object was null", __func__ , __LINE__));
+		return false;
+	}
+	
+	the_screen = (*the_buffers)->screen_;
+	R32(the_screen->vicky_ + BITMAP_L0_VRAM_ADDR_L) = (*the_buffers)->prev_vram_addr_;
+	the_screen->bitmap_ = (*the_buffers)->prev_bitmap_;
+	
+	Bitmap_Destroy(&(*the_buffers)->bitmap_[0]);
+	Bitmap_Destroy(&(*the_buffers)->bitmap_[1]);
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_buffers	%p	size	%i", __func__ , __LINE__, *the_buffers, sizeof(DoubleBuffer)));
+	f_free(*the_buffers, MEM_STANDARD);
+	*the_buffers = NULL;
+	
+	return true;
+}
+
+
+//! Get the bitmap that is currently not displayed, and which should be drawn into for the next frame
+//! @return	returns NULL on any error
+Bitmap* DoubleBuffer_GetBackBitmap(DoubleBuffer* the_buffers)
+{
+	if (the_buffers == NULL)
+	{
+		LOG_ERR(("%s %d: passed double buffer was NULL", __func__, __LINE__));
+		return NULL;
+	}
+	
+	return the_buffers->bitmap_[the_buffers->back_];
+}
+
+
+//! Display the back buffer by pointing the screen's bitmap layer at it. The old front buffer becomes the new back buffer.
+//! If the double buffer was created with PARAM_COPY_DIRTY, the area drawn in the frame just shown is then copied into the new back buffer, so both buffers match again.
+//! @param	wait_for_vblank: PARAM_WAIT_FOR_VBLANK to wait for the start of a new frame before switching (prevents tearing), or PARAM_DO_NOT_WAIT.
+//! @return	returns false on any error/invalid input.
+boolean Graphics_Flip(DoubleBuffer* the_buffers, boolean wait_for_vblank)
+{
+	Bitmap*		the_front;
+	Bitmap*		the_back;
+	Rectangle	the_dirty;
+	
+	if (the_buffers == NULL)
+	{
+		LOG_ERR(("%s %d: passed double buffer was NULL", __func__, __LINE__));
+		return false;
+	}
+	
+	the_front = the_buffers->bitmap_[the_buffers->back_];
+	the_back = the_buffers->bitmap_[the_buffers->back_ ^ 1];
+	
+	if (wait_for_vblank)
+	{
+		Graphics_WaitForVBlank();
+	}
+	
+	// LOGIC:
+	//   The VICKY knows the VRAM addr as a relative location to the place the VRAM exists in the system memory map
+	//   Rewriting the layer address is all it takes to change which bitmap is displayed: no pixels are copied.
+	
+	R32(the_buffers->screen_->vicky_ + BITMAP_L0_VRAM_ADDR_L) = (unsigned long)the_front->addr_ - VRAM_BUFFER_A;
+	the_buffers->screen_->bitmap_ = the_front;
+	the_buffers->back_ ^= 1;
+	
+	// LOGIC:
+	//   the new back buffer is missing whatever was drawn into the new front buffer during the last frame.
+	//   copy just that area forward so the app can keep drawing incrementally. 
+	//   the copy itself marks the back buffer dirty, so clear both dirty rects once it's done.
+	
+	if (the_buffers->copy_dirty_)
+	{
+		if (Bitmap_GetDirtyRect(the_front, &the_dirty))
+		{
+			Graphics_BlitBitMap(the_front, the_dirty.MinX, the_dirty.MinY, the_back, the_dirty.MinX, the_dirty.MinY, the_dirty.MaxX - the_dirty.MinX + 1, the_dirty.MaxY - the_dirty.MinY + 1);
+		}
+		
+		Bitmap_ClearDirtyRect(the_front);
+		Bitmap_ClearDirtyRect(the_back);
+	}
+	
+	return true;
+}
+
+
+
+
+// **** Snapshot functions ****
+
+//! Take a snapshot of the bitmap's current pixels, that can later be restored with Bitmap_Restore()
+//! No pixels are copied when the snapshot is taken. The bitmap is divided into BITMAP_SNAPSHOT_TILE_SIZE tiles, and each tile is only copied into the snapshot the first time a primitive writes to it. Tiles that don't change are shared with newer snapshots and with the bitmap itself, so a history of snapshots costs roughly the size of the areas edited, not a full bitmap per snapshot. 
+//! NOTE: writes done directly through memory obtained from Bitmap_GetMemLocForXY() bypass the snapshot. 
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return	returns NULL on any error. The snapshot is owned by the bitmap, and will be freed when the bitmap is destroyed.
+BitmapSnapshot* Bitmap_Snapshot(Bitmap* the_bitmap)
+{
+	BitmapSnapshot*		the_snapshot;
+	
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return NULL;
+	}
+	
+	if ((the_snapshot = f_calloc(1, sizeof(BitmapSnapshot), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for snapshot struct", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_snapshot	%p	size	%i", __func__ , __LINE__, the_snapshot, sizeof(BitmapSnapshot)));
+	
+	the_snapshot->tiles_across_ = (the_bitmap->width_ + BITMAP_SNAPSHOT_TILE_SIZE - 1) / BITMAP_SNAPSHOT_TILE_SIZE;
+	the_snapshot->tiles_down_ = (the_bitmap->height_ + BITMAP_SNAPSHOT_TILE_SIZE - 1) / BITMAP_SNAPSHOT_TILE_SIZE;
+	
+	if ((the_snapshot->tile_ = f_calloc(the_snapshot->tiles_across_ * the_snapshot->tiles_down_, sizeof(unsigned char*), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate snapshot tile table", __func__, __LINE__));
+		f_free(the_snapshot, MEM_STANDARD);
+		return NULL;
+	}
+	
+	// LOGIC:
+	//   a lazily-cleared band holds garbage until it is cleared. If the first write after the snapshot covered a whole band,
+	//   the band would only be marked valid, and the snapshot would save the garbage. Clear any pending bands now so that can't happen.
+	
+	Bitmap_PrepareRowsForRead(the_bitmap, 0, the_bitmap->height_);
+	
+	the_snapshot->bitmap_ = the_bitmap;
+	the_snapshot->older_ = the_bitmap->snapshot_;
+	
+	if (the_snapshot->older_)
+	{
+		the_snapshot->older_->newer_ = the_snapshot;
+	}
+	
+	the_bitmap->snapshot_ = the_snapshot;
+	
+	return the_snapshot;
+}
+
+
+//! Put the bitmap's pixels back the way they were when the snapshot was taken
+//! Any snapshots newer than the_snapshot are discarded. the_snapshot itself remains valid, and can be restored again.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_snapshot: a snapshot previously taken of this bitmap with Bitmap_Snapshot()
+//! @return	returns false on any error/invalid input, or if memory ran out while saving a tile for the_snapshot or a newer snapshot. In that case the bitmap is left unchanged.
+boolean Bitmap_Restore(Bitmap* the_bitmap, BitmapSnapshot* the_snapshot)
+{
+	BitmapSnapshot*		the_source;
+	BitmapSnapshot*		the_newer;
+	signed int			the_tile;
+	signed int			num_tiles;
+	
+	if (the_bitmap == NULL || the_snapshot == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or snapshot was NULL", __func__, __LINE__));
+		return false;
+	}
+	
+	if (the_snapshot->bitmap_ != the_bitmap)
+	{
+		LOG_ERR(("%s %d: snapshot %p does not belong to bitmap %p", __func__, __LINE__, the_snapshot, the_bitmap));
+		return false;
+	}
+	
+	// a tile that couldn't be saved by the_snapshot or any newer snapshot has lost the pixels the_snapshot needs
+	for (the_source = the_snapshot; the_source != NULL; the_source = the_source->newer_)
+	{
+		if (the_source->incomplete_)
+		{
+			LOG_ERR(("%s %d: snapshot %p is missing tiles, and can't be restored", __func__, __LINE__, the_source));
+			return false;
+		}
+	}
+	
+	// LOGIC:
+	//   each tile's pixels as of the_snapshot are in the first snapshot, going from the_snapshot towards the newest, that saved the tile.
+	//   if none of them saved it, the tile hasn't been written since the_snapshot, and the bitmap already has the right pixels.
+	//   detach the snapshots while copying, so the restore itself isn't saved as a write. It still needs to update the dirty rect.
+	
+	the_bitmap->snapshot_ = NULL;
+	num_tiles = the_snapshot->tiles_across_ * the_snapshot->tiles_down_;
+	
+	for (the_tile = 0; the_tile < num_tiles; the_tile++)
+	{
+		for (the_source = the_snapshot; the_source != NULL && the_source->tile_[the_tile] == NULL; the_source = the_source->newer_)
+		{
+		}
+		
+		if (the_source)
+		{
+			Bitmap_PrepareRectForWrite(the_bitmap, (the_tile % the_snapshot->tiles_across_) * BITMAP_SNAPSHOT_TILE_SIZE, (the_tile / the_snapshot->tiles_across_) * BITMAP_SNAPSHOT_TILE_SIZE, BITMAP_SNAPSHOT_TILE_SIZE, BITMAP_SNAPSHOT_TILE_SIZE);
+			Bitmap_CopyTile(the_bitmap, the_snapshot, the_tile, the_source->tile_[the_tile], true);
+		}
+	}
+
+	// the bitmap now matches the_snapshot exactly: nothing newer is needed, and none of the_snapshot's saved tiles are either
+	for (the_source = the_snapshot->newer_; the_source != NULL; the_source = the_newer)
+	{
+		the_newer = the_source->newer_;
+		
+		for (the_tile = 0; the_tile < num_tiles; the_tile++)
+		{
+			if (the_source->tile_[the_tile])
+			{
+				f_free(the_source->tile_[the_tile], MEM_STANDARD);
+			}
+		}
+		
+		f_free(the_source->tile_, MEM_STANDARD);
+		LOG_ALLOC(("%s %d:	__FREE__	the_source	%p	size	%i", __func__ , __LINE__, the_source, sizeof(BitmapSnapshot)));
+		f_free(the_source, MEM_STANDARD);
+	}
+	
+	for (the_tile = 0; the_tile < num_tiles; the_tile++)
+	{
+		if (the_snapshot->tile_[the_tile])
+		{
+			f_free(the_snapshot->tile_[the_tile], MEM_STANDARD);
+			the_snapshot->tile_[the_tile] = NULL;
+		}
+	}
+	
+	the_snapshot->newer_ = NULL;
+	the_bitmap->snapshot_ = the_snapshot;
+	
+	return true;
+}
+
+
+//! Discard a snapshot that is no longer needed, such as the oldest step of an undo history
+//! Any other snapshots of the bitmap remain valid and restorable.
+//! @param	the_snapshot: a snapshot previously taken with Bitmap_Snapshot(). Will be set to NULL.
+//! @return	returns false on any error/invalid input.
+boolean Bitmap_DiscardSnapshot(BitmapSnapshot** the_snapshot)
+{
+	BitmapSnapshot*		the_older;
+	signed int			the_tile;
+	signed int			num_tiles;
+	
+	if (the_snapshot == NULL || *the_snapshot == NULL)
+	{
+		LOG_ERR(("%s %d: passed class object was null", __func__ , __LINE__));
+		return false;
+	}
+	
+	// LOGIC:
+	//   an older snapshot that never saved a tile relies on newer snapshots (or the bitmap) to hold it. 
+	//   so any tile this snapshot saved, that the next older one didn't, is handed down to the older one instead of being freed.
+	
+	the_older = (*the_snapshot)->older_;
+	num_tiles = (*the_snapshot)->tiles_across_ * (*the_snapshot)->tiles_down_;
+	
+	for (the_tile = 0; the_tile < num_tiles; the_tile++)
+	{
+		if ((*the_snapshot)->tile_[the_tile] == NULL)
+		{
+			continue;
+		}
+		
+		if (the_older && the_older->tile_[the_tile] == NULL)
+		{
+			the_older->tile_[the_tile] = (*the_snapshot)->tile_[the_tile];
+		}
+		else
+		{
+			f_free((*the_snapshot)->tile_[the_tile], MEM_STANDARD);
+		}
+	}
+	
+	// unlink from the bitmap's list of snapshots. Tiles this snapshot failed to save are lost to the older one as well
+	if (the_older)
+	{
+		the_older->newer_ = (*the_snapshot)->newer_;
+		the_older->incomplete_ = the_older->incomplete_ || (*the_snapshot)->incomplete_;
+	}
+	
+	if ((*the_snapshot)->newer_)
+	{
+		(*the_snapshot)->newer_->older_ = the_older;
+	}
+	else
+	{
+		(*the_snapshot)->bitmap_->snapshot_ = the_older;
+	}
+	
+	f_free((*the_snapshot)->tile_, MEM_STANDARD);
+	LOG_ALLOC(("%s %d:	__FREE__	*the_snapshot	%p	size	%i", __func__ , __LINE__, *the_snapshot, sizeof(BitmapSnapshot)));
+	f_free(*the_snapshot, MEM_STANDARD);
+	*the_snapshot = NULL;
+	
+	return true;
+}
+
+
+
+
 // **** Block copy functions ****
 
 //! Blit from source bitmap to distination bitmap. 
@@ -380,68 +1554,132 @@ boolean Graphics_BlitBitMap(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm
 {
 	unsigned char*		the_read_loc;
 	unsigned char*		the_write_loc;
-	int					i;
+	boolean			via_vram;
 	
-	// TODO: move the 2 checks below to a private common function if other blit functions are added
-	
-	if (src_bm == NULL || dst_bm == NULL)
+	if (!Graphics_ValidateBlitBitmaps(src_bm, dst_bm))
 	{
-		LOG_ERR(("%s %d: passed source or destination bitmap was NULL", __func__, __LINE__));
 		return false;
 	}
 	
-	if (src_bm->addr_ == NULL || dst_bm->addr_ == NULL)
+	// LOGIC:
+	//   negative starting locations are allowed, as long as some part of the rectangle is in both bitmaps.
+	//   whatever sticks out of either bitmap is trimmed off both the source and destination rectangles.
+	
+	if (!Graphics_ClipBlit(src_bm, &src_x, &src_y, dst_bm, &dst_x, &dst_y, &width, &height))
 	{
-		LOG_ERR(("%s %d: passed source or destination bitmap had a NULL address", __func__, __LINE__));
+		LOG_INFO(("%s %d: No part of the rectangle was in both bitmaps. No copy performed.", __func__, __LINE__));
 		return false;
 	}
+
+	// checks complete. make sure any lazily-cleared bands are ready, then copy. 
+	Bitmap_PrepareRowsForRead(src_bm, src_y, height);
+	Bitmap_PrepareRectForWrite(dst_bm, dst_x, dst_y, width, height);
 	
-	// LOGIC:
-	//   check if any part of the desired rectangle is within visible space in the source.
-	//   We want to allow negative starting locations as long as height/width means some part of the rectange is actually in the bitmap. 
+	the_read_loc = src_bm->addr_ + (src_bm->width_ * src_y) + src_x;
+	the_write_loc = dst_bm->addr_ + (dst_bm->width_ * dst_y) + dst_x;
+	via_vram = !((src_bm->flags_ & dst_bm->flags_) & BITMAP_FLAG_STANDARD_RAM);
+	
+	Graphics_ProcessRows(the_write_loc, dst_bm->width_, the_read_loc, src_bm->width_, width, height, 0, via_vram);
+
+	return true;
+}
+
+
+//! Blit from source bitmap to destination bitmap, translating every pixel through a 256-entry table on the way
+//! Use for shaded, highlighted, greyed-out, or recolored copies of an image, without storing each variant as its own bitmap.
+//! The rectangle is clipped to both bitmaps. The source and destination can be the same bitmap, if the source and destination rectangles don't overlap.
+//! @param src_bm: the source bitmap. It must have a valid address.
+//! @param dst_bm: the destination bitmap. It must have a valid address. It can be the same bitmap as the source.
+//! @param src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to copy. May be negative.
+//! @param dst_x, dst_y: the location within the destination bitmap to copy pixels to. May be negative.
+//! @param width, height: the scope of the copy, in pixels.
+//! @param the_table: 256 LUT indexes. Each source pixel with value n is written to the destination as the_table[n].
+//! @return	returns false on any error, or if no part of the rectangle was within both bitmaps
+boolean Graphics_BlitBitMapRemapped(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm, int dst_x, int dst_y, int width, int height, const uint8_t* the_table)
+{
+	unsigned char*		the_read_loc;
+	unsigned char*		the_write_loc;
+	int					i;
 	
-	if (src_x + width < 0 || src_y + height < 0)
+	if (!Graphics_ValidateBlitBitmaps(src_bm, dst_bm))
 	{
-		LOG_INFO(("%s %d: No part of the copy-from rectangle was on screen. No copy performed. src_x=%i, src_y=%i, width=%i, height=%i.", __func__, __LINE__, src_x, src_y, width, height));
 		return false;
 	}
 	
-	// LOGIC:
-	//   check if any part of the desired rectangle is within visible space in the target.
-	//   We want to allow near-right-edge/bottom-edge starting locations as long as some part of the rectange is actually in the bitmap. 
-	
-	if (dst_x >= dst_bm->width_ || dst_y >= dst_bm->height_)
+	if (the_table == NULL)
 	{
-		LOG_INFO(("%s %d: No part of the copy-to rectangle was on screen. No copy performed. dst_x=%i, dst_y=%i, width=%i, height=%i.", __func__, __LINE__, dst_x, dst_y, width, height));
+		LOG_ERR(("%s %d: passed table was NULL", __func__, __LINE__));
 		return false;
 	}
-
-	// adjust copy width/height if the whole image wouldn't fit on target screen anyway
-	width = (dst_x + width >= dst_bm->width_) ? dst_bm->width_ - dst_x : width;
-	height = (dst_y + height >= dst_bm->height_) ? dst_bm->height_ - dst_y : height;
 	
-	// adjust copy width/height if the starting x,y are offscreen
-	if (src_x < 0)
+	if (!Graphics_ClipBlit(src_bm, &src_x, &src_y, dst_bm, &dst_x, &dst_y, &width, &height))
 	{
-		width -= src_x;
-		src_x = 0;
+		LOG_INFO(("%s %d: No part of the rectangle was in both bitmaps. No copy performed.", __func__, __LINE__));
+		return false;
 	}
-
-	if (src_y < 0)
+	
+	Bitmap_PrepareRowsForRead(src_bm, src_y, height);
+	Bitmap_PrepareRectForWrite(dst_bm, dst_x, dst_y, width, height);
+	
+	the_read_loc = src_bm->addr_ + (src_bm->width_ * src_y) + src_x;
+	the_write_loc = dst_bm->addr_ + (dst_bm->width_ * dst_y) + dst_x;
+	
+	for (i = 0; i < height; i++)
 	{
-		height -= src_y;
-		src_y = 0;
+		Graphics_RemapRow(the_write_loc, the_read_loc, width, the_table);
+		
+		the_write_loc += dst_bm->width_;
+		the_read_loc += src_bm->width_;
 	}
 
-	//DEBUG_OUT(("%s %d: final parameters: src_x=%i, src_y=%i, dst_x=%i, dst_y=%i, width=%i, height=%i.", __func__, __LINE__, src_x, src_y, dst_x, dst_y, width, height));
+	return true;
+}
 
-	// checks complete. ready to copy. 
+
+//! Blend a rectangle of the source bitmap over the destination bitmap, through a 256 x 256 blend table
+//! Use for translucent overlays, glass, and ghosted images. Blend tables for a palette and opacity can be built with Palette_GetBlendTable().
+//! The rectangle is clipped to both bitmaps. The source and destination can be the same bitmap, if the source and destination rectangles don't overlap.
+//! @param src_bm: the source bitmap. It must have a valid address.
+//! @param dst_bm: the destination bitmap. It must have a valid address. It can be the same bitmap as the source.
+//! @param src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to blend. May be negative.
+//! @param dst_x, dst_y: the location within the destination bitmap to blend pixels into. May be negative.
+//! @param width, height: the scope of the blend, in pixels.
+//! @param the_blend_table: 65536 LUT indexes. Each destination pixel d, under source pixel s, becomes the_blend_table[s * 256 + d].
+//! @return	returns false on any error, or if no part of the rectangle was within both bitmaps
+boolean Graphics_BlitBlended(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm, int dst_x, int dst_y, int width, int height, const uint8_t* the_blend_table)
+{
+	unsigned char*		the_read_loc;
+	unsigned char*		the_write_loc;
+	int					i;
+	
+	if (!Graphics_ValidateBlitBitmaps(src_bm, dst_bm))
+	{
+		return false;
+	}
+	
+	if (the_blend_table == NULL)
+	{
+		LOG_ERR(("%s %d: passed blend table was NULL", __func__, __LINE__));
+		return false;
+	}
+	
+	if (!Graphics_ClipBlit(src_bm, &src_x, &src_y, dst_bm, &dst_x, &dst_y, &width, &height))
+	{
+		LOG_INFO(("%s %d: No part of the rectangle was in both bitmaps. No blend performed.", __func__, __LINE__));
+		return false;
+	}
+	
+	// destination pixels are read as well as written
+	Bitmap_PrepareRowsForRead(src_bm, src_y, height);
+	Bitmap_PrepareRowsForRead(dst_bm, dst_y, height);
+	Bitmap_PrepareRectForWrite(dst_bm, dst_x, dst_y, width, height);
+	
 	the_read_loc = src_bm->addr_ + (src_bm->width_ * src_y) + src_x;
 	the_write_loc = dst_bm->addr_ + (dst_bm->width_ * dst_y) + dst_x;
 	
 	for (i = 0; i < height; i++)
 	{
-		memcpy(the_write_loc, the_read_loc, width);
+		Graphics_BlendRow(the_write_loc, the_read_loc, width, the_blend_table);
 		
 		the_write_loc += dst_bm->width_;
 		the_read_loc += src_bm->width_;
@@ -451,74 +1689,344 @@ boolean Graphics_BlitBitMap(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm
 }
 
 
-// **** Block fill functions ****
+// **** Block fill functions ****
+
+
+// Fill graphics memory with specified value
+// calling function must validate the screen ID before passing!
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean Graphics_FillMemory(Bitmap* the_bitmap, unsigned char the_color)
+{
+	unsigned char*	the_write_loc;
+	
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	the_write_loc = Graphics_GetMemLocForXY(the_bitmap, 0, 0);
+
+	Bitmap_PrepareRectForWrite(the_bitmap, 0, 0, the_bitmap->width_, the_bitmap->height_);
+
+	Graphics_ProcessRows(the_write_loc, the_bitmap->width_, NULL, 0, the_bitmap->width_, the_bitmap->height_, the_color, false);
+
+	return true;
+}
+
+
+//! Fill pixel values for the passed Rectangle object, using the specified LUT value
+//! @param	the_coords: the rectangle to fill. MaxX and MaxY are inclusive.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean Graphics_FillBoxRect(Bitmap* the_bitmap, Rectangle* the_coords, unsigned char the_color)
+{
+	if (the_coords == NULL)
+	{
+		LOG_ERR(("%s %d: passed rectangle was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return Graphics_FillBox(the_bitmap, the_coords->MinX, the_coords->MinY, the_coords->MaxX - the_coords->MinX + 1, the_coords->MaxY - the_coords->MinY + 1, the_color);
+}
+
+
+//! Fill pixel values for a specific box area
+//! calling function must validate screen id, coords!
+//! @param	width: width, in pixels, of the rectangle to be filled
+//! @param	height: height, in pixels, of the rectangle to be filled. Exactly this many rows are filled.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean Graphics_FillBox(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	unsigned char*	the_write_loc;
+
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	//DEBUG_OUT(("%s %d: x=%i, y=%i, width=%i, height=%i, the_color=%i, the_bitmap=%p", __func__, __LINE__, x, y, width, height, the_color, the_bitmap));
+	
+	// set up initial loc
+	the_write_loc = Graphics_GetMemLocForXY(the_bitmap, x, y);
+	
+	Bitmap_PrepareRectForWrite(the_bitmap, x, y, width, height);
+	
+	Graphics_ProcessRows(the_write_loc, the_bitmap->width_, NULL, 0, width, height, the_color, false);
+			
+	return true;
+}
+
+
+
+#if defined(__linux__)
+
+	// **** Worker pool functions ****
+
+	//! Create a pool of threads to split work between (host builds only)
+	//! @param	num_workers: number of threads each job runs on, counting the thread that starts it. 0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS.
+	//! @return	returns NULL on any error. If fewer threads could be started than asked for, the pool uses the ones that did start.
+	WorkerPool* WorkerPool_New(signed int num_workers)
+	{
+		WorkerPool*		the_pool;
+		signed int		i;
+
+		if (num_workers < 0 || num_workers > GRAPHICS_MAX_WORKERS)
+		{
+			LOG_ERR(("%s %d: invalid number of workers (%i)", __func__, __LINE__, num_workers));
+			return NULL;
+		}
+
+		if (num_workers == 0)
+		{
+			num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+			num_workers = (num_workers < 1) ? 1 : (num_workers > GRAPHICS_MAX_WORKERS) ? GRAPHICS_MAX_WORKERS : num_workers;
+		}
+
+		if ((the_pool = f_calloc(1, sizeof(WorkerPool), MEM_STANDARD)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for worker pool", __func__, __LINE__));
+			return NULL;
+		}
+		LOG_ALLOC(("%s %d:	__ALLOC__	the_pool	%p	size	%i", __func__ , __LINE__, the_pool, sizeof(WorkerPool)));
+
+		pthread_mutex_init(&the_pool->run_lock_, NULL);
+		pthread_mutex_init(&the_pool->lock_, NULL);
+		pthread_cond_init(&the_pool->start_cond_, NULL);
+		pthread_cond_init(&the_pool->done_cond_, NULL);
+		the_pool->num_workers_ = 1;
+
+		// LOGIC:
+		//   job_ is 0 from the calloc, and stays 0 until the first WorkerPool_Run(), which can only come after this returns.
+		//   every worker starts out waiting for it to move on from 0, so none can miss the first job, however late it starts.
+
+		for (i = 1; i < num_workers; i++)
+		{
+			if (pthread_create(&the_pool->thread_[i - 1], NULL, WorkerPool_Worker, the_pool) != 0)
+			{
+				LOG_ERR(("%s %d: Couldn't start worker thread %i of %i", __func__, __LINE__, i, num_workers - 1));
+				break;
+			}
+
+			the_pool->num_workers_++;
+		}
+
+		return the_pool;
+	}
+
+
+	// destructor
+	// stops the pool's threads, and frees the object. Must not be called while a job is running.
+	boolean WorkerPool_Destroy(WorkerPool** the_pool)
+	{
+		signed int		i;
+
+		if (the_pool == NULL || *the_pool == NULL)
+		{
+			LOG_ERR(("%s %d: passed worker pool was NULL", __func__, __LINE__));
+			return false;
+		}
+
+		pthread_mutex_lock(&(*the_pool)->lock_);
+		(*the_pool)->quit_ = true;
+		pthread_cond_broadcast(&(*the_pool)->start_cond_);
+		pthread_mutex_unlock(&(*the_pool)->lock_);
+
+		for (i = 0; i < (*the_pool)->num_workers_ - 1; i++)
+		{
+			pthread_join((*the_pool)->thread_[i], NULL);
+		}
+
+		pthread_cond_destroy(&(*the_pool)->done_cond_);
+		pthread_cond_destroy(&(*the_pool)->start_cond_);
+		pthread_mutex_destroy(&(*the_pool)->lock_);
+		pthread_mutex_destroy(&(*the_pool)->run_lock_);
+
+		LOG_ALLOC(("%s %d:	__FREE__	*the_pool	%p	size	%i", __func__ , __LINE__, *the_pool, sizeof(WorkerPool)));
+		f_free(*the_pool, MEM_STANDARD);
+		*the_pool = NULL;
+
+		return true;
+	}
+
+
+	//! Run a job on every thread in a pool, including the calling thread, and wait for every thread to finish it
+	//! @param	the_job: called once on each thread, with the_arg. It must divide the work up itself.
+	//! @return	returns false, without running anything, if another thread's job is running in the pool.
+	boolean WorkerPool_Run(WorkerPool* the_pool, void (*the_job)(void* the_arg), void* the_arg)
+	{
+		if (the_pool == NULL || the_job == NULL)
+		{
+			LOG_ERR(("%s %d: passed worker pool or job was NULL", __func__, __LINE__));
+			return false;
+		}
+
+		if (pthread_mutex_trylock(&the_pool->run_lock_) != 0)
+		{
+			return false;
+		}
+
+		// LOGIC:
+		//   the workers are woken by bumping the job number. the lock taken to start and to finish each job
+		//   also makes everything the workers wrote visible to the caller afterwards.
+
+		pthread_mutex_lock(&the_pool->lock_);
+		the_pool->job_function_ = the_job;
+		the_pool->job_arg_ = the_arg;
+		the_pool->num_busy_ = the_pool->num_workers_ - 1;
+		the_pool->job_++;
+		pthread_cond_broadcast(&the_pool->start_cond_);
+		pthread_mutex_unlock(&the_pool->lock_);
+
+		(*the_job)(the_arg);
+
+		pthread_mutex_lock(&the_pool->lock_);
+
+		while (the_pool->num_busy_ > 0)
+		{
+			pthread_cond_wait(&the_pool->done_cond_, &the_pool->lock_);
+		}
+
+		pthread_mutex_unlock(&the_pool->lock_);
+		pthread_mutex_unlock(&the_pool->run_lock_);
+
+		return true;
+	}
+
+
+	//! Split large fills and blits between several threads (host builds only)
+	//! Once set, Graphics_FillMemory, Graphics_FillBox, and Graphics_BlitBitMap split any block of GRAPHICS_PARALLEL_MIN_BYTES or more pixels into slices of rows, one per thread.
+	//! Each call still returns only when every row is done. Blits within one bitmap whose source and destination overlap are never split.
+	//! Don't call this while another thread is drawing.
+	//! @param	num_workers: number of threads, counting the thread making each drawing call. 1 turns splitting off (the default). 0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS.
+	//! @return	returns false on any error/invalid input. If fewer threads could be started than asked for, the ones that did start are used.
+	boolean Graphics_SetWorkerThreads(signed int num_workers)
+	{
+		if (num_workers < 0 || num_workers > GRAPHICS_MAX_WORKERS)
+		{
+			LOG_ERR(("%s %d: invalid number of workers (%i)", __func__, __LINE__, num_workers));
+			return false;
+		}
+
+		if (global_worker_pool != NULL)
+		{
+			WorkerPool_Destroy(&global_worker_pool);
+		}
+
+		if (num_workers == 1)
+		{
+			return true;
+		}
+
+		if ((global_worker_pool = WorkerPool_New(num_workers)) == NULL)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+#endif
+
+
+// **** Remap and blend functions ****
+
+//! Translate every pixel in the passed Rectangle object through a 256-entry table
+//! @param	the_coords: the rectangle to remap. MaxX and MaxY are inclusive. Clipped to the bitmap.
+//! @param	the_table: 256 LUT indexes. Each pixel with value n is replaced with the_table[n].
+//! @return	returns false on any error/invalid input.
+boolean Graphics_RemapRect(Bitmap* the_bitmap, Rectangle* the_coords, const uint8_t* the_table)
+{
+	if (the_coords == NULL)
+	{
+		LOG_ERR(("%s %d: passed rectangle was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return Graphics_RemapBox(the_bitmap, the_coords->MinX, the_coords->MinY, the_coords->MaxX - the_coords->MinX + 1, the_coords->MaxY - the_coords->MinY + 1, the_table);
+}
 
 
-// Fill graphics memory with specified value
-// calling function must validate the screen ID before passing!
-//! @param	the_color: a 1-byte index to the current LUT
+//! Translate every pixel in a specific box area through a 256-entry table
+//! Use for shading, highlighting, or greying out part of a bitmap in place, or recoloring it.
+//! @param	width: width, in pixels, of the rectangle to remap
+//! @param	height: height, in pixels, of the rectangle to remap
+//! @param	the_table: 256 LUT indexes. Each pixel with value n is replaced with the_table[n].
 //! @return	returns false on any error/invalid input.
-boolean Graphics_FillMemory(Bitmap* the_bitmap, unsigned char the_color)
+boolean Graphics_RemapBox(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, const uint8_t* the_table)
 {
-	unsigned char*	the_write_loc;
-	unsigned long	the_write_len;
-	
-	if (the_bitmap == NULL)
+	unsigned char*	the_loc;
+	signed int		dst_x = x;
+	signed int		dst_y = y;
+	signed int		i;
+
+	if (the_bitmap == NULL || the_table == NULL)
 	{
-		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		LOG_ERR(("%s %d: passed bitmap or table was NULL", __func__, __LINE__));
 		return false;
 	}
 
-	the_write_loc = Graphics_GetMemLocForXY(the_bitmap, 0, 0);
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
 
-	the_write_len = the_bitmap->width_ * the_bitmap->height_;
-	
-	memset(the_write_loc, the_color, the_write_len);
+	// clip to the bitmap: remapping works in place, so it is a blit with the same bitmap and rectangle on both sides
+	if (!Graphics_ClipBlit(the_bitmap, &x, &y, the_bitmap, &dst_x, &dst_y, &width, &height))
+	{
+		return true;
+	}
 
-	return true;
-}
+	// pixels are read before they are written, so lazily-cleared bands must be cleared first
+	Bitmap_PrepareRowsForRead(the_bitmap, y, height);
+	Bitmap_PrepareRectForWrite(the_bitmap, x, y, width, height);
 
+	the_loc = the_bitmap->addr_ + (the_bitmap->width_ * y) + x;
 
-//! Fill pixel values for the passed Rectangle object, using the specified LUT value
-//! @param	the_color: a 1-byte index to the current LUT
-//! @return	returns false on any error/invalid input.
-boolean Graphics_FillBoxRect(Bitmap* the_bitmap, Rectangle* the_coords, unsigned char the_color)
-{
-	return Graphics_FillBox(the_bitmap, the_coords->MinX, the_coords->MinY, the_coords->MaxX - the_coords->MinX, the_coords->MaxY - the_coords->MinY, the_color);
+	for (i = 0; i < height; i++)
+	{
+		Graphics_RemapRow(the_loc, the_loc, width, the_table);
+		the_loc += the_bitmap->width_;
+	}
+
+	return true;
 }
 
 
-//! Fill pixel values for a specific box area
-//! calling function must validate screen id, coords!
-//! @param	width: width, in pixels, of the rectangle to be filled
-//! @param	height: height, in pixels, of the rectangle to be filled
-//! @param	the_color: a 1-byte index to the current LUT
+//! Blend a single color over a specific box area, through a 256 x 256 blend table
+//! Use for drop shadows, dimmed backgrounds behind dialogs, and selection highlights. Blend tables for a palette and opacity can be built with Palette_GetBlendTable().
+//! The box is clipped to the bitmap.
+//! @param	width: width, in pixels, of the rectangle to blend
+//! @param	height: height, in pixels, of the rectangle to blend
+//! @param	the_color: a 1-byte index to the current LUT: the color to blend over the box
+//! @param	the_blend_table: 65536 LUT indexes. Each pixel d becomes the_blend_table[the_color * 256 + d].
 //! @return	returns false on any error/invalid input.
-boolean Graphics_FillBox(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+boolean Graphics_FillBoxBlended(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, const uint8_t* the_blend_table)
 {
-	unsigned char*	the_write_loc;
-	signed int		max_row;
-
-	if (the_bitmap == NULL)
+	if (the_blend_table == NULL)
 	{
-		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		LOG_ERR(("%s %d: passed blend table was NULL", __func__, __LINE__));
 		return false;
 	}
 
-	//DEBUG_OUT(("%s %d: x=%i, y=%i, width=%i, height=%i, the_color=%i, the_bitmap=%p", __func__, __LINE__, x, y, width, height, the_color, the_bitmap));
-	
-	// set up initial loc
-	the_write_loc = Graphics_GetMemLocForXY(the_bitmap, x, y);
-	
-	max_row = y + height;
-	
-	for (; y <= max_row; y++)
-	{
-		memset(the_write_loc, the_color, width);
-		the_write_loc += the_bitmap->width_;
-	}
-			
-	return true;
+	// with the source color fixed, the blend table's row for that color is a plain remap table
+	return Graphics_RemapBox(the_bitmap, x, y, width, height, &the_blend_table[the_color << 8]);
 }
 
 
@@ -601,6 +2109,75 @@ boolean Bitmap_SetCurrentXY(Bitmap* the_bitmap, signed int x, signed int y)
 }
 
 
+//! Report whether the bitmap's pixel memory is in VRAM (and can therefore be displayed), or in standard RAM
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return Returns true if the pixels are in VRAM, false if they are in standard RAM or on any error
+boolean Bitmap_IsInVRAM(Bitmap* the_bitmap)
+{
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return !(the_bitmap->flags_ & BITMAP_FLAG_STANDARD_RAM);
+}
+
+
+//! Get the bounding rectangle of everything drawn into the bitmap since the dirty rect was last cleared
+//! Only available for bitmaps created with BITMAP_FLAG_TRACK_DIRTY. Drawing done directly through memory obtained from Bitmap_GetMemLocForXY() is not tracked.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_rect: a Rectangle to be filled with the dirty area, in inclusive coordinates.
+//! @return Returns false if nothing has been drawn, or on any error condition
+boolean Bitmap_GetDirtyRect(Bitmap* the_bitmap, Rectangle* the_rect)
+{
+	if (the_bitmap == NULL || the_rect == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or rect was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!(the_bitmap->flags_ & BITMAP_FLAG_TRACK_DIRTY))
+	{
+		LOG_ERR(("%s %d: bitmap is not tracking a dirty rect", __func__, __LINE__));
+		return false;
+	}
+	
+	if (the_bitmap->dirty_.MinX > the_bitmap->dirty_.MaxX)
+	{
+		return false;
+	}
+	
+	*the_rect = the_bitmap->dirty_;
+	
+	// writes aren't clipped horizontally, so keep the result within the bitmap
+	the_rect->MinX = (the_rect->MinX < 0) ? 0 : the_rect->MinX;
+	the_rect->MaxX = (the_rect->MaxX >= the_bitmap->width_) ? the_bitmap->width_ - 1 : the_rect->MaxX;
+	
+	return true;
+}
+
+
+//! Mark the entire bitmap as clean
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return Returns false on any error condition
+boolean Bitmap_ClearDirtyRect(Bitmap* the_bitmap)
+{
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	the_bitmap->dirty_.MinX = the_bitmap->width_;
+	the_bitmap->dirty_.MinY = the_bitmap->height_;
+	the_bitmap->dirty_.MaxX = -1;
+	the_bitmap->dirty_.MaxY = -1;
+	
+	return true;
+}
+
+
 //! Get the current color of the pen
 //! @param	the_bitmap: reference to a valid Bitmap object.
 //! @return Returns a 1-byte index to the current LUT, or 0 on any error
@@ -675,6 +2252,47 @@ unsigned char* Bitmap_GetMemLocForXY(Bitmap* the_bitmap, signed int x, signed in
 		return NULL;
 	}
 	
+	Bitmap_PrepareRowsForRead(the_bitmap, y, 1);
+	
+	return the_bitmap->addr_ + (the_bitmap->width_ * y) + x;
+}
+
+
+//! Calculate the memory location of the specified coordinate within the bitmap, and prepare a rectangle starting there to be written to directly
+//! Use this instead of Bitmap_GetMemLocForXY() when filling a block of rows by hand, so that lazy clearing, dirty rect tracking, and snapshots see the write.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	x: the horizontal position, between 0 and bitmap width - 1
+//! @param	y: the vertical position, between 0 and bitmap height - 1
+//! @param	width, height: size of the rectangle that will be written to. Must fit within the bitmap.
+//! @return Returns a pointer to the memory location that corresponds to the passed X, Y, or NULL on any error condition, including if the bitmap is read-only
+unsigned char* Bitmap_GetMemLocForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height)
+{
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return NULL;
+	}
+	
+	if (the_bitmap->addr_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap had a NULL address", __func__, __LINE__));
+		return NULL;
+	}
+	
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return NULL;
+	}
+	
+	if (x < 0 || y < 0 || width < 1 || height < 1 || x + width > the_bitmap->width_ || y + height > the_bitmap->height_)
+	{
+		LOG_ERR(("%s %d: invalid rectangle passed (%i, %i, %i, %i)", __func__, __LINE__, x, y, width, height));
+		return NULL;
+	}
+	
+	Bitmap_PrepareRectForWrite(the_bitmap, x, y, width, height);
+	
 	return the_bitmap->addr_ + (the_bitmap->width_ * y) + x;
 }
 
@@ -708,12 +2326,20 @@ boolean Graphics_SetPixelAtXY(Bitmap* the_bitmap, signed int x, signed int y, un
 		return false;
 	}
 
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
 	if (!Graphics_ValidateXY(the_bitmap, x, y))
 	{
 		LOG_ERR(("%s %d: illegal coordinate", __func__, __LINE__));
 		return false;
 	}
 	
+	Bitmap_PrepareRectForWrite(the_bitmap, x, y, 1, 1);
+	
 	the_write_loc = Graphics_GetMemLocForXY(the_bitmap, x, y);	
  	*the_write_loc = the_color;
 	
@@ -745,6 +2371,8 @@ unsigned char Graphics_GetPixelAtXY(Bitmap* the_bitmap, signed int x, signed int
 		return false;
 	}
 	
+	Bitmap_PrepareRowsForRead(the_bitmap, y, 1);
+	
 	the_read_loc = Graphics_GetMemLocForXY(the_bitmap, x, y);	
  	the_color = (unsigned char)*the_read_loc;
 	
@@ -841,7 +2469,7 @@ boolean Graphics_DrawHLine(Bitmap* the_bitmap, signed int x, signed int y, signe
 		return false;
 	}
 
-	result = Graphics_FillBox(the_bitmap, x, y, the_line_len, 0, the_color);
+	result = Graphics_FillBox(the_bitmap, x, y, the_line_len, 1, the_color);
 
 	return result;
 }
@@ -878,6 +2506,7 @@ boolean Graphics_DrawVLine(Bitmap* the_bitmap, signed int x, signed int y, signe
 
 
 //! Draws a rectangle based on the passed Rectangle object, using the specified LUT value
+//! @param	the_coords: the rectangle to outline. MaxX and MaxY are inclusive: the outline is drawn on them.
 //! @param	the_color: a 1-byte index to the current LUT
 //! @return	returns false on any error/invalid input.
 boolean Graphics_DrawBoxRect(Bitmap* the_bitmap, Rectangle* the_coords, unsigned char the_color)
@@ -987,7 +2616,7 @@ boolean Graphics_DrawBox(Bitmap* the_bitmap, signed int x, signed int y, signed
 	
 	if (do_fill)
 	{
-		if (!Graphics_FillBox(the_bitmap, x, y, width, height - 1, the_color))
+		if (!Graphics_FillBox(the_bitmap, x, y, width, height, the_color))
 		{
 			LOG_ERR(("%s %d: draw filled box failed", __func__, __LINE__));
 			return false;
@@ -1100,9 +2729,9 @@ boolean Graphics_DrawRoundBox(Bitmap* the_bitmap, signed int x, signed int y, si
 	// fill with same color as outline, if specified
 	if (do_fill)
 	{
-		Graphics_FillBox(the_bitmap, x + radius, y + 1, width - radius*2, radius, the_color);
-		Graphics_FillBox(the_bitmap, x + 1, y + radius, width - 1, height-radius*2, the_color);
-		Graphics_FillBox(the_bitmap, x + radius, y + height-radius*1, width - radius*2, radius-1, the_color);
+		Graphics_FillBox(the_bitmap, x + radius, y + 1, width - radius*2, radius + 1, the_color);
+		Graphics_FillBox(the_bitmap, x + 1, y + radius, width - 1, height-radius*2 + 1, the_color);
+		Graphics_FillBox(the_bitmap, x + radius, y + height-radius*1, width - radius*2, radius, the_color);
 		Graphics_Fill(the_bitmap, x + radius - 1, y + 1, the_color);
 		Graphics_Fill(the_bitmap, x + (width - radius) + 1, y + 1, the_color);
 		Graphics_Fill(the_bitmap, x + radius - 1, y + (height - radius) + 1, the_color);
@@ -1135,5 +2764,224 @@ boolean Graphics_DrawCircle(Bitmap* the_bitmap, signed int x1, signed int y1, si
 
 // **** Draw string functions *****
 
+//! Draw a string in the bitmap's current font and pen color
+//! The string is drawn with the top of the line of text at y: the baseline is font ascent rows below it. Text is clipped to the bitmap.
+//! Characters the font has no glyph for are drawn as its missing character. Afterwards, the pen is left at the end of the string, so more text can carry on from there.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	x, y: where the top left corner of the line of text should go. Can be negative, or partly outside the bitmap.
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawString(Bitmap* the_bitmap, signed int x, signed int y, const char* the_string)
+{
+	if (the_bitmap == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or string was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->font_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap has no font", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	if (!Font_BuildSpanCache(the_bitmap->font_))
+	{
+		return false;
+	}
+
+	the_bitmap->x_ = Graphics_DrawChars(the_bitmap, the_bitmap->font_, x, y, the_string, strlen(the_string), the_bitmap->color_);
+	the_bitmap->y_ = y;
+
+	return true;
+}
+
+
+//! Draw a string in the bitmap's current font and pen color, at the pen position
+//! The pen is the top left corner of the line of text. Afterwards, it is left at the end of the string.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStringAtPen(Bitmap* the_bitmap, const char* the_string)
+{
+	if (the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return Graphics_DrawString(the_bitmap, the_bitmap->x_, the_bitmap->y_, the_string);
+}
+
+
+//! Measure how wide a string would be, drawn in the bitmap's current font
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_string: the text to measure
+//! @return	returns the width of the string in pixels, or -1 on any error
+signed int Graphics_MeasureString(Bitmap* the_bitmap, const char* the_string)
+{
+	if (the_bitmap == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or string was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	if (the_bitmap->font_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap has no font", __func__, __LINE__));
+		return -1;
+	}
+
+	return Font_MeasureString(the_bitmap->font_, the_string, strlen(the_string));
+}
+
+
+//! Draw a text layout in the bitmap's pen color, with the top left corner of its rectangle at x, y
+//! The layout's lines were worked out when it was created or last updated, so nothing is measured here. Text is clipped to the bitmap, not the rectangle.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_layout: the text layout to draw. It is drawn in its own font, not the bitmap's.
+//! @param	x, y: where the top left corner of the layout's rectangle should go
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawLayout(Bitmap* the_bitmap, TextLayout* the_layout, signed int x, signed int y)
+{
+	TextLine*	the_line;
+	signed int	line_x;
+	signed int	i;
+
+	if (the_bitmap == NULL || the_layout == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or layout was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	if (!Font_BuildSpanCache(the_layout->font_))
+	{
+		return false;
+	}
+
+	for (i = 0, the_line = the_layout->line_; i < the_layout->num_lines_; i++, the_line++)
+	{
+		if (the_layout->align_ == FONT_ALIGN_CENTER)
+		{
+			line_x = x + (the_layout->width_ - the_line->width_) / 2;
+		}
+		else if (the_layout->align_ == FONT_ALIGN_RIGHT)
+		{
+			line_x = x + the_layout->width_ - the_line->width_;
+		}
+		else
+		{
+			line_x = x;
+		}
+
+		line_x = Graphics_DrawChars(the_bitmap, the_layout->font_, line_x, y, &the_layout->string_[the_line->start_], the_line->num_chars_, the_bitmap->color_);
+
+		if (the_line->ellipsis_)
+		{
+			Graphics_DrawChars(the_bitmap, the_layout->font_, line_x, y, FONT_ELLIPSIS, FONT_ELLIPSIS_LEN, the_bitmap->color_);
+		}
+
+		y += the_layout->font_->height_ + the_layout->font_->leading_;
+	}
+
+	return true;
+}
+
+
+//! Draw a string in the bitmap's current font and pen color, wrapped and fitted to a rectangle
+//! For text drawn more than once, create a text layout with TextLayout_New() and draw it with Graphics_DrawLayout() instead: this works the lines out every time.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_rect: the rectangle to fit the text to. MaxX and MaxY are included in the rectangle.
+//! @param	the_string: the text to draw
+//! @param	the_align: a font_align value
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStringInRect(Bitmap* the_bitmap, Rectangle* the_rect, const char* the_string, uint8_t the_align)
+{
+	TextLayout*	the_layout;
+	boolean		the_result;
+
+	if (the_bitmap == NULL || the_rect == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap or rectangle was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->font_ == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap has no font", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_layout = TextLayout_New(the_bitmap->font_, the_string, the_rect->MaxX - the_rect->MinX + 1, the_rect->MaxY - the_rect->MinY + 1, the_align, PARAM_WRAP)) == NULL)
+	{
+		return false;
+	}
+
+	the_result = Graphics_DrawLayout(the_bitmap, the_layout, the_rect->MinX, the_rect->MinY);
+	TextLayout_Destroy(&the_layout);
+
+	return the_result;
+}
+
+
+//! Draw a string in a stroke font, at any size, in the bitmap's pen color
+//! The string is drawn with the top of the line of text at y. Text is clipped to the bitmap. Afterwards, the pen is left at the end of the string.
+//! Glyphs are rasterized the first time they are drawn at a size, and drawn from the font's cache after that.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_font: the stroke font to draw in. The bitmap's own font is not used or changed.
+//! @param	the_size: height of the line of text, in pixels, from 1 to STROKE_FONT_MAX_SIZE
+//! @param	x, y: where the top left corner of the line of text should go. Can be negative, or partly outside the bitmap.
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStrokeString(Bitmap* the_bitmap, StrokeFont* the_font, signed int the_size, signed int x, signed int y, const char* the_string)
+{
+	const StrokeGlyph*	the_glyph;
+
+	if (the_bitmap == NULL || the_font == NULL || the_string == NULL)
+	{
+		LOG_ERR(("%s %d: passed bitmap, stroke font, or string was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_bitmap->flags_ & BITMAP_FLAG_READ_ONLY)
+	{
+		LOG_ERR(("%s %d: passed bitmap is read-only", __func__, __LINE__));
+		return false;
+	}
+
+	// LOGIC:
+	//   each glyph is drawn as soon as it is looked up: looking up the next one can throw it out of the cache.
+
+	for (; *the_string; the_string++)
+	{
+		if ((the_glyph = StrokeFont_GetGlyph(the_font, (unsigned char)*the_string, the_size)) == NULL)
+		{
+			return false;
+		}
+
+		// glyphs that can't reach the bitmap are only advanced past
+		if (x + the_glyph->x_ < the_bitmap->width_ && x + the_glyph->x_ + the_glyph->width_ > 0)
+		{
+			Graphics_DrawSpans(the_bitmap, the_glyph->span_, the_glyph->num_spans_, x + the_glyph->x_, y + the_glyph->y_, the_glyph->width_, the_glyph->height_, the_bitmap->color_);
+		}
+
+		x += the_glyph->advance_;
+	}
 
+	the_bitmap->x_ = x;
+	the_bitmap->y_ = y;
 
+	return true;
+}
@@ -50,6 +50,7 @@
 /*****************************************************************************/
 
 // project includes
+#include "lib_font.h"
 
 // A2560 includes
 #include <mcp/syscalls.h>
@@ -57,6 +58,11 @@
 #include <mb/lib_general.h>
 #include <mb/lib_text.h>
 
+// host-build includes
+#if defined(__linux__)
+	#include <pthread.h>
+#endif
+
 
 /*****************************************************************************/
 /*                            Macro Definitions                              */
@@ -74,6 +80,37 @@
 #define PARAM_DO_FILL		true	//!< for various graphic routines
 #define PARAM_DO_NOT_FILL	false	//!< for various graphic routines
 
+#define BITMAP_MIN_WIDTH			2		//!< smallest width, in pixels, that Bitmap_New will accept
+#define BITMAP_MIN_HEIGHT			2		//!< smallest height, in pixels, that Bitmap_New will accept
+#define BITMAP_MAX_WIDTH			2000	//!< largest width, in pixels, that Bitmap_New will accept
+#define BITMAP_MAX_HEIGHT			2000	//!< largest height, in pixels, that Bitmap_New will accept
+
+#define BITMAP_BAND_HEIGHT			16		//!< number of rows in each row band. Lazily-cleared bitmaps track which parts have been cleared one band at a time.
+#define BITMAP_MAX_BANDS			((BITMAP_MAX_HEIGHT + BITMAP_BAND_HEIGHT - 1) / BITMAP_BAND_HEIGHT)	//!< number of row bands in the tallest possible bitmap
+
+#define BITMAP_FLAG_NONE			0x00	//!< for Bitmap_NewWithFlags: pixel memory is zeroed when the bitmap is allocated (same as Bitmap_New)
+#define BITMAP_FLAG_LAZY_CLEAR		0x01	//!< for Bitmap_NewWithFlags: pixel memory is not zeroed when allocated. Each row band is zeroed the first time something reads it or writes only part of it.
+#define BITMAP_FLAG_UNINITIALIZED	0x02	//!< for Bitmap_NewWithFlags: pixel memory is never zeroed. Only use this if you will fill or blit over the entire bitmap before reading from it.
+#define BITMAP_FLAG_STANDARD_RAM	0x04	//!< for Bitmap_NewWithFlags: allocate the pixel memory in standard RAM instead of VRAM. Use for scratch and offscreen bitmaps that will never be displayed directly. Can be combined with the other flags.
+#define BITMAP_FLAG_TRACK_DIRTY		0x08	//!< for Bitmap_NewWithFlags: keep a running bounding rectangle of everything drawn into the bitmap. See Bitmap_GetDirtyRect(). Can be combined with the other flags.
+#define BITMAP_FLAG_MAPPED			0x10	//!< set by Bitmap_MapFile: the pixel memory is a memory-mapped file, not an allocation. Not valid for Bitmap_NewWithFlags.
+#define BITMAP_FLAG_READ_ONLY		0x20	//!< set by Bitmap_MapFile: the pixel memory cannot be written, and drawing functions will refuse to draw into the bitmap. Not valid for Bitmap_NewWithFlags.
+#define BITMAP_CREATION_FLAGS		(BITMAP_FLAG_LAZY_CLEAR | BITMAP_FLAG_UNINITIALIZED | BITMAP_FLAG_STANDARD_RAM | BITMAP_FLAG_TRACK_DIRTY)	//!< the flags Bitmap_NewWithFlags accepts
+
+#define BITMAP_SNAPSHOT_TILE_SIZE	32		//!< width and height, in pixels, of the tiles that snapshots save on first write. Edge tiles may be smaller.
+
+#define GRAPHICS_LONG_COPY_MIN_LEN	16		//!< rows shorter than this are always copied with memcpy, even when VRAM is involved
+
+#define GRAPHICS_MAX_WORKERS		16		//!< host builds: most threads a WorkerPool can run a job on, counting the thread that starts it
+#define GRAPHICS_PARALLEL_MIN_BYTES	65536	//!< host builds: fills and blits of fewer pixels than this are always done on the calling thread. Below it, waking the workers costs more than it saves.
+
+#define PARAM_WAIT_FOR_VBLANK		true	//!< for Graphics_Flip, wait for the start of the next frame before switching buffers
+#define PARAM_DO_NOT_WAIT			false	//!< for Graphics_Flip, switch buffers immediately
+#define PARAM_COPY_DIRTY			true	//!< for DoubleBuffer_New, after each flip, copy only the areas drawn in the last frame forward into the new back buffer
+#define PARAM_DO_NOT_COPY_DIRTY		false	//!< for DoubleBuffer_New, never copy anything between buffers: the app redraws the whole back buffer every frame
+
+#define VICKY_GRAPHICS_LUT0_L		0x0800	//!< offset from a screen's VICKY registers to its graphics LUT 0, in long words like BITMAP_L0_VRAM_ADDR_L (byte offset 0x2000). Use as the_screen->vicky_ + VICKY_GRAPHICS_LUT0_L.
+
 /*****************************************************************************/
 /*                               Enumerations                                */
 /*****************************************************************************/
@@ -84,6 +121,16 @@
 /*                                 Structs                                   */
 /*****************************************************************************/
 
+// LOGIC:
+//   Rectangle comes from the platform header. Every function in this library that takes or returns one
+//   treats MaxX and MaxY as inclusive: the rectangle covers MaxX - MinX + 1 columns and MaxY - MinY + 1 rows.
+//   A rectangle with MinX > MaxX (or MinY > MaxY) is empty.
+
+typedef struct DoubleBuffer DoubleBuffer;
+typedef struct BitmapSnapshot BitmapSnapshot;
+typedef struct WorkerPool WorkerPool;
+typedef struct GraphicsRowJob GraphicsRowJob;
+
 struct Bitmap
 {
 	signed int		width_;		//!< width of the bitmap in pixels
@@ -91,11 +138,76 @@ struct Bitmap
 	signed int		x_;			//!< H position within this bitmap, of the "pen", for functions that draw from that point
 	signed int		y_;			//!< V position within this bitmap, of the "pen", for functions that draw from that point
 	uint8_t			color_;		//!< color value to use for next "pen" based operation in this bitmap
-	uint8_t			reserved_;	//!< future use
+	uint8_t			flags_;		//!< the BITMAP_FLAG_xxx options the bitmap was created with
 	Font*			font_;		//!< the currently selected font. All text drawing activities will use this font face.
-	unsigned char*	addr_;		//!< address of the start of the bitmap, within the machine's global address space. This is not the VICKY's local address for this bitmap. This address MUST be within the VRAM, however, it cannot be in non-VRAM memory space.
+	unsigned char*	addr_;		//!< address of the start of the bitmap, within the machine's global address space. This is not the VICKY's local address for this bitmap. This address is within the VRAM, unless the bitmap was created with BITMAP_FLAG_STANDARD_RAM. Only bitmaps in VRAM can be displayed.
+	signed int		bands_pending_;	//!< number of row bands that have not been cleared yet. Always 0 unless the bitmap was created with BITMAP_FLAG_LAZY_CLEAR.
+	uint8_t			band_valid_[(BITMAP_MAX_BANDS + 7) / 8];	//!< 1 bit per row band: set once the band has been cleared or completely overwritten. Only meaningful while bands_pending_ > 0.
+	Rectangle		dirty_;		//!< bounding rectangle (inclusive coordinates) of everything drawn since the dirty rect was last cleared. Empty if MinX > MaxX. Only maintained if the bitmap was created with BITMAP_FLAG_TRACK_DIRTY.
+	BitmapSnapshot*	snapshot_;	//!< the most recent snapshot taken of this bitmap, or NULL if there are none
+	void*			map_base_;	//!< for bitmaps created with Bitmap_MapFile, the start of the file mapping (addr_ points into it, past the header). NULL otherwise.
+	unsigned long	map_len_;	//!< for bitmaps created with Bitmap_MapFile, the length of the file mapping. 0 otherwise.
 };
 
+struct BitmapSnapshot
+{
+	Bitmap*			bitmap_;		//!< the bitmap this is a snapshot of
+	BitmapSnapshot*	older_;			//!< the next older snapshot of the same bitmap, or NULL if this is the oldest
+	BitmapSnapshot*	newer_;			//!< the next newer snapshot of the same bitmap, or NULL if this is the most recent
+	signed int		tiles_across_;	//!< number of BITMAP_SNAPSHOT_TILE_SIZE tiles needed to cover the bitmap's width
+	signed int		tiles_down_;	//!< number of BITMAP_SNAPSHOT_TILE_SIZE tiles needed to cover the bitmap's height
+	unsigned char**	tile_;			//!< 1 entry per tile, in rows: the tile's pixels as they were when the snapshot was taken, or NULL if the tile has not been written since. In that case a newer snapshot, or the bitmap itself, holds the same pixels.
+	boolean			incomplete_;	//!< true if a tile couldn't be saved before it was written to. Neither this snapshot nor any older one can be restored.
+};
+
+struct DoubleBuffer
+{
+	Screen*			screen_;			//!< the screen whose bitmap layer 0 is flipped between the 2 bitmaps
+	Bitmap*			bitmap_[2];			//!< the 2 screen-sized bitmaps, both in VRAM
+	uint8_t			back_;				//!< index into bitmap_ of the bitmap currently being drawn into (not displayed)
+	boolean			copy_dirty_;		//!< if true, Graphics_Flip copies the areas drawn in the last frame into the new back buffer
+	Bitmap*			prev_bitmap_;		//!< the screen's bitmap before the double buffer took it over. Restored by DoubleBuffer_Destroy.
+	unsigned long	prev_vram_addr_;	//!< the bitmap layer's VRAM address register value before the double buffer took it over. Restored by DoubleBuffer_Destroy.
+};
+
+#if defined(__linux__)
+
+	//! Host builds: a set of threads that all run the same job, for work that splits into independent pieces
+	//! The thread that starts a job runs it as well, and the start returns only once every thread has finished. The job itself decides which piece each thread does,
+	//! typically by claiming pieces with an atomic counter until none are left. Used by the row-splitting fills and blits, and by TileRenderer.
+	struct WorkerPool
+	{
+		pthread_t		thread_[GRAPHICS_MAX_WORKERS - 1];	//!< the worker threads. num_workers_ - 1 of them are running.
+		signed int		num_workers_;	//!< number of threads each job runs on, counting the thread that starts it
+		pthread_mutex_t	run_lock_;		//!< held by the thread whose job the workers are running. Another thread starting a job at the same time is refused.
+		pthread_mutex_t	lock_;			//!< protects job_, num_busy_, and quit_
+		pthread_cond_t	start_cond_;	//!< signalled when job_ changes, or quit_ is set
+		pthread_cond_t	done_cond_;		//!< signalled when num_busy_ reaches 0
+		unsigned long	job_;			//!< number of jobs started. 0 when the pool is created, before any worker exists: each worker waits for it to move on from 0.
+		signed int		num_busy_;		//!< number of worker threads still running the current job
+		boolean			quit_;			//!< set to stop the worker threads
+		void			(*job_function_)(void* the_arg);	//!< the current job
+		void*			job_arg_;		//!< passed to the current job
+	};
+
+	//! Host builds: one block of rows being filled or copied, split into slices of rows across a WorkerPool
+	//! Slices never share a row, so the fill and copy loops take no locks.
+	struct GraphicsRowJob
+	{
+		unsigned char*	write_loc_;		//!< first pixel of the first row to write
+		signed int		write_stride_;	//!< bytes from one row to write to the next
+		unsigned char*	read_loc_;		//!< for copies: first pixel of the first row to read. NULL for fills.
+		signed int		read_stride_;	//!< for copies: bytes from one row to read to the next
+		signed int		len_;			//!< number of pixels in each row
+		signed int		num_rows_;		//!< number of rows in the block
+		unsigned char	color_;			//!< for fills: the 1-byte LUT index to fill with
+		boolean			via_vram_;		//!< for copies: true if either side is in VRAM
+		signed int		num_slices_;	//!< number of slices the rows are split into
+		signed int		next_slice_;	//!< the next slice no thread has started on
+	};
+
+#endif
+
 
 /*****************************************************************************/
 /*                             Global Variables                              */
@@ -115,22 +227,100 @@ struct Bitmap
 //! @param	Font: optional font object to associate with the Bitmap. 
 Bitmap* Bitmap_New(signed int width, signed int height, Font* the_font);
 
+//! Create a new bitmap object, with control over how the pixel memory is prepared
+//! Zeroing a large bitmap is slow, and is wasted work if the first thing you do is fill or blit over it. Pass BITMAP_FLAG_LAZY_CLEAR to defer clearing until a row band is actually read or partially drawn into, or BITMAP_FLAG_UNINITIALIZED to skip clearing entirely.
+//! Bitmaps that will only be drawn into and then blitted to a screen should be placed in standard RAM with BITMAP_FLAG_STANDARD_RAM, leaving VRAM for displayed content. If standard RAM can't be allocated, the bitmap falls back to VRAM: check with Bitmap_IsInVRAM() if it matters.
+//! @param	Font: optional font object to associate with the Bitmap. 
+//! @param	flags: BITMAP_FLAG_NONE, or any combination of BITMAP_FLAG_LAZY_CLEAR or BITMAP_FLAG_UNINITIALIZED, and BITMAP_FLAG_STANDARD_RAM
+Bitmap* Bitmap_NewWithFlags(signed int width, signed int height, Font* the_font, uint8_t flags);
+
 // destructor
 // frees all allocated memory associated with the passed object, and the object itself
 boolean Bitmap_Destroy(Bitmap** the_bitmap);
 
 
+//! Create a pair of screen-sized bitmaps in VRAM, and point the screen's bitmap layer at the first of them
+//! Draw into the bitmap returned by DoubleBuffer_GetBackBitmap(), then call Graphics_Flip() to display it. While the double buffer exists, the_screen->bitmap_ is always the displayed (front) bitmap.
+//! The current contents of the screen's bitmap, if any, are copied into both buffers, so nothing visibly changes.
+//! @param	the_screen: the screen to double buffer. Its vicky_ register pointer can be a stand-in block of normal memory, for testing.
+//! @param	copy_dirty: PARAM_COPY_DIRTY if the app draws incrementally and the buffers must be kept in sync, PARAM_DO_NOT_COPY_DIRTY if the app redraws everything every frame.
+//! @return	returns NULL on any error
+DoubleBuffer* DoubleBuffer_New(Screen* the_screen, boolean copy_dirty);
+
+//! Destroy a double buffer, pointing the screen's bitmap layer back at the bitmap it was using before the double buffer was created
+//! frees the 2 buffer bitmaps and the object itself
+boolean DoubleBuffer_Destroy(DoubleBuffer** the_buffers);
+
+//! Get the bitmap that is currently not displayed, and which should be drawn into for the next frame
+//! @return	returns NULL on any error
+Bitmap* DoubleBuffer_GetBackBitmap(DoubleBuffer* the_buffers);
+
+//! Display the back buffer by pointing the screen's bitmap layer at it. The old front buffer becomes the new back buffer.
+//! If the double buffer was created with PARAM_COPY_DIRTY, the area drawn in the frame just shown is then copied into the new back buffer, so both buffers match again.
+//! @param	wait_for_vblank: PARAM_WAIT_FOR_VBLANK to wait for the start of a new frame before switching (prevents tearing), or PARAM_DO_NOT_WAIT.
+//! @return	returns false on any error/invalid input.
+boolean Graphics_Flip(DoubleBuffer* the_buffers, boolean wait_for_vblank);
+
+
+// **** Snapshot functions ****
+
+//! Take a snapshot of the bitmap's current pixels, that can later be restored with Bitmap_Restore()
+//! No pixels are copied when the snapshot is taken. The bitmap is divided into BITMAP_SNAPSHOT_TILE_SIZE tiles, and each tile is only copied into the snapshot the first time a primitive writes to it. Tiles that don't change are shared with newer snapshots and with the bitmap itself, so a history of snapshots costs roughly the size of the areas edited, not a full bitmap per snapshot. 
+//! NOTE: writes done directly through memory obtained from Bitmap_GetMemLocForXY() bypass the snapshot. 
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return	returns NULL on any error. The snapshot is owned by the bitmap, and will be freed when the bitmap is destroyed.
+BitmapSnapshot* Bitmap_Snapshot(Bitmap* the_bitmap);
+
+//! Put the bitmap's pixels back the way they were when the snapshot was taken
+//! Any snapshots newer than the_snapshot are discarded. the_snapshot itself remains valid, and can be restored again.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_snapshot: a snapshot previously taken of this bitmap with Bitmap_Snapshot()
+//! @return	returns false on any error/invalid input, or if memory ran out while saving a tile for the_snapshot or a newer snapshot. In that case the bitmap is left unchanged.
+boolean Bitmap_Restore(Bitmap* the_bitmap, BitmapSnapshot* the_snapshot);
+
+//! Discard a snapshot that is no longer needed, such as the oldest step of an undo history
+//! Any other snapshots of the bitmap remain valid and restorable.
+//! @param	the_snapshot: a snapshot previously taken with Bitmap_Snapshot(). Will be set to NULL.
+//! @return	returns false on any error/invalid input.
+boolean Bitmap_DiscardSnapshot(BitmapSnapshot** the_snapshot);
+
+
 // **** Block copy functions ****
 
 //! Blit from source bitmap to distination bitmap. 
 //! The source and destination bitmaps can be the same: you can use this to copy a chunk of pixels from one part of a screen to another. If the destination location cannot fit the entirety of the copied rectangle, the copy will be truncated, but will not return an error. 
-//! @param src_bm: the source bitmap. It must have a valid address within the VRAM memory space.
-//! @param dst_bm: the destination bitmap. It must have a valid address within the VRAM memory space. It can be the same bitmap as the source.
+//! Either bitmap can be in VRAM or in standard RAM. When VRAM is on either side, rows are copied a long word at a time where alignment allows, which suits the VRAM bus better than byte copies; RAM-to-RAM copies use memcpy.
+//! @param src_bm: the source bitmap. It must have a valid address.
+//! @param dst_bm: the destination bitmap. It must have a valid address. It can be the same bitmap as the source.
 //! @param src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to copy. May be negative.
 //! @param dst_x, dst_y: the location within the destination bitmap to copy pixels to. May be negative.
 //! @param width, height: the scope of the copy, in pixels.
 boolean Graphics_BlitBitMap(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm, int dst_x, int dst_y, int width, int height);
 
+//! Blit from source bitmap to destination bitmap, translating every pixel through a 256-entry table on the way
+//! Use for shaded, highlighted, greyed-out, or recolored copies of an image, without storing each variant as its own bitmap.
+//! The rectangle is clipped to both bitmaps. The source and destination can be the same bitmap, if the source and destination rectangles don't overlap.
+//! @param src_bm: the source bitmap. It must have a valid address.
+//! @param dst_bm: the destination bitmap. It must have a valid address. It can be the same bitmap as the source.
+//! @param src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to copy. May be negative.
+//! @param dst_x, dst_y: the location within the destination bitmap to copy pixels to. May be negative.
+//! @param width, height: the scope of the copy, in pixels.
+//! @param the_table: 256 LUT indexes. Each source pixel with value n is written to the destination as the_table[n].
+//! @return	returns false on any error, or if no part of the rectangle was within both bitmaps
+boolean Graphics_BlitBitMapRemapped(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm, int dst_x, int dst_y, int width, int height, const uint8_t* the_table);
+
+//! Blend a rectangle of the source bitmap over the destination bitmap, through a 256 x 256 blend table
+//! Use for translucent overlays, glass, and ghosted images. Blend tables for a palette and opacity can be built with Palette_GetBlendTable().
+//! The rectangle is clipped to both bitmaps. The source and destination can be the same bitmap, if the source and destination rectangles don't overlap.
+//! @param src_bm: the source bitmap. It must have a valid address.
+//! @param dst_bm: the destination bitmap. It must have a valid address. It can be the same bitmap as the source.
+//! @param src_x, src_y: the upper left coordinate within the source bitmap, for the rectangle you want to blend. May be negative.
+//! @param dst_x, dst_y: the location within the destination bitmap to blend pixels into. May be negative.
+//! @param width, height: the scope of the blend, in pixels.
+//! @param the_blend_table: 65536 LUT indexes. Each destination pixel d, under source pixel s, becomes the_blend_table[s * 256 + d].
+//! @return	returns false on any error, or if no part of the rectangle was within both bitmaps
+boolean Graphics_BlitBlended(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm, int dst_x, int dst_y, int width, int height, const uint8_t* the_blend_table);
+
 
 // **** Block fill functions ****
 
@@ -141,17 +331,75 @@ boolean Graphics_BlitBitMap(Bitmap* src_bm, int src_x, int src_y, Bitmap* dst_bm
 boolean Graphics_FillMemory(Bitmap* the_bitmap, unsigned char the_color);
 
 //! Fill pixel values for the passed Rectangle object, using the specified LUT value
+//! @param	the_coords: the rectangle to fill. MaxX and MaxY are inclusive.
 //! @param	the_color: a 1-byte index to the current LUT
 //! @return	returns false on any error/invalid input.
 boolean Graphics_FillBoxRect(Bitmap* the_bitmap, Rectangle* the_coords, unsigned char the_color);
 
 // Fill pixel values for a specific box area, using the specified LUT value
 // calling function must validate screen id, coords!
+//! @param	width, height: size of the box, in pixels. Exactly height rows of width pixels are filled.
 //! @param	the_color: a 1-byte index to the current LUT
 //! @return	returns false on any error/invalid input.
 boolean Graphics_FillBox(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
 
 
+#if defined(__linux__)
+
+	// **** Worker pool functions ****
+
+	//! Create a pool of threads to split work between (host builds only)
+	//! @param	num_workers: number of threads each job runs on, counting the thread that starts it. 0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS.
+	//! @return	returns NULL on any error. If fewer threads could be started than asked for, the pool uses the ones that did start.
+	WorkerPool* WorkerPool_New(signed int num_workers);
+
+	// destructor
+	// stops the pool's threads, and frees the object. Must not be called while a job is running.
+	boolean WorkerPool_Destroy(WorkerPool** the_pool);
+
+	//! Run a job on every thread in a pool, including the calling thread, and wait for every thread to finish it
+	//! @param	the_job: called once on each thread, with the_arg. It must divide the work up itself.
+	//! @return	returns false, without running anything, if another thread's job is running in the pool.
+	boolean WorkerPool_Run(WorkerPool* the_pool, void (*the_job)(void* the_arg), void* the_arg);
+
+	//! Split large fills and blits between several threads (host builds only)
+	//! Once set, Graphics_FillMemory, Graphics_FillBox, and Graphics_BlitBitMap split any block of GRAPHICS_PARALLEL_MIN_BYTES or more pixels into slices of rows, one per thread.
+	//! Each call still returns only when every row is done. Blits within one bitmap whose source and destination overlap are never split.
+	//! Don't call this while another thread is drawing.
+	//! @param	num_workers: number of threads, counting the thread making each drawing call. 1 turns splitting off (the default). 0 uses 1 thread per processor. At most GRAPHICS_MAX_WORKERS.
+	//! @return	returns false on any error/invalid input. If fewer threads could be started than asked for, the ones that did start are used.
+	boolean Graphics_SetWorkerThreads(signed int num_workers);
+
+#endif
+
+
+// **** Remap and blend functions ****
+
+//! Translate every pixel in the passed Rectangle object through a 256-entry table
+//! @param	the_coords: the rectangle to remap. MaxX and MaxY are inclusive. Clipped to the bitmap.
+//! @param	the_table: 256 LUT indexes. Each pixel with value n is replaced with the_table[n].
+//! @return	returns false on any error/invalid input.
+boolean Graphics_RemapRect(Bitmap* the_bitmap, Rectangle* the_coords, const uint8_t* the_table);
+
+//! Translate every pixel in a specific box area through a 256-entry table
+//! Use for shading, highlighting, or greying out part of a bitmap in place, or recoloring it.
+//! @param	width: width, in pixels, of the rectangle to remap
+//! @param	height: height, in pixels, of the rectangle to remap
+//! @param	the_table: 256 LUT indexes. Each pixel with value n is replaced with the_table[n].
+//! @return	returns false on any error/invalid input.
+boolean Graphics_RemapBox(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, const uint8_t* the_table);
+
+//! Blend a single color over a specific box area, through a 256 x 256 blend table
+//! Use for drop shadows, dimmed backgrounds behind dialogs, and selection highlights. Blend tables for a palette and opacity can be built with Palette_GetBlendTable().
+//! The box is clipped to the bitmap.
+//! @param	width: width, in pixels, of the rectangle to blend
+//! @param	height: height, in pixels, of the rectangle to blend
+//! @param	the_color: a 1-byte index to the current LUT: the color to blend over the box
+//! @param	the_blend_table: 65536 LUT indexes. Each pixel d becomes the_blend_table[the_color * 256 + d].
+//! @return	returns false on any error/invalid input.
+boolean Graphics_FillBoxBlended(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, const uint8_t* the_blend_table);
+
+
 
 
 // **** Bitmap functions *****
@@ -181,6 +429,23 @@ boolean Bitmap_SetCurrentColor(Bitmap* the_bitmap, uint8_t the_color);
 //! @return Returns false on any error condition
 boolean Bitmap_SetCurrentXY(Bitmap* the_bitmap, signed int x, signed int y);
 
+//! Report whether the bitmap's pixel memory is in VRAM (and can therefore be displayed), or in standard RAM
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return Returns true if the pixels are in VRAM, false if they are in standard RAM or on any error
+boolean Bitmap_IsInVRAM(Bitmap* the_bitmap);
+
+//! Get the bounding rectangle of everything drawn into the bitmap since the dirty rect was last cleared
+//! Only available for bitmaps created with BITMAP_FLAG_TRACK_DIRTY. Drawing done directly through memory obtained from Bitmap_GetMemLocForXY() is not tracked.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	the_rect: a Rectangle to be filled with the dirty area, in inclusive coordinates.
+//! @return Returns false if nothing has been drawn, or on any error condition
+boolean Bitmap_GetDirtyRect(Bitmap* the_bitmap, Rectangle* the_rect);
+
+//! Mark the entire bitmap as clean
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @return Returns false on any error condition
+boolean Bitmap_ClearDirtyRect(Bitmap* the_bitmap);
+
 //! Get the current color of the pen
 //! @param	the_bitmap: reference to a valid Bitmap object.
 //! @return Returns a 1-byte index to the current LUT, or 0 on any error
@@ -197,12 +462,22 @@ signed int Bitmap_GetCurrentX(Bitmap* the_bitmap);
 signed int Bitmap_GetCurrentY(Bitmap* the_bitmap);
 
 //! Calculate the VRAM location of the specified coordinate within the bitmap
+//! NOTE: for bitmaps created with BITMAP_FLAG_LAZY_CLEAR, only the row band containing y is guaranteed to have been cleared. If you will access memory beyond that band directly, fill or blit to it first.
 //! @param	the_bitmap: reference to a valid Bitmap object.
 //! @param	x: the horizontal position, between 0 and bitmap width - 1
 //! @param	y: the vertical position, between 0 and bitmap height - 1
 //! @return Returns a pointer to the VRAM location that corresponds to the passed X, Y, or NULL on any error condition
 unsigned char* Bitmap_GetMemLocForXY(Bitmap* the_bitmap, signed int x, signed int y);
 
+//! Calculate the memory location of the specified coordinate within the bitmap, and prepare a rectangle starting there to be written to directly
+//! Use this instead of Bitmap_GetMemLocForXY() when filling a block of rows by hand, so that lazy clearing, dirty rect tracking, and snapshots see the write.
+//! @param	the_bitmap: reference to a valid Bitmap object.
+//! @param	x: the horizontal position, between 0 and bitmap width - 1
+//! @param	y: the vertical position, between 0 and bitmap height - 1
+//! @param	width, height: size of the rectangle that will be written to. Must fit within the bitmap.
+//! @return Returns a pointer to the memory location that corresponds to the passed X, Y, or NULL on any error condition, including if the bitmap is read-only
+unsigned char* Bitmap_GetMemLocForWrite(Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height);
+
 //! Calculate the VRAM location of the current coordinate within the bitmap
 //! @param	the_bitmap: reference to a valid Bitmap object.
 //! @return Returns a pointer to the VRAM location that corresponds to the current "pen" X, Y, or NULL on any error condition
@@ -249,6 +524,7 @@ boolean Graphics_DrawHLine(Bitmap* the_bitmap, signed int x, signed int y, signe
 boolean Graphics_DrawVLine(Bitmap* the_bitmap, signed int x, signed int y, signed int the_line_len, unsigned char the_color);
 
 //! Draws a rectangle based on the passed Rectangle object, using the specified LUT value
+//! @param	the_coords: the rectangle to outline. MaxX and MaxY are inclusive: the outline is drawn on them.
 //! @param	the_color: a 1-byte index to the current LUT
 //! @return	returns false on any error/invalid input.
 boolean Graphics_DrawBoxRect(Bitmap* the_bitmap, Rectangle* the_coords, unsigned char the_color);
@@ -280,6 +556,59 @@ boolean Graphics_DrawRoundBox(Bitmap* the_bitmap, signed int x, signed int y, si
 boolean Graphics_DrawCircle(Bitmap* the_bitmap, signed int x1, signed int y1, signed int radius, unsigned char the_color);
 
 
+// **** Draw string functions *****
+
+//! Draw a string in the bitmap's current font and pen color
+//! The string is drawn with the top of the line of text at y: the baseline is font ascent rows below it. Text is clipped to the bitmap.
+//! Characters the font has no glyph for are drawn as its missing character. Afterwards, the pen is left at the end of the string, so more text can carry on from there.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	x, y: where the top left corner of the line of text should go. Can be negative, or partly outside the bitmap.
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawString(Bitmap* the_bitmap, signed int x, signed int y, const char* the_string);
+
+//! Draw a string in the bitmap's current font and pen color, at the pen position
+//! The pen is the top left corner of the line of text. Afterwards, it is left at the end of the string.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStringAtPen(Bitmap* the_bitmap, const char* the_string);
+
+//! Measure how wide a string would be, drawn in the bitmap's current font
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_string: the text to measure
+//! @return	returns the width of the string in pixels, or -1 on any error
+signed int Graphics_MeasureString(Bitmap* the_bitmap, const char* the_string);
+
+//! Draw a text layout in the bitmap's pen color, with the top left corner of its rectangle at x, y
+//! The layout's lines were worked out when it was created or last updated, so nothing is measured here. Text is clipped to the bitmap, not the rectangle.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_layout: the text layout to draw. It is drawn in its own font, not the bitmap's.
+//! @param	x, y: where the top left corner of the layout's rectangle should go
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawLayout(Bitmap* the_bitmap, TextLayout* the_layout, signed int x, signed int y);
+
+//! Draw a string in the bitmap's current font and pen color, wrapped and fitted to a rectangle
+//! For text drawn more than once, create a text layout with TextLayout_New() and draw it with Graphics_DrawLayout() instead: this works the lines out every time.
+//! @param	the_bitmap: reference to a valid Bitmap object, with a font set with Bitmap_SetCurrentFont()
+//! @param	the_rect: the rectangle to fit the text to. MaxX and MaxY are included in the rectangle.
+//! @param	the_string: the text to draw
+//! @param	the_align: a font_align value
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStringInRect(Bitmap* the_bitmap, Rectangle* the_rect, const char* the_string, uint8_t the_align);
+
+//! Draw a string in a stroke font, at any size, in the bitmap's pen color
+//! The string is drawn with the top of the line of text at y. Text is clipped to the bitmap. Afterwards, the pen is left at the end of the string.
+//! Glyphs are rasterized the first time they are drawn at a size, and drawn from the font's cache after that.
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_font: the stroke font to draw in. The bitmap's own font is not used or changed.
+//! @param	the_size: height of the line of text, in pixels, from 1 to STROKE_FONT_MAX_SIZE
+//! @param	x, y: where the top left corner of the line of text should go. Can be negative, or partly outside the bitmap.
+//! @param	the_string: the text to draw
+//! @return	returns false on any error/invalid input.
+boolean Graphics_DrawStrokeString(Bitmap* the_bitmap, StrokeFont* the_font, signed int the_size, signed int x, signed int y, const char* the_string);
+
+
 
 
 
@@ -21,8 +21,18 @@
 
 // class being tested
 #include "lib_graphics.h"
+#include "lib_tiled_bitmap.h"
+#include "lib_bitmap_file.h"
+#include "lib_asset_pack.h"
+#include "lib_gif.h"
+#include "lib_palette.h"
+#include "lib_font.h"
+#include "lib_display_list.h"
 
 // C includes
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 
 
 // A2560 includes
@@ -37,6 +47,22 @@
 /*                               Definitions                                 */
 /*****************************************************************************/
 
+#define TEST_VICKY_BYTES	0x20000	// size of the block of memory that stands in for a screen's VICKY registers and LUTs
+#define TEST_TILES_PATH		"_test.tiles"	// scratch file written and deleted by the unit tests
+#define TEST_RAW_PATH		"_test.a2bm"
+#define TEST_BMP_PATH		"_test.bmp"
+#define TEST_PACK_PATH		"_test.a2pk"
+#define TEST_DATA_LEN		4000
+#define TEST_PCX_PATH		"_test.pcx"
+#define TEST_GIF_PATH		"_test.gif"
+#define TEST_GIF_WIDTH		6
+#define TEST_GIF_HEIGHT		4
+#define TEST_PAL_PATH		"_test.pal"
+#define TEST_FONT_FIRST		' '		// the test font has glyphs for ' ' to 'Z', each 4 pixels wide and 5 tall
+#define TEST_FONT_LAST		'Z'
+#define TEST_FONT_ROW_BYTES	30
+#define TEST_FONT_PATH		"_test.a2fn"
+
 
 
 /*****************************************************************************/
@@ -51,6 +77,25 @@
 
 extern System*			global_system;
 
+// a 6x4 GIF with a 4-color global palette (black, red, green, blue), LZW minimum code size 2
+static const uint8_t	test_gif_bytes[] =
+{
+	0x47, 0x49, 0x46, 0x38, 0x39, 0x61, 0x06, 0x00, 0x04, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x2C, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00,
+	0x04, 0x00, 0x00, 0x02, 0x0B, 0x44, 0x34, 0x16, 0x7B, 0x38, 0x09, 0x80, 0x08, 0x60, 0xCC, 0x02,
+	0x00, 0x3B
+};
+
+static const uint8_t	test_gif_pixels[TEST_GIF_HEIGHT][TEST_GIF_WIDTH] =
+{
+	{0, 1, 2, 3, 0, 1},
+	{1, 1, 1, 1, 2, 2},
+	{3, 3, 3, 0, 0, 0},
+	{2, 1, 0, 3, 2, 1}
+};
+
+static uint8_t			test_font_strike[5 * TEST_FONT_ROW_BYTES];
+
 
 
 
@@ -58,6 +103,30 @@ extern System*			global_system;
 /*                       Private Function Prototypes                         */
 /*****************************************************************************/
 
+// write a small 8-bit BMP whose pixel at x, y is test_image_pixel(x, y), and whose LUT entry i is (i, 255 - i, i / 2)
+static boolean test_write_bmp(const char* the_path, signed int width, signed int height, boolean top_down);
+
+// the pixel test images are generated with
+static uint8_t test_image_pixel(signed int x, signed int y);
+
+// pass callback for the progressive load test: checks the interlaced rows of the test image are in place after each pass
+static boolean test_progressive_pass(Bitmap* the_bitmap, signed int the_pass, void* the_user_data);
+
+// fill a palette with a 6x6x6 color cube in entries 0-215, and a grey ramp in entries 216-255
+static void test_build_palette(uint8_t* the_palette);
+
+// set up a screen whose VICKY registers are a block of memory, so LUT writes can be checked without hardware
+static boolean test_new_screen(Screen* the_screen);
+
+// create a fixed-width font where every character is a solid 3x5 block, except space (blank) and '.' (the bottom left pixel)
+static Font* test_new_font(void);
+
+// record a scene with every kind of display list command in it
+static boolean test_record_scene(DisplayList* the_list, Bitmap* the_source);
+
+// draw the same scene as test_record_scene, directly with the Graphics_ functions, moved by x_offset, y_offset
+static boolean test_draw_scene(Bitmap* the_bitmap, Bitmap* the_source, signed int x_offset, signed int y_offset);
+
 
 
 /*****************************************************************************/
@@ -65,6 +134,184 @@ extern System*			global_system;
 /*****************************************************************************/
 
 
+static uint8_t test_image_pixel(signed int x, signed int y)
+{
+	return (uint8_t)(x * 5 + y * 3 + 1);
+}
+
+
+static boolean test_write_bmp(const char* the_path, signed int width, signed int height, boolean top_down)
+{
+	FILE*		the_file;
+	uint8_t		the_header[54];
+	uint8_t		the_entry[4];
+	signed int	stride = (width + 3) & ~3;
+	signed int	x;
+	signed int	y;
+	signed int	row;
+	
+	memset(the_header, 0, sizeof(the_header));
+	the_header[0] = 'B';
+	the_header[1] = 'M';
+	the_header[10] = (54 + 1024) & 0xFF;
+	the_header[11] = (54 + 1024) >> 8;
+	the_header[14] = 40;
+	the_header[18] = width;
+	the_header[22] = top_down ? -height : height;
+	the_header[23] = the_header[24] = the_header[25] = top_down ? 0xFF : 0;
+	the_header[26] = 1;
+	the_header[28] = 8;
+	
+	if ((the_file = fopen(the_path, "wb")) == NULL)
+	{
+		return false;
+	}
+	
+	fwrite(the_header, 1, sizeof(the_header), the_file);
+	
+	for (x = 0; x < 256; x++)
+	{
+		the_entry[0] = (uint8_t)x;
+		the_entry[1] = (uint8_t)(255 - x);
+		the_entry[2] = (uint8_t)(x / 2);
+		the_entry[3] = 0;
+		fwrite(the_entry, 1, 4, the_file);
+	}
+	
+	for (row = 0; row < height; row++)
+	{
+		y = top_down ? row : height - 1 - row;
+		
+		for (x = 0; x < stride; x++)
+		{
+			fputc(x < width ? test_image_pixel(x, y) : 0, the_file);
+		}
+	}
+	
+	fclose(the_file);
+	
+	return true;
+}
+
+
+static boolean test_progressive_pass(Bitmap* the_bitmap, signed int the_pass, void* the_user_data)
+{
+	static const signed int	pass_step[4] = {8, 4, 2, 1};
+	signed int*	the_passes_seen = (signed int*)the_user_data;
+	signed int	x;
+	signed int	y;
+	signed int	src_y;
+	
+	// after each pass, every row is a copy of the nearest row at or above it that has been decoded
+	for (y = 0; y < the_bitmap->height_; y++)
+	{
+		src_y = y - (y % pass_step[the_pass]);
+		
+		for (x = 0; x < the_bitmap->width_; x++)
+		{
+			if (Graphics_GetPixelAtXY(the_bitmap, x, y) != test_image_pixel(x, src_y))
+			{
+				return false;
+			}
+		}
+	}
+	
+	(*the_passes_seen)++;
+	
+	// stop after pass 1 if asked to
+	return (the_passes_seen[1] == 0 || the_pass < 1);
+}
+
+
+static void test_build_palette(uint8_t* the_palette)
+{
+	signed int	i;
+	
+	for (i = 0; i < 216; i++)
+	{
+		the_palette[i * 4 + 0] = (uint8_t)((i / 36) * 51);
+		the_palette[i * 4 + 1] = (uint8_t)(((i / 6) % 6) * 51);
+		the_palette[i * 4 + 2] = (uint8_t)((i % 6) * 51);
+		the_palette[i * 4 + 3] = 0xFF;
+	}
+	
+	for (; i < 256; i++)
+	{
+		the_palette[i * 4 + 0] = the_palette[i * 4 + 1] = the_palette[i * 4 + 2] = (uint8_t)((i - 216) * 255 / 39);
+		the_palette[i * 4 + 3] = 0xFF;
+	}
+}
+
+
+static boolean test_new_screen(Screen* the_screen)
+{
+	memset(the_screen, 0, sizeof(Screen));
+	the_screen->width_ = 64;
+	the_screen->height_ = 48;
+	the_screen->vicky_ = f_calloc(TEST_VICKY_BYTES, 1, MEM_STANDARD);
+	
+	return (the_screen->vicky_ != NULL);
+}
+
+
+static Font* test_new_font(void)
+{
+	signed int	the_char;
+	signed int	x;
+	signed int	y;
+	
+	memset(test_font_strike, 0, sizeof(test_font_strike));
+	
+	for (the_char = TEST_FONT_FIRST + 1; the_char <= TEST_FONT_LAST; the_char++)
+	{
+		for (y = (the_char == '.') ? 4 : 0; y < 5; y++)
+		{
+			for (x = 0; x < ((the_char == '.') ? 1 : 3); x++)
+			{
+				test_font_strike[y * TEST_FONT_ROW_BYTES + ((the_char - TEST_FONT_FIRST) * 4 + x) / 8] |= 0x80 >> (((the_char - TEST_FONT_FIRST) * 4 + x) % 8);
+			}
+		}
+	}
+	
+	return Font_NewFixedWidth(test_font_strike, TEST_FONT_ROW_BYTES, TEST_FONT_FIRST, TEST_FONT_LAST, 4, 5, 4);
+}
+
+
+static boolean test_record_scene(DisplayList* the_list, Bitmap* the_source)
+{
+	return DisplayList_FillBox(the_list, 5, 5, 30, 20, 1)
+		&& DisplayList_DrawLine(the_list, 0, 0, 150, 100, 2)
+		&& DisplayList_DrawHLine(the_list, 10, 60, 50, 3)
+		&& DisplayList_DrawVLine(the_list, 80, 10, 40, 4)
+		&& DisplayList_DrawBox(the_list, 90, 20, 30, 25, 5, PARAM_DO_NOT_FILL)
+		&& DisplayList_DrawCircle(the_list, 50, 80, 15, 6)
+		&& DisplayList_DrawRoundBox(the_list, 100, 60, 40, 30, 5, 7, PARAM_DO_NOT_FILL)
+		&& DisplayList_DrawRoundBox(the_list, 20, 90, 30, 15, 4, 8, PARAM_DO_FILL)
+		&& DisplayList_SetPixelAtXY(the_list, 150, 5, 9)
+		&& DisplayList_BlitBitMap(the_list, the_source, 0, 0, 120, 95, 16, 10)
+		&& DisplayList_DrawLine(the_list, 140, 10, 100, 50, 10);
+}
+
+
+static boolean test_draw_scene(Bitmap* the_bitmap, Bitmap* the_source, signed int x_offset, signed int y_offset)
+{
+	signed int	x = x_offset;
+	signed int	y = y_offset;
+	
+	return Graphics_DrawBox(the_bitmap, x + 5, y + 5, 30, 20, 1, PARAM_DO_FILL)
+		&& Graphics_DrawLine(the_bitmap, x + 0, y + 0, x + 150, y + 100, 2)
+		&& Graphics_DrawHLine(the_bitmap, x + 10, y + 60, 50, 3)
+		&& Graphics_DrawVLine(the_bitmap, x + 80, y + 10, 40, 4)
+		&& Graphics_DrawBox(the_bitmap, x + 90, y + 20, 30, 25, 5, PARAM_DO_NOT_FILL)
+		&& Graphics_DrawCircle(the_bitmap, x + 50, y + 80, 15, 6)
+		&& Graphics_DrawRoundBox(the_bitmap, x + 100, y + 60, 40, 30, 5, 7, PARAM_DO_NOT_FILL)
+		&& Graphics_DrawRoundBox(the_bitmap, x + 20, y + 90, 30, 15, 4, 8, PARAM_DO_FILL)
+		&& Graphics_SetPixelAtXY(the_bitmap, x + 150, y + 5, 9)
+		&& Graphics_BlitBitMap(the_source, 0, 0, the_bitmap, x + 120, y + 95, 16, 10)
+		&& Graphics_DrawLine(the_bitmap, x + 140, y + 10, x + 100, y + 50, 10);
+}
+
+
 
 
 
@@ -126,6 +373,1795 @@ MU_TEST(text_test_hline_speed)
 
 
 
+// **** unit tests
+
+MU_TEST(graphics_test_lazy_clear_bands)
+{
+	Bitmap*		the_bitmap;
+	
+	the_bitmap = Bitmap_NewWithFlags(40, BITMAP_BAND_HEIGHT * 4, NULL, BITMAP_FLAG_LAZY_CLEAR);
+	mu_check(the_bitmap != NULL);
+	mu_assert_int_eq(4, the_bitmap->bands_pending_);
+	
+	// stand in for whatever was left in the memory before the bitmap got it
+	memset(the_bitmap->addr_, 0xAA, 40 * BITMAP_BAND_HEIGHT * 4);
+	
+	// drawing into part of band 1 clears the rest of that band, and nothing else
+	mu_check(Graphics_FillBox(the_bitmap, 5, BITMAP_BAND_HEIGHT + 2, 10, 3, 7));
+	mu_assert_int_eq(3, the_bitmap->bands_pending_);
+	mu_assert_int_eq(0xAA, the_bitmap->addr_[0]);
+	mu_assert_int_eq(7, Graphics_GetPixelAtXY(the_bitmap, 5, BITMAP_BAND_HEIGHT + 2));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 0, BITMAP_BAND_HEIGHT));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 39, BITMAP_BAND_HEIGHT * 2 - 1));
+	mu_assert_int_eq(3, the_bitmap->bands_pending_);
+	
+	// reading from band 0 clears it
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 39, 0));
+	mu_assert_int_eq(2, the_bitmap->bands_pending_);
+	
+	// filling all of band 2 makes it valid without clearing it first
+	mu_check(Graphics_FillBox(the_bitmap, 0, BITMAP_BAND_HEIGHT * 2, 40, BITMAP_BAND_HEIGHT, 9));
+	mu_assert_int_eq(1, the_bitmap->bands_pending_);
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 0, BITMAP_BAND_HEIGHT * 2));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 39, BITMAP_BAND_HEIGHT * 3 - 1));
+	
+	// band 3 was never touched, but still reads as cleared
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 20, BITMAP_BAND_HEIGHT * 3 + 5));
+	mu_assert_int_eq(0, the_bitmap->bands_pending_);
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_uninitialized_bitmap)
+{
+	Bitmap*		the_bitmap;
+	
+	// nothing is tracked for an uninitialized bitmap: whatever is drawn is what is there
+	the_bitmap = Bitmap_NewWithFlags(32, 20, NULL, BITMAP_FLAG_UNINITIALIZED);
+	mu_check(the_bitmap != NULL);
+	mu_assert_int_eq(0, the_bitmap->bands_pending_);
+	
+	mu_check(Graphics_FillMemory(the_bitmap, 5));
+	mu_assert_int_eq(5, Graphics_GetPixelAtXY(the_bitmap, 0, 0));
+	mu_assert_int_eq(5, Graphics_GetPixelAtXY(the_bitmap, 31, 19));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	
+	mu_check(Bitmap_NewWithFlags(0, 20, NULL, BITMAP_FLAG_UNINITIALIZED) == NULL);
+}
+
+
+MU_TEST(graphics_test_standard_ram_blit)
+{
+	Bitmap*		the_ram_bitmap;
+	Bitmap*		the_vram_bitmap;
+	Bitmap*		the_copy;
+	signed int	x;
+	signed int	y;
+	signed int	num_bad;
+	
+	the_ram_bitmap = Bitmap_NewWithFlags(100, 40, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_vram_bitmap = Bitmap_New(100, 40, NULL);
+	the_copy = Bitmap_NewWithFlags(100, 40, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_ram_bitmap != NULL && the_vram_bitmap != NULL && the_copy != NULL);
+	mu_check(Bitmap_IsInVRAM(the_ram_bitmap) == false);
+	mu_check(Bitmap_IsInVRAM(the_vram_bitmap) == true);
+	
+	for (y = 0; y < 40; y++)
+	{
+		for (x = 0; x < 100; x++)
+		{
+			the_ram_bitmap->addr_[y * 100 + x] = (unsigned char)(x * 3 + y);
+		}
+	}
+	
+	// odd offsets and widths, so the long word copy has to line up, and finish, byte by byte
+	mu_check(Graphics_BlitBitMap(the_ram_bitmap, 3, 5, the_vram_bitmap, 1, 2, 77, 30));
+	mu_check(Graphics_BlitBitMap(the_vram_bitmap, 1, 2, the_copy, 6, 7, 77, 30));
+	
+	for (num_bad = 0, y = 0; y < 30; y++)
+	{
+		for (x = 0; x < 77; x++)
+		{
+			num_bad += (Graphics_GetPixelAtXY(the_vram_bitmap, x + 1, y + 2) != (unsigned char)((x + 3) * 3 + y + 5));
+			num_bad += (Graphics_GetPixelAtXY(the_copy, x + 6, y + 7) != (unsigned char)((x + 3) * 3 + y + 5));
+		}
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	
+	// the pixels around the copy are not touched
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_vram_bitmap, 0, 2));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_vram_bitmap, 78, 2));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_copy, 83, 36));
+	
+	mu_check(Bitmap_Destroy(&the_ram_bitmap));
+	mu_check(Bitmap_Destroy(&the_vram_bitmap));
+	mu_check(Bitmap_Destroy(&the_copy));
+}
+
+
+MU_TEST(graphics_test_double_buffer_flip)
+{
+	Screen			the_screen;
+	DoubleBuffer*	the_buffers;
+	Bitmap*			the_back;
+	Rectangle		the_rect;
+	
+	// stand in for the VICKY registers with a block of memory, so flips can be checked without hardware
+	memset(&the_screen, 0, sizeof(Screen));
+	the_screen.width_ = 64;
+	the_screen.height_ = 48;
+	the_screen.vicky_ = f_calloc(TEST_VICKY_BYTES, 1, MEM_STANDARD);
+	mu_check(the_screen.vicky_ != NULL);
+	R32(the_screen.vicky_ + BITMAP_L0_VRAM_ADDR_L) = 0x1234;
+	
+	the_buffers = DoubleBuffer_New(&the_screen, PARAM_COPY_DIRTY);
+	mu_check(the_buffers != NULL);
+	mu_check(the_screen.bitmap_ == the_buffers->bitmap_[0]);
+	mu_check(R32(the_screen.vicky_ + BITMAP_L0_VRAM_ADDR_L) == (unsigned long)the_screen.bitmap_->addr_ - VRAM_BUFFER_A);
+	
+	the_back = DoubleBuffer_GetBackBitmap(the_buffers);
+	mu_check(the_back == the_buffers->bitmap_[1]);
+	mu_check(Graphics_FillBox(the_back, 3, 4, 10, 5, 0x42));
+	mu_check(Bitmap_GetDirtyRect(the_back, &the_rect));
+	mu_assert_int_eq(3, the_rect.MinX);
+	mu_assert_int_eq(4, the_rect.MinY);
+	mu_assert_int_eq(12, the_rect.MaxX);
+	mu_assert_int_eq(8, the_rect.MaxY);
+	
+	// the back buffer is now displayed, and what was drawn in it was copied forward to the new back buffer
+	mu_check(Graphics_Flip(the_buffers, PARAM_DO_NOT_WAIT));
+	mu_check(the_screen.bitmap_ == the_back);
+	mu_check(R32(the_screen.vicky_ + BITMAP_L0_VRAM_ADDR_L) == (unsigned long)the_screen.bitmap_->addr_ - VRAM_BUFFER_A);
+	mu_check(DoubleBuffer_GetBackBitmap(the_buffers) == the_buffers->bitmap_[0]);
+	mu_assert_int_eq(0x42, Graphics_GetPixelAtXY(the_buffers->bitmap_[0], 3, 4));
+	mu_assert_int_eq(0x42, Graphics_GetPixelAtXY(the_buffers->bitmap_[0], 12, 8));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_buffers->bitmap_[0], 13, 8));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_buffers->bitmap_[0], 12, 9));
+
+	mu_check(Graphics_Flip(the_buffers, PARAM_DO_NOT_WAIT));
+	mu_check(the_screen.bitmap_ == the_buffers->bitmap_[0]);
+	mu_check(R32(the_screen.vicky_ + BITMAP_L0_VRAM_ADDR_L) == (unsigned long)the_screen.bitmap_->addr_ - VRAM_BUFFER_A);
+	
+	// destroying the double buffer gives the screen back its original bitmap layer address
+	mu_check(DoubleBuffer_Destroy(&the_buffers));
+	mu_check(the_buffers == NULL);
+	mu_check(the_screen.bitmap_ == NULL);
+	mu_check(R32(the_screen.vicky_ + BITMAP_L0_VRAM_ADDR_L) == 0x1234);
+	
+	f_free((void*)the_screen.vicky_, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_snapshot_restore)
+{
+	Bitmap*				the_bitmap;
+	BitmapSnapshot*		the_first;
+	BitmapSnapshot*		the_second;
+	unsigned char*		the_original;
+	unsigned char*		the_middle;
+	signed int			the_size;
+	signed int			i;
+	
+	the_bitmap = Bitmap_NewWithFlags(100, 70, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	the_size = 100 * 70;
+	
+	for (i = 0; i < the_size; i++)
+	{
+		the_bitmap->addr_[i] = (unsigned char)(i * 7);
+	}
+	
+	the_original = f_calloc(the_size, sizeof(unsigned char), MEM_STANDARD);
+	the_middle = f_calloc(the_size, sizeof(unsigned char), MEM_STANDARD);
+	mu_check(the_original != NULL && the_middle != NULL);
+	memcpy(the_original, the_bitmap->addr_, the_size);
+	
+	the_first = Bitmap_Snapshot(the_bitmap);
+	mu_check(the_first != NULL);
+	
+	mu_check(Graphics_FillBox(the_bitmap, 10, 10, 50, 40, 1));
+	mu_check(Graphics_DrawLine(the_bitmap, 0, 0, 99, 69, 2));
+	memcpy(the_middle, the_bitmap->addr_, the_size);
+	mu_check(memcmp(the_middle, the_original, the_size) != 0);
+	
+	// a second snapshot, then more drawing, some of it over tiles the first snapshot already saved
+	the_second = Bitmap_Snapshot(the_bitmap);
+	mu_check(the_second != NULL);
+	mu_check(Graphics_FillBox(the_bitmap, 40, 30, 55, 35, 3));
+	
+	mu_check(Bitmap_Restore(the_bitmap, the_second));
+	mu_check(memcmp(the_bitmap->addr_, the_middle, the_size) == 0);
+	
+	// restoring the first snapshot also throws away the second, which is newer
+	mu_check(Bitmap_Restore(the_bitmap, the_first));
+	mu_check(memcmp(the_bitmap->addr_, the_original, the_size) == 0);
+	
+	mu_check(Bitmap_DiscardSnapshot(&the_first));
+	mu_check(the_first == NULL);
+	
+	// a snapshot that couldn't save a tile refuses to restore, and leaves the bitmap alone
+	the_first = Bitmap_Snapshot(the_bitmap);
+	the_second = Bitmap_Snapshot(the_bitmap);
+	mu_check(the_first != NULL && the_second != NULL);
+	mu_check(Graphics_FillBox(the_bitmap, 0, 0, 20, 20, 4));
+	the_second->incomplete_ = true;
+	memcpy(the_middle, the_bitmap->addr_, the_size);
+	mu_check(Bitmap_Restore(the_bitmap, the_second) == false);
+	mu_check(Bitmap_Restore(the_bitmap, the_first) == false);
+	mu_check(memcmp(the_bitmap->addr_, the_middle, the_size) == 0);
+	
+	// the older snapshot relied on the lost tile too, so discarding the newer one doesn't make it restorable
+	mu_check(Bitmap_DiscardSnapshot(&the_second));
+	mu_check(Bitmap_Restore(the_bitmap, the_first) == false);
+	mu_check(Bitmap_DiscardSnapshot(&the_first));
+	
+	f_free(the_original, MEM_STANDARD);
+	f_free(the_middle, MEM_STANDARD);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_tiled_bitmap_draw)
+{
+	TiledBitmap*	the_canvas;
+	Bitmap*			the_direct;
+	Bitmap*			the_copy;
+	signed int		the_size;
+	
+	// only 2 tiles can be loaded at once, so most of the drawing pages tiles out to the backing file and back in
+	the_canvas = TiledBitmap_New(200, 150, TEST_TILES_PATH, 0, 2);
+	mu_check(the_canvas != NULL);
+	the_direct = Bitmap_NewWithFlags(200, 150, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_copy = Bitmap_NewWithFlags(200, 150, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_direct != NULL && the_copy != NULL);
+	the_size = 200 * 150;
+	
+	// the canvas draws the same pixels as a normal bitmap does
+	mu_check(TiledBitmap_DrawLine(the_canvas, 3, 140, 190, 7, 1));
+	mu_check(Graphics_DrawLine(the_direct, 3, 140, 190, 7, 1));
+	mu_check(TiledBitmap_DrawLine(the_canvas, 10, 70, 180, 70, 2));
+	mu_check(Graphics_DrawLine(the_direct, 10, 70, 180, 70, 2));
+	mu_check(TiledBitmap_DrawLine(the_canvas, 130, 5, 130, 145, 3));
+	mu_check(Graphics_DrawLine(the_direct, 130, 5, 130, 145, 3));
+	mu_check(TiledBitmap_DrawBox(the_canvas, 50, 20, 90, 100, 4, PARAM_DO_NOT_FILL));
+	mu_check(Graphics_DrawBox(the_direct, 50, 20, 90, 100, 4, PARAM_DO_NOT_FILL));
+	mu_check(TiledBitmap_DrawCircle(the_canvas, 100, 75, 60, 5));
+	mu_check(Graphics_DrawCircle(the_direct, 100, 75, 60, 5));
+	
+	mu_check(TiledBitmap_BlitToBitmap(the_canvas, 0, 0, the_copy, 0, 0, 200, 150));
+	mu_check(memcmp(the_copy->addr_, the_direct->addr_, the_size) == 0);
+	
+	// a fill crossing tile edges covers exactly width x height pixels
+	mu_check(TiledBitmap_FillBox(the_canvas, 60, 60, 10, 8, 6));
+	mu_assert_int_eq(6, TiledBitmap_GetPixelAtXY(the_canvas, 60, 60));
+	mu_assert_int_eq(6, TiledBitmap_GetPixelAtXY(the_canvas, 69, 67));
+	mu_assert_int_eq(0, TiledBitmap_GetPixelAtXY(the_canvas, 70, 67));
+	mu_assert_int_eq(0, TiledBitmap_GetPixelAtXY(the_canvas, 69, 68));
+	
+	// clipped drawing succeeds; drawing that misses the canvas entirely fails, whatever its direction
+	mu_check(TiledBitmap_FillBox(the_canvas, 190, 140, 50, 50, 7));
+	mu_assert_int_eq(7, TiledBitmap_GetPixelAtXY(the_canvas, 199, 149));
+	mu_check(TiledBitmap_DrawLine(the_canvas, -20, -10, 20, 10, 8));
+	mu_assert_int_eq(8, TiledBitmap_GetPixelAtXY(the_canvas, 0, 0));
+	mu_check(TiledBitmap_FillBox(the_canvas, 300, 10, 5, 5, 7) == false);
+	mu_check(TiledBitmap_DrawLine(the_canvas, 300, 10, 400, 10, 7) == false);
+	mu_check(TiledBitmap_DrawLine(the_canvas, 300, 10, 400, 60, 7) == false);
+	mu_check(TiledBitmap_DrawLine(the_canvas, -50, 10, -10, 60, 7) == false);
+	
+	// blits are clipped to both the canvas and the bitmap
+	mu_check(Graphics_FillMemory(the_direct, 9));
+	mu_check(TiledBitmap_BlitFromBitmap(the_direct, 0, 0, the_canvas, -5, 145, 20, 20));
+	mu_assert_int_eq(9, TiledBitmap_GetPixelAtXY(the_canvas, 0, 145));
+	mu_assert_int_eq(9, TiledBitmap_GetPixelAtXY(the_canvas, 14, 149));
+	mu_assert_int_eq(0, TiledBitmap_GetPixelAtXY(the_canvas, 15, 149));
+	mu_check(TiledBitmap_BlitFromBitmap(the_direct, 0, 0, the_canvas, 200, 0, 20, 20) == false);
+	mu_check(TiledBitmap_BlitToBitmap(the_canvas, 0, 0, the_copy, 210, 0, 20, 20) == false);
+	
+	mu_check(TiledBitmap_Destroy(&the_canvas));
+	mu_check(the_canvas == NULL);
+	remove(TEST_TILES_PATH);
+	mu_check(Bitmap_Destroy(&the_direct));
+	mu_check(Bitmap_Destroy(&the_copy));
+}
+
+
+MU_TEST(graphics_test_raw_file_map)
+{
+	Bitmap*		the_bitmap;
+	Bitmap*		the_mapped;
+	uint8_t*	the_palette;
+	uint8_t*	the_loaded_palette;
+	FILE*		the_file;
+	signed int	i;
+	
+	the_bitmap = Bitmap_NewWithFlags(40, 30, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_loaded_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_bitmap != NULL && the_palette != NULL && the_loaded_palette != NULL);
+	
+	for (i = 0; i < 40 * 30; i++)
+	{
+		the_bitmap->addr_[i] = (unsigned char)(i * 13);
+	}
+	
+	for (i = 0; i < BITMAP_PALETTE_BYTES; i++)
+	{
+		the_palette[i] = (uint8_t)(255 - i);
+	}
+	
+	mu_check(Bitmap_SaveRawFile(the_bitmap, TEST_RAW_PATH, the_palette));
+	
+#if defined(__linux__)
+	// a read-only mapping has the file's pixels and palette, and refuses drawing
+	the_mapped = Bitmap_MapFile(TEST_RAW_PATH, PARAM_MAP_READ_ONLY, the_loaded_palette);
+	mu_check(the_mapped != NULL);
+	mu_assert_int_eq(40, the_mapped->width_);
+	mu_assert_int_eq(30, the_mapped->height_);
+	mu_check((the_mapped->flags_ & (BITMAP_FLAG_MAPPED | BITMAP_FLAG_READ_ONLY)) == (BITMAP_FLAG_MAPPED | BITMAP_FLAG_READ_ONLY));
+	mu_check(memcmp(the_mapped->addr_, the_bitmap->addr_, 40 * 30) == 0);
+	mu_check(memcmp(the_loaded_palette, the_palette, BITMAP_PALETTE_BYTES) == 0);
+	mu_check(Graphics_FillBox(the_mapped, 0, 0, 5, 5, 1) == false);
+	mu_check(Graphics_SetPixelAtXY(the_mapped, 3, 3, 1) == false);
+	mu_check(Bitmap_Destroy(&the_mapped));
+	
+	// a copy-on-write mapping can be drawn into, without changing the file
+	the_mapped = Bitmap_MapFile(TEST_RAW_PATH, PARAM_MAP_COPY_ON_WRITE, NULL);
+	mu_check(the_mapped != NULL);
+	mu_check((the_mapped->flags_ & BITMAP_FLAG_READ_ONLY) == 0);
+	mu_check(Graphics_SetPixelAtXY(the_mapped, 3, 3, 0xEE));
+	mu_assert_int_eq(0xEE, Graphics_GetPixelAtXY(the_mapped, 3, 3));
+	mu_check(Bitmap_Destroy(&the_mapped));
+	
+	the_mapped = Bitmap_MapFile(TEST_RAW_PATH, PARAM_MAP_READ_ONLY, NULL);
+	mu_check(the_mapped != NULL);
+	mu_assert_int_eq(the_bitmap->addr_[3 * 40 + 3], Graphics_GetPixelAtXY(the_mapped, 3, 3));
+	mu_check(Bitmap_Destroy(&the_mapped));
+	
+	// a file that isn't a raw bitmap is refused
+	the_file = fopen(TEST_RAW_PATH, "r+b");
+	mu_check(the_file != NULL);
+	fputc('X', the_file);
+	fclose(the_file);
+	mu_check(Bitmap_MapFile(TEST_RAW_PATH, PARAM_MAP_READ_ONLY, NULL) == NULL);
+#endif
+	
+	remove(TEST_RAW_PATH);
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_loaded_palette, MEM_STANDARD);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_bmp_load)
+{
+	FILE*		the_file;
+	Bitmap*		the_bitmap;
+	uint8_t*	the_palette;
+	signed int	the_pass;
+	signed int	x;
+	signed int	y;
+	signed int	num_bad;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL);
+	
+	// bottom-up and top-down files, with a width that needs row padding
+	for (the_pass = 0; the_pass < 2; the_pass++)
+	{
+		mu_check(test_write_bmp(TEST_BMP_PATH, 13, 9, the_pass == 1));
+		the_bitmap = Bitmap_LoadFromFile(TEST_BMP_PATH, the_palette);
+		mu_check(the_bitmap != NULL);
+		mu_assert_int_eq(13, the_bitmap->width_);
+		mu_assert_int_eq(9, the_bitmap->height_);
+		
+		for (num_bad = 0, y = 0; y < 9; y++)
+		{
+			for (x = 0; x < 13; x++)
+			{
+				num_bad += (Graphics_GetPixelAtXY(the_bitmap, x, y) != test_image_pixel(x, y));
+			}
+		}
+		
+		mu_assert_int_eq(0, num_bad);
+		mu_check(Bitmap_Destroy(&the_bitmap));
+	}
+	
+	// palettes come back in LUT order, with the alpha byte set
+	mu_assert_int_eq(10, the_palette[10 * 4 + 0]);
+	mu_assert_int_eq(245, the_palette[10 * 4 + 1]);
+	mu_assert_int_eq(5, the_palette[10 * 4 + 2]);
+	mu_assert_int_eq(0xFF, the_palette[10 * 4 + 3]);
+	
+	// loading into an existing bitmap is clipped on every side
+	the_bitmap = Bitmap_NewWithFlags(10, 6, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_LoadFileIntoBitmap(TEST_BMP_PATH, the_bitmap, -4, 2, NULL));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 0, 1));
+	mu_assert_int_eq(test_image_pixel(4, 0), Graphics_GetPixelAtXY(the_bitmap, 0, 2));
+	mu_assert_int_eq(test_image_pixel(12, 3), Graphics_GetPixelAtXY(the_bitmap, 8, 5));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 9, 5));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	
+	// a height of 0, or one that can't be negated, is refused
+	for (the_pass = 0; the_pass < 2; the_pass++)
+	{
+		mu_check(test_write_bmp(TEST_BMP_PATH, 13, 9, false));
+		the_file = fopen(TEST_BMP_PATH, "r+b");
+		mu_check(the_file != NULL);
+		fseek(the_file, 22, SEEK_SET);
+		fputc(0, the_file);
+		fputc(0, the_file);
+		fputc(0, the_file);
+		fputc(the_pass == 0 ? 0 : 0x80, the_file);
+		fclose(the_file);
+		mu_check(Bitmap_LoadFromFile(TEST_BMP_PATH, NULL) == NULL);
+	}
+	
+	// a missing file is refused
+	remove(TEST_BMP_PATH);
+	mu_check(Bitmap_LoadFromFile(TEST_BMP_PATH, NULL) == NULL);
+	
+	// a raw file from a different version of the format is refused
+	the_bitmap = Bitmap_NewWithFlags(10, 6, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_SaveRawFile(the_bitmap, TEST_RAW_PATH, NULL));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	the_bitmap = Bitmap_LoadFromFile(TEST_RAW_PATH, NULL);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	the_file = fopen(TEST_RAW_PATH, "r+b");
+	mu_check(the_file != NULL);
+	fseek(the_file, 5, SEEK_SET);
+	fputc(BITMAP_RAW_VERSION + 1, the_file);
+	fclose(the_file);
+	mu_check(Bitmap_LoadFromFile(TEST_RAW_PATH, NULL) == NULL);
+	remove(TEST_RAW_PATH);
+	
+	f_free(the_palette, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_asset_pack_lz)
+{
+	AssetPackWriter*	the_writer;
+	AssetPack*			the_pack;
+	AssetPackEntry*		the_entry;
+	uint8_t*			the_data;
+	uint8_t*			the_loaded;
+	signed int			the_id;
+	signed int			i;
+	
+	// repeating runs with some variation, so there is something for the compressor to find
+	the_data = f_calloc(TEST_DATA_LEN, sizeof(uint8_t), MEM_STANDARD);
+	the_loaded = f_calloc(TEST_DATA_LEN, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_data != NULL && the_loaded != NULL);
+	
+	for (i = 0; i < TEST_DATA_LEN; i++)
+	{
+		the_data[i] = (uint8_t)((i % 37) < 20 ? i / 37 : i % 11);
+	}
+	
+	the_writer = AssetPack_NewWriter(TEST_PACK_PATH, 1);
+	mu_check(the_writer != NULL);
+	mu_assert_int_eq(0, AssetPack_AddData(the_writer, "data", ASSET_TYPE_DATA, the_data, TEST_DATA_LEN, PARAM_COMPRESS));
+	mu_check(AssetPack_FinishWriter(&the_writer));
+	
+	the_pack = AssetPack_Open(TEST_PACK_PATH);
+	mu_check(the_pack != NULL);
+	the_id = AssetPack_FindAsset(the_pack, "data");
+	mu_assert_int_eq(0, the_id);
+	mu_assert_int_eq(ASSET_PACK_NOT_FOUND, AssetPack_FindAsset(the_pack, "nothing"));
+	the_entry = AssetPack_GetEntry(the_pack, the_id);
+	mu_check(the_entry != NULL);
+	mu_assert_int_eq(ASSET_COMPRESSION_LZ, the_entry->compression_);
+	mu_check(the_entry->stored_len_ < the_entry->unpacked_len_);
+	mu_check(the_entry->unpacked_len_ == TEST_DATA_LEN);
+	
+	mu_check(AssetPack_LoadData(the_pack, the_id, the_loaded, TEST_DATA_LEN));
+	mu_check(memcmp(the_data, the_loaded, TEST_DATA_LEN) == 0);
+	
+	mu_check(AssetPack_Close(&the_pack));
+	remove(TEST_PACK_PATH);
+	f_free(the_data, MEM_STANDARD);
+	f_free(the_loaded, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_asset_pack_region)
+{
+	AssetPackWriter*	the_writer;
+	AssetPack*			the_pack;
+	Bitmap*				the_bitmap;
+	Bitmap*				the_region;
+	signed int			the_id;
+	signed int			x;
+	signed int			y;
+	signed int			num_bad;
+	
+	// taller than one band, so the region starts and ends partway through bands
+	the_bitmap = Bitmap_NewWithFlags(60, ASSET_PACK_BAND_HEIGHT * 3 + 5, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_region = Bitmap_NewWithFlags(40, 40, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL && the_region != NULL);
+	
+	for (y = 0; y < the_bitmap->height_; y++)
+	{
+		for (x = 0; x < 60; x++)
+		{
+			the_bitmap->addr_[y * 60 + x] = (x / 4 + y) & 0x07;
+		}
+	}
+	
+	the_writer = AssetPack_NewWriter(TEST_PACK_PATH, 2);
+	mu_check(the_writer != NULL);
+	mu_assert_int_eq(0, AssetPack_AddBitmap(the_writer, "raw", the_bitmap, PARAM_DO_NOT_COMPRESS));
+	mu_assert_int_eq(1, AssetPack_AddBitmap(the_writer, "packed", the_bitmap, PARAM_COMPRESS));
+	mu_check(AssetPack_FinishWriter(&the_writer));
+	
+	the_pack = AssetPack_Open(TEST_PACK_PATH);
+	mu_check(the_pack != NULL);
+	
+	for (the_id = 0; the_id < 2; the_id++)
+	{
+		mu_check(Graphics_FillMemory(the_region, 0xFF));
+		mu_check(AssetPack_LoadBitmapRect(the_pack, the_id, 5, ASSET_PACK_BAND_HEIGHT - 3, 30, ASSET_PACK_BAND_HEIGHT + 10, the_region, 2, 3));
+		
+		for (num_bad = 0, y = 0; y < ASSET_PACK_BAND_HEIGHT + 10; y++)
+		{
+			for (x = 0; x < 30; x++)
+			{
+				num_bad += (Graphics_GetPixelAtXY(the_region, x + 2, y + 3) != the_bitmap->addr_[(y + ASSET_PACK_BAND_HEIGHT - 3) * 60 + x + 5]);
+			}
+		}
+		
+		mu_assert_int_eq(0, num_bad);
+		mu_assert_int_eq(0xFF, Graphics_GetPixelAtXY(the_region, 1, 3));
+		mu_assert_int_eq(0xFF, Graphics_GetPixelAtXY(the_region, 32, 3));
+		mu_assert_int_eq(0xFF, Graphics_GetPixelAtXY(the_region, 2, ASSET_PACK_BAND_HEIGHT + 13));
+	}
+	
+	mu_check(AssetPack_Close(&the_pack));
+	remove(TEST_PACK_PATH);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(Bitmap_Destroy(&the_region));
+}
+
+
+MU_TEST(graphics_test_save_round_trip)
+{
+	static const char*	the_path[3] = {TEST_BMP_PATH, TEST_PCX_PATH, TEST_RAW_PATH};
+	static const uint8_t	the_format[3] = {BITMAP_FILE_BMP, BITMAP_FILE_PCX, BITMAP_FILE_RAW};
+	Bitmap*		the_bitmap;
+	Bitmap*		the_loaded;
+	uint8_t*	the_palette;
+	uint8_t*	the_loaded_palette;
+	signed int	i;
+	signed int	x;
+	signed int	y;
+	signed int	num_bad;
+	
+	the_bitmap = Bitmap_NewWithFlags(50, 40, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_loaded_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_bitmap != NULL && the_palette != NULL && the_loaded_palette != NULL);
+	
+	// runs of the same color, and single pixels, so the PCX encoder writes both kinds of run
+	for (y = 0; y < 40; y++)
+	{
+		for (x = 0; x < 50; x++)
+		{
+			the_bitmap->addr_[y * 50 + x] = (x < 20) ? (uint8_t)(y + 0xC0) : test_image_pixel(x, y);
+		}
+	}
+	
+	for (i = 0; i < 256; i++)
+	{
+		the_palette[i * 4 + 0] = (uint8_t)i;
+		the_palette[i * 4 + 1] = (uint8_t)(i * 3);
+		the_palette[i * 4 + 2] = (uint8_t)(255 - i);
+		the_palette[i * 4 + 3] = 0xFF;
+	}
+	
+	// an odd sized rectangle, partly off the right edge of the bitmap, so only 37 x 29 pixels are saved
+	for (i = 0; i < 3; i++)
+	{
+		mu_check(Bitmap_SaveToFile(the_bitmap, the_path[i], the_format[i], 13, 11, 45, 29, the_palette));
+		the_loaded = Bitmap_LoadFromFile(the_path[i], the_loaded_palette);
+		remove(the_path[i]);
+		mu_check(the_loaded != NULL);
+		mu_assert_int_eq(37, the_loaded->width_);
+		mu_assert_int_eq(29, the_loaded->height_);
+		
+		for (num_bad = 0, y = 0; y < 29; y++)
+		{
+			for (x = 0; x < 37; x++)
+			{
+				num_bad += (Graphics_GetPixelAtXY(the_loaded, x, y) != the_bitmap->addr_[(y + 11) * 50 + x + 13]);
+			}
+		}
+		
+		mu_assert_int_eq(0, num_bad);
+		mu_check(memcmp(the_loaded_palette, the_palette, BITMAP_PALETTE_BYTES) == 0);
+		mu_check(Bitmap_Destroy(&the_loaded));
+	}
+	
+	// nothing to save
+	mu_check(Bitmap_SaveToFile(the_bitmap, TEST_BMP_PATH, BITMAP_FILE_BMP, 50, 0, 10, 10, NULL) == false);
+	
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_loaded_palette, MEM_STANDARD);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_progressive_load)
+{
+	Bitmap*		the_bitmap;
+	signed int	the_passes_seen[2];
+	
+	mu_check(test_write_bmp(TEST_BMP_PATH, 21, 19, false));
+	the_bitmap = Bitmap_NewWithFlags(21, 19, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	
+	the_passes_seen[0] = the_passes_seen[1] = 0;
+	mu_check(Bitmap_LoadFileProgressive(TEST_BMP_PATH, the_bitmap, 0, 0, NULL, &test_progressive_pass, the_passes_seen));
+	mu_assert_int_eq(BITMAP_FILE_NUM_PASSES, the_passes_seen[0]);
+	
+	// the callback can stop the load partway through
+	mu_check(Graphics_FillMemory(the_bitmap, 0));
+	the_passes_seen[0] = 0;
+	the_passes_seen[1] = 1;
+	mu_check(Bitmap_LoadFileProgressive(TEST_BMP_PATH, the_bitmap, 0, 0, NULL, &test_progressive_pass, the_passes_seen) == false);
+	mu_assert_int_eq(2, the_passes_seen[0]);
+	
+	// PCX files load in one go, and report the last pass
+	mu_check(Bitmap_LoadFileProgressive(TEST_BMP_PATH, the_bitmap, 0, 0, NULL, NULL, NULL));
+	mu_check(Bitmap_SaveToFile(the_bitmap, TEST_PCX_PATH, BITMAP_FILE_PCX, 0, 0, 21, 19, NULL));
+	mu_check(Graphics_FillMemory(the_bitmap, 0));
+	the_passes_seen[0] = the_passes_seen[1] = 0;
+	mu_check(Bitmap_LoadFileProgressive(TEST_PCX_PATH, the_bitmap, 0, 0, NULL, &test_progressive_pass, the_passes_seen));
+	mu_assert_int_eq(1, the_passes_seen[0]);
+	
+	remove(TEST_BMP_PATH);
+	remove(TEST_PCX_PATH);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_gif_decode)
+{
+	FILE*		the_file;
+	Bitmap*		the_bitmap;
+	uint8_t*	the_palette;
+	signed int	x;
+	signed int	y;
+	
+	the_palette = f_calloc(GIF_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL);
+	
+	the_file = fopen(TEST_GIF_PATH, "wb");
+	mu_check(the_file != NULL);
+	mu_check(fwrite(test_gif_bytes, 1, sizeof(test_gif_bytes), the_file) == sizeof(test_gif_bytes));
+	fclose(the_file);
+	
+	the_bitmap = Gif_LoadFromFile(TEST_GIF_PATH, the_palette);
+	remove(TEST_GIF_PATH);
+	mu_check(the_bitmap != NULL);
+	mu_assert_int_eq(TEST_GIF_WIDTH, the_bitmap->width_);
+	mu_assert_int_eq(TEST_GIF_HEIGHT, the_bitmap->height_);
+	
+	for (y = 0; y < TEST_GIF_HEIGHT; y++)
+	{
+		for (x = 0; x < TEST_GIF_WIDTH; x++)
+		{
+			mu_assert_int_eq(test_gif_pixels[y][x], Graphics_GetPixelAtXY(the_bitmap, x, y));
+		}
+	}
+	
+	// the global color table comes back in LUT order: entry 1 is red
+	mu_assert_int_eq(0, the_palette[1 * 4 + 0]);
+	mu_assert_int_eq(0, the_palette[1 * 4 + 1]);
+	mu_assert_int_eq(0xFF, the_palette[1 * 4 + 2]);
+	mu_assert_int_eq(0xFF, the_palette[3 * 4 + 0]);
+	
+	f_free(the_palette, MEM_STANDARD);
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_palette_cycle)
+{
+	Screen			the_screen;
+	PaletteCycler*	the_cycler;
+	uint8_t*		the_palette;
+	uint8_t*		the_lut;
+	FILE*			the_file;
+	signed int		the_id;
+	signed int		the_other_id;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_lut = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL && the_lut != NULL);
+	mu_check(test_new_screen(&the_screen));
+	test_build_palette(the_palette);
+	
+	// the LUT reads back as written, and single entries are set in LUT order
+	mu_check(Palette_SetLUT(&the_screen, the_palette, 0, PALETTE_NUM_ENTRIES));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(the_lut, the_palette, BITMAP_PALETTE_BYTES) == 0);
+	mu_check(Palette_SetColor(&the_screen, 7, 10, 20, 30));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 7, 1));
+	mu_assert_int_eq(30, the_lut[7 * 4 + 0]);
+	mu_assert_int_eq(20, the_lut[7 * 4 + 1]);
+	mu_assert_int_eq(10, the_lut[7 * 4 + 2]);
+	
+	// a forward range moves each color up one entry per step, and the last wraps around to the first
+	the_cycler = Palette_NewCycler(&the_screen, the_palette);
+	mu_check(the_cycler != NULL);
+	the_id = Palette_AddCycle(the_cycler, 10, 13, 1, PALETTE_CYCLE_FORWARD);
+	the_other_id = Palette_AddCycle(the_cycler, 20, 22, 2, PALETTE_CYCLE_BACKWARD);
+	mu_check(the_id != PALETTE_NO_CYCLE && the_other_id != PALETTE_NO_CYCLE);
+	mu_assert_int_eq(PALETTE_NO_CYCLE, Palette_AddCycle(the_cycler, 30, 30, 1, PALETTE_CYCLE_FORWARD));
+	
+	mu_assert_int_eq(1, Palette_CycleTick(the_cycler));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[11 * 4], &the_palette[10 * 4], 4) == 0);
+	mu_check(memcmp(&the_lut[10 * 4], &the_palette[13 * 4], 4) == 0);
+	mu_check(memcmp(&the_lut[20 * 4], &the_palette[20 * 4], 12) == 0);
+	
+	// the backward range moves every second tick, each color down one entry
+	mu_assert_int_eq(2, Palette_CycleTick(the_cycler));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[12 * 4], &the_palette[10 * 4], 4) == 0);
+	mu_check(memcmp(&the_lut[20 * 4], &the_palette[21 * 4], 4) == 0);
+	mu_check(memcmp(&the_lut[22 * 4], &the_palette[20 * 4], 4) == 0);
+	
+	// a paused range stays put; a removed one goes back to the palette
+	mu_check(Palette_PauseCycle(the_cycler, the_id, true));
+	mu_assert_int_eq(0, Palette_CycleTick(the_cycler));
+	mu_assert_int_eq(1, Palette_CycleTick(the_cycler));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[12 * 4], &the_palette[10 * 4], 4) == 0);
+	mu_check(Palette_RemoveCycle(the_cycler, the_id));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[10 * 4], &the_palette[10 * 4], 16) == 0);
+	mu_check(Palette_RemoveCycle(the_cycler, the_id) == false);
+	
+	// ping pong reverses at each end of the range, instead of wrapping
+	the_id = Palette_AddCycle(the_cycler, 40, 42, 1, PALETTE_CYCLE_PING_PONG);
+	mu_check(Palette_RemoveCycle(the_cycler, the_other_id));
+	Palette_CycleTick(the_cycler);
+	Palette_CycleTick(the_cycler);
+	mu_assert_int_eq(2, the_cycler->cycle_[the_id].offset_);
+	Palette_CycleTick(the_cycler);
+	mu_assert_int_eq(1, the_cycler->cycle_[the_id].offset_);
+	Palette_CycleTick(the_cycler);
+	Palette_CycleTick(the_cycler);
+	mu_assert_int_eq(1, the_cycler->cycle_[the_id].offset_);
+	mu_check(Palette_DestroyCycler(&the_cycler));
+	
+	// JASC-PAL files load into LUT order, with unlisted entries left black
+	the_file = fopen(TEST_PAL_PATH, "wb");
+	mu_check(the_file != NULL);
+	fputs("JASC-PAL\r\n0100\r\n2\r\n255 128 0\r\n1 2 3\r\n", the_file);
+	fclose(the_file);
+	memset(the_lut, 0x55, BITMAP_PALETTE_BYTES);
+	mu_check(Palette_LoadFromFile(TEST_PAL_PATH, the_lut));
+	remove(TEST_PAL_PATH);
+	mu_assert_int_eq(0, the_lut[0]);
+	mu_assert_int_eq(128, the_lut[1]);
+	mu_assert_int_eq(255, the_lut[2]);
+	mu_assert_int_eq(3, the_lut[4]);
+	mu_assert_int_eq(1, the_lut[6]);
+	mu_assert_int_eq(0, the_lut[8]);
+	
+	f_free((void*)the_screen.vicky_, MEM_STANDARD);
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_lut, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_palette_fade)
+{
+	Screen			the_screen;
+	PaletteFade*	the_fade;
+	const uint8_t*	the_step;
+	uint8_t*		the_palette;
+	uint8_t*		the_lut;
+	signed int		i;
+	signed int		num_bad;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_lut = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL && the_lut != NULL);
+	mu_check(test_new_screen(&the_screen));
+	test_build_palette(the_palette);
+	
+	// fade entries 16 to 215 to black in 4 steps
+	the_fade = Palette_NewFade(the_palette, NULL, 16, 200, 4);
+	mu_check(the_fade != NULL);
+	mu_check(Palette_NewFade(the_palette, NULL, 0, 256, 0) == NULL);
+	mu_check(Palette_GetFadeStep(the_fade, 5) == NULL);
+	
+	the_step = Palette_GetFadeStep(the_fade, 0);
+	mu_check(the_step != NULL);
+	mu_check(memcmp(the_step, &the_palette[16 * 4], 200 * 4) == 0);
+	
+	// entry 215 is white: half way, it is mid grey
+	the_step = Palette_GetFadeStep(the_fade, 2);
+	mu_check(the_step[199 * 4 + 0] >= 126 && the_step[199 * 4 + 0] <= 129);
+	mu_assert_int_eq(the_step[199 * 4 + 0], the_step[199 * 4 + 2]);
+	
+	the_step = Palette_GetFadeStep(the_fade, 4);
+	
+	for (num_bad = 0, i = 0; i < 200; i++)
+	{
+		num_bad += (the_step[i * 4 + 0] != 0 || the_step[i * 4 + 1] != 0 || the_step[i * 4 + 2] != 0);
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	
+	// ticking writes step 0, then each step after it, and only the fade's range
+	mu_check(Palette_SetLUT(&the_screen, the_palette, 0, PALETTE_NUM_ENTRIES));
+	mu_assert_int_eq(4, Palette_FadeTick(the_fade, &the_screen));
+	mu_assert_int_eq(3, Palette_FadeTick(the_fade, &the_screen));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[16 * 4], Palette_GetFadeStep(the_fade, 1), 200 * 4) == 0);
+	mu_assert_int_eq(2, Palette_FadeTick(the_fade, &the_screen));
+	mu_assert_int_eq(1, Palette_FadeTick(the_fade, &the_screen));
+	mu_assert_int_eq(0, Palette_FadeTick(the_fade, &the_screen));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[16 * 4], Palette_GetFadeStep(the_fade, 4), 200 * 4) == 0);
+	mu_check(memcmp(the_lut, the_palette, 16 * 4) == 0);
+	mu_check(memcmp(&the_lut[216 * 4], &the_palette[216 * 4], 40 * 4) == 0);
+	
+	// jumping back to a step that isn't next to the last one writes every entry
+	mu_check(Palette_ApplyFadeStep(the_fade, &the_screen, 1, PARAM_CHANGED_ONLY));
+	mu_check(Palette_GetLUT(&the_screen, the_lut, 0, PALETTE_NUM_ENTRIES));
+	mu_check(memcmp(&the_lut[16 * 4], Palette_GetFadeStep(the_fade, 1), 200 * 4) == 0);
+	
+	mu_check(Palette_DestroyFade(&the_fade));
+	mu_check(the_fade == NULL);
+	f_free((void*)the_screen.vicky_, MEM_STANDARD);
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_lut, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_remap_tables)
+{
+	Bitmap*		the_bitmap;
+	Bitmap*		the_copy;
+	Rectangle	the_rect;
+	uint8_t*	the_palette;
+	uint8_t		the_table[256];
+	signed int	i;
+	signed int	x;
+	signed int	y;
+	signed int	num_bad;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL);
+	test_build_palette(the_palette);
+	
+	// exact colors are found, and ties go to the lowest index (black is both entry 0 and entry 216)
+	mu_assert_int_eq(5, Palette_FindNearestColor(the_palette, 255, 0, 0));
+	mu_assert_int_eq(30, Palette_FindNearestColor(the_palette, 0, 255, 0));
+	mu_assert_int_eq(180, Palette_FindNearestColor(the_palette, 0, 0, 255));
+	mu_assert_int_eq(0, Palette_FindNearestColor(the_palette, 0, 0, 0));
+	mu_assert_int_eq(1, Palette_FindNearestColor(the_palette, 60, 5, 0));
+	
+	// no shade leaves the cube alone; full shade makes everything black or white
+	mu_check(Palette_BuildShadeTable(the_palette, 0, the_table));
+	
+	for (num_bad = 0, i = 0; i < 216; i++)
+	{
+		num_bad += (the_table[i] != i);
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	mu_check(Palette_BuildShadeTable(the_palette, -PALETTE_BLEND_MAX, the_table));
+	mu_assert_int_eq(0, the_table[215]);
+	mu_assert_int_eq(0, the_table[100]);
+	mu_check(Palette_BuildShadeTable(the_palette, PALETTE_BLEND_MAX, the_table));
+	mu_assert_int_eq(215, the_table[0]);
+	
+	// a half shade of white is mid grey
+	mu_check(Palette_BuildShadeTable(the_palette, -PALETTE_BLEND_MAX / 2, the_table));
+	mu_check(the_table[215] >= 216);
+	mu_check(the_palette[the_table[215] * 4] >= 120 && the_palette[the_table[215] * 4] <= 135);
+	
+	// a full tint of every color is the tint color
+	mu_check(Palette_BuildTintTable(the_palette, 255, 0, 0, PALETTE_BLEND_MAX, the_table));
+	mu_assert_int_eq(5, the_table[0]);
+	mu_assert_int_eq(5, the_table[180]);
+	
+	// remapping a box changes exactly width x height pixels; a rect includes its max row and column
+	the_bitmap = Bitmap_NewWithFlags(30, 20, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_copy = Bitmap_NewWithFlags(30, 20, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL && the_copy != NULL);
+	
+	for (i = 0; i < 256; i++)
+	{
+		the_table[i] = (uint8_t)(255 - i);
+	}
+	
+	for (i = 0; i < 30 * 20; i++)
+	{
+		the_bitmap->addr_[i] = (uint8_t)i;
+	}
+	
+	mu_check(Graphics_RemapBox(the_bitmap, 4, 3, 10, 5, the_table));
+	
+	for (num_bad = 0, y = 0; y < 20; y++)
+	{
+		for (x = 0; x < 30; x++)
+		{
+			i = y * 30 + x;
+			num_bad += (the_bitmap->addr_[i] != ((x >= 4 && x < 14 && y >= 3 && y < 8) ? (uint8_t)(255 - (uint8_t)i) : (uint8_t)i));
+		}
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	
+	the_rect.MinX = 20;
+	the_rect.MinY = 10;
+	the_rect.MaxX = 21;
+	the_rect.MaxY = 11;
+	mu_check(Graphics_RemapRect(the_bitmap, &the_rect, the_table));
+	mu_assert_int_eq(255 - (uint8_t)(11 * 30 + 21), the_bitmap->addr_[11 * 30 + 21]);
+	mu_assert_int_eq((uint8_t)(12 * 30 + 21), the_bitmap->addr_[12 * 30 + 21]);
+	mu_assert_int_eq((uint8_t)(11 * 30 + 22), the_bitmap->addr_[11 * 30 + 22]);
+	
+	// a remapped blit is clipped to both bitmaps
+	mu_check(Graphics_BlitBitMapRemapped(the_bitmap, 0, 0, the_copy, 25, -2, 10, 10, the_table));
+	mu_assert_int_eq(255 - the_bitmap->addr_[2 * 30], Graphics_GetPixelAtXY(the_copy, 25, 0));
+	mu_assert_int_eq(255 - the_bitmap->addr_[9 * 30 + 4], Graphics_GetPixelAtXY(the_copy, 29, 7));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_copy, 24, 0));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_copy, 25, 8));
+	mu_check(Graphics_BlitBitMapRemapped(the_bitmap, 0, 0, the_copy, 30, 0, 10, 10, the_table) == false);
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(Bitmap_Destroy(&the_copy));
+	f_free(the_palette, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_fill_box_exact)
+{
+	Bitmap*		the_bitmap;
+	Rectangle	the_rect;
+	
+	the_bitmap = Bitmap_New(20, 20, NULL);
+	mu_check(the_bitmap != NULL);
+	
+	// a box fills exactly width columns and height rows
+	mu_check(Graphics_FillBox(the_bitmap, 2, 3, 4, 5, 7));
+	mu_assert_int_eq(7, Graphics_GetPixelAtXY(the_bitmap, 2, 3));
+	mu_assert_int_eq(7, Graphics_GetPixelAtXY(the_bitmap, 5, 7));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 6, 7));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 5, 8));
+	
+	// rectangle MaxX and MaxY are inclusive
+	the_rect.MinX = 10;
+	the_rect.MinY = 10;
+	the_rect.MaxX = 12;
+	the_rect.MaxY = 11;
+	mu_check(Graphics_FillBoxRect(the_bitmap, &the_rect, 9));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 12, 11));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 13, 11));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 12, 12));
+	
+	// a horizontal line is one row tall
+	mu_check(Graphics_DrawHLine(the_bitmap, 0, 15, 8, 4));
+	mu_assert_int_eq(4, Graphics_GetPixelAtXY(the_bitmap, 7, 15));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 8, 15));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 0, 16));
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+
+
+MU_TEST(graphics_test_blend_tables)
+{
+	Bitmap*			the_bitmap;
+	Bitmap*			the_source;
+	const uint8_t*	the_table;
+	uint8_t*		the_palette;
+	uint8_t			the_mix;
+	signed int		s;
+	signed int		d;
+	signed int		num_bad;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL);
+	test_build_palette(the_palette);
+	
+	// fully transparent keeps the destination, solid replaces it
+	the_table = Palette_GetBlendTable(the_palette, 0);
+	mu_check(the_table != NULL);
+	
+	for (num_bad = 0, s = 0; s < 216; s += 7)
+	{
+		for (d = 0; d < 216; d++)
+		{
+			num_bad += (the_table[s * 256 + d] != d);
+		}
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	
+	the_table = Palette_GetBlendTable(the_palette, PALETTE_BLEND_MAX);
+	mu_check(the_table != NULL);
+	
+	for (num_bad = 0, s = 0; s < 216; s++)
+	{
+		for (d = 0; d < 216; d += 7)
+		{
+			num_bad += (the_table[s * 256 + d] != s);
+		}
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	
+	// white over black, evenly mixed, is mid grey
+	the_table = Palette_GetBlendTable(the_palette, PALETTE_BLEND_MAX / 2);
+	mu_check(the_table != NULL);
+	the_mix = the_table[215 * 256 + 0];
+	mu_check(the_palette[the_mix * 4] >= 120 && the_palette[the_mix * 4] <= 135);
+	mu_assert_int_eq(the_palette[the_mix * 4], the_palette[the_mix * 4 + 2]);
+	
+	// the same palette and opacity come back from the cache
+	mu_check(Palette_GetBlendTable(the_palette, PALETTE_BLEND_MAX / 2) == the_table);
+	
+	// a blended fill covers exactly width x height pixels
+	the_bitmap = Bitmap_NewWithFlags(20, 20, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_source = Bitmap_NewWithFlags(20, 20, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL && the_source != NULL);
+	mu_check(Graphics_FillBoxBlended(the_bitmap, 2, 3, 5, 4, 215, the_table));
+	mu_assert_int_eq(the_mix, Graphics_GetPixelAtXY(the_bitmap, 2, 3));
+	mu_assert_int_eq(the_mix, Graphics_GetPixelAtXY(the_bitmap, 6, 6));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 7, 6));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 6, 7));
+	
+	// a blended blit looks up each source pixel over each destination pixel
+	mu_check(Graphics_FillMemory(the_source, 215));
+	mu_check(Graphics_BlitBlended(the_source, 0, 0, the_bitmap, 0, 0, 3, 4, the_table));
+	mu_assert_int_eq(the_mix, Graphics_GetPixelAtXY(the_bitmap, 0, 0));
+	mu_assert_int_eq(the_table[215 * 256 + the_mix], Graphics_GetPixelAtXY(the_bitmap, 2, 3));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 3, 0));
+	
+	Palette_FlushBlendTables();
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(Bitmap_Destroy(&the_source));
+	f_free(the_palette, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_inverse_map)
+{
+	Screen				the_screen;
+	PaletteInverseMap*	the_map;
+	uint8_t*			the_palette;
+	uint8_t				the_pixels[4 * 4];
+	uint8_t				the_dest[4];
+	signed int			the_bits;
+	signed int			r;
+	signed int			g;
+	signed int			b;
+	signed int			num_bad;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL);
+	test_build_palette(the_palette);
+	
+	// every color of the cube maps to its own entry, at both cell sizes (except that at 15 bits, a grey of the cube
+	//   shares its cell with the nearby greys of the ramp, and any of them may be picked)
+	for (the_bits = PALETTE_INVERSE_15_BIT; the_bits <= PALETTE_INVERSE_18_BIT; the_bits++)
+	{
+		the_map = Palette_NewInverseMap(the_palette, the_bits);
+		mu_check(the_map != NULL);
+		
+		for (num_bad = 0, b = 0; b < 6; b++)
+		{
+			for (g = 0; g < 6; g++)
+			{
+				for (r = 0; r < 6; r++)
+				{
+					if (the_bits == PALETTE_INVERSE_15_BIT && r == g && g == b)
+					{
+						continue;
+					}
+					
+					num_bad += (Palette_MapColor(the_map, r * 51, g * 51, b * 51) != b * 36 + g * 6 + r);
+				}
+			}
+		}
+		
+		mu_assert_int_eq(0, num_bad);
+		
+		// and colors between cube levels go to the closest one
+		mu_assert_int_eq(1, Palette_MapColor(the_map, 60, 10, 0));
+		mu_check(Palette_DestroyInverseMap(&the_map));
+		mu_check(the_map == NULL);
+	}
+	
+	mu_check(Palette_NewInverseMap(the_palette, 4) == NULL);
+	
+	// rows map the same as single colors, in each pixel format
+	the_map = Palette_NewInverseMap(the_palette, PALETTE_INVERSE_15_BIT);
+	mu_check(the_map != NULL);
+	memset(the_pixels, 0, sizeof(the_pixels));
+	the_pixels[0] = 255;
+	the_pixels[4] = 255;
+	the_pixels[8] = 255;
+	mu_check(Palette_MapRow(the_map, the_pixels, PALETTE_PIXEL_RGB24, the_dest, 3));
+	mu_assert_int_eq(5, the_dest[0]);
+	mu_assert_int_eq(30, the_dest[1]);
+	mu_assert_int_eq(180, the_dest[2]);
+	memset(the_pixels, 0, sizeof(the_pixels));
+	the_pixels[2] = 255;
+	the_pixels[5] = 255;
+	mu_check(Palette_MapRow(the_map, the_pixels, PALETTE_PIXEL_BGRA32, the_dest, 2));
+	mu_assert_int_eq(5, the_dest[0]);
+	mu_assert_int_eq(30, the_dest[1]);
+	mu_check(Palette_DestroyInverseMap(&the_map));
+	
+	// a map for a screen notices when the LUT is changed through this library
+	mu_check(test_new_screen(&the_screen));
+	mu_check(Palette_SetLUT(&the_screen, the_palette, 0, PALETTE_NUM_ENTRIES));
+	the_map = Palette_NewInverseMapForScreen(&the_screen, PALETTE_INVERSE_15_BIT);
+	mu_check(the_map != NULL);
+	mu_assert_int_eq(5, Palette_MapColor(the_map, 255, 0, 0));
+	mu_check(Palette_SetColor(&the_screen, 3, 255, 0, 0));
+	mu_assert_int_eq(3, Palette_MapColor(the_map, 255, 0, 0));
+	mu_check(Palette_DestroyInverseMap(&the_map));
+	
+	f_free((void*)the_screen.vicky_, MEM_STANDARD);
+	f_free(the_palette, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_import_dither)
+{
+	PaletteInverseMap*	the_map;
+	PaletteImporter*	the_importer;
+	Bitmap*				the_bitmap;
+	uint8_t*			the_palette;
+	uint8_t*			the_image;
+	uint8_t				the_dither;
+	signed int			the_level;
+	signed int			x;
+	signed int			y;
+	signed int			num_white;
+	signed int			num_bad;
+	
+	// a palette with only black (entry 0) and white (entry 1), so every grey has to be dithered
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_image = f_calloc(8 * 8 * 3, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL && the_image != NULL);
+	the_palette[4] = the_palette[5] = the_palette[6] = 255;
+	the_map = Palette_NewInverseMap(the_palette, PALETTE_INVERSE_15_BIT);
+	the_bitmap = Bitmap_NewWithFlags(8, 8, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_map != NULL && the_bitmap != NULL);
+	
+	// pure black and pure white come through every kind of dither unchanged
+	for (the_level = 0; the_level <= 255; the_level += 255)
+	{
+		memset(the_image, the_level, 8 * 8 * 3);
+		
+		for (the_dither = PALETTE_DITHER_NONE; the_dither <= PALETTE_DITHER_DIFFUSION; the_dither++)
+		{
+			mu_check(Palette_ImportImage(the_map, the_image, PALETTE_PIXEL_RGB24, 8, 8, 8 * 3, the_bitmap, 0, 0, the_dither));
+			
+			for (num_bad = 0, x = 0; x < 8 * 8; x++)
+			{
+				num_bad += (the_bitmap->addr_[x] != (the_level ? 1 : 0));
+			}
+			
+			mu_assert_int_eq(0, num_bad);
+		}
+	}
+	
+	// mid grey, undithered, is all white
+	memset(the_image, 128, 8 * 8 * 3);
+	mu_check(Palette_ImportImage(the_map, the_image, PALETTE_PIXEL_RGB24, 8, 8, 8 * 3, the_bitmap, 0, 0, PALETTE_DITHER_NONE));
+	
+	for (num_white = 0, x = 0; x < 8 * 8; x++)
+	{
+		num_white += the_bitmap->addr_[x];
+	}
+	
+	mu_assert_int_eq(64, num_white);
+	
+	// ordered dither gives a mix of both, in a pattern that repeats every 4 pixels across and down
+	mu_check(Palette_ImportImage(the_map, the_image, PALETTE_PIXEL_RGB24, 8, 8, 8 * 3, the_bitmap, 0, 0, PALETTE_DITHER_ORDERED));
+	
+	for (num_white = 0, num_bad = 0, y = 0; y < 8; y++)
+	{
+		for (x = 0; x < 8; x++)
+		{
+			num_white += the_bitmap->addr_[y * 8 + x];
+			num_bad += (the_bitmap->addr_[y * 8 + x] != the_bitmap->addr_[(y % 4) * 8 + (x % 4)]);
+		}
+	}
+	
+	mu_assert_int_eq(0, num_bad);
+	mu_check(num_white >= 24 && num_white <= 40);
+	
+	// error diffusion keeps the average close to the grey
+	mu_check(Palette_ImportImage(the_map, the_image, PALETTE_PIXEL_RGB24, 8, 8, 8 * 3, the_bitmap, 0, 0, PALETTE_DITHER_DIFFUSION));
+	
+	for (num_white = 0, x = 0; x < 8 * 8; x++)
+	{
+		num_white += the_bitmap->addr_[x];
+	}
+	
+	mu_check(num_white >= 28 && num_white <= 36);
+	
+	// row by row import is clipped to the bitmap, and stops after the last row
+	memset(the_image, 255, 8 * 3);
+	mu_check(Graphics_FillMemory(the_bitmap, 7));
+	the_importer = Palette_NewImporter(the_map, the_bitmap, -3, 6, 8, 3, PALETTE_PIXEL_RGB24, PALETTE_DITHER_NONE);
+	mu_check(the_importer != NULL);
+	mu_check(Palette_ImportRow(the_importer, the_image));
+	mu_check(Palette_ImportRow(the_importer, the_image));
+	mu_check(Palette_ImportRow(the_importer, the_image));
+	mu_check(Palette_ImportRow(the_importer, the_image) == false);
+	mu_assert_int_eq(7, Graphics_GetPixelAtXY(the_bitmap, 0, 5));
+	mu_assert_int_eq(1, Graphics_GetPixelAtXY(the_bitmap, 0, 6));
+	mu_assert_int_eq(1, Graphics_GetPixelAtXY(the_bitmap, 4, 7));
+	mu_assert_int_eq(7, Graphics_GetPixelAtXY(the_bitmap, 5, 7));
+	mu_check(Palette_DestroyImporter(&the_importer));
+	mu_check(the_importer == NULL);
+	
+	mu_check(Palette_DestroyInverseMap(&the_map));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_image, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_quantizer)
+{
+	PaletteQuantizer*	the_quantizer;
+	Bitmap*				the_bitmap;
+	uint8_t*			the_palette;
+	uint8_t*			the_cube;
+	uint8_t				the_row[5 * 3];
+	uint8_t				the_table[256];
+	uint8_t				the_entry;
+	signed int			i;
+	
+	the_palette = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	the_cube = f_calloc(BITMAP_PALETTE_BYTES, sizeof(uint8_t), MEM_STANDARD);
+	mu_check(the_palette != NULL && the_cube != NULL);
+	test_build_palette(the_cube);
+	
+	// red, green, blue, yellow and black pixels, in a row of RGB24
+	memset(the_row, 0, sizeof(the_row));
+	the_row[0] = 255;
+	the_row[4] = 255;
+	the_row[8] = 255;
+	the_row[9] = the_row[10] = 255;
+	
+	the_quantizer = Palette_NewQuantizer();
+	mu_check(the_quantizer != NULL);
+	
+	for (i = 0; i < 10; i++)
+	{
+		mu_check(Palette_QuantizerAddRow(the_quantizer, the_row, PALETTE_PIXEL_RGB24, 5));
+	}
+	
+	// entry 0 is reserved as red, and the reserved entries outside the range are black: only green, blue and yellow need entries
+	the_palette[0 * 4 + 2] = 255;
+	memset(&the_palette[24 * 4], 0x77, 4);
+	mu_assert_int_eq(3, Palette_QuantizerBuildPalette(the_quantizer, the_palette, 16, 8));
+	mu_assert_int_eq(255, the_palette[0 * 4 + 2]);
+	mu_assert_int_eq(0x77, the_palette[24 * 4]);
+	
+	the_entry = Palette_FindNearestColor(the_palette, 0, 255, 0);
+	mu_check(the_entry >= 16 && the_entry < 19);
+	mu_check(the_palette[the_entry * 4 + 1] >= 248 && the_palette[the_entry * 4 + 0] < 8 && the_palette[the_entry * 4 + 2] < 8);
+	the_entry = Palette_FindNearestColor(the_palette, 0, 0, 255);
+	mu_check(the_entry >= 16 && the_entry < 19);
+	mu_check(the_palette[the_entry * 4 + 0] >= 248 && the_palette[the_entry * 4 + 1] < 8 && the_palette[the_entry * 4 + 2] < 8);
+	the_entry = Palette_FindNearestColor(the_palette, 255, 255, 0);
+	mu_check(the_entry >= 16 && the_entry < 19);
+	mu_check(the_palette[the_entry * 4 + 2] >= 248 && the_palette[the_entry * 4 + 1] >= 248 && the_palette[the_entry * 4 + 0] < 8);
+	
+	// entries of the range not needed are black
+	for (i = 19; i < 24; i++)
+	{
+		mu_check(the_palette[i * 4] == 0 && the_palette[i * 4 + 1] == 0 && the_palette[i * 4 + 2] == 0);
+	}
+	
+	// with fewer entries than colors, the palette is as full as it can be
+	mu_assert_int_eq(2, Palette_QuantizerBuildPalette(the_quantizer, the_palette, 16, 2));
+	
+	// an 8-bit image moves to the new palette through a remap table
+	mu_check(Palette_QuantizerBuildPalette(the_quantizer, the_palette, 16, 8) == 3);
+	mu_check(Palette_BuildRemapTable(the_cube, the_palette, the_table));
+	mu_assert_int_eq(0, the_table[5]);
+	mu_assert_int_eq(Palette_FindNearestColor(the_palette, 0, 255, 0), the_table[30]);
+	mu_assert_int_eq(Palette_FindNearestColor(the_palette, 0, 0, 0), the_table[0]);
+	mu_check(Palette_DestroyQuantizer(&the_quantizer));
+	mu_check(the_quantizer == NULL);
+	
+	// an 8-bit bitmap adds its pixels through its own palette
+	the_bitmap = Bitmap_NewWithFlags(10, 10, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_quantizer = Palette_NewQuantizer();
+	mu_check(the_bitmap != NULL && the_quantizer != NULL);
+	mu_check(Graphics_FillMemory(the_bitmap, 30));
+	mu_check(Palette_QuantizerAddBitmap(the_quantizer, the_bitmap, the_cube));
+	mu_assert_int_eq(1, Palette_QuantizerBuildPalette(the_quantizer, the_palette, 16, 8));
+	mu_check(the_palette[16 * 4 + 1] >= 248 && the_palette[16 * 4 + 0] < 8 && the_palette[16 * 4 + 2] < 8);
+	mu_check(Palette_DestroyQuantizer(&the_quantizer));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	
+	f_free(the_palette, MEM_STANDARD);
+	f_free(the_cube, MEM_STANDARD);
+}
+
+
+MU_TEST(graphics_test_font_draw)
+{
+	Font*				the_font;
+	Bitmap*				the_bitmap;
+	const FontGlyph*	the_glyph;
+	signed int			x;
+	signed int			y;
+	signed int			num_set;
+	
+	the_font = test_new_font();
+	mu_check(the_font != NULL);
+	mu_check(Font_NewFixedWidth(test_font_strike, TEST_FONT_ROW_BYTES, 'Z', 'A', 4, 5, 4) == NULL);
+	
+	// glyphs are cut into runs of set pixels, one per row for the blocks
+	mu_check(Font_BuildSpanCache(the_font));
+	the_glyph = Font_GetGlyph(the_font, 'A');
+	mu_check(the_glyph != NULL);
+	mu_assert_int_eq(4, the_glyph->advance_);
+	mu_assert_int_eq(5, the_glyph->num_spans_);
+	mu_assert_int_eq(3, the_font->span_[the_glyph->first_span_].len_);
+	mu_assert_int_eq(0, Font_GetGlyph(the_font, ' ')->num_spans_);
+	mu_assert_int_eq(1, Font_GetGlyph(the_font, '.')->num_spans_);
+	
+	// characters the font doesn't have are drawn as its missing character
+	mu_check(Font_GetGlyph(the_font, 'a') == Font_GetGlyph(the_font, FONT_MISSING_CHAR));
+	
+	the_bitmap = Bitmap_NewWithFlags(40, 20, the_font, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_SetCurrentColor(the_bitmap, 9));
+	
+	// the top of the text is at y, and the pen is left at the end of the string
+	mu_check(Graphics_DrawString(the_bitmap, 2, 3, "A. a"));
+	mu_assert_int_eq(18, Bitmap_GetCurrentX(the_bitmap));
+	
+	for (num_set = 0, y = 0; y < 20; y++)
+	{
+		for (x = 0; x < 40; x++)
+		{
+			num_set += (Graphics_GetPixelAtXY(the_bitmap, x, y) != 0);
+		}
+	}
+	
+	mu_assert_int_eq(15 + 1 + 15, num_set);
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 2, 3));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 4, 7));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 5, 7));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 6, 7));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 6, 6));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 14, 3));
+	
+	// text running off the edges is clipped
+	mu_check(Graphics_FillMemory(the_bitmap, 0));
+	mu_check(Graphics_DrawString(the_bitmap, -2, 17, "AB"));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 0, 17));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 1, 17));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 2, 19));
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(Font_Destroy(&the_font));
+	mu_check(the_font == NULL);
+}
+
+
+MU_TEST(graphics_test_text_layout)
+{
+	Font*			the_font;
+	TextLayout*		the_layout;
+	Bitmap*			the_bitmap;
+	
+	the_font = test_new_font();
+	mu_check(the_font != NULL);
+	mu_assert_int_eq(12, Font_MeasureString(the_font, "A B", 3));
+	mu_assert_int_eq(4, Font_MeasureString(the_font, "A B", 1));
+	
+	// lines wrap at the last space that fits, and the space is dropped
+	the_layout = TextLayout_New(the_font, "AB CD EF", 20, 50, FONT_ALIGN_LEFT, PARAM_WRAP);
+	mu_check(the_layout != NULL);
+	mu_assert_int_eq(2, the_layout->num_lines_);
+	mu_assert_int_eq(0, the_layout->line_[0].start_);
+	mu_assert_int_eq(5, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(20, the_layout->line_[0].width_);
+	mu_assert_int_eq(6, the_layout->line_[1].start_);
+	mu_assert_int_eq(2, the_layout->line_[1].num_chars_);
+	mu_assert_int_eq(8, the_layout->line_[1].width_);
+	mu_check(the_layout->line_[1].ellipsis_ == false);
+	
+	// a word too long for a line is broken inside the word
+	mu_check(TextLayout_Update(the_layout, the_font, "ABCDEFG", 12, 50));
+	mu_assert_int_eq(3, the_layout->num_lines_);
+	mu_assert_int_eq(3, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(3, the_layout->line_[1].start_);
+	mu_assert_int_eq(1, the_layout->line_[2].num_chars_);
+	
+	// spaces before a wrap are trimmed, and line breaks always break, even on an empty line
+	mu_check(TextLayout_Update(the_layout, the_font, "AB  CD\n\nE", 12, 50));
+	mu_assert_int_eq(4, the_layout->num_lines_);
+	mu_assert_int_eq(2, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(8, the_layout->line_[0].width_);
+	mu_assert_int_eq(0, the_layout->line_[2].num_chars_);
+	mu_assert_int_eq(8, the_layout->line_[3].start_);
+	
+	// only as many lines as fit the height: the last one is cut short, with room left for the ellipsis
+	mu_check(TextLayout_Update(the_layout, the_font, "AB CD EF", 20, 9));
+	mu_assert_int_eq(1, the_layout->num_lines_);
+	mu_check(the_layout->line_[0].ellipsis_);
+	mu_assert_int_eq(2, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(20, the_layout->line_[0].width_);
+	
+	// a rectangle shorter than one line has no lines
+	mu_check(TextLayout_Update(the_layout, the_font, "AB", 20, 4));
+	mu_assert_int_eq(0, the_layout->num_lines_);
+	mu_check(TextLayout_Destroy(&the_layout));
+	
+	// without wrapping, lines too wide get an ellipsis; if even that doesn't fit, it's all there is
+	the_layout = TextLayout_New(the_font, "ABCDEFGH\nAB", 20, 50, FONT_ALIGN_RIGHT, PARAM_NO_WRAP);
+	mu_check(the_layout != NULL);
+	mu_assert_int_eq(2, the_layout->num_lines_);
+	mu_check(the_layout->line_[0].ellipsis_);
+	mu_assert_int_eq(2, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(20, the_layout->line_[0].width_);
+	mu_check(the_layout->line_[1].ellipsis_ == false);
+	mu_check(TextLayout_Update(the_layout, the_font, "ABCDEFGH\nAB", 8, 50));
+	mu_check(the_layout->line_[0].ellipsis_);
+	mu_assert_int_eq(0, the_layout->line_[0].num_chars_);
+	mu_assert_int_eq(12, the_layout->line_[0].width_);
+	
+	// right aligned lines end at the right edge of the rectangle
+	mu_check(TextLayout_Update(the_layout, the_font, "ABCDEFGH\nAB", 20, 50));
+	the_bitmap = Bitmap_NewWithFlags(40, 20, the_font, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_SetCurrentColor(the_bitmap, 9));
+	mu_check(Graphics_DrawLayout(the_bitmap, the_layout, 10, 0));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 10, 0));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 26, 9));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 25, 9));
+	mu_assert_int_eq(9, Graphics_GetPixelAtXY(the_bitmap, 22, 5));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 21, 5));
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(TextLayout_Destroy(&the_layout));
+	mu_check(Font_Destroy(&the_font));
+}
+
+
+MU_TEST(graphics_test_font_file)
+{
+	static const uint8_t	the_pairs[3 * FONT_KERN_PAIR_SIZE] = {'A', 'V', (uint8_t)-2, 0, 'L', 'T', (uint8_t)-3, 0, 'T', 'A', 1, 0};
+	static const uint8_t	the_unsorted[2 * FONT_KERN_PAIR_SIZE] = {'T', 'A', 1, 0, 'A', 'V', (uint8_t)-2, 0};
+	Font*		the_font;
+	Font*		the_loaded;
+	Bitmap*		the_bitmap;
+	Bitmap*		the_loaded_bitmap;
+	
+	the_font = test_new_font();
+	mu_check(the_font != NULL);
+	
+	// kerning pairs adjust the advance of the left character
+	mu_check(Font_SetKerning(the_font, the_unsorted, 2) == false);
+	mu_check(Font_SetKerning(the_font, the_pairs, 3));
+	mu_assert_int_eq(-2, Font_GetKerning(the_font, 'A', 'V'));
+	mu_assert_int_eq(-3, Font_GetKerning(the_font, 'L', 'T'));
+	mu_assert_int_eq(1, Font_GetKerning(the_font, 'T', 'A'));
+	mu_assert_int_eq(0, Font_GetKerning(the_font, 'V', 'A'));
+	mu_assert_int_eq(4 + 4 - 2 + 4, Font_MeasureString(the_font, "AVA", 3));
+	mu_assert_int_eq(4 + 1 + 4 - 2 + 4, Font_MeasureString(the_font, "TAV", 3));
+	
+	// a saved font loads back with the same glyphs and kerning
+	mu_check(Font_SaveToFile(the_font, TEST_FONT_PATH));
+	the_loaded = Font_LoadFromFile(TEST_FONT_PATH);
+	remove(TEST_FONT_PATH);
+	mu_check(the_loaded != NULL);
+	mu_assert_int_eq(the_font->first_char_, the_loaded->first_char_);
+	mu_assert_int_eq(the_font->last_char_, the_loaded->last_char_);
+	mu_assert_int_eq(the_font->height_, the_loaded->height_);
+	mu_assert_int_eq(the_font->ascent_, the_loaded->ascent_);
+	mu_assert_int_eq(3, the_loaded->num_kern_pairs_);
+	mu_assert_int_eq(-3, Font_GetKerning(the_loaded, 'L', 'T'));
+	mu_assert_int_eq(Font_MeasureString(the_font, "TAV LT", 6), Font_MeasureString(the_loaded, "TAV LT", 6));
+	
+	the_bitmap = Bitmap_NewWithFlags(40, 10, the_font, BITMAP_FLAG_STANDARD_RAM);
+	the_loaded_bitmap = Bitmap_NewWithFlags(40, 10, the_loaded, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL && the_loaded_bitmap != NULL);
+	mu_check(Bitmap_SetCurrentColor(the_bitmap, 3));
+	mu_check(Bitmap_SetCurrentColor(the_loaded_bitmap, 3));
+	mu_check(Graphics_DrawString(the_bitmap, 1, 1, "TAV. LT"));
+	mu_check(Graphics_DrawString(the_loaded_bitmap, 1, 1, "TAV. LT"));
+	mu_check(memcmp(the_bitmap->addr_, the_loaded_bitmap->addr_, 40 * 10) == 0);
+	
+	// data that isn't a font file is refused
+	mu_check(Font_NewFromMemory(test_font_strike, sizeof(test_font_strike)) == NULL);
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(Bitmap_Destroy(&the_loaded_bitmap));
+	mu_check(Font_Destroy(&the_loaded));
+	mu_check(Font_Destroy(&the_font));
+}
+
+
+MU_TEST(graphics_test_stroke_font)
+{
+	static const char* const	the_glyphs[3] = {"I[RFJ[ RRFZ[ RMTWT", NULL, "LXNLVL"};
+	static const char* const	the_bad_glyphs[1] = {"I[RFJ"};
+	StrokeFont*			the_font;
+	const StrokeGlyph*	the_glyph;
+	Bitmap*				the_bitmap;
+	unsigned long		the_bytes;
+	signed int			x;
+	signed int			num_set;
+	
+	mu_check(StrokeFont_New(the_bad_glyphs, 'A', 'A', -16, 16, STROKE_FONT_DEFAULT_BUDGET) == NULL);
+	the_font = StrokeFont_New(the_glyphs, 'A', 'C', -16, 16, STROKE_FONT_DEFAULT_BUDGET);
+	mu_check(the_font != NULL);
+	
+	// a line of text is 32 units tall, so at size 32 one unit is one pixel
+	mu_assert_int_eq(18 + 12, StrokeFont_MeasureString(the_font, 32, "AC", 2));
+	mu_assert_int_eq(9 + 6, StrokeFont_MeasureString(the_font, 16, "AC", 2));
+	mu_assert_int_eq(StrokeFont_MeasureString(the_font, 32, "A", 1), StrokeFont_MeasureString(the_font, 32, "B", 1));
+	
+	// each size of each glyph is rasterized once, then found in the cache
+	the_glyph = StrokeFont_GetGlyph(the_font, 'C', 32);
+	mu_check(the_glyph != NULL);
+	mu_assert_int_eq(9, the_glyph->width_);
+	mu_assert_int_eq(1, the_glyph->height_);
+	mu_assert_int_eq(2, the_glyph->x_);
+	mu_assert_int_eq(10, the_glyph->y_);
+	mu_assert_int_eq(12, the_glyph->advance_);
+	mu_assert_int_eq(1, the_font->cache_misses_);
+	mu_check(StrokeFont_GetGlyph(the_font, 'C', 32) == the_glyph);
+	mu_assert_int_eq(1, the_font->cache_hits_);
+	mu_check(StrokeFont_GetGlyph(the_font, 'C', 16) != NULL);
+	mu_check(StrokeFont_GetGlyph(the_font, 'A', 32) != NULL);
+	mu_assert_int_eq(3, the_font->cache_misses_);
+	mu_check(StrokeFont_GetGlyph(the_font, 'C', 0) == NULL);
+	
+	// shrinking the budget throws out all but the glyph used last
+	the_bytes = StrokeFont_GetGlyph(the_font, 'A', 32)->bytes_;
+	mu_check(StrokeFont_SetCacheBudget(the_font, 0));
+	mu_assert_int_eq(the_bytes, the_font->cache_used_);
+	mu_check(StrokeFont_GetGlyph(the_font, 'C', 32) != NULL);
+	mu_assert_int_eq(4, the_font->cache_misses_);
+	
+	// drawn text has its glyph lines where the glyph strings put them
+	the_bitmap = Bitmap_NewWithFlags(60, 40, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	mu_check(Bitmap_SetCurrentColor(the_bitmap, 4));
+	mu_check(Graphics_DrawStrokeString(the_bitmap, the_font, 32, 5, 3, "CC"));
+	
+	for (num_set = 0, x = 0; x < 60; x++)
+	{
+		num_set += (Graphics_GetPixelAtXY(the_bitmap, x, 13) != 0);
+	}
+	
+	mu_assert_int_eq(18, num_set);
+	mu_assert_int_eq(4, Graphics_GetPixelAtXY(the_bitmap, 7, 13));
+	mu_assert_int_eq(4, Graphics_GetPixelAtXY(the_bitmap, 15, 13));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 16, 13));
+	mu_assert_int_eq(4, Graphics_GetPixelAtXY(the_bitmap, 19, 13));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 7, 12));
+	mu_assert_int_eq(0, Graphics_GetPixelAtXY(the_bitmap, 7, 14));
+	
+	mu_check(Bitmap_Destroy(&the_bitmap));
+	mu_check(StrokeFont_Destroy(&the_font));
+	mu_check(the_font == NULL);
+}
+
+
+MU_TEST(graphics_test_display_list_merge)
+{
+	DisplayList*	the_list;
+	
+	the_list = DisplayList_New();
+	mu_check(the_list != NULL);
+	
+	// a box inside the one before it, in the same color, adds nothing
+	mu_check(DisplayList_FillBox(the_list, 10, 10, 20, 20, 1));
+	mu_check(DisplayList_FillBox(the_list, 12, 12, 5, 5, 1));
+	mu_check(DisplayList_FillBox(the_list, 10, 10, 20, 20, 1));
+	mu_assert_int_eq(1, the_list->num_commands_);
+	mu_assert_int_eq(20, the_list->command_[0].width_);
+	mu_assert_int_eq(20, the_list->command_[0].height_);
+	
+	// the same box in another color is a new command
+	mu_check(DisplayList_FillBox(the_list, 12, 12, 5, 5, 2));
+	mu_assert_int_eq(2, the_list->num_commands_);
+	
+	// boxes in the same columns, touching top to bottom, become one taller box, whichever is recorded first
+	mu_check(DisplayList_Clear(the_list));
+	mu_assert_int_eq(0, the_list->num_commands_);
+	mu_check(DisplayList_FillBox(the_list, 0, 10, 10, 5, 3));
+	mu_check(DisplayList_FillBox(the_list, 0, 15, 10, 5, 3));
+	mu_check(DisplayList_FillBox(the_list, 0, 2, 10, 8, 3));
+	mu_assert_int_eq(1, the_list->num_commands_);
+	mu_assert_int_eq(0, the_list->command_[0].x_);
+	mu_assert_int_eq(2, the_list->command_[0].y_);
+	mu_assert_int_eq(10, the_list->command_[0].width_);
+	mu_assert_int_eq(18, the_list->command_[0].height_);
+	
+	// likewise side to side, for boxes in the same rows
+	mu_check(DisplayList_Clear(the_list));
+	mu_check(DisplayList_FillBox(the_list, 20, 0, 5, 10, 3));
+	mu_check(DisplayList_FillBox(the_list, 25, 0, 5, 10, 3));
+	mu_check(DisplayList_FillBox(the_list, 17, 0, 5, 10, 3));
+	mu_assert_int_eq(1, the_list->num_commands_);
+	mu_assert_int_eq(17, the_list->command_[0].x_);
+	mu_assert_int_eq(13, the_list->command_[0].width_);
+	mu_assert_int_eq(10, the_list->command_[0].height_);
+	
+	// a gap, or a different height, keeps them apart
+	mu_check(DisplayList_FillBox(the_list, 31, 0, 5, 10, 3));
+	mu_check(DisplayList_FillBox(the_list, 36, 0, 5, 9, 3));
+	mu_assert_int_eq(3, the_list->num_commands_);
+	
+	// a horizontal line continuing the one before it is merged too
+	mu_check(DisplayList_Clear(the_list));
+	mu_check(DisplayList_DrawHLine(the_list, 0, 40, 10, 4));
+	mu_check(DisplayList_DrawHLine(the_list, 10, 40, 10, 4));
+	mu_assert_int_eq(1, the_list->num_commands_);
+	mu_assert_int_eq(20, the_list->command_[0].width_);
+	mu_assert_int_eq(0, the_list->bounds_.MinX);
+	mu_assert_int_eq(19, the_list->bounds_.MaxX);
+	
+	mu_check(DisplayList_FillBox(the_list, 0, 0, 0, 10, 4) == false);
+	mu_check(DisplayList_FillBox(the_list, DISPLAY_LIST_MAX_COORD, 0, 2, 10, 4) == false);
+	
+	mu_check(DisplayList_Destroy(&the_list));
+	mu_check(the_list == NULL);
+}
+
+
+MU_TEST(graphics_test_display_list_replay)
+{
+	DisplayList*	the_list;
+	Bitmap*			the_source;
+	Bitmap*			the_direct;
+	Bitmap*			the_replay;
+	signed int		i;
+	
+	the_list = DisplayList_New();
+	the_source = Bitmap_NewWithFlags(16, 10, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_direct = Bitmap_NewWithFlags(160, 120, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_replay = Bitmap_NewWithFlags(160, 120, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_list != NULL && the_source != NULL && the_direct != NULL && the_replay != NULL);
+	
+	for (i = 0; i < 16 * 10; i++)
+	{
+		the_source->addr_[i] = (uint8_t)(i | 0x80);
+	}
+	
+	mu_check(test_record_scene(the_list, the_source));
+	
+	// replaying the list draws exactly what drawing directly does, wherever it is drawn
+	mu_check(DisplayList_Replay(the_list, the_replay, 0, 0));
+	mu_check(test_draw_scene(the_direct, the_source, 0, 0));
+	mu_check(memcmp(the_replay->addr_, the_direct->addr_, 160 * 120) == 0);
+	
+	mu_check(Graphics_FillMemory(the_direct, 0));
+	mu_check(Graphics_FillMemory(the_replay, 0));
+	mu_check(DisplayList_Replay(the_list, the_replay, 6, 4));
+	mu_check(test_draw_scene(the_direct, the_source, 6, 4));
+	mu_check(memcmp(the_replay->addr_, the_direct->addr_, 160 * 120) == 0);
+	
+	// drawn partly off the bitmap, the list is clipped, not refused
+	mu_check(DisplayList_Replay(the_list, the_replay, -100, -50));
+	
+	mu_check(DisplayList_Destroy(&the_list));
+	mu_check(Bitmap_Destroy(&the_source));
+	mu_check(Bitmap_Destroy(&the_direct));
+	mu_check(Bitmap_Destroy(&the_replay));
+}
+
+
+MU_TEST(graphics_test_tile_renderer)
+{
+	TileRenderer*	the_renderer;
+	DisplayList*	the_list;
+	Bitmap*			the_source;
+	Bitmap*			the_direct;
+	Bitmap*			the_tiled;
+	signed int		the_workers;
+	signed int		i;
+	
+	// not a whole number of tiles in either direction
+	the_list = DisplayList_New();
+	the_source = Bitmap_NewWithFlags(16, 10, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_direct = Bitmap_NewWithFlags(160, 120, NULL, BITMAP_FLAG_STANDARD_RAM);
+	the_tiled = Bitmap_NewWithFlags(160, 120, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_list != NULL && the_source != NULL && the_direct != NULL && the_tiled != NULL);
+	
+	for (i = 0; i < 16 * 10; i++)
+	{
+		the_source->addr_[i] = (uint8_t)(i | 0x80);
+	}
+	
+	mu_check(test_record_scene(the_list, the_source));
+	mu_check(test_draw_scene(the_direct, the_source, 6, 4));
+	
+	// tile by tile, on 1 thread or several, the renderer draws exactly what drawing directly does
+	for (the_workers = 1; the_workers <= 4; the_workers += 3)
+	{
+		the_renderer = TileRenderer_New(the_workers);
+		mu_check(the_renderer != NULL);
+		mu_check(Graphics_FillMemory(the_tiled, 0));
+		mu_check(TileRenderer_Render(the_renderer, the_list, the_tiled, 6, 4));
+		mu_check(memcmp(the_tiled->addr_, the_direct->addr_, 160 * 120) == 0);
+		
+		// and again, reusing the bins it has already allocated
+		mu_check(Graphics_FillMemory(the_tiled, 0));
+		mu_check(TileRenderer_Render(the_renderer, the_list, the_tiled, 6, 4));
+		mu_check(memcmp(the_tiled->addr_, the_direct->addr_, 160 * 120) == 0);
+		
+		mu_check(TileRenderer_Destroy(&the_renderer));
+		mu_check(the_renderer == NULL);
+	}
+	
+	mu_check(DisplayList_Destroy(&the_list));
+	mu_check(Bitmap_Destroy(&the_source));
+	mu_check(Bitmap_Destroy(&the_direct));
+	mu_check(Bitmap_Destroy(&the_tiled));
+}
+
+
+#if defined(__linux__)
+MU_TEST(graphics_test_worker_pool_fill)
+{
+	Bitmap*		the_bitmap;
+	signed int	the_pass;
+	signed int	i;
+	signed int	num_bad;
+	
+	// big enough that the fill is split across the workers
+	the_bitmap = Bitmap_NewWithFlags(400, 300, NULL, BITMAP_FLAG_STANDARD_RAM);
+	mu_check(the_bitmap != NULL);
+	
+	// starting a new pool and using it right away must not hang or skip rows
+	for (the_pass = 1; the_pass <= 8; the_pass++)
+	{
+		mu_check(Graphics_SetWorkerThreads(4));
+		mu_check(Graphics_FillMemory(the_bitmap, the_pass));
+		
+		for (num_bad = 0, i = 0; i < 400 * 300; i++)
+		{
+			if (the_bitmap->addr_[i] != the_pass)
+			{
+				num_bad++;
+			}
+		}
+		
+		mu_assert_int_eq(0, num_bad);
+	}
+	
+	mu_check(Graphics_SetWorkerThreads(1));
+	mu_check(Bitmap_Destroy(&the_bitmap));
+}
+#endif
+
+
+
 	// speed tests
 MU_TEST_SUITE(text_test_suite_speed)
 {	
@@ -140,7 +2176,37 @@ MU_TEST_SUITE(text_test_suite_units)
 {	
 	MU_SUITE_CONFIGURE(&text_test_setup, &text_test_teardown);
 	
-// 	MU_RUN_TEST(font_replace_test);
+	MU_RUN_TEST(graphics_test_lazy_clear_bands);
+	MU_RUN_TEST(graphics_test_uninitialized_bitmap);
+	MU_RUN_TEST(graphics_test_standard_ram_blit);
+	MU_RUN_TEST(graphics_test_double_buffer_flip);
+	MU_RUN_TEST(graphics_test_snapshot_restore);
+	MU_RUN_TEST(graphics_test_tiled_bitmap_draw);
+	MU_RUN_TEST(graphics_test_raw_file_map);
+	MU_RUN_TEST(graphics_test_bmp_load);
+	MU_RUN_TEST(graphics_test_asset_pack_lz);
+	MU_RUN_TEST(graphics_test_asset_pack_region);
+	MU_RUN_TEST(graphics_test_save_round_trip);
+	MU_RUN_TEST(graphics_test_progressive_load);
+	MU_RUN_TEST(graphics_test_gif_decode);
+	MU_RUN_TEST(graphics_test_palette_cycle);
+	MU_RUN_TEST(graphics_test_palette_fade);
+	MU_RUN_TEST(graphics_test_remap_tables);
+	MU_RUN_TEST(graphics_test_fill_box_exact);
+	MU_RUN_TEST(graphics_test_blend_tables);
+	MU_RUN_TEST(graphics_test_inverse_map);
+	MU_RUN_TEST(graphics_test_import_dither);
+	MU_RUN_TEST(graphics_test_quantizer);
+	MU_RUN_TEST(graphics_test_font_draw);
+	MU_RUN_TEST(graphics_test_text_layout);
+	MU_RUN_TEST(graphics_test_font_file);
+	MU_RUN_TEST(graphics_test_stroke_font);
+	MU_RUN_TEST(graphics_test_display_list_merge);
+	MU_RUN_TEST(graphics_test_display_list_replay);
+	MU_RUN_TEST(graphics_test_tile_renderer);
+#if defined(__linux__)
+	MU_RUN_TEST(graphics_test_worker_pool_fill);
+#endif
 }
 
 
@@ -176,9 +2242,9 @@ int main(int argc, char* argv[])
 	
 
 	#if defined(RUN_TESTS)
-// 		MU_RUN_SUITE(text_test_suite_units);
+		MU_RUN_SUITE(text_test_suite_units);
 // 		MU_RUN_SUITE(text_test_suite_speed);
-// 		MU_REPORT();
+		MU_REPORT();
 		return MU_EXIT_CODE;
 	#endif
 
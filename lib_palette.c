@@ -0,0 +1,2474 @@
+/*
+ * lib_palette.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_palette.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+#define PALETTE_JASC_MAGIC			"JASC-PAL"
+#define PALETTE_FILE_MAX_BYTES		4096	//!< largest palette file Palette_LoadFromFile will read. A full JASC-PAL file is under 3.5KB.
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+static PaletteBlendTable	global_blend_cache[PALETTE_BLEND_CACHE_SIZE];
+static unsigned long		global_blend_clock = 0;
+static unsigned long		global_lut_generation = 0;	//!< incremented every time this library writes to any LUT, so inverse color maps know to check theirs
+
+static const uint8_t		global_bayer_matrix[16] =	//!< 4x4 ordered dither pattern: each value from 0 to 15 appears once, spread as evenly as possible
+{
+	 0,  8,  2, 10,
+	12,  4, 14,  6,
+	 3, 11,  1,  9,
+	15,  7, 13,  5,
+};
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// get the address of a screen's graphics LUT
+volatile uint8_t* Palette_GetLUTAddress(Screen* the_screen);
+
+// write the_count entries of a palette, starting with the_source, to the LUT, starting at the_first_entry
+void Palette_WriteEntries(volatile uint8_t* the_lut, uint8_t the_first_entry, const uint8_t* the_source, signed int the_count);
+
+// write a range of a palette cycler to the LUT, rotated as it currently is
+void Palette_WriteCycle(PaletteCycler* the_cycler, PaletteCycle* the_cycle);
+
+// get the next number from a JASC-PAL text file, and move past it
+boolean Palette_ParseNumber(const char** the_text, const char* the_end, signed int* the_number);
+
+// convert the text of a JASC-PAL file into a palette
+boolean Palette_ParseJASC(const char* the_text, const char* the_end, uint8_t* the_palette);
+
+// sort the palette of an inverse color map by green, and forget every cell searched so far
+void Palette_ResetInverseMap(PaletteInverseMap* the_map);
+
+// find the closest palette entry to a color, searching outward from the entries with the closest green
+uint8_t Palette_SearchInverseMap(PaletteInverseMap* the_map, signed int r, signed int g, signed int b);
+
+// for an inverse color map that follows a screen, start over if the screen's LUT has changed since the map last looked
+void Palette_CheckInverseMap(PaletteInverseMap* the_map);
+
+// get the closest palette entry to a color from its cell, searching the cell first if it hasn't been yet
+uint8_t Palette_LookupCell(PaletteInverseMap* the_map, uint8_t r, uint8_t g, uint8_t b);
+
+// get the byte offsets of R, G, and B within a pixel of a palette_pixel_format, and the size of the pixel
+boolean Palette_GetPixelLayout(uint8_t the_format, signed int* r_offset, signed int* g_offset, signed int* b_offset, signed int* pixel_bytes);
+
+// convert a row of truecolor pixels with no dithering or ordered dithering. the_dest receives the columns from left_ to right_, or can be NULL.
+void Palette_ImportRowOrdered(PaletteImporter* the_importer, const uint8_t* the_pixels, uint8_t* the_dest);
+
+// convert a row of truecolor pixels with Floyd-Steinberg error diffusion. the_dest receives the columns from left_ to right_, or can be NULL.
+void Palette_ImportRowDiffused(PaletteImporter* the_importer, const uint8_t* the_pixels, uint8_t* the_dest);
+
+// halve every count in a palette quantizer's histogram, keeping colors that have any pixels at 1 or more
+void Palette_HalveHistogram(PaletteQuantizer* the_quantizer);
+
+// shrink a box of color cells to the cells in it that have any pixels, and count its pixels
+void Palette_ShrinkQuantizeBox(const uint32_t* the_histogram, PaletteQuantizeBox* the_box);
+
+// split a box of color cells at the median of its longest side. the_box keeps the lower half, and the_new_box gets the upper half.
+boolean Palette_SplitQuantizeBox(const uint32_t* the_histogram, PaletteQuantizeBox* the_box, PaletteQuantizeBox* the_new_box);
+
+// fill in a blend table for a palette and opacity
+boolean Palette_BuildBlendTable(const uint8_t* the_palette, signed int the_opacity, uint8_t* the_table);
+
+//! \endcond
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Get the address of a screen's graphics LUT
+volatile uint8_t* Palette_GetLUTAddress(Screen* the_screen)
+{
+	return (volatile uint8_t*)&R32(the_screen->vicky_ + VICKY_GRAPHICS_LUT0_L);
+}
+
+
+//! Write the_count entries of a palette, starting with the_source, to the LUT, starting at the_first_entry
+//! Each entry is 4 bytes, so when the source is long-aligned, every entry goes to the LUT in a single 32-bit write.
+void Palette_WriteEntries(volatile uint8_t* the_lut, uint8_t the_first_entry, const uint8_t* the_source, signed int the_count)
+{
+	volatile uint32_t*	the_lut_long;
+	const uint32_t*		the_source_long;
+	volatile uint8_t*	the_lut_byte;
+	signed int			i;
+
+	global_lut_generation++;
+
+	if (((unsigned long)the_source & 0x03) == 0)
+	{
+		the_lut_long = (volatile uint32_t*)(the_lut + the_first_entry * 4);
+		the_source_long = (const uint32_t*)the_source;
+
+		for (i = 0; i < the_count; i++)
+		{
+			the_lut_long[i] = the_source_long[i];
+		}
+
+		return;
+	}
+
+	the_lut_byte = the_lut + the_first_entry * 4;
+	the_count *= 4;
+
+	for (i = 0; i < the_count; i++)
+	{
+		the_lut_byte[i] = the_source[i];
+	}
+}
+
+
+//! Write a range of a palette cycler to the LUT, rotated as it currently is
+void Palette_WriteCycle(PaletteCycler* the_cycler, PaletteCycle* the_cycle)
+{
+	volatile uint8_t*	the_lut;
+	signed int			the_len;
+	signed int			the_offset;
+
+	the_lut = Palette_GetLUTAddress(the_cycler->screen_);
+	the_len = the_cycle->last_ - the_cycle->first_ + 1;
+	the_offset = the_cycle->offset_;
+
+	// LOGIC:
+	//   rotated up by offset, entry first + i shows color first + (i - offset) mod len. that's 2 unbroken runs of the palette:
+	//   the last offset colors of the range go to the first offset entries, and the rest follow them.
+
+	if (the_offset > 0)
+	{
+		Palette_WriteEntries(the_lut, the_cycle->first_, &the_cycler->palette_[(the_cycle->last_ - the_offset + 1) * 4], the_offset);
+	}
+
+	Palette_WriteEntries(the_lut, the_cycle->first_ + the_offset, &the_cycler->palette_[the_cycle->first_ * 4], the_len - the_offset);
+}
+
+
+//! Get the next number from a JASC-PAL text file, and move past it
+//! @return	returns false if the text ran out before a number was found
+boolean Palette_ParseNumber(const char** the_text, const char* the_end, signed int* the_number)
+{
+	const char*		the_char = *the_text;
+
+	while (the_char < the_end && (*the_char < '0' || *the_char > '9'))
+	{
+		the_char++;
+	}
+
+	if (the_char == the_end)
+	{
+		return false;
+	}
+
+	*the_number = 0;
+
+	while (the_char < the_end && *the_char >= '0' && *the_char <= '9')
+	{
+		*the_number = *the_number * 10 + (*the_char - '0');
+		the_char++;
+	}
+
+	*the_text = the_char;
+
+	return true;
+}
+
+
+//! Convert the text of a JASC-PAL file into a palette
+//! The format is a line with "JASC-PAL", a version line ("0100"), a line with the number of colors, then one "R G B" line per color.
+boolean Palette_ParseJASC(const char* the_text, const char* the_end, uint8_t* the_palette)
+{
+	signed int		the_version;
+	signed int		the_count;
+	signed int		the_rgb[3];
+	signed int		i;
+	signed int		j;
+
+	the_text += strlen(PALETTE_JASC_MAGIC);
+
+	if (!Palette_ParseNumber(&the_text, the_end, &the_version) || !Palette_ParseNumber(&the_text, the_end, &the_count))
+	{
+		return false;
+	}
+
+	if (the_count > PALETTE_NUM_ENTRIES)
+	{
+		LOG_WARN(("%s %d: palette has %i colors; only the first %i will be used", __func__, __LINE__, the_count, PALETTE_NUM_ENTRIES));
+		the_count = PALETTE_NUM_ENTRIES;
+	}
+
+	for (i = 0; i < the_count; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			if (!Palette_ParseNumber(&the_text, the_end, &the_rgb[j]))
+			{
+				return false;
+			}
+		}
+
+		the_palette[i * 4] = the_rgb[2];
+		the_palette[i * 4 + 1] = the_rgb[1];
+		the_palette[i * 4 + 2] = the_rgb[0];
+		the_palette[i * 4 + 3] = 0xFF;
+	}
+
+	return true;
+}
+
+
+//! Sort the palette of an inverse color map by green, and forget every cell searched so far
+void Palette_ResetInverseMap(PaletteInverseMap* the_map)
+{
+	signed int		the_count[PALETTE_NUM_ENTRIES];
+	signed int		the_green;
+	signed int		the_pos;
+	signed int		i;
+
+	memset(the_map->found_, 0, (1L << (the_map->bits_ * 3)) / 8);
+
+	// counting sort: entries with the same green stay in index order, so ties in the search go to the lowest index, as they do in Palette_FindNearestColor
+	memset(the_count, 0, sizeof(the_count));
+
+	for (i = 0; i < PALETTE_NUM_ENTRIES; i++)
+	{
+		the_count[the_map->palette_[i * 4 + 1]]++;
+	}
+
+	for (i = 0, the_pos = 0; i < PALETTE_NUM_ENTRIES; i++)
+	{
+		the_green = the_count[i];
+		the_count[i] = the_pos;
+		the_pos += the_green;
+	}
+
+	for (i = 0; i < PALETTE_NUM_ENTRIES; i++)
+	{
+		the_green = the_map->palette_[i * 4 + 1];
+		the_pos = the_count[the_green]++;
+		the_map->sorted_index_[the_pos] = i;
+		the_map->sorted_green_[the_pos] = the_green;
+	}
+}
+
+
+//! Find the closest palette entry to a color, searching outward from the entries with the closest green
+//! Gives the same answer as Palette_FindNearestColor(), usually after checking only a small fraction of the palette.
+uint8_t Palette_SearchInverseMap(PaletteInverseMap* the_map, signed int r, signed int g, signed int b)
+{
+	const uint8_t*	the_entry;
+	signed long		the_distance;
+	signed long		best_distance = 0x7FFFFFFF;
+	signed long		green_distance;
+	signed int		the_diff;
+	signed int		the_index;
+	signed int		best_index = PALETTE_NUM_ENTRIES;
+	signed int		low;
+	signed int		high;
+	signed int		the_pos;
+	boolean			low_done = false;
+	boolean			high_done = false;
+
+	// LOGIC:
+	//   an entry's distance is at least its green difference squared. with the entries sorted by green, the search starts where the color's green would go,
+	//   and walks out in both directions. each direction stops once its green difference alone is further than the best match so far:
+	//   every entry beyond that point is further still.
+
+	low = 0;
+	high = PALETTE_NUM_ENTRIES;
+
+	while (low < high)
+	{
+		the_pos = (low + high) / 2;
+
+		if (the_map->sorted_green_[the_pos] < g)
+		{
+			low = the_pos + 1;
+		}
+		else
+		{
+			high = the_pos;
+		}
+	}
+
+	high = low;
+	low = low - 1;
+
+	while (!low_done || !high_done)
+	{
+		if (!high_done)
+		{
+			if (high >= PALETTE_NUM_ENTRIES)
+			{
+				high_done = true;
+			}
+			else
+			{
+				the_diff = the_map->sorted_green_[high] - g;
+				green_distance = (signed long)the_diff * the_diff;
+
+				if (green_distance > best_distance)
+				{
+					high_done = true;
+				}
+				else
+				{
+					the_index = the_map->sorted_index_[high++];
+					the_entry = &the_map->palette_[the_index * 4];
+					the_diff = the_entry[2] - r;
+					the_distance = green_distance + (signed long)the_diff * the_diff;
+					the_diff = the_entry[0] - b;
+					the_distance += (signed long)the_diff * the_diff;
+
+					if (the_distance < best_distance || (the_distance == best_distance && the_index < best_index))
+					{
+						best_distance = the_distance;
+						best_index = the_index;
+					}
+				}
+			}
+		}
+
+		if (!low_done)
+		{
+			if (low < 0)
+			{
+				low_done = true;
+			}
+			else
+			{
+				the_diff = the_map->sorted_green_[low] - g;
+				green_distance = (signed long)the_diff * the_diff;
+
+				if (green_distance > best_distance)
+				{
+					low_done = true;
+				}
+				else
+				{
+					the_index = the_map->sorted_index_[low--];
+					the_entry = &the_map->palette_[the_index * 4];
+					the_diff = the_entry[2] - r;
+					the_distance = green_distance + (signed long)the_diff * the_diff;
+					the_diff = the_entry[0] - b;
+					the_distance += (signed long)the_diff * the_diff;
+
+					if (the_distance < best_distance || (the_distance == best_distance && the_index < best_index))
+					{
+						best_distance = the_distance;
+						best_index = the_index;
+					}
+				}
+			}
+		}
+	}
+
+	return best_index;
+}
+
+
+//! For an inverse color map that follows a screen, start over if the screen's LUT has changed since the map last looked
+void Palette_CheckInverseMap(PaletteInverseMap* the_map)
+{
+	volatile uint8_t*	the_lut;
+	signed int			i;
+	boolean				changed = false;
+
+	if (the_map->screen_ == NULL || the_map->generation_ == global_lut_generation)
+	{
+		return;
+	}
+
+	the_map->generation_ = global_lut_generation;
+	the_lut = Palette_GetLUTAddress(the_map->screen_);
+
+	// the LUT may have been rewritten with the same colors (a fade that has finished, or a different screen's LUT), so compare before starting over
+	for (i = 0; i < BITMAP_PALETTE_BYTES; i++)
+	{
+		if (the_map->palette_[i] != the_lut[i])
+		{
+			the_map->palette_[i] = the_lut[i];
+			changed = true;
+		}
+	}
+
+	if (changed)
+	{
+		Palette_ResetInverseMap(the_map);
+	}
+}
+
+
+//! Get the closest palette entry to a color from its cell, searching the cell first if it hasn't been yet
+uint8_t Palette_LookupCell(PaletteInverseMap* the_map, uint8_t r, uint8_t g, uint8_t b)
+{
+	signed int		the_shift;
+	signed long		the_cell;
+	signed int		the_half;
+
+	the_shift = 8 - the_map->bits_;
+	the_cell = ((signed long)(r >> the_shift) << (the_map->bits_ * 2)) | ((g >> the_shift) << the_map->bits_) | (b >> the_shift);
+
+	if ((the_map->found_[the_cell >> 3] & (1 << (the_cell & 0x07))) == 0)
+	{
+		the_half = 1 << (the_shift - 1);
+		the_map->cell_[the_cell] = Palette_SearchInverseMap(the_map, ((r >> the_shift) << the_shift) | the_half, ((g >> the_shift) << the_shift) | the_half, ((b >> the_shift) << the_shift) | the_half);
+		the_map->found_[the_cell >> 3] |= (1 << (the_cell & 0x07));
+	}
+
+	return the_map->cell_[the_cell];
+}
+
+
+//! Get the byte offsets of R, G, and B within a pixel of a palette_pixel_format, and the size of the pixel
+//! The outputs are always set: for an invalid format, to the PALETTE_PIXEL_RGB24 layout.
+//! @return	returns false if the format is not valid
+boolean Palette_GetPixelLayout(uint8_t the_format, signed int* r_offset, signed int* g_offset, signed int* b_offset, signed int* pixel_bytes)
+{
+	*r_offset = 0;
+	*g_offset = 1;
+	*b_offset = 2;
+	*pixel_bytes = 3;
+
+	if (the_format == PALETTE_PIXEL_RGBA32)
+	{
+		*pixel_bytes = 4;
+	}
+	else if (the_format == PALETTE_PIXEL_BGRA32)
+	{
+		*r_offset = 2;
+		*b_offset = 0;
+		*pixel_bytes = 4;
+	}
+	else if (the_format != PALETTE_PIXEL_RGB24)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+//! Convert a row of truecolor pixels with no dithering or ordered dithering
+//! @param	the_dest: receives the columns from left_ to right_. Never NULL: rows outside the bitmap don't need converting, as they affect no other row.
+void Palette_ImportRowOrdered(PaletteImporter* the_importer, const uint8_t* the_pixels, uint8_t* the_dest)
+{
+	const uint8_t*	the_pattern;
+	signed int		the_offset[4];
+	signed int		r_offset;
+	signed int		g_offset;
+	signed int		b_offset;
+	signed int		pixel_bytes;
+	signed int		x;
+	signed int		the_add;
+	signed int		r;
+	signed int		g;
+	signed int		b;
+
+	Palette_GetPixelLayout(the_importer->format_, &r_offset, &g_offset, &b_offset, &pixel_bytes);
+	the_pixels += the_importer->left_ * pixel_bytes;
+
+	if (the_importer->dither_ == PALETTE_DITHER_NONE)
+	{
+		for (x = the_importer->left_; x < the_importer->right_; x++, the_pixels += pixel_bytes)
+		{
+			*the_dest++ = Palette_LookupCell(the_importer->map_, the_pixels[r_offset], the_pixels[g_offset], the_pixels[b_offset]);
+		}
+
+		return;
+	}
+
+	// LOGIC:
+	//   the pattern is tied to bitmap coordinates, not image coordinates, so images loaded side by side dither seamlessly.
+	//   the 4 offsets for this row are worked out once: from about -PALETTE_DITHER_SPREAD / 2 to +PALETTE_DITHER_SPREAD / 2, averaging 0.
+
+	the_pattern = &global_bayer_matrix[((the_importer->y_ + the_importer->row_) & 0x03) * 4];
+
+	for (x = 0; x < 4; x++)
+	{
+		the_offset[x] = ((signed int)the_pattern[x] * 2 - 15) * PALETTE_DITHER_SPREAD / 32;
+	}
+
+	for (x = the_importer->left_; x < the_importer->right_; x++, the_pixels += pixel_bytes)
+	{
+		the_add = the_offset[(the_importer->x_ + x) & 0x03];
+		r = the_pixels[r_offset] + the_add;
+		g = the_pixels[g_offset] + the_add;
+		b = the_pixels[b_offset] + the_add;
+		r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+		g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+		b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+		*the_dest++ = Palette_LookupCell(the_importer->map_, r, g, b);
+	}
+}
+
+
+//! Convert a row of truecolor pixels with Floyd-Steinberg error diffusion
+//! @param	the_dest: receives the columns from left_ to right_, or NULL for rows above the bitmap, whose errors are still needed by the rows below
+void Palette_ImportRowDiffused(PaletteImporter* the_importer, const uint8_t* the_pixels, uint8_t* the_dest)
+{
+	const uint8_t*	the_entry;
+	signed short*	this_error;
+	signed short*	next_error;
+	signed short*	the_swap;
+	signed int		r_offset;
+	signed int		g_offset;
+	signed int		b_offset;
+	signed int		pixel_bytes;
+	signed int		x;
+	signed int		c;
+	signed int		the_value[3];
+	signed int		the_diff;
+	uint8_t			the_index;
+
+	// LOGIC:
+	//   errors are kept x 16, so the 7/16, 3/16, 5/16, and 1/16 shares need no division until they are added to a pixel.
+	//   each error row has a spare pixel at each end, so the shares of the first and last pixels can be spread without checking for the edge.
+	//   the largest error for a channel is 255, so even with all 4 shares landing on one pixel, the total fits in a signed short.
+	//   every column is converted, even those outside the bitmap, so the errors spread the same way however the image is clipped.
+
+	Palette_GetPixelLayout(the_importer->format_, &r_offset, &g_offset, &b_offset, &pixel_bytes);
+
+	this_error = the_importer->this_error_ + 3;
+	next_error = the_importer->next_error_ + 3;
+	memset(the_importer->next_error_, 0, (the_importer->width_ + 2) * 3 * sizeof(signed short));
+
+	if (the_dest)
+	{
+		the_dest -= the_importer->left_;
+	}
+
+	for (x = 0; x < the_importer->width_; x++, the_pixels += pixel_bytes, this_error += 3, next_error += 3)
+	{
+		the_value[0] = the_pixels[b_offset] + this_error[0] / 16;
+		the_value[1] = the_pixels[g_offset] + this_error[1] / 16;
+		the_value[2] = the_pixels[r_offset] + this_error[2] / 16;
+
+		for (c = 0; c < 3; c++)
+		{
+			the_value[c] = (the_value[c] < 0) ? 0 : (the_value[c] > 255) ? 255 : the_value[c];
+		}
+
+		the_index = Palette_LookupCell(the_importer->map_, the_value[2], the_value[1], the_value[0]);
+		the_entry = &the_importer->map_->palette_[the_index * 4];
+
+		// the error channels are in LUT order, B, G, R, so they line up with the palette entry
+		for (c = 0; c < 3; c++)
+		{
+			the_diff = the_value[c] - the_entry[c];
+			this_error[c + 3] += the_diff * 7;
+			next_error[c - 3] += the_diff * 3;
+			next_error[c] += the_diff * 5;
+			next_error[c + 3] += the_diff;
+		}
+
+		if (the_dest && x >= the_importer->left_ && x < the_importer->right_)
+		{
+			the_dest[x] = the_index;
+		}
+	}
+
+	the_swap = the_importer->this_error_;
+	the_importer->this_error_ = the_importer->next_error_;
+	the_importer->next_error_ = the_swap;
+}
+
+
+//! Halve every count in a palette quantizer's histogram, keeping colors that have any pixels at 1 or more
+void Palette_HalveHistogram(PaletteQuantizer* the_quantizer)
+{
+	uint32_t*	the_count = the_quantizer->histogram_;
+	long		i;
+
+	the_quantizer->num_pixels_ = 0;
+
+	for (i = 0; i < PALETTE_QUANTIZE_CELLS; i++, the_count++)
+	{
+		*the_count = (*the_count + 1) / 2;
+		the_quantizer->num_pixels_ += *the_count;
+	}
+}
+
+
+//! Shrink a box of color cells to the cells in it that have any pixels, and count its pixels
+void Palette_ShrinkQuantizeBox(const uint32_t* the_histogram, PaletteQuantizeBox* the_box)
+{
+	uint8_t			the_min[3] = {255, 255, 255};
+	uint8_t			the_max[3] = {0, 0, 0};
+	uint32_t		the_count;
+	signed int		r;
+	signed int		g;
+	signed int		b;
+
+	the_box->count_ = 0;
+
+	for (r = the_box->min_[0]; r <= the_box->max_[0]; r++)
+	{
+		for (g = the_box->min_[1]; g <= the_box->max_[1]; g++)
+		{
+			for (b = the_box->min_[2]; b <= the_box->max_[2]; b++)
+			{
+				if ((the_count = the_histogram[(r << (PALETTE_QUANTIZE_BITS * 2)) | (g << PALETTE_QUANTIZE_BITS) | b]) == 0)
+				{
+					continue;
+				}
+
+				the_box->count_ += the_count;
+				the_min[0] = (r < the_min[0]) ? r : the_min[0];
+				the_max[0] = (r > the_max[0]) ? r : the_max[0];
+				the_min[1] = (g < the_min[1]) ? g : the_min[1];
+				the_max[1] = (g > the_max[1]) ? g : the_max[1];
+				the_min[2] = (b < the_min[2]) ? b : the_min[2];
+				the_max[2] = (b > the_max[2]) ? b : the_max[2];
+			}
+		}
+	}
+
+	if (the_box->count_ > 0)
+	{
+		memcpy(the_box->min_, the_min, 3);
+		memcpy(the_box->max_, the_max, 3);
+	}
+}
+
+
+//! Split a box of color cells at the median of its longest side. the_box keeps the lower half, and the_new_box gets the upper half.
+//! @return	returns false if the box is a single cell, and can't be split
+boolean Palette_SplitQuantizeBox(const uint32_t* the_histogram, PaletteQuantizeBox* the_box, PaletteQuantizeBox* the_new_box)
+{
+	unsigned long	the_sum[1 << PALETTE_QUANTIZE_BITS];
+	unsigned long	the_total;
+	signed int		the_axis = 0;
+	signed int		the_split;
+	signed int		the_cell[3];
+	signed int		i;
+
+	for (i = 1; i < 3; i++)
+	{
+		if (the_box->max_[i] - the_box->min_[i] > the_box->max_[the_axis] - the_box->min_[the_axis])
+		{
+			the_axis = i;
+		}
+	}
+
+	if (the_box->max_[the_axis] == the_box->min_[the_axis])
+	{
+		return false;
+	}
+
+	// LOGIC:
+	//   count the box's pixels in each slice along its longest side, then split after the slice where the count passes half of the box's pixels.
+	//   the split is kept short of the last slice, so both halves have pixels: the box was shrunk, so its first and last slices are never empty.
+
+	memset(the_sum, 0, sizeof(the_sum));
+
+	for (the_cell[0] = the_box->min_[0]; the_cell[0] <= the_box->max_[0]; the_cell[0]++)
+	{
+		for (the_cell[1] = the_box->min_[1]; the_cell[1] <= the_box->max_[1]; the_cell[1]++)
+		{
+			for (the_cell[2] = the_box->min_[2]; the_cell[2] <= the_box->max_[2]; the_cell[2]++)
+			{
+				the_sum[the_cell[the_axis]] += the_histogram[(the_cell[0] << (PALETTE_QUANTIZE_BITS * 2)) | (the_cell[1] << PALETTE_QUANTIZE_BITS) | the_cell[2]];
+			}
+		}
+	}
+
+	the_total = 0;
+
+	for (the_split = the_box->min_[the_axis]; the_split < the_box->max_[the_axis] - 1; the_split++)
+	{
+		the_total += the_sum[the_split];
+
+		if (the_total >= the_box->count_ / 2)
+		{
+			break;
+		}
+	}
+
+	*the_new_box = *the_box;
+	the_box->max_[the_axis] = the_split;
+	the_new_box->min_[the_axis] = the_split + 1;
+	Palette_ShrinkQuantizeBox(the_histogram, the_box);
+	Palette_ShrinkQuantizeBox(the_histogram, the_new_box);
+
+	return true;
+}
+
+
+//! Fill in a blend table for a palette and opacity
+//! @return	returns false if the inverse color map needed to build it couldn't be allocated
+boolean Palette_BuildBlendTable(const uint8_t* the_palette, signed int the_opacity, uint8_t* the_table)
+{
+	PaletteInverseMap*	the_map;
+	const uint8_t*		the_src;
+	const uint8_t*		the_dst;
+	signed int			the_under = PALETTE_BLEND_MAX - the_opacity;
+	signed int			s;
+	signed int			d;
+
+	// LOGIC:
+	//   65536 searches through 256 palette entries would take far too long. but many pairs mix to nearly the same color,
+	//   so matches are found through a 15-bit inverse color map, which searches each cell only the first time a mix lands in it.
+	//   mixing a color with itself gives back the same color, as do fully opaque and fully transparent mixes, so those are filled in directly.
+
+	if ((the_map = Palette_NewInverseMap(the_palette, PALETTE_INVERSE_15_BIT)) == NULL)
+	{
+		return false;
+	}
+
+	for (s = 0, the_src = the_palette; s < PALETTE_NUM_ENTRIES; s++, the_src += 4)
+	{
+		for (d = 0, the_dst = the_palette; d < PALETTE_NUM_ENTRIES; d++, the_dst += 4)
+		{
+			if (s == d || the_opacity == PALETTE_BLEND_MAX)
+			{
+				*the_table++ = s;
+				continue;
+			}
+
+			if (the_opacity == 0)
+			{
+				*the_table++ = d;
+				continue;
+			}
+
+			*the_table++ = Palette_LookupCell(the_map,
+				(the_src[2] * the_opacity + the_dst[2] * the_under) / PALETTE_BLEND_MAX,
+				(the_src[1] * the_opacity + the_dst[1] * the_under) / PALETTE_BLEND_MAX,
+				(the_src[0] * the_opacity + the_dst[0] * the_under) / PALETTE_BLEND_MAX);
+		}
+	}
+
+	Palette_DestroyInverseMap(&the_map);
+
+	return true;
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a palette cycler for a screen
+//! The cycler starts with no ranges. Add them with Palette_AddCycle().
+//! @param	the_screen: reference to a valid Screen object. Its vicky_ register pointer can be a stand-in block of normal memory, for testing.
+//! @param	the_palette: the palette to rotate ranges of. It is copied, and written to the screen's LUT.
+//! @return	returns NULL on any error
+PaletteCycler* Palette_NewCycler(Screen* the_screen, const uint8_t* the_palette)
+{
+	PaletteCycler*	the_cycler;
+
+	if (the_screen == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen or palette was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if ((the_cycler = f_calloc(1, sizeof(PaletteCycler), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for palette cycler", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_cycler	%p	size	%i", __func__ , __LINE__, the_cycler, sizeof(PaletteCycler)));
+
+	the_cycler->screen_ = the_screen;
+	memcpy(the_cycler->palette_, the_palette, BITMAP_PALETTE_BYTES);
+	Palette_WriteEntries(Palette_GetLUTAddress(the_screen), 0, the_cycler->palette_, PALETTE_NUM_ENTRIES);
+
+	return the_cycler;
+}
+
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. The LUT is left as it is.
+boolean Palette_DestroyCycler(PaletteCycler** the_cycler)
+{
+	if (the_cycler == NULL || *the_cycler == NULL)
+	{
+		LOG_ERR(("%s %d: passed cycler was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_cycler	%p	size	%i", __func__ , __LINE__, *the_cycler, sizeof(PaletteCycler)));
+	f_free(*the_cycler, MEM_STANDARD);
+	*the_cycler = NULL;
+
+	return true;
+}
+
+
+
+
+// **** LUT functions ****
+
+//! Write a range of entries of a palette to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Only the entries in the range are written, each to the LUT entry with the same index.
+//! @param	first_entry: the first LUT entry to write
+//! @param	num_entries: the number of LUT entries to write. Clipped to the end of the LUT.
+//! @return	returns false on any error
+boolean Palette_SetLUT(Screen* the_screen, const uint8_t* the_palette, uint8_t first_entry, signed int num_entries)
+{
+	if (the_screen == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen or palette was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (num_entries > PALETTE_NUM_ENTRIES - first_entry)
+	{
+		num_entries = PALETTE_NUM_ENTRIES - first_entry;
+	}
+
+	if (num_entries < 1)
+	{
+		return true;
+	}
+
+	Palette_WriteEntries(Palette_GetLUTAddress(the_screen), first_entry, &the_palette[first_entry * 4], num_entries);
+
+	return true;
+}
+
+
+//! Read a range of entries of a screen's graphics LUT into a palette
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Only the entries in the range are read into it, each from the LUT entry with the same index.
+//! @param	first_entry: the first LUT entry to read
+//! @param	num_entries: the number of LUT entries to read. Clipped to the end of the LUT.
+//! @return	returns false on any error
+boolean Palette_GetLUT(Screen* the_screen, uint8_t* the_palette, uint8_t first_entry, signed int num_entries)
+{
+	volatile uint8_t*	the_lut;
+	signed int			i;
+
+	if (the_screen == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen or palette was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (num_entries > PALETTE_NUM_ENTRIES - first_entry)
+	{
+		num_entries = PALETTE_NUM_ENTRIES - first_entry;
+	}
+
+	the_lut = Palette_GetLUTAddress(the_screen);
+
+	for (i = first_entry * 4; i < (first_entry + num_entries) * 4; i++)
+	{
+		the_palette[i] = the_lut[i];
+	}
+
+	return true;
+}
+
+
+//! Set one entry of a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_entry: the LUT entry to set
+//! @param	r, g, b: the color
+//! @return	returns false on any error
+boolean Palette_SetColor(Screen* the_screen, uint8_t the_entry, uint8_t r, uint8_t g, uint8_t b)
+{
+	volatile uint8_t*	the_lut;
+
+	if (the_screen == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	global_lut_generation++;
+	the_lut = Palette_GetLUTAddress(the_screen) + the_entry * 4;
+	the_lut[0] = b;
+	the_lut[1] = g;
+	the_lut[2] = r;
+	the_lut[3] = 0xFF;
+
+	return true;
+}
+
+
+
+
+// **** Load functions ****
+
+//! Load a palette file
+//! Accepted formats are: a raw LUT dump (BITMAP_PALETTE_BYTES bytes of B, G, R, A), a raw R, G, B file (PALETTE_RGB_FILE_BYTES bytes), and JASC-PAL text files.
+//! Entries the file doesn't define are set to 0.
+//! @param	the_path: path of the palette file
+//! @param	the_palette: a BITMAP_PALETTE_BYTES buffer to receive the palette, in LUT order
+//! @return	returns false on any error
+boolean Palette_LoadFromFile(const char* the_path, uint8_t* the_palette)
+{
+	FILE*			the_file;
+	uint8_t*		the_buffer;
+	signed int		the_len;
+	signed int		i;
+	boolean			success = false;
+
+	if (the_path == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed path or palette was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_file = fopen(the_path, "rb")) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't open file '%s'", __func__, __LINE__, the_path));
+		return false;
+	}
+
+	if ((the_buffer = f_calloc(PALETTE_FILE_MAX_BYTES + 1, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space to read palette file", __func__, __LINE__));
+		fclose(the_file);
+		return false;
+	}
+
+	// LOGIC:
+	//   palette files are small, so the whole file is read in one go, and its format told from its first bytes and its length.
+	//   the buffer is one byte bigger than the largest file accepted, so a file that fills it is known to be too big.
+
+	the_len = fread(the_buffer, 1, PALETTE_FILE_MAX_BYTES + 1, the_file);
+	fclose(the_file);
+
+	memset(the_palette, 0, BITMAP_PALETTE_BYTES);
+
+	if (the_len > PALETTE_FILE_MAX_BYTES)
+	{
+		LOG_ERR(("%s %d: '%s' is too big to be a palette file", __func__, __LINE__, the_path));
+	}
+	else if (the_len > (signed int)strlen(PALETTE_JASC_MAGIC) && memcmp(the_buffer, PALETTE_JASC_MAGIC, strlen(PALETTE_JASC_MAGIC)) == 0)
+	{
+		if ((success = Palette_ParseJASC((const char*)the_buffer, (const char*)the_buffer + the_len, the_palette)) == false)
+		{
+			LOG_ERR(("%s %d: '%s' ended before all its colors were read", __func__, __LINE__, the_path));
+		}
+	}
+	else if (the_len == BITMAP_PALETTE_BYTES)
+	{
+		memcpy(the_palette, the_buffer, BITMAP_PALETTE_BYTES);
+		success = true;
+	}
+	else if (the_len == PALETTE_RGB_FILE_BYTES)
+	{
+		for (i = 0; i < PALETTE_NUM_ENTRIES; i++)
+		{
+			the_palette[i * 4] = the_buffer[i * 3 + 2];
+			the_palette[i * 4 + 1] = the_buffer[i * 3 + 1];
+			the_palette[i * 4 + 2] = the_buffer[i * 3];
+			the_palette[i * 4 + 3] = 0xFF;
+		}
+
+		success = true;
+	}
+	else
+	{
+		LOG_ERR(("%s %d: '%s' is not a palette file this library understands (%i bytes)", __func__, __LINE__, the_path, the_len));
+	}
+
+	f_free(the_buffer, MEM_STANDARD);
+
+	return success;
+}
+
+
+//! Load a palette file, and write all of it to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_path: path of the palette file. See Palette_LoadFromFile() for the formats accepted.
+//! @return	returns false on any error
+boolean Palette_LoadLUTFromFile(Screen* the_screen, const char* the_path)
+{
+	uint8_t		the_palette[BITMAP_PALETTE_BYTES];
+
+	if (the_screen == NULL)
+	{
+		LOG_ERR(("%s %d: passed screen was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!Palette_LoadFromFile(the_path, the_palette))
+	{
+		return false;
+	}
+
+	return Palette_SetLUT(the_screen, the_palette, 0, PALETTE_NUM_ENTRIES);
+}
+
+
+
+
+// **** Palette cycling functions ****
+
+//! Add a range of LUT entries to rotate
+//! Ranges should not overlap.
+//! @param	first_entry, last_entry: the first and last LUT entries of the range
+//! @param	ticks_per_step: the number of calls to Palette_CycleTick() between each step of the rotation. 1 rotates on every call.
+//! @param	the_direction: a palette_cycle_direction value
+//! @return	returns the id of the new range, or PALETTE_NO_CYCLE on any error, or if the cycler already has PALETTE_MAX_CYCLES ranges
+signed int Palette_AddCycle(PaletteCycler* the_cycler, uint8_t first_entry, uint8_t last_entry, signed int ticks_per_step, uint8_t the_direction)
+{
+	PaletteCycle*	the_cycle;
+	signed int		i;
+
+	if (the_cycler == NULL)
+	{
+		LOG_ERR(("%s %d: passed cycler was NULL", __func__, __LINE__));
+		return PALETTE_NO_CYCLE;
+	}
+
+	if (last_entry <= first_entry || ticks_per_step < 1 || the_direction > PALETTE_CYCLE_PING_PONG)
+	{
+		LOG_ERR(("%s %d: invalid range (%u to %u), speed (%i), or direction (%u)", __func__, __LINE__, first_entry, last_entry, ticks_per_step, the_direction));
+		return PALETTE_NO_CYCLE;
+	}
+
+	for (i = 0; i < PALETTE_MAX_CYCLES; i++)
+	{
+		if (the_cycler->cycle_[i].in_use_ == false)
+		{
+			break;
+		}
+	}
+
+	if (i == PALETTE_MAX_CYCLES)
+	{
+		LOG_ERR(("%s %d: cycler already has %i ranges", __func__, __LINE__, PALETTE_MAX_CYCLES));
+		return PALETTE_NO_CYCLE;
+	}
+
+	the_cycle = &the_cycler->cycle_[i];
+	memset(the_cycle, 0, sizeof(PaletteCycle));
+	the_cycle->in_use_ = true;
+	the_cycle->first_ = first_entry;
+	the_cycle->last_ = last_entry;
+	the_cycle->direction_ = the_direction;
+	the_cycle->ticks_per_step_ = ticks_per_step;
+	the_cycle->ticks_left_ = ticks_per_step;
+
+	return i;
+}
+
+
+//! Stop rotating a range of LUT entries, and put its entries back as they are in the cycler's palette
+//! @param	the_id: the id returned by Palette_AddCycle()
+//! @return	returns false on any error
+boolean Palette_RemoveCycle(PaletteCycler* the_cycler, signed int the_id)
+{
+	PaletteCycle*	the_cycle;
+
+	if (the_cycler == NULL || the_id < 0 || the_id >= PALETTE_MAX_CYCLES || the_cycler->cycle_[the_id].in_use_ == false)
+	{
+		LOG_ERR(("%s %d: passed cycler was NULL, or range id (%i) was invalid", __func__, __LINE__, the_id));
+		return false;
+	}
+
+	the_cycle = &the_cycler->cycle_[the_id];
+	the_cycle->offset_ = 0;
+	Palette_WriteCycle(the_cycler, the_cycle);
+	the_cycle->in_use_ = false;
+
+	return true;
+}
+
+
+//! Pause or resume the rotation of a range of LUT entries
+//! A paused range stays as it is in the LUT until it is resumed.
+//! @param	the_id: the id returned by Palette_AddCycle()
+//! @param	paused: true to pause the range, false to resume it
+//! @return	returns false on any error
+boolean Palette_PauseCycle(PaletteCycler* the_cycler, signed int the_id, boolean paused)
+{
+	if (the_cycler == NULL || the_id < 0 || the_id >= PALETTE_MAX_CYCLES || the_cycler->cycle_[the_id].in_use_ == false)
+	{
+		LOG_ERR(("%s %d: passed cycler was NULL, or range id (%i) was invalid", __func__, __LINE__, the_id));
+		return false;
+	}
+
+	the_cycler->cycle_[the_id].paused_ = paused;
+
+	return true;
+}
+
+
+//! Replace the palette a cycler rotates ranges of
+//! Each range keeps its current rotation. The whole new palette is written to the LUT, rotated where the ranges are.
+//! @param	the_palette: the new palette. It is copied.
+//! @return	returns false on any error
+boolean Palette_SetCyclerPalette(PaletteCycler* the_cycler, const uint8_t* the_palette)
+{
+	signed int		i;
+
+	if (the_cycler == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed cycler or palette was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	memcpy(the_cycler->palette_, the_palette, BITMAP_PALETTE_BYTES);
+	Palette_WriteEntries(Palette_GetLUTAddress(the_cycler->screen_), 0, the_cycler->palette_, PALETTE_NUM_ENTRIES);
+
+	for (i = 0; i < PALETTE_MAX_CYCLES; i++)
+	{
+		if (the_cycler->cycle_[i].in_use_ && the_cycler->cycle_[i].offset_ > 0)
+		{
+			Palette_WriteCycle(the_cycler, &the_cycler->cycle_[i]);
+		}
+	}
+
+	return true;
+}
+
+
+//! Advance every range of a palette cycler, writing the ranges that moved to the LUT
+//! Call once per frame (or at any steady rate): range speeds are counted in calls to this function.
+//! @return	returns the number of ranges that moved and were written to the LUT, or -1 on any error
+signed int Palette_CycleTick(PaletteCycler* the_cycler)
+{
+	PaletteCycle*	the_cycle;
+	signed int		the_len;
+	signed int		num_moved = 0;
+	signed int		i;
+
+	if (the_cycler == NULL)
+	{
+		LOG_ERR(("%s %d: passed cycler was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	for (i = 0; i < PALETTE_MAX_CYCLES; i++)
+	{
+		the_cycle = &the_cycler->cycle_[i];
+
+		if (the_cycle->in_use_ == false || the_cycle->paused_ || --the_cycle->ticks_left_ > 0)
+		{
+			continue;
+		}
+
+		the_cycle->ticks_left_ = the_cycle->ticks_per_step_;
+		the_len = the_cycle->last_ - the_cycle->first_ + 1;
+
+		// LOGIC:
+		//   offset is how far the colors are rotated up the range. forward adds 1, backward takes 1, both wrapping around.
+		//   ping pong moves up until the offset would wrap, then down until it is back at 0.
+
+		if (the_cycle->direction_ == PALETTE_CYCLE_FORWARD)
+		{
+			the_cycle->offset_ = (the_cycle->offset_ + 1 == the_len) ? 0 : the_cycle->offset_ + 1;
+		}
+		else if (the_cycle->direction_ == PALETTE_CYCLE_BACKWARD)
+		{
+			the_cycle->offset_ = (the_cycle->offset_ == 0) ? the_len - 1 : the_cycle->offset_ - 1;
+		}
+		else
+		{
+			if (the_cycle->reversing_ == false && the_cycle->offset_ + 1 == the_len)
+			{
+				the_cycle->reversing_ = true;
+			}
+			else if (the_cycle->reversing_ && the_cycle->offset_ == 0)
+			{
+				the_cycle->reversing_ = false;
+			}
+
+			the_cycle->offset_ += (the_cycle->reversing_) ? -1 : 1;
+		}
+
+		Palette_WriteCycle(the_cycler, the_cycle);
+		num_moved++;
+	}
+
+	return num_moved;
+}
+
+
+
+
+// **** Palette fade functions ****
+
+//! Create a fade between two palettes, working out every step of it
+//! @param	from_palette: the palette at the start of the fade
+//! @param	to_palette: the palette at the end of the fade, or NULL to fade to black
+//! @param	first_entry: the first LUT entry the fade changes
+//! @param	num_entries: the number of LUT entries the fade changes. Clipped to the end of the LUT.
+//! @param	num_steps: the number of steps from the first palette to the second, from 1 to PALETTE_FADE_MAX_STEPS
+//! @return	returns NULL on any error
+PaletteFade* Palette_NewFade(const uint8_t* from_palette, const uint8_t* to_palette, uint8_t first_entry, signed int num_entries, signed int num_steps)
+{
+	PaletteFade*	the_fade;
+	uint8_t*		the_step;
+	uint8_t*		the_prev_step;
+	const uint8_t*	the_from;
+	signed int		the_to;
+	signed int		num_bytes;
+	signed int		num_runs;
+	signed int		run_start;
+	signed int		s;
+	signed int		i;
+	signed int		b;
+
+	if (from_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (num_entries > PALETTE_NUM_ENTRIES - first_entry)
+	{
+		num_entries = PALETTE_NUM_ENTRIES - first_entry;
+	}
+
+	if (num_entries < 1 || num_steps < 1 || num_steps > PALETTE_FADE_MAX_STEPS)
+	{
+		LOG_ERR(("%s %d: invalid number of entries (%i) or steps (%i)", __func__, __LINE__, num_entries, num_steps));
+		return NULL;
+	}
+
+	if ((the_fade = f_calloc(1, sizeof(PaletteFade), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for palette fade", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_fade	%p	size	%i", __func__ , __LINE__, the_fade, sizeof(PaletteFade)));
+
+	the_fade->first_ = first_entry;
+	the_fade->num_entries_ = num_entries;
+	the_fade->num_steps_ = num_steps;
+	the_fade->last_step_ = -1;
+	num_bytes = num_entries * 4;
+
+	if ((the_fade->step_ = f_calloc((num_steps + 1) * num_bytes, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i fade steps", __func__, __LINE__, num_steps + 1));
+		goto error;
+	}
+
+	if ((the_fade->run_index_ = f_calloc(num_steps + 2, sizeof(signed int), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for fade run index", __func__, __LINE__));
+		goto error;
+	}
+
+	// LOGIC:
+	//   each byte of each step is interpolated between the 2 palettes, rounding to nearest. fading to black leaves the alpha bytes alone.
+	//   then each step is compared to the one before to find the runs of entries that changed. they are counted first, so the run list can be allocated in one go.
+
+	the_from = &from_palette[first_entry * 4];
+
+	for (s = 0; s <= num_steps; s++)
+	{
+		the_step = &the_fade->step_[s * num_bytes];
+
+		for (b = 0; b < num_bytes; b++)
+		{
+			if (to_palette)
+			{
+				the_to = to_palette[first_entry * 4 + b];
+			}
+			else
+			{
+				the_to = ((b & 0x03) == 3) ? the_from[b] : 0;
+			}
+
+			the_step[b] = (the_from[b] * (num_steps - s) + the_to * s + num_steps / 2) / num_steps;
+		}
+	}
+
+	num_runs = 0;
+
+	for (s = 1; s <= num_steps; s++)
+	{
+		the_step = &the_fade->step_[s * num_bytes];
+		the_prev_step = the_step - num_bytes;
+
+		for (i = 0; i < num_entries; i++)
+		{
+			if (memcmp(&the_step[i * 4], &the_prev_step[i * 4], 4) != 0 && (i == 0 || memcmp(&the_step[(i - 1) * 4], &the_prev_step[(i - 1) * 4], 4) == 0))
+			{
+				num_runs++;
+			}
+		}
+	}
+
+	if (num_runs > 0 && (the_fade->run_ = f_calloc(num_runs * 2, sizeof(uint16_t), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %i fade runs", __func__, __LINE__, num_runs));
+		goto error;
+	}
+
+	num_runs = 0;
+
+	for (s = 1; s <= num_steps; s++)
+	{
+		the_step = &the_fade->step_[s * num_bytes];
+		the_prev_step = the_step - num_bytes;
+		the_fade->run_index_[s] = num_runs;
+		run_start = -1;
+
+		for (i = 0; i <= num_entries; i++)
+		{
+			if (i < num_entries && memcmp(&the_step[i * 4], &the_prev_step[i * 4], 4) != 0)
+			{
+				if (run_start < 0)
+				{
+					run_start = i;
+				}
+			}
+			else if (run_start >= 0)
+			{
+				the_fade->run_[num_runs * 2] = run_start;
+				the_fade->run_[num_runs * 2 + 1] = i - run_start;
+				num_runs++;
+				run_start = -1;
+			}
+		}
+	}
+
+	the_fade->run_index_[num_steps + 1] = num_runs;
+
+	return the_fade;
+
+error:
+	Palette_DestroyFade(&the_fade);
+	return NULL;
+}
+
+
+//! Free a palette fade, and all memory associated with it
+boolean Palette_DestroyFade(PaletteFade** the_fade)
+{
+	if (the_fade == NULL || *the_fade == NULL)
+	{
+		LOG_ERR(("%s %d: passed fade was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_fade)->step_)
+	{
+		f_free((*the_fade)->step_, MEM_STANDARD);
+	}
+
+	if ((*the_fade)->run_index_)
+	{
+		f_free((*the_fade)->run_index_, MEM_STANDARD);
+	}
+
+	if ((*the_fade)->run_)
+	{
+		f_free((*the_fade)->run_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_fade	%p	size	%i", __func__ , __LINE__, *the_fade, sizeof(PaletteFade)));
+	f_free(*the_fade, MEM_STANDARD);
+	*the_fade = NULL;
+
+	return true;
+}
+
+
+//! Get the LUT entries of one step of a fade
+//! Useful to fade a palette cycler's palette, with Palette_SetCyclerPalette(), instead of writing to the LUT directly.
+//! @param	the_step: from 0 (the starting palette) to the number of steps (the ending palette)
+//! @return	returns the fade's range of entries at that step, starting with its first entry, or NULL on any error
+const uint8_t* Palette_GetFadeStep(PaletteFade* the_fade, signed int the_step)
+{
+	if (the_fade == NULL || the_step < 0 || the_step > the_fade->num_steps_)
+	{
+		LOG_ERR(("%s %d: passed fade was NULL, or step (%i) was invalid", __func__, __LINE__, the_step));
+		return NULL;
+	}
+
+	return &the_fade->step_[the_step * the_fade->num_entries_ * 4];
+}
+
+
+//! Write one step of a fade to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_step: from 0 (the starting palette) to the number of steps (the ending palette)
+//! @param	changed_only: PARAM_CHANGED_ONLY or PARAM_ALL_ENTRIES. Changed-only writes are only possible when the step applied before was the one just before or after this one; otherwise every entry is written.
+//! @return	returns false on any error
+boolean Palette_ApplyFadeStep(PaletteFade* the_fade, Screen* the_screen, signed int the_step, boolean changed_only)
+{
+	volatile uint8_t*	the_lut;
+	uint8_t*			the_entries;
+	uint16_t*			the_run;
+	signed int			the_pair;
+	signed int			i;
+
+	if (the_fade == NULL || the_screen == NULL || the_step < 0 || the_step > the_fade->num_steps_)
+	{
+		LOG_ERR(("%s %d: passed fade or screen was NULL, or step (%i) was invalid", __func__, __LINE__, the_step));
+		return false;
+	}
+
+	the_lut = Palette_GetLUTAddress(the_screen);
+	the_entries = &the_fade->step_[the_step * the_fade->num_entries_ * 4];
+
+	// LOGIC:
+	//   the runs stored for step s are the entries that differ between steps s - 1 and s. that is the same set going either way,
+	//   so they serve for stepping forward into s, or back from s into s - 1.
+
+	if (changed_only && the_step == the_fade->last_step_)
+	{
+		return true;
+	}
+
+	if (changed_only && the_fade->last_step_ >= 0 && (the_step == the_fade->last_step_ + 1 || the_step == the_fade->last_step_ - 1))
+	{
+		the_pair = (the_step > the_fade->last_step_) ? the_step : the_fade->last_step_;
+
+		for (i = the_fade->run_index_[the_pair]; i < the_fade->run_index_[the_pair + 1]; i++)
+		{
+			the_run = &the_fade->run_[i * 2];
+			Palette_WriteEntries(the_lut, the_fade->first_ + the_run[0], &the_entries[the_run[0] * 4], the_run[1]);
+		}
+	}
+	else
+	{
+		Palette_WriteEntries(the_lut, the_fade->first_, the_entries, the_fade->num_entries_);
+	}
+
+	the_fade->last_step_ = the_step;
+
+	return true;
+}
+
+
+//! Write the next step of a fade to a screen's graphics LUT, writing only the entries that changed
+//! The first call writes step 0.
+//! @param	the_screen: reference to a valid Screen object
+//! @return	returns the number of steps left after this one (0 once the ending palette has been written), or -1 on any error
+signed int Palette_FadeTick(PaletteFade* the_fade, Screen* the_screen)
+{
+	if (the_fade == NULL || the_screen == NULL)
+	{
+		LOG_ERR(("%s %d: passed fade or screen was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	if (the_fade->last_step_ >= the_fade->num_steps_)
+	{
+		return 0;
+	}
+
+	if (!Palette_ApplyFadeStep(the_fade, the_screen, the_fade->last_step_ + 1, PARAM_CHANGED_ONLY))
+	{
+		return -1;
+	}
+
+	return the_fade->num_steps_ - the_fade->last_step_;
+}
+
+
+
+
+// **** Remap table functions ****
+
+//! Find the palette entry closest to a color
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to search the screen's current LUT.
+//! @param	r, g, b: the color to match
+//! @return	returns the index of the entry with the smallest RGB distance to the color. Ties go to the lowest index.
+uint8_t Palette_FindNearestColor(const uint8_t* the_palette, uint8_t r, uint8_t g, uint8_t b)
+{
+	const uint8_t*	the_entry;
+	signed long		the_distance;
+	signed long		best_distance = 0x7FFFFFFF;
+	signed int		the_diff;
+	uint8_t			best_index = 0;
+	signed int		i;
+
+	if (the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette was NULL", __func__, __LINE__));
+		return 0;
+	}
+
+	for (i = 0, the_entry = the_palette; i < PALETTE_NUM_ENTRIES; i++, the_entry += 4)
+	{
+		the_diff = the_entry[2] - r;
+		the_distance = (signed long)the_diff * the_diff;
+		the_diff = the_entry[1] - g;
+		the_distance += (signed long)the_diff * the_diff;
+		the_diff = the_entry[0] - b;
+		the_distance += (signed long)the_diff * the_diff;
+
+		if (the_distance < best_distance)
+		{
+			best_distance = the_distance;
+			best_index = i;
+
+			if (the_distance == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	return best_index;
+}
+
+
+//! Build a remap table that darkens or lightens every color of a palette
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	the_amount: from -PALETTE_BLEND_MAX (every color becomes black) through 0 (no change) to PALETTE_BLEND_MAX (every color becomes white)
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the palette entry closest to the shaded color of entry n.
+//! @return	returns false on any error
+boolean Palette_BuildShadeTable(const uint8_t* the_palette, signed int the_amount, uint8_t* the_table)
+{
+	if (the_amount < 0)
+	{
+		return Palette_BuildTintTable(the_palette, 0, 0, 0, -the_amount, the_table);
+	}
+
+	return Palette_BuildTintTable(the_palette, 0xFF, 0xFF, 0xFF, the_amount, the_table);
+}
+
+
+//! Build a remap table that blends every color of a palette toward one color
+//! Use for team colors, selection highlights, and tinted or greyed-out widgets.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	r, g, b: the color to blend toward
+//! @param	the_amount: from 0 (no change) to PALETTE_BLEND_MAX (every color becomes r, g, b, or the closest the palette has)
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the palette entry closest to the blended color of entry n.
+//! @return	returns false on any error
+boolean Palette_BuildTintTable(const uint8_t* the_palette, uint8_t r, uint8_t g, uint8_t b, signed int the_amount, uint8_t* the_table)
+{
+	const uint8_t*	the_entry;
+	signed int		the_keep;
+	signed int		i;
+
+	if (the_palette == NULL || the_table == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette or table was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_amount < 0 || the_amount > PALETTE_BLEND_MAX)
+	{
+		LOG_ERR(("%s %d: invalid amount (%i)", __func__, __LINE__, the_amount));
+		return false;
+	}
+
+	the_keep = PALETTE_BLEND_MAX - the_amount;
+
+	for (i = 0, the_entry = the_palette; i < PALETTE_NUM_ENTRIES; i++, the_entry += 4)
+	{
+		// with no blending, an entry's closest match is itself, unless the palette has an identical entry before it
+		the_table[i] = Palette_FindNearestColor(the_palette,
+			(the_entry[2] * the_keep + r * the_amount) / PALETTE_BLEND_MAX,
+			(the_entry[1] * the_keep + g * the_amount) / PALETTE_BLEND_MAX,
+			(the_entry[0] * the_keep + b * the_amount) / PALETTE_BLEND_MAX);
+	}
+
+	return true;
+}
+
+
+
+//! Build a remap table from one palette to another
+//! Use with Graphics_RemapRect() to convert an 8-bit image drawn with one palette to another, such as a palette built by a palette quantizer.
+//! @param	from_palette: the BITMAP_PALETTE_BYTES palette the image was drawn with
+//! @param	to_palette: the BITMAP_PALETTE_BYTES palette to convert it to
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the entry of to_palette closest to entry n of from_palette.
+//! @return	returns false on any error
+boolean Palette_BuildRemapTable(const uint8_t* from_palette, const uint8_t* to_palette, uint8_t* the_table)
+{
+	const uint8_t*	the_entry;
+	signed int		i;
+
+	if (from_palette == NULL || to_palette == NULL || the_table == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette or table was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	for (i = 0, the_entry = from_palette; i < PALETTE_NUM_ENTRIES; i++, the_entry += 4)
+	{
+		the_table[i] = Palette_FindNearestColor(to_palette, the_entry[2], the_entry[1], the_entry[0]);
+	}
+
+	return true;
+}
+
+
+
+
+
+// **** Inverse color map functions ****
+
+//! Create an inverse color map, to find the closest entries of a fixed palette to RGB colors
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. It is copied.
+//! @param	the_bits: PALETTE_INVERSE_15_BIT or PALETTE_INVERSE_18_BIT
+//! @return	returns NULL on any error
+PaletteInverseMap* Palette_NewInverseMap(const uint8_t* the_palette, uint8_t the_bits)
+{
+	PaletteInverseMap*	the_map;
+	unsigned long		num_cells;
+
+	if (the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_bits != PALETTE_INVERSE_15_BIT && the_bits != PALETTE_INVERSE_18_BIT)
+	{
+		LOG_ERR(("%s %d: invalid number of bits (%u)", __func__, __LINE__, the_bits));
+		return NULL;
+	}
+
+	if ((the_map = f_calloc(1, sizeof(PaletteInverseMap), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for inverse color map", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_map	%p	size	%i", __func__ , __LINE__, the_map, sizeof(PaletteInverseMap)));
+
+	the_map->bits_ = the_bits;
+	num_cells = 1L << (the_bits * 3);
+
+	if ((the_map->cell_ = f_calloc(num_cells, 1, MEM_STANDARD)) == NULL || (the_map->found_ = f_calloc(num_cells / 8, 1, MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for %lu inverse color map cells", __func__, __LINE__, num_cells));
+		Palette_DestroyInverseMap(&the_map);
+		return NULL;
+	}
+
+	memcpy(the_map->palette_, the_palette, BITMAP_PALETTE_BYTES);
+	Palette_ResetInverseMap(the_map);
+
+	return the_map;
+}
+
+
+//! Create an inverse color map that follows a screen's graphics LUT
+//! Whenever a color is mapped, the map checks whether this library has written to any LUT since it last looked, and if the screen's LUT has really changed, starts over.
+//! LUT changes made without this library are not noticed: call Palette_SetInverseMapPalette() after making them.
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_bits: PALETTE_INVERSE_15_BIT or PALETTE_INVERSE_18_BIT
+//! @return	returns NULL on any error
+PaletteInverseMap* Palette_NewInverseMapForScreen(Screen* the_screen, uint8_t the_bits)
+{
+	PaletteInverseMap*	the_map;
+	uint8_t				the_palette[BITMAP_PALETTE_BYTES];
+
+	if (!Palette_GetLUT(the_screen, the_palette, 0, PALETTE_NUM_ENTRIES))
+	{
+		return NULL;
+	}
+
+	if ((the_map = Palette_NewInverseMap(the_palette, the_bits)) == NULL)
+	{
+		return NULL;
+	}
+
+	the_map->screen_ = the_screen;
+	the_map->generation_ = global_lut_generation;
+
+	return the_map;
+}
+
+
+//! Free an inverse color map, and all memory associated with it
+boolean Palette_DestroyInverseMap(PaletteInverseMap** the_map)
+{
+	if (the_map == NULL || *the_map == NULL)
+	{
+		LOG_ERR(("%s %d: passed map was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_map)->cell_)
+	{
+		f_free((*the_map)->cell_, MEM_STANDARD);
+	}
+
+	if ((*the_map)->found_)
+	{
+		f_free((*the_map)->found_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_map	%p	size	%i", __func__ , __LINE__, *the_map, sizeof(PaletteInverseMap)));
+	f_free(*the_map, MEM_STANDARD);
+	*the_map = NULL;
+
+	return true;
+}
+
+
+//! Change the palette an inverse color map finds matches in
+//! Cells already searched are forgotten, unless the new palette is the same as the old one.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. It is copied. For a map that follows a screen, pass NULL to re-read the screen's LUT.
+//! @return	returns false on any error
+boolean Palette_SetInverseMapPalette(PaletteInverseMap* the_map, const uint8_t* the_palette)
+{
+	if (the_map == NULL || (the_palette == NULL && the_map->screen_ == NULL))
+	{
+		LOG_ERR(("%s %d: passed map was NULL, or palette was NULL for a map that doesn't follow a screen", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_palette == NULL)
+	{
+		// force a check of the screen's LUT, even if this library hasn't written to it
+		the_map->generation_ = global_lut_generation - 1;
+		Palette_CheckInverseMap(the_map);
+		return true;
+	}
+
+	if (memcmp(the_map->palette_, the_palette, BITMAP_PALETTE_BYTES) != 0)
+	{
+		memcpy(the_map->palette_, the_palette, BITMAP_PALETTE_BYTES);
+		Palette_ResetInverseMap(the_map);
+	}
+
+	return true;
+}
+
+
+//! Find the closest palette entry to an RGB color
+//! The match is the closest entry to the center of the color's cell, so it can differ slightly from Palette_FindNearestColor() for the exact color.
+//! @param	r, g, b: the color to match
+//! @return	returns the index of the closest palette entry, or 0 on any error
+uint8_t Palette_MapColor(PaletteInverseMap* the_map, uint8_t r, uint8_t g, uint8_t b)
+{
+	if (the_map == NULL)
+	{
+		LOG_ERR(("%s %d: passed map was NULL", __func__, __LINE__));
+		return 0;
+	}
+
+	Palette_CheckInverseMap(the_map);
+
+	return Palette_LookupCell(the_map, r, g, b);
+}
+
+
+//! Find the closest palette entry to every pixel of a row of RGB pixels
+//! @param	the_pixels: the row to convert
+//! @param	the_format: a palette_pixel_format value, describing the_pixels
+//! @param	the_dest: num_pixels bytes to receive the palette indexes. Can be a row of a bitmap (see Bitmap_GetMemLocForWrite()).
+//! @param	num_pixels: the number of pixels in the row
+//! @return	returns false on any error
+boolean Palette_MapRow(PaletteInverseMap* the_map, const uint8_t* the_pixels, uint8_t the_format, uint8_t* the_dest, signed int num_pixels)
+{
+	if (the_map == NULL || the_pixels == NULL || the_dest == NULL)
+	{
+		LOG_ERR(("%s %d: passed map, pixels, or destination was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	Palette_CheckInverseMap(the_map);
+
+	if (the_format == PALETTE_PIXEL_RGB24)
+	{
+		for (; num_pixels > 0; num_pixels--, the_pixels += 3)
+		{
+			*the_dest++ = Palette_LookupCell(the_map, the_pixels[0], the_pixels[1], the_pixels[2]);
+		}
+	}
+	else if (the_format == PALETTE_PIXEL_RGBA32)
+	{
+		for (; num_pixels > 0; num_pixels--, the_pixels += 4)
+		{
+			*the_dest++ = Palette_LookupCell(the_map, the_pixels[0], the_pixels[1], the_pixels[2]);
+		}
+	}
+	else if (the_format == PALETTE_PIXEL_BGRA32)
+	{
+		for (; num_pixels > 0; num_pixels--, the_pixels += 4)
+		{
+			*the_dest++ = Palette_LookupCell(the_map, the_pixels[2], the_pixels[1], the_pixels[0]);
+		}
+	}
+	else
+	{
+		LOG_ERR(("%s %d: invalid pixel format (%u)", __func__, __LINE__, the_format));
+		return false;
+	}
+
+	return true;
+}
+
+
+
+
+
+// **** Truecolor import functions ****
+
+//! Create an importer, to convert a truecolor image into a bitmap one row at a time
+//! @param	the_map: the inverse color map to match colors through. For the screen's current LUT, use Palette_NewInverseMapForScreen(). It is not copied: keep it until the importer is destroyed.
+//! @param	the_bitmap: reference to a valid Bitmap object to write rows into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. The image is clipped to the bitmap.
+//! @param	width, height: size of the image in pixels
+//! @param	the_format: a palette_pixel_format value, describing the rows that will be passed to Palette_ImportRow()
+//! @param	the_dither: a palette_dither value
+//! @return	returns NULL on any error
+PaletteImporter* Palette_NewImporter(PaletteInverseMap* the_map, Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, uint8_t the_format, uint8_t the_dither)
+{
+	PaletteImporter*	the_importer;
+	signed int			r_offset;
+	signed int			g_offset;
+	signed int			b_offset;
+	signed int			pixel_bytes;
+	signed long			error_bytes;
+
+	if (the_map == NULL || the_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed map or bitmap was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: invalid image size (%i x %i)", __func__, __LINE__, width, height));
+		return NULL;
+	}
+
+	if (!Palette_GetPixelLayout(the_format, &r_offset, &g_offset, &b_offset, &pixel_bytes))
+	{
+		LOG_ERR(("%s %d: invalid pixel format (%u)", __func__, __LINE__, the_format));
+		return NULL;
+	}
+
+	if (the_dither > PALETTE_DITHER_DIFFUSION)
+	{
+		LOG_ERR(("%s %d: invalid dither (%u)", __func__, __LINE__, the_dither));
+		return NULL;
+	}
+
+	if ((the_importer = f_calloc(1, sizeof(PaletteImporter), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for palette importer", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_importer	%p	size	%i", __func__ , __LINE__, the_importer, sizeof(PaletteImporter)));
+
+	the_importer->map_ = the_map;
+	the_importer->bitmap_ = the_bitmap;
+	the_importer->x_ = x;
+	the_importer->y_ = y;
+	the_importer->width_ = width;
+	the_importer->height_ = height;
+	the_importer->format_ = the_format;
+	the_importer->dither_ = the_dither;
+	the_importer->left_ = (x < 0) ? -x : 0;
+	the_importer->right_ = (width < the_bitmap->width_ - x) ? width : the_bitmap->width_ - x;
+
+	if (the_dither == PALETTE_DITHER_DIFFUSION)
+	{
+		error_bytes = (signed long)(width + 2) * 3 * sizeof(signed short);
+
+		if ((the_importer->error_ = f_calloc(2, error_bytes, MEM_STANDARD)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for 2 rows of dither errors", __func__, __LINE__));
+			Palette_DestroyImporter(&the_importer);
+			return NULL;
+		}
+
+		the_importer->this_error_ = the_importer->error_;
+		the_importer->next_error_ = the_importer->error_ + (width + 2) * 3;
+	}
+
+	return the_importer;
+}
+
+
+//! Free an importer, and all memory associated with it. The bitmap and inverse color map are not affected.
+boolean Palette_DestroyImporter(PaletteImporter** the_importer)
+{
+	if (the_importer == NULL || *the_importer == NULL)
+	{
+		LOG_ERR(("%s %d: passed importer was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_importer)->error_)
+	{
+		f_free((*the_importer)->error_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_importer	%p	size	%i", __func__ , __LINE__, *the_importer, sizeof(PaletteImporter)));
+	f_free(*the_importer, MEM_STANDARD);
+	*the_importer = NULL;
+
+	return true;
+}
+
+
+//! Convert the next row of the image, and write it into the bitmap
+//! Rows must be passed in order, from the top of the image down. Rows and columns outside the bitmap are not written, but still spread their errors when diffusing.
+//! @param	the_pixels: width pixels, in the importer's format
+//! @return	returns false on any error, or if every row of the image has already been imported
+boolean Palette_ImportRow(PaletteImporter* the_importer, const uint8_t* the_pixels)
+{
+	unsigned char*	the_write_loc = NULL;
+	signed int		the_y;
+
+	if (the_importer == NULL || the_pixels == NULL)
+	{
+		LOG_ERR(("%s %d: passed importer or pixels was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_importer->row_ >= the_importer->height_)
+	{
+		LOG_ERR(("%s %d: all %i rows of the image have already been imported", __func__, __LINE__, the_importer->height_));
+		return false;
+	}
+
+	// the LUT may have changed since the last row: check once here, rather than for every pixel
+	Palette_CheckInverseMap(the_importer->map_);
+
+	the_y = the_importer->y_ + the_importer->row_;
+
+	if (the_y >= 0 && the_y < the_importer->bitmap_->height_ && the_importer->left_ < the_importer->right_)
+	{
+		if ((the_write_loc = Bitmap_GetMemLocForWrite(the_importer->bitmap_, the_importer->x_ + the_importer->left_, the_y, the_importer->right_ - the_importer->left_, 1)) == NULL)
+		{
+			return false;
+		}
+	}
+
+	if (the_importer->dither_ == PALETTE_DITHER_DIFFUSION)
+	{
+		Palette_ImportRowDiffused(the_importer, the_pixels, the_write_loc);
+	}
+	else if (the_write_loc)
+	{
+		Palette_ImportRowOrdered(the_importer, the_pixels, the_write_loc);
+	}
+
+	the_importer->row_++;
+
+	return true;
+}
+
+
+//! Convert a whole truecolor image in memory, and write it into a bitmap
+//! @param	the_map: the inverse color map to match colors through
+//! @param	the_pixels: the first row of the image
+//! @param	the_format: a palette_pixel_format value
+//! @param	width, height: size of the image in pixels
+//! @param	the_stride: bytes from the start of one row of the_pixels to the start of the next
+//! @param	the_bitmap: reference to a valid Bitmap object to write the image into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. The image is clipped to the bitmap.
+//! @param	the_dither: a palette_dither value
+//! @return	returns false on any error
+boolean Palette_ImportImage(PaletteInverseMap* the_map, const uint8_t* the_pixels, uint8_t the_format, signed int width, signed int height, signed long the_stride, Bitmap* the_bitmap, signed int x, signed int y, uint8_t the_dither)
+{
+	PaletteImporter*	the_importer;
+	signed int			the_row;
+	signed int			last_row;
+
+	if (the_pixels == NULL)
+	{
+		LOG_ERR(("%s %d: passed pixels was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_importer = Palette_NewImporter(the_map, the_bitmap, x, y, width, height, the_format, the_dither)) == NULL)
+	{
+		return false;
+	}
+
+	// rows below the bitmap affect nothing. only diffusion needs the rows above it.
+	last_row = (height < the_bitmap->height_ - y) ? height : the_bitmap->height_ - y;
+	the_row = (y < 0 && the_dither != PALETTE_DITHER_DIFFUSION) ? -y : 0;
+	the_importer->row_ = the_row;
+
+	for (; the_row < last_row; the_row++)
+	{
+		if (!Palette_ImportRow(the_importer, the_pixels + the_row * the_stride))
+		{
+			goto error;
+		}
+	}
+
+	Palette_DestroyImporter(&the_importer);
+
+	return true;
+
+error:
+	Palette_DestroyImporter(&the_importer);
+
+	return false;
+}
+
+
+
+
+
+// **** Palette quantizer functions ****
+
+//! Create a palette quantizer, with an empty histogram
+//! @return	returns NULL on any error
+PaletteQuantizer* Palette_NewQuantizer(void)
+{
+	PaletteQuantizer*	the_quantizer;
+
+	if ((the_quantizer = f_calloc(1, sizeof(PaletteQuantizer), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for palette quantizer", __func__, __LINE__));
+		return NULL;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_quantizer	%p	size	%i", __func__ , __LINE__, the_quantizer, sizeof(PaletteQuantizer)));
+
+	if ((the_quantizer->histogram_ = f_calloc(PALETTE_QUANTIZE_CELLS, sizeof(uint32_t), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for palette quantizer histogram", __func__, __LINE__));
+		Palette_DestroyQuantizer(&the_quantizer);
+		return NULL;
+	}
+
+	return the_quantizer;
+}
+
+
+//! Free a palette quantizer, and all memory associated with it
+boolean Palette_DestroyQuantizer(PaletteQuantizer** the_quantizer)
+{
+	if (the_quantizer == NULL || *the_quantizer == NULL)
+	{
+		LOG_ERR(("%s %d: passed quantizer was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if ((*the_quantizer)->histogram_)
+	{
+		f_free((*the_quantizer)->histogram_, MEM_STANDARD);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_quantizer	%p	size	%i", __func__ , __LINE__, *the_quantizer, sizeof(PaletteQuantizer)));
+	f_free(*the_quantizer, MEM_STANDARD);
+	*the_quantizer = NULL;
+
+	return true;
+}
+
+
+//! Add a row of truecolor pixels to a palette quantizer's histogram
+//! Call for every row of every image that will share the palette. Rows of one image can be added as it is streamed in.
+//! @param	the_pixels: the row to add
+//! @param	the_format: a palette_pixel_format value, describing the_pixels
+//! @param	num_pixels: the number of pixels in the row
+//! @return	returns false on any error
+boolean Palette_QuantizerAddRow(PaletteQuantizer* the_quantizer, const uint8_t* the_pixels, uint8_t the_format, signed int num_pixels)
+{
+	signed int		r_offset;
+	signed int		g_offset;
+	signed int		b_offset;
+	signed int		pixel_bytes;
+	signed int		the_shift = 8 - PALETTE_QUANTIZE_BITS;
+
+	if (the_quantizer == NULL || the_pixels == NULL)
+	{
+		LOG_ERR(("%s %d: passed quantizer or pixels was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!Palette_GetPixelLayout(the_format, &r_offset, &g_offset, &b_offset, &pixel_bytes))
+	{
+		LOG_ERR(("%s %d: invalid pixel format (%u)", __func__, __LINE__, the_format));
+		return false;
+	}
+
+	for (; num_pixels > 0; num_pixels--, the_pixels += pixel_bytes)
+	{
+		the_quantizer->histogram_[((the_pixels[r_offset] >> the_shift) << (PALETTE_QUANTIZE_BITS * 2)) | ((the_pixels[g_offset] >> the_shift) << PALETTE_QUANTIZE_BITS) | (the_pixels[b_offset] >> the_shift)]++;
+
+		if (++the_quantizer->num_pixels_ > PALETTE_QUANTIZE_MAX_PIXELS)
+		{
+			Palette_HalveHistogram(the_quantizer);
+		}
+	}
+
+	return true;
+}
+
+
+//! Add every pixel of an 8-bit bitmap to a palette quantizer's histogram
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_palette: the BITMAP_PALETTE_BYTES palette the bitmap was drawn with
+//! @return	returns false on any error
+boolean Palette_QuantizerAddBitmap(PaletteQuantizer* the_quantizer, Bitmap* the_bitmap, const uint8_t* the_palette)
+{
+	unsigned long	the_count[PALETTE_NUM_ENTRIES];
+	unsigned char*	the_read_loc;
+	const uint8_t*	the_entry;
+	signed int		the_shift = 8 - PALETTE_QUANTIZE_BITS;
+	signed int		the_row;
+	signed int		x;
+	signed int		i;
+	long			the_cell;
+
+	if (the_quantizer == NULL || the_bitmap == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed quantizer, bitmap, or palette was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	// LOGIC:
+	//   an 8-bit bitmap has at most 256 colors: count how many pixels use each, then add each color's count to its cell in one go.
+	//   rows are read through Bitmap_GetMemLocForXY, so any lazily-cleared bands are cleared before they are read.
+
+	memset(the_count, 0, sizeof(the_count));
+
+	for (the_row = 0; the_row < the_bitmap->height_; the_row++)
+	{
+		if ((the_read_loc = Bitmap_GetMemLocForXY(the_bitmap, 0, the_row)) == NULL)
+		{
+			return false;
+		}
+
+		for (x = 0; x < the_bitmap->width_; x++)
+		{
+			the_count[*the_read_loc++]++;
+		}
+	}
+
+	for (i = 0, the_entry = the_palette; i < PALETTE_NUM_ENTRIES; i++, the_entry += 4)
+	{
+		if (the_count[i] == 0)
+		{
+			continue;
+		}
+
+		the_cell = ((the_entry[2] >> the_shift) << (PALETTE_QUANTIZE_BITS * 2)) | ((the_entry[1] >> the_shift) << PALETTE_QUANTIZE_BITS) | (the_entry[0] >> the_shift);
+
+		// one bitmap is at most 4 million pixels, so adding its counts can't overflow before the halving brings the total back down
+		the_quantizer->histogram_[the_cell] += the_count[i];
+		the_quantizer->num_pixels_ += the_count[i];
+
+		while (the_quantizer->num_pixels_ > PALETTE_QUANTIZE_MAX_PIXELS)
+		{
+			Palette_HalveHistogram(the_quantizer);
+		}
+	}
+
+	return true;
+}
+
+
+//! Build a palette for every pixel added to a palette quantizer so far
+//! The histogram is not changed: more pixels can be added, and the palette built again.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Entries outside the range are reserved: they are left as they are, and colors close to them are not given entries of their own.
+//! @param	first_entry: the first palette entry the quantizer can fill in
+//! @param	num_entries: the number of palette entries the quantizer can fill in. Clipped to the end of the palette.
+//! @return	returns the number of entries filled in, from the first entry up (fewer than num_entries if the images have fewer colors), or -1 on any error. Entries of the range not filled in are set to black.
+signed int Palette_QuantizerBuildPalette(PaletteQuantizer* the_quantizer, uint8_t* the_palette, uint8_t first_entry, signed int num_entries)
+{
+	PaletteQuantizeBox*	the_box = NULL;
+	uint32_t*			the_histogram = NULL;
+	uint8_t*			the_entry;
+	unsigned long		the_sum[3];
+	unsigned long		the_score;
+	unsigned long		best_score;
+	uint32_t			the_count;
+	signed int			num_boxes;
+	signed int			best_box;
+	signed int			the_half = 1 << (7 - PALETTE_QUANTIZE_BITS);
+	signed int			the_diff;
+	signed int			the_distance;
+	signed int			r;
+	signed int			g;
+	signed int			b;
+	signed int			i;
+	long				the_cell;
+
+	if (the_quantizer == NULL || the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed quantizer or palette was NULL", __func__, __LINE__));
+		return -1;
+	}
+
+	if (num_entries > PALETTE_NUM_ENTRIES - first_entry)
+	{
+		num_entries = PALETTE_NUM_ENTRIES - first_entry;
+	}
+
+	if (num_entries < 1)
+	{
+		LOG_ERR(("%s %d: invalid number of entries (%i)", __func__, __LINE__, num_entries));
+		return -1;
+	}
+
+	if ((the_histogram = f_calloc(PALETTE_QUANTIZE_CELLS, sizeof(uint32_t), MEM_STANDARD)) == NULL || (the_box = f_calloc(num_entries, sizeof(PaletteQuantizeBox), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space to build a palette", __func__, __LINE__));
+		goto error;
+	}
+
+	// LOGIC:
+	//   work on a copy of the histogram, with the colors the reserved entries already cover taken out, so they don't pull free entries toward them.
+	//   then median cut: start with one box holding every color, and keep splitting the box with the highest score at the median of its longest side,
+	//   until there is a box for each free entry, or no box can be split. the score is pixels x longest side, so big, busy boxes split first,
+	//   but a small cluster of distinct colors (a highlight, say) still gets split before a huge block of nearly one color.
+	//   each entry becomes the average color of its box's pixels.
+	//   num_pixels_ is kept under PALETTE_QUANTIZE_MAX_PIXELS, so no score or sum of (count x color) can overflow 32 bits.
+
+	memcpy(the_histogram, the_quantizer->histogram_, PALETTE_QUANTIZE_CELLS * sizeof(uint32_t));
+
+	for (the_cell = 0; the_cell < PALETTE_QUANTIZE_CELLS; the_cell++)
+	{
+		if (the_histogram[the_cell] == 0)
+		{
+			continue;
+		}
+
+		r = ((the_cell >> (PALETTE_QUANTIZE_BITS * 2)) << (8 - PALETTE_QUANTIZE_BITS)) | the_half;
+		g = (((the_cell >> PALETTE_QUANTIZE_BITS) & ((1 << PALETTE_QUANTIZE_BITS) - 1)) << (8 - PALETTE_QUANTIZE_BITS)) | the_half;
+		b = ((the_cell & ((1 << PALETTE_QUANTIZE_BITS) - 1)) << (8 - PALETTE_QUANTIZE_BITS)) | the_half;
+
+		for (i = 0, the_entry = the_palette; i < PALETTE_NUM_ENTRIES; i++, the_entry += 4)
+		{
+			if (i >= first_entry && i < first_entry + num_entries)
+			{
+				continue;
+			}
+
+			the_diff = the_entry[2] - r;
+			the_distance = the_diff * the_diff;
+			the_diff = the_entry[1] - g;
+			the_distance += the_diff * the_diff;
+			the_diff = the_entry[0] - b;
+			the_distance += the_diff * the_diff;
+
+			if (the_distance < PALETTE_QUANTIZE_RESERVED_DISTANCE)
+			{
+				the_histogram[the_cell] = 0;
+				break;
+			}
+		}
+	}
+
+	memset(the_box[0].min_, 0, 3);
+	memset(the_box[0].max_, (1 << PALETTE_QUANTIZE_BITS) - 1, 3);
+	Palette_ShrinkQuantizeBox(the_histogram, &the_box[0]);
+	num_boxes = (the_box[0].count_ > 0) ? 1 : 0;
+
+	while (num_boxes > 0 && num_boxes < num_entries)
+	{
+		best_box = -1;
+		best_score = 0;
+
+		for (i = 0; i < num_boxes; i++)
+		{
+			r = the_box[i].max_[0] - the_box[i].min_[0];
+			g = the_box[i].max_[1] - the_box[i].min_[1];
+			b = the_box[i].max_[2] - the_box[i].min_[2];
+			the_diff = (r > g) ? ((r > b) ? r : b) : ((g > b) ? g : b);
+			the_score = the_box[i].count_ * the_diff;
+
+			if (the_diff > 0 && (best_box < 0 || the_score > best_score))
+			{
+				best_box = i;
+				best_score = the_score;
+			}
+		}
+
+		if (best_box < 0 || !Palette_SplitQuantizeBox(the_histogram, &the_box[best_box], &the_box[num_boxes]))
+		{
+			break;
+		}
+
+		num_boxes++;
+	}
+
+	memset(&the_palette[first_entry * 4], 0, num_entries * 4);
+
+	for (i = 0; i < num_boxes; i++)
+	{
+		memset(the_sum, 0, sizeof(the_sum));
+
+		for (r = the_box[i].min_[0]; r <= the_box[i].max_[0]; r++)
+		{
+			for (g = the_box[i].min_[1]; g <= the_box[i].max_[1]; g++)
+			{
+				for (b = the_box[i].min_[2]; b <= the_box[i].max_[2]; b++)
+				{
+					the_count = the_histogram[(r << (PALETTE_QUANTIZE_BITS * 2)) | (g << PALETTE_QUANTIZE_BITS) | b];
+					the_sum[0] += the_count * r;
+					the_sum[1] += the_count * g;
+					the_sum[2] += the_count * b;
+				}
+			}
+		}
+
+		the_entry = &the_palette[(first_entry + i) * 4];
+		the_entry[2] = ((the_sum[0] << (8 - PALETTE_QUANTIZE_BITS)) + the_box[i].count_ / 2) / the_box[i].count_ + the_half;
+		the_entry[1] = ((the_sum[1] << (8 - PALETTE_QUANTIZE_BITS)) + the_box[i].count_ / 2) / the_box[i].count_ + the_half;
+		the_entry[0] = ((the_sum[2] << (8 - PALETTE_QUANTIZE_BITS)) + the_box[i].count_ / 2) / the_box[i].count_ + the_half;
+	}
+
+	f_free(the_histogram, MEM_STANDARD);
+	f_free(the_box, MEM_STANDARD);
+
+	return num_boxes;
+
+error:
+	if (the_histogram)
+	{
+		f_free(the_histogram, MEM_STANDARD);
+	}
+
+	if (the_box)
+	{
+		f_free(the_box, MEM_STANDARD);
+	}
+
+	return -1;
+}
+
+
+
+
+
+// **** Blend table functions ****
+
+//! Get a blend table for a palette and opacity, building it if it isn't in the cache
+//! Entry s * 256 + d of the table is the palette entry closest to color s mixed over color d at the passed opacity.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	the_opacity: from 0 (source colors are invisible) to PALETTE_BLEND_MAX (source colors are solid). PALETTE_BLEND_MAX / 2 mixes them evenly.
+//! @return	returns the table, or NULL on any error. The table belongs to the cache: it stays valid until PALETTE_BLEND_CACHE_SIZE other tables have been built, or the cache is flushed.
+const uint8_t* Palette_GetBlendTable(const uint8_t* the_palette, signed int the_opacity)
+{
+	PaletteBlendTable*	the_entry;
+	PaletteBlendTable*	oldest_entry = NULL;
+	signed int			i;
+
+	if (the_palette == NULL)
+	{
+		LOG_ERR(("%s %d: passed palette was NULL", __func__, __LINE__));
+		return NULL;
+	}
+
+	if (the_opacity < 0 || the_opacity > PALETTE_BLEND_MAX)
+	{
+		LOG_ERR(("%s %d: invalid opacity (%i)", __func__, __LINE__, the_opacity));
+		return NULL;
+	}
+
+	global_blend_clock++;
+
+	// LOGIC:
+	//   a cached table is only reused if it was built for the same opacity and exactly the same palette.
+	//   otherwise the least recently used entry (or an empty one) is rebuilt. its memory is reused if it has any.
+
+	for (i = 0; i < PALETTE_BLEND_CACHE_SIZE; i++)
+	{
+		the_entry = &global_blend_cache[i];
+
+		if (the_entry->table_ && the_entry->opacity_ == the_opacity && memcmp(the_entry->palette_, the_palette, BITMAP_PALETTE_BYTES) == 0)
+		{
+			the_entry->last_used_ = global_blend_clock;
+			return the_entry->table_;
+		}
+
+		// an empty entry, once found, is never passed over for a used one
+		if (oldest_entry == NULL || (oldest_entry->table_ && (the_entry->table_ == NULL || the_entry->last_used_ < oldest_entry->last_used_)))
+		{
+			oldest_entry = the_entry;
+		}
+	}
+
+	the_entry = oldest_entry;
+
+	if (the_entry->table_ == NULL)
+	{
+		if ((the_entry->table_ = f_calloc(PALETTE_BLEND_TABLE_BYTES, 1, MEM_STANDARD)) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't allocate space for a blend table", __func__, __LINE__));
+			return NULL;
+		}
+		LOG_ALLOC(("%s %d:	__ALLOC__	the_entry->table_	%p	size	%i", __func__ , __LINE__, the_entry->table_, PALETTE_BLEND_TABLE_BYTES));
+	}
+
+	if (!Palette_BuildBlendTable(the_palette, the_opacity, the_entry->table_))
+	{
+		LOG_ERR(("%s %d: Couldn't allocate an inverse color map to build a blend table", __func__, __LINE__));
+		f_free(the_entry->table_, MEM_STANDARD);
+		the_entry->table_ = NULL;
+		return NULL;
+	}
+
+	memcpy(the_entry->palette_, the_palette, BITMAP_PALETTE_BYTES);
+	the_entry->opacity_ = the_opacity;
+	the_entry->last_used_ = global_blend_clock;
+
+	return the_entry->table_;
+}
+
+
+//! Free every blend table in the cache
+void Palette_FlushBlendTables(void)
+{
+	signed int		i;
+
+	for (i = 0; i < PALETTE_BLEND_CACHE_SIZE; i++)
+	{
+		if (global_blend_cache[i].table_)
+		{
+			LOG_ALLOC(("%s %d:	__FREE__	global_blend_cache[i].table_	%p	size	%i", __func__ , __LINE__, global_blend_cache[i].table_, PALETTE_BLEND_TABLE_BYTES));
+			f_free(global_blend_cache[i].table_, MEM_STANDARD);
+			global_blend_cache[i].table_ = NULL;
+		}
+	}
+}
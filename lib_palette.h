@@ -0,0 +1,511 @@
+//! @file lib_palette.h
+
+/*
+ * lib_palette.h
+ *
+*  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+#ifndef LIB_PALETTE_H_
+#define LIB_PALETTE_H_
+
+
+/* about this library: Palette
+ *
+ * This provides functionality for reading and changing a screen's graphics LUT, loading palettes from disk, and animating the LUT.
+ *
+ * Palettes are BITMAP_PALETTE_BYTES buffers in LUT order: 256 entries of B, G, R, A. Ranges of entries are written to the LUT in one pass.
+ *
+ * A palette cycler rotates ranges of LUT entries, each at its own speed and in its own direction, every time Palette_CycleTick() is called.
+ * Anything drawn in those colors appears to move (water, lights, progress bars) while only a few LUT entries are written per frame and no pixels are redrawn.
+ *
+ * A palette fade works out every step of a fade between two palettes (or to black) when it is created, so each frame of the fade is only LUT writes.
+ * For each step it also keeps a list of the runs of entries that differ from the step before, so stepping through a fade can skip entries that don't change.
+ *
+ * Remap tables, for Graphics_RemapRect() and Graphics_BlitBitMapRemapped(), can be built from a palette: each entry is mapped to the palette's closest match
+ * to a darker, lighter, or tinted version of its color.
+ *
+ * An inverse color map finds the closest palette entry to any RGB color with a table lookup. The RGB color space is divided into a grid of cells
+ * (15 or 18 bits' worth), and each cell is searched for the first time a color lands in it, so the map costs nothing for colors never asked for.
+ * A map can follow a screen's LUT: it notices when anything in this library writes to the LUT, and forgets its cells only if the colors really changed.
+ *
+ * A palette importer converts truecolor images (RGB24 or RGBA32) to 8-bit, one row at a time, matching colors through an inverse color map.
+ * Images can be dithered with a 4x4 Bayer pattern, or with Floyd-Steinberg error diffusion, which keeps only two rows of errors.
+ * Memory use depends only on the width of the image, so a file loader can feed rows in as it decodes them. With a map that follows the screen,
+ * images are converted to whatever the LUT is at the time they are loaded.
+ *
+ * A palette quantizer picks the palette for a set of images that must share the LUT. Any number of images (truecolor rows, or 8-bit bitmaps with their palettes)
+ * are added to one histogram of 15-bit color cells, which never grows, then a median cut splits the colors into as many boxes as there are free LUT entries.
+ * Reserved entries, such as the UI colors, are left alone, and colors they already cover well don't use up free entries.
+ * Images are then remapped to the new palette: truecolor ones through a palette importer, and 8-bit ones with a remap table from Palette_BuildRemapTable().
+ *
+ * Blend tables, for Graphics_BlitBlended() and Graphics_FillBoxBlended(), give translucency with indexed color: for every pair of source and destination colors,
+ * the palette's closest match to the two mixed at a given opacity. They take 64KB each and are slow to build, so the last few built are kept in a cache.
+ *
+ */
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_graphics.h"
+#include "lib_bitmap_file.h"
+
+// C includes
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                            Macro Definitions                              */
+/*****************************************************************************/
+
+#define PALETTE_NUM_ENTRIES			256		//!< number of entries in a graphics LUT
+#define PALETTE_RGB_FILE_BYTES		768		//!< size of a palette file of 256 R, G, B entries
+#define PALETTE_MAX_CYCLES			8		//!< number of ranges one palette cycler can rotate
+#define PALETTE_NO_CYCLE			-1		//!< returned by Palette_AddCycle on any error
+#define PALETTE_FADE_MAX_STEPS		256		//!< most steps a palette fade can have
+
+#define PALETTE_BLEND_MAX			256		//!< for the remap table builders: the amount that blends a color all the way to the target color
+
+#define PALETTE_BLEND_TABLE_BYTES	65536	//!< size of a blend table: 256 source colors x 256 destination colors
+#define PALETTE_BLEND_CACHE_SIZE	4		//!< number of blend tables Palette_GetBlendTable keeps built
+
+#define PALETTE_INVERSE_15_BIT		5		//!< for Palette_NewInverseMap: 5 bits each of R, G, and B. 32KB of cells, plus 4KB of flags.
+#define PALETTE_INVERSE_18_BIT		6		//!< for Palette_NewInverseMap: 6 bits each of R, G, and B. 256KB of cells, plus 32KB of flags. Closer matches for subtle gradients.
+
+#define PALETTE_DITHER_SPREAD		32		//!< for PALETTE_DITHER_ORDERED: the range of the pattern's offsets to each channel. Suits palettes with about 8 levels of each channel.
+
+#define PALETTE_QUANTIZE_BITS		5		//!< bits of each of R, G, and B kept in a palette quantizer's histogram
+#define PALETTE_QUANTIZE_CELLS		(1L << (PALETTE_QUANTIZE_BITS * 3))	//!< number of color cells in a palette quantizer's histogram
+#define PALETTE_QUANTIZE_MAX_PIXELS	0x00FFFFFFL	//!< once a palette quantizer has counted more pixels than this, every count is halved, so no sum of counts and colors can overflow 32 bits
+#define PALETTE_QUANTIZE_RESERVED_DISTANCE	192	//!< colors within this squared RGB distance of a reserved entry are left to that entry by the quantizer
+
+#define PARAM_CHANGED_ONLY			true	//!< for Palette_ApplyFadeStep: only write the entries that differ from the step applied before
+#define PARAM_ALL_ENTRIES			false	//!< for Palette_ApplyFadeStep: write every entry of the fade's range
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+typedef enum palette_cycle_direction
+{
+	PALETTE_CYCLE_FORWARD = 0,	//!< colors move up the range, and the last wraps around to the first
+	PALETTE_CYCLE_BACKWARD,		//!< colors move down the range, and the first wraps around to the last
+	PALETTE_CYCLE_PING_PONG,	//!< colors move up the range until each has moved the length of the range, then back down
+} palette_cycle_direction;
+
+typedef enum palette_pixel_format
+{
+	PALETTE_PIXEL_RGB24 = 0,	//!< 3 bytes per pixel: R, G, B
+	PALETTE_PIXEL_RGBA32,		//!< 4 bytes per pixel: R, G, B, A. Alpha is ignored.
+	PALETTE_PIXEL_BGRA32,		//!< 4 bytes per pixel: B, G, R, A, the same as LUT entries. Alpha is ignored.
+} palette_pixel_format;
+
+typedef enum palette_dither
+{
+	PALETTE_DITHER_NONE = 0,	//!< every pixel becomes the closest palette entry. Fastest, but gradients band.
+	PALETTE_DITHER_ORDERED,		//!< a 4x4 Bayer pattern is added to each pixel before matching. Fast, stable from frame to frame, and rows don't depend on each other.
+	PALETTE_DITHER_DIFFUSION,	//!< Floyd-Steinberg: each pixel's matching error is spread to the pixels right of and below it. Best quality.
+} palette_dither;
+
+
+/*****************************************************************************/
+/*                                 Structs                                   */
+/*****************************************************************************/
+
+typedef struct PaletteCycle PaletteCycle;
+typedef struct PaletteCycler PaletteCycler;
+typedef struct PaletteFade PaletteFade;
+typedef struct PaletteBlendTable PaletteBlendTable;
+typedef struct PaletteInverseMap PaletteInverseMap;
+typedef struct PaletteImporter PaletteImporter;
+typedef struct PaletteQuantizer PaletteQuantizer;
+typedef struct PaletteQuantizeBox PaletteQuantizeBox;
+
+//! One range of LUT entries being rotated
+struct PaletteCycle
+{
+	boolean			in_use_;
+	boolean			paused_;
+	uint8_t			first_;				//!< first LUT entry of the range
+	uint8_t			last_;				//!< last LUT entry of the range
+	uint8_t			direction_;			//!< a palette_cycle_direction value
+	boolean			reversing_;			//!< for PALETTE_CYCLE_PING_PONG: true while the colors are moving back down
+	signed int		ticks_per_step_;	//!< number of calls to Palette_CycleTick() between each step of the rotation
+	signed int		ticks_left_;		//!< calls to Palette_CycleTick() left before the next step
+	signed int		offset_;			//!< how many entries the colors are currently rotated up the range, from 0 to the length of the range - 1
+};
+
+struct PaletteCycler
+{
+	Screen*			screen_;
+	PaletteCycle	cycle_[PALETTE_MAX_CYCLES];
+	uint8_t			palette_[BITMAP_PALETTE_BYTES];	//!< the palette the ranges are rotated from
+};
+
+struct PaletteFade
+{
+	uint8_t			first_;			//!< first LUT entry the fade changes
+	signed int		num_entries_;	//!< number of LUT entries the fade changes
+	signed int		num_steps_;		//!< step 0 is the starting palette, step num_steps_ is the ending palette
+	signed int		last_step_;		//!< the step most recently applied, or -1 if none has been
+	uint8_t*		step_;			//!< (num_steps_ + 1) * num_entries_ LUT entries: the fade's range at each step
+	signed int*		run_index_;		//!< for each step from 1 to num_steps_, the index of its first run in run_. Entry 0 is unused, and entry num_steps_ + 1 is the total number of runs.
+	uint16_t*		run_;			//!< pairs of (first entry, number of entries): the runs of entries that differ between each step and the one before it
+};
+
+struct PaletteInverseMap
+{
+	Screen*			screen_;		//!< the screen whose LUT the map follows, or NULL if the map is for a fixed palette
+	unsigned long	generation_;	//!< for maps that follow a screen: how many times this library had written to a LUT when the map last checked the screen's
+	uint8_t			bits_;			//!< bits of each of R, G, and B that pick a cell: PALETTE_INVERSE_15_BIT or PALETTE_INVERSE_18_BIT
+	uint8_t*		cell_;			//!< 2 ^ (3 * bits_) palette indexes, one for each cell, valid only where found_ says so
+	uint8_t*		found_;			//!< 1 bit per cell: set once the cell has been searched
+	uint8_t			sorted_index_[PALETTE_NUM_ENTRIES];	//!< palette indexes, sorted by green, then by index
+	uint8_t			sorted_green_[PALETTE_NUM_ENTRIES];	//!< the green of each entry of sorted_index_
+	uint8_t			palette_[BITMAP_PALETTE_BYTES];		//!< the palette the map finds matches in
+};
+
+//! The state of a truecolor image being converted into a bitmap, row by row
+struct PaletteImporter
+{
+	PaletteInverseMap*	map_;		//!< the map colors are matched through. Not owned by the importer.
+	Bitmap*			bitmap_;		//!< the bitmap rows are written into
+	signed int		x_;				//!< where in bitmap_ the top left corner of the image goes
+	signed int		y_;
+	signed int		width_;			//!< width of the image in pixels
+	signed int		height_;		//!< height of the image in pixels
+	signed int		row_;			//!< the image row the next call to Palette_ImportRow() converts
+	signed int		left_;			//!< first image column inside the bitmap
+	signed int		right_;			//!< image column after the last one inside the bitmap
+	uint8_t			format_;		//!< a palette_pixel_format value
+	uint8_t			dither_;		//!< a palette_dither value
+	signed short*	error_;			//!< for PALETTE_DITHER_DIFFUSION: 2 rows of (width_ + 2) R, G, B errors, x 16. NULL otherwise.
+	signed short*	this_error_;	//!< the errors being added to the row being converted. Has a spare pixel at each end, so edges need no checks.
+	signed short*	next_error_;	//!< the errors being spread to the row below
+};
+
+struct PaletteQuantizer
+{
+	uint32_t*		histogram_;		//!< PALETTE_QUANTIZE_CELLS pixel counts, one for each color cell. Cell (r << 10) | (g << 5) | b.
+	unsigned long	num_pixels_;	//!< total of the counts in histogram_
+};
+
+//! A box of color cells, used while a palette quantizer builds a palette
+struct PaletteQuantizeBox
+{
+	uint8_t			min_[3];		//!< lowest cell of the box with any pixels, for R, G, and B
+	uint8_t			max_[3];		//!< highest cell of the box with any pixels, for R, G, and B
+	unsigned long	count_;			//!< number of pixels in the box
+};
+
+//! One entry in the blend table cache
+struct PaletteBlendTable
+{
+	uint8_t*		table_;			//!< PALETTE_BLEND_TABLE_BYTES LUT indexes, or NULL if this cache entry is empty
+	signed int		opacity_;		//!< opacity of the source colors the table was built for
+	unsigned long	last_used_;		//!< when the table was last requested, to find the least recently used one
+	uint8_t			palette_[BITMAP_PALETTE_BYTES];	//!< the palette the table was built for
+};
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+/*****************************************************************************/
+/*                       Public Function Prototypes                         */
+/*****************************************************************************/
+
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a palette cycler for a screen
+//! The cycler starts with no ranges. Add them with Palette_AddCycle().
+//! @param	the_screen: reference to a valid Screen object. Its vicky_ register pointer can be a stand-in block of normal memory, for testing.
+//! @param	the_palette: the palette to rotate ranges of. It is copied, and written to the screen's LUT.
+//! @return	returns NULL on any error
+PaletteCycler* Palette_NewCycler(Screen* the_screen, const uint8_t* the_palette);
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. The LUT is left as it is.
+boolean Palette_DestroyCycler(PaletteCycler** the_cycler);
+
+
+// **** LUT functions ****
+
+//! Write a range of entries of a palette to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Only the entries in the range are written, each to the LUT entry with the same index.
+//! @param	first_entry: the first LUT entry to write
+//! @param	num_entries: the number of LUT entries to write. Clipped to the end of the LUT.
+//! @return	returns false on any error
+boolean Palette_SetLUT(Screen* the_screen, const uint8_t* the_palette, uint8_t first_entry, signed int num_entries);
+
+//! Read a range of entries of a screen's graphics LUT into a palette
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Only the entries in the range are read into it, each from the LUT entry with the same index.
+//! @param	first_entry: the first LUT entry to read
+//! @param	num_entries: the number of LUT entries to read. Clipped to the end of the LUT.
+//! @return	returns false on any error
+boolean Palette_GetLUT(Screen* the_screen, uint8_t* the_palette, uint8_t first_entry, signed int num_entries);
+
+//! Set one entry of a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_entry: the LUT entry to set
+//! @param	r, g, b: the color
+//! @return	returns false on any error
+boolean Palette_SetColor(Screen* the_screen, uint8_t the_entry, uint8_t r, uint8_t g, uint8_t b);
+
+
+// **** Load functions ****
+
+//! Load a palette file
+//! Accepted formats are: a raw LUT dump (BITMAP_PALETTE_BYTES bytes of B, G, R, A), a raw R, G, B file (PALETTE_RGB_FILE_BYTES bytes), and JASC-PAL text files.
+//! Entries the file doesn't define are set to 0.
+//! @param	the_path: path of the palette file
+//! @param	the_palette: a BITMAP_PALETTE_BYTES buffer to receive the palette, in LUT order
+//! @return	returns false on any error
+boolean Palette_LoadFromFile(const char* the_path, uint8_t* the_palette);
+
+//! Load a palette file, and write all of it to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_path: path of the palette file. See Palette_LoadFromFile() for the formats accepted.
+//! @return	returns false on any error
+boolean Palette_LoadLUTFromFile(Screen* the_screen, const char* the_path);
+
+
+// **** Palette cycling functions ****
+
+//! Add a range of LUT entries to rotate
+//! Ranges should not overlap.
+//! @param	first_entry, last_entry: the first and last LUT entries of the range
+//! @param	ticks_per_step: the number of calls to Palette_CycleTick() between each step of the rotation. 1 rotates on every call.
+//! @param	the_direction: a palette_cycle_direction value
+//! @return	returns the id of the new range, or PALETTE_NO_CYCLE on any error, or if the cycler already has PALETTE_MAX_CYCLES ranges
+signed int Palette_AddCycle(PaletteCycler* the_cycler, uint8_t first_entry, uint8_t last_entry, signed int ticks_per_step, uint8_t the_direction);
+
+//! Stop rotating a range of LUT entries, and put its entries back as they are in the cycler's palette
+//! @param	the_id: the id returned by Palette_AddCycle()
+//! @return	returns false on any error
+boolean Palette_RemoveCycle(PaletteCycler* the_cycler, signed int the_id);
+
+//! Pause or resume the rotation of a range of LUT entries
+//! A paused range stays as it is in the LUT until it is resumed.
+//! @param	the_id: the id returned by Palette_AddCycle()
+//! @param	paused: true to pause the range, false to resume it
+//! @return	returns false on any error
+boolean Palette_PauseCycle(PaletteCycler* the_cycler, signed int the_id, boolean paused);
+
+//! Replace the palette a cycler rotates ranges of
+//! Each range keeps its current rotation. The whole new palette is written to the LUT, rotated where the ranges are.
+//! @param	the_palette: the new palette. It is copied.
+//! @return	returns false on any error
+boolean Palette_SetCyclerPalette(PaletteCycler* the_cycler, const uint8_t* the_palette);
+
+//! Advance every range of a palette cycler, writing the ranges that moved to the LUT
+//! Call once per frame (or at any steady rate): range speeds are counted in calls to this function.
+//! @return	returns the number of ranges that moved and were written to the LUT, or -1 on any error
+signed int Palette_CycleTick(PaletteCycler* the_cycler);
+
+
+// **** Palette fade functions ****
+
+//! Create a fade between two palettes, working out every step of it
+//! @param	from_palette: the palette at the start of the fade
+//! @param	to_palette: the palette at the end of the fade, or NULL to fade to black
+//! @param	first_entry: the first LUT entry the fade changes
+//! @param	num_entries: the number of LUT entries the fade changes. Clipped to the end of the LUT.
+//! @param	num_steps: the number of steps from the first palette to the second, from 1 to PALETTE_FADE_MAX_STEPS
+//! @return	returns NULL on any error
+PaletteFade* Palette_NewFade(const uint8_t* from_palette, const uint8_t* to_palette, uint8_t first_entry, signed int num_entries, signed int num_steps);
+
+//! Free a palette fade, and all memory associated with it
+boolean Palette_DestroyFade(PaletteFade** the_fade);
+
+//! Get the LUT entries of one step of a fade
+//! Useful to fade a palette cycler's palette, with Palette_SetCyclerPalette(), instead of writing to the LUT directly.
+//! @param	the_step: from 0 (the starting palette) to the number of steps (the ending palette)
+//! @return	returns the fade's range of entries at that step, starting with its first entry, or NULL on any error
+const uint8_t* Palette_GetFadeStep(PaletteFade* the_fade, signed int the_step);
+
+//! Write one step of a fade to a screen's graphics LUT
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_step: from 0 (the starting palette) to the number of steps (the ending palette)
+//! @param	changed_only: PARAM_CHANGED_ONLY or PARAM_ALL_ENTRIES. Changed-only writes are only possible when the step applied before was the one just before or after this one; otherwise every entry is written.
+//! @return	returns false on any error
+boolean Palette_ApplyFadeStep(PaletteFade* the_fade, Screen* the_screen, signed int the_step, boolean changed_only);
+
+//! Write the next step of a fade to a screen's graphics LUT, writing only the entries that changed
+//! The first call writes step 0.
+//! @param	the_screen: reference to a valid Screen object
+//! @return	returns the number of steps left after this one (0 once the ending palette has been written), or -1 on any error
+signed int Palette_FadeTick(PaletteFade* the_fade, Screen* the_screen);
+
+
+// **** Remap table functions ****
+
+//! Find the palette entry closest to a color
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to search the screen's current LUT.
+//! @param	r, g, b: the color to match
+//! @return	returns the index of the entry with the smallest RGB distance to the color. Ties go to the lowest index.
+uint8_t Palette_FindNearestColor(const uint8_t* the_palette, uint8_t r, uint8_t g, uint8_t b);
+
+//! Build a remap table that darkens or lightens every color of a palette
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	the_amount: from -PALETTE_BLEND_MAX (every color becomes black) through 0 (no change) to PALETTE_BLEND_MAX (every color becomes white)
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the palette entry closest to the shaded color of entry n.
+//! @return	returns false on any error
+boolean Palette_BuildShadeTable(const uint8_t* the_palette, signed int the_amount, uint8_t* the_table);
+
+//! Build a remap table that blends every color of a palette toward one color
+//! Use for team colors, selection highlights, and tinted or greyed-out widgets.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	r, g, b: the color to blend toward
+//! @param	the_amount: from 0 (no change) to PALETTE_BLEND_MAX (every color becomes r, g, b, or the closest the palette has)
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the palette entry closest to the blended color of entry n.
+//! @return	returns false on any error
+boolean Palette_BuildTintTable(const uint8_t* the_palette, uint8_t r, uint8_t g, uint8_t b, signed int the_amount, uint8_t* the_table);
+
+
+//! Build a remap table from one palette to another
+//! Use with Graphics_RemapRect() to convert an 8-bit image drawn with one palette to another, such as a palette built by a palette quantizer.
+//! @param	from_palette: the BITMAP_PALETTE_BYTES palette the image was drawn with
+//! @param	to_palette: the BITMAP_PALETTE_BYTES palette to convert it to
+//! @param	the_table: a 256-byte table to fill. Entry n is set to the entry of to_palette closest to entry n of from_palette.
+//! @return	returns false on any error
+boolean Palette_BuildRemapTable(const uint8_t* from_palette, const uint8_t* to_palette, uint8_t* the_table);
+
+
+// **** Inverse color map functions ****
+
+//! Create an inverse color map, to find the closest entries of a fixed palette to RGB colors
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. It is copied.
+//! @param	the_bits: PALETTE_INVERSE_15_BIT or PALETTE_INVERSE_18_BIT
+//! @return	returns NULL on any error
+PaletteInverseMap* Palette_NewInverseMap(const uint8_t* the_palette, uint8_t the_bits);
+
+//! Create an inverse color map that follows a screen's graphics LUT
+//! Whenever a color is mapped, the map checks whether this library has written to any LUT since it last looked, and if the screen's LUT has really changed, starts over.
+//! LUT changes made without this library are not noticed: call Palette_SetInverseMapPalette() after making them.
+//! @param	the_screen: reference to a valid Screen object
+//! @param	the_bits: PALETTE_INVERSE_15_BIT or PALETTE_INVERSE_18_BIT
+//! @return	returns NULL on any error
+PaletteInverseMap* Palette_NewInverseMapForScreen(Screen* the_screen, uint8_t the_bits);
+
+//! Free an inverse color map, and all memory associated with it
+boolean Palette_DestroyInverseMap(PaletteInverseMap** the_map);
+
+//! Change the palette an inverse color map finds matches in
+//! Cells already searched are forgotten, unless the new palette is the same as the old one.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. It is copied. For a map that follows a screen, pass NULL to re-read the screen's LUT.
+//! @return	returns false on any error
+boolean Palette_SetInverseMapPalette(PaletteInverseMap* the_map, const uint8_t* the_palette);
+
+//! Find the closest palette entry to an RGB color
+//! The match is the closest entry to the center of the color's cell, so it can differ slightly from Palette_FindNearestColor() for the exact color.
+//! @param	r, g, b: the color to match
+//! @return	returns the index of the closest palette entry, or 0 on any error
+uint8_t Palette_MapColor(PaletteInverseMap* the_map, uint8_t r, uint8_t g, uint8_t b);
+
+//! Find the closest palette entry to every pixel of a row of RGB pixels
+//! @param	the_pixels: the row to convert
+//! @param	the_format: a palette_pixel_format value, describing the_pixels
+//! @param	the_dest: num_pixels bytes to receive the palette indexes. Can be a row of a bitmap (see Bitmap_GetMemLocForWrite()).
+//! @param	num_pixels: the number of pixels in the row
+//! @return	returns false on any error
+boolean Palette_MapRow(PaletteInverseMap* the_map, const uint8_t* the_pixels, uint8_t the_format, uint8_t* the_dest, signed int num_pixels);
+
+
+// **** Truecolor import functions ****
+
+//! Create an importer, to convert a truecolor image into a bitmap one row at a time
+//! @param	the_map: the inverse color map to match colors through. For the screen's current LUT, use Palette_NewInverseMapForScreen(). It is not copied: keep it until the importer is destroyed.
+//! @param	the_bitmap: reference to a valid Bitmap object to write rows into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. The image is clipped to the bitmap.
+//! @param	width, height: size of the image in pixels
+//! @param	the_format: a palette_pixel_format value, describing the rows that will be passed to Palette_ImportRow()
+//! @param	the_dither: a palette_dither value
+//! @return	returns NULL on any error
+PaletteImporter* Palette_NewImporter(PaletteInverseMap* the_map, Bitmap* the_bitmap, signed int x, signed int y, signed int width, signed int height, uint8_t the_format, uint8_t the_dither);
+
+//! Free an importer, and all memory associated with it. The bitmap and inverse color map are not affected.
+boolean Palette_DestroyImporter(PaletteImporter** the_importer);
+
+//! Convert the next row of the image, and write it into the bitmap
+//! Rows must be passed in order, from the top of the image down. Rows and columns outside the bitmap are not written, but still spread their errors when diffusing.
+//! @param	the_pixels: width pixels, in the importer's format
+//! @return	returns false on any error, or if every row of the image has already been imported
+boolean Palette_ImportRow(PaletteImporter* the_importer, const uint8_t* the_pixels);
+
+//! Convert a whole truecolor image in memory, and write it into a bitmap
+//! @param	the_map: the inverse color map to match colors through
+//! @param	the_pixels: the first row of the image
+//! @param	the_format: a palette_pixel_format value
+//! @param	width, height: size of the image in pixels
+//! @param	the_stride: bytes from the start of one row of the_pixels to the start of the next
+//! @param	the_bitmap: reference to a valid Bitmap object to write the image into
+//! @param	x, y: where in the_bitmap the top left corner of the image should go. The image is clipped to the bitmap.
+//! @param	the_dither: a palette_dither value
+//! @return	returns false on any error
+boolean Palette_ImportImage(PaletteInverseMap* the_map, const uint8_t* the_pixels, uint8_t the_format, signed int width, signed int height, signed long the_stride, Bitmap* the_bitmap, signed int x, signed int y, uint8_t the_dither);
+
+
+// **** Palette quantizer functions ****
+
+//! Create a palette quantizer, with an empty histogram
+//! @return	returns NULL on any error
+PaletteQuantizer* Palette_NewQuantizer(void);
+
+//! Free a palette quantizer, and all memory associated with it
+boolean Palette_DestroyQuantizer(PaletteQuantizer** the_quantizer);
+
+//! Add a row of truecolor pixels to a palette quantizer's histogram
+//! Call for every row of every image that will share the palette. Rows of one image can be added as it is streamed in.
+//! @param	the_pixels: the row to add
+//! @param	the_format: a palette_pixel_format value, describing the_pixels
+//! @param	num_pixels: the number of pixels in the row
+//! @return	returns false on any error
+boolean Palette_QuantizerAddRow(PaletteQuantizer* the_quantizer, const uint8_t* the_pixels, uint8_t the_format, signed int num_pixels);
+
+//! Add every pixel of an 8-bit bitmap to a palette quantizer's histogram
+//! @param	the_bitmap: reference to a valid Bitmap object
+//! @param	the_palette: the BITMAP_PALETTE_BYTES palette the bitmap was drawn with
+//! @return	returns false on any error
+boolean Palette_QuantizerAddBitmap(PaletteQuantizer* the_quantizer, Bitmap* the_bitmap, const uint8_t* the_palette);
+
+//! Build a palette for every pixel added to a palette quantizer so far
+//! The histogram is not changed: more pixels can be added, and the palette built again.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Entries outside the range are reserved: they are left as they are, and colors close to them are not given entries of their own.
+//! @param	first_entry: the first palette entry the quantizer can fill in
+//! @param	num_entries: the number of palette entries the quantizer can fill in. Clipped to the end of the palette.
+//! @return	returns the number of entries filled in, from the first entry up (fewer than num_entries if the images have fewer colors), or -1 on any error. Entries of the range not filled in are set to black.
+signed int Palette_QuantizerBuildPalette(PaletteQuantizer* the_quantizer, uint8_t* the_palette, uint8_t first_entry, signed int num_entries);
+
+
+// **** Blend table functions ****
+
+//! Get a blend table for a palette and opacity, building it if it isn't in the cache
+//! Entry s * 256 + d of the table is the palette entry closest to color s mixed over color d at the passed opacity.
+//! @param	the_palette: a BITMAP_PALETTE_BYTES palette. Use Palette_GetLUT() to build from the screen's current LUT.
+//! @param	the_opacity: from 0 (source colors are invisible) to PALETTE_BLEND_MAX (source colors are solid). PALETTE_BLEND_MAX / 2 mixes them evenly.
+//! @return	returns the table, or NULL on any error. The table belongs to the cache: it stays valid until PALETTE_BLEND_CACHE_SIZE other tables have been built, or the cache is flushed.
+const uint8_t* Palette_GetBlendTable(const uint8_t* the_palette, signed int the_opacity);
+
+//! Free every blend table in the cache
+void Palette_FlushBlendTables(void);
+
+
+
+#endif /* LIB_PALETTE_H_ */
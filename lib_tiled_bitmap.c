@@ -0,0 +1,1037 @@
+/*
+ * lib_tiled_bitmap.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: micahbly
+ */
+
+
+
+
+
+/*****************************************************************************/
+/*                                Includes                                   */
+/*****************************************************************************/
+
+// project includes
+#include "lib_tiled_bitmap.h"
+#include "lib_graphics.h"
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A2560 includes
+#include <mcp/syscalls.h>
+#include <mb/a2560_platform.h>
+#include <mb/lib_general.h>
+
+
+/*****************************************************************************/
+/*                               Definitions                                 */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                               Enumerations                                */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                             Global Variables                              */
+/*****************************************************************************/
+
+
+
+/*****************************************************************************/
+/*                       Private Function Prototypes                         */
+/*****************************************************************************/
+
+//! \cond PRIVATE
+
+// remove a tile from the LRU list for its location
+void TiledBitmap_LRUUnlink(TiledBitmap* the_tiled_bitmap, signed int the_tile);
+
+// add a tile to the most-recently-used end of the LRU list for its location
+void TiledBitmap_LRUPushNewest(TiledBitmap* the_tiled_bitmap, signed int the_tile);
+
+// write a loaded tile's pixels to the backing file
+boolean TiledBitmap_WriteTile(TiledBitmap* the_tiled_bitmap, signed int the_tile);
+
+// write a tile to the backing file if needed, and free its memory
+boolean TiledBitmap_Evict(TiledBitmap* the_tiled_bitmap, signed int the_tile);
+
+// move a tile from VRAM to standard RAM
+boolean TiledBitmap_Demote(TiledBitmap* the_tiled_bitmap, signed int the_tile);
+
+// move or evict least recently used tiles until there is room for one more tile in the specified location
+boolean TiledBitmap_MakeRoom(TiledBitmap* the_tiled_bitmap, uint8_t the_location);
+
+// get the bitmap for a tile, loading it if necessary
+Bitmap* TiledBitmap_GetTile(TiledBitmap* the_tiled_bitmap, signed int the_tile, boolean for_write);
+
+// clip a box to the canvas. returns false if no part of it is on the canvas
+boolean TiledBitmap_ClipBox(TiledBitmap* the_tiled_bitmap, signed int* x, signed int* y, signed int* width, signed int* height);
+
+// clip a copy between two rectangles of pixels (bitmaps or canvases) to both of them. returns false if no part of the copy is left.
+boolean TiledBitmap_ClipCopy(signed int src_width, signed int src_height, signed int* src_x, signed int* src_y, signed int dst_width, signed int dst_height, signed int* dst_x, signed int* dst_y, signed int* width, signed int* height);
+
+// fill a box that is entirely on the canvas, one tile at a time
+boolean TiledBitmap_FillClippedBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color);
+
+// set a pixel of the canvas, if it is on the canvas
+boolean TiledBitmap_PlotClipped(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, unsigned char the_color);
+
+//! \endcond
+
+
+/*****************************************************************************/
+/*                       Private Function Definitions                        */
+/*****************************************************************************/
+
+// **** NOTE: all functions in private section REQUIRE pre-validated parameters.
+// **** NEVER call these from your own functions. Always use the public interface. You have been warned!
+
+
+//! \cond PRIVATE
+
+//! Remove a tile from the LRU list for its location
+void TiledBitmap_LRUUnlink(TiledBitmap* the_tiled_bitmap, signed int the_tile)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+
+	if (the_entry->lru_newer_ != TILED_BITMAP_NO_TILE)
+	{
+		the_tiled_bitmap->tile_[the_entry->lru_newer_].lru_older_ = the_entry->lru_older_;
+	}
+	else
+	{
+		the_tiled_bitmap->lru_newest_[the_entry->location_] = the_entry->lru_older_;
+	}
+
+	if (the_entry->lru_older_ != TILED_BITMAP_NO_TILE)
+	{
+		the_tiled_bitmap->tile_[the_entry->lru_older_].lru_newer_ = the_entry->lru_newer_;
+	}
+	else
+	{
+		the_tiled_bitmap->lru_oldest_[the_entry->location_] = the_entry->lru_newer_;
+	}
+
+	the_entry->lru_newer_ = TILED_BITMAP_NO_TILE;
+	the_entry->lru_older_ = TILED_BITMAP_NO_TILE;
+}
+
+
+//! Add a tile to the most-recently-used end of the LRU list for its location
+void TiledBitmap_LRUPushNewest(TiledBitmap* the_tiled_bitmap, signed int the_tile)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+	uint8_t				the_location = the_entry->location_;
+
+	the_entry->lru_newer_ = TILED_BITMAP_NO_TILE;
+	the_entry->lru_older_ = the_tiled_bitmap->lru_newest_[the_location];
+
+	if (the_entry->lru_older_ != TILED_BITMAP_NO_TILE)
+	{
+		the_tiled_bitmap->tile_[the_entry->lru_older_].lru_newer_ = the_tile;
+	}
+	else
+	{
+		the_tiled_bitmap->lru_oldest_[the_location] = the_tile;
+	}
+
+	the_tiled_bitmap->lru_newest_[the_location] = the_tile;
+}
+
+
+//! Write a loaded tile's pixels to the backing file
+//! Each tile has a fixed slot in the file, based on its index.
+boolean TiledBitmap_WriteTile(TiledBitmap* the_tiled_bitmap, signed int the_tile)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+
+	if (the_tiled_bitmap->file_ == NULL)
+	{
+		LOG_ERR(("%s %d: tile %i must be paged out, but there is no backing file", __func__, __LINE__, the_tile));
+		return false;
+	}
+
+	if (fseek(the_tiled_bitmap->file_, (long)the_tile * TILED_BITMAP_TILE_BYTES, SEEK_SET) != 0 ||
+		fwrite(the_entry->bitmap_->addr_, TILED_BITMAP_TILE_BYTES, 1, the_tiled_bitmap->file_) != 1)
+	{
+		LOG_ERR(("%s %d: couldn't write tile %i to the backing file", __func__, __LINE__, the_tile));
+		return false;
+	}
+
+	the_entry->in_file_ = true;
+	the_entry->dirty_ = false;
+
+	return true;
+}
+
+
+//! Write a tile to the backing file if needed, and free its memory
+boolean TiledBitmap_Evict(TiledBitmap* the_tiled_bitmap, signed int the_tile)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+
+	if (the_entry->dirty_)
+	{
+		if (!TiledBitmap_WriteTile(the_tiled_bitmap, the_tile))
+		{
+			return false;
+		}
+	}
+
+	TiledBitmap_LRUUnlink(the_tiled_bitmap, the_tile);
+	the_tiled_bitmap->num_loaded_[the_entry->location_]--;
+	the_entry->location_ = TILE_NOT_LOADED;
+	Bitmap_Destroy(&the_entry->bitmap_);
+
+	return true;
+}
+
+
+//! Move a tile from VRAM to standard RAM
+//! There must already be room in standard RAM's budget for it.
+boolean TiledBitmap_Demote(TiledBitmap* the_tiled_bitmap, signed int the_tile)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+	Bitmap*				the_ram_bitmap;
+
+	if ((the_ram_bitmap = Bitmap_NewWithFlags(TILED_BITMAP_TILE_SIZE, TILED_BITMAP_TILE_SIZE, NULL, BITMAP_FLAG_UNINITIALIZED | BITMAP_FLAG_STANDARD_RAM)) == NULL)
+	{
+		LOG_ERR(("%s %d: couldn't allocate standard RAM for tile %i", __func__, __LINE__, the_tile));
+		return false;
+	}
+
+	Graphics_BlitBitMap(the_entry->bitmap_, 0, 0, the_ram_bitmap, 0, 0, TILED_BITMAP_TILE_SIZE, TILED_BITMAP_TILE_SIZE);
+	Bitmap_Destroy(&the_entry->bitmap_);
+	the_entry->bitmap_ = the_ram_bitmap;
+
+	TiledBitmap_LRUUnlink(the_tiled_bitmap, the_tile);
+	the_tiled_bitmap->num_loaded_[TILE_IN_VRAM]--;
+	the_entry->location_ = TILE_IN_RAM;
+	the_tiled_bitmap->num_loaded_[TILE_IN_RAM]++;
+	TiledBitmap_LRUPushNewest(the_tiled_bitmap, the_tile);
+
+	return true;
+}
+
+
+//! Move or evict least recently used tiles until there is room for one more tile in the specified location
+//! LOGIC:
+//!   VRAM tiles are demoted to standard RAM if standard RAM has a budget, otherwise they go straight to the backing file
+//!   standard RAM tiles go to the backing file
+boolean TiledBitmap_MakeRoom(TiledBitmap* the_tiled_bitmap, uint8_t the_location)
+{
+	signed int		the_victim;
+
+	while (the_tiled_bitmap->num_loaded_[the_location] >= the_tiled_bitmap->max_loaded_[the_location])
+	{
+		the_victim = the_tiled_bitmap->lru_oldest_[the_location];
+
+		if (the_victim == TILED_BITMAP_NO_TILE)
+		{
+			LOG_ERR(("%s %d: no budget for tiles in location %u", __func__, __LINE__, the_location));
+			return false;
+		}
+
+		if (the_location == TILE_IN_VRAM && the_tiled_bitmap->max_loaded_[TILE_IN_RAM] > 0)
+		{
+			if (!TiledBitmap_MakeRoom(the_tiled_bitmap, TILE_IN_RAM) || !TiledBitmap_Demote(the_tiled_bitmap, the_victim))
+			{
+				return false;
+			}
+		}
+		else if (!TiledBitmap_Evict(the_tiled_bitmap, the_victim))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! Get the bitmap for a tile, loading it if necessary
+//! NOTE: the returned bitmap is only valid until the next call to this function, which may move or evict it. Finish with one tile before getting the next.
+//! @param	for_write: if true, the tile will be marked as needing to be written back to the backing file
+//! @return	returns NULL on any error
+Bitmap* TiledBitmap_GetTile(TiledBitmap* the_tiled_bitmap, signed int the_tile, boolean for_write)
+{
+	TiledBitmapTile*	the_entry = &the_tiled_bitmap->tile_[the_tile];
+	uint8_t				the_location;
+	uint8_t				the_flags;
+
+	if (the_entry->location_ == TILE_NOT_LOADED)
+	{
+		// LOGIC:
+		//   newly loaded tiles go into VRAM if it has a budget: they are the most likely to be rendered to the screen next.
+		//   tiles that have never been drawn into are blank, so they are zeroed instead of read.
+
+		the_location = (the_tiled_bitmap->max_loaded_[TILE_IN_VRAM] > 0) ? TILE_IN_VRAM : TILE_IN_RAM;
+
+		if (!TiledBitmap_MakeRoom(the_tiled_bitmap, the_location))
+		{
+			return NULL;
+		}
+
+		the_flags = (the_entry->in_file_ ? BITMAP_FLAG_UNINITIALIZED : BITMAP_FLAG_NONE) | (the_location == TILE_IN_RAM ? BITMAP_FLAG_STANDARD_RAM : BITMAP_FLAG_NONE);
+
+		if ((the_entry->bitmap_ = Bitmap_NewWithFlags(TILED_BITMAP_TILE_SIZE, TILED_BITMAP_TILE_SIZE, NULL, the_flags)) == NULL)
+		{
+			LOG_ERR(("%s %d: couldn't allocate memory for tile %i", __func__, __LINE__, the_tile));
+			return NULL;
+		}
+
+		if (the_entry->in_file_)
+		{
+			if (fseek(the_tiled_bitmap->file_, (long)the_tile * TILED_BITMAP_TILE_BYTES, SEEK_SET) != 0 ||
+				fread(the_entry->bitmap_->addr_, TILED_BITMAP_TILE_BYTES, 1, the_tiled_bitmap->file_) != 1)
+			{
+				LOG_ERR(("%s %d: couldn't read tile %i from the backing file", __func__, __LINE__, the_tile));
+				Bitmap_Destroy(&the_entry->bitmap_);
+				return NULL;
+			}
+		}
+
+		the_entry->location_ = the_location;
+		the_tiled_bitmap->num_loaded_[the_location]++;
+		TiledBitmap_LRUPushNewest(the_tiled_bitmap, the_tile);
+	}
+	else if (the_tile != the_tiled_bitmap->last_tile_)
+	{
+		TiledBitmap_LRUUnlink(the_tiled_bitmap, the_tile);
+		TiledBitmap_LRUPushNewest(the_tiled_bitmap, the_tile);
+	}
+
+	the_tiled_bitmap->last_tile_ = the_tile;
+	the_entry->dirty_ |= for_write;
+
+	return the_entry->bitmap_;
+}
+
+
+
+//! Clip a box to the canvas
+//! @return	returns false if no part of the box is on the canvas
+boolean TiledBitmap_ClipBox(TiledBitmap* the_tiled_bitmap, signed int* x, signed int* y, signed int* width, signed int* height)
+{
+	if (*x < 0)
+	{
+		*width += *x;
+		*x = 0;
+	}
+
+	if (*y < 0)
+	{
+		*height += *y;
+		*y = 0;
+	}
+
+	*width = (*x + *width > the_tiled_bitmap->width_) ? the_tiled_bitmap->width_ - *x : *width;
+	*height = (*y + *height > the_tiled_bitmap->height_) ? the_tiled_bitmap->height_ - *y : *height;
+
+	return (*width > 0 && *height > 0);
+}
+
+
+//! Clip a copy from one rectangle of pixels to another, such as a bitmap and a canvas, to both of them
+//! Where one side is clipped, the other side's coordinates and the size move in step.
+//! @param	src_width, src_height: size of the source
+//! @param	dst_width, dst_height: size of the destination
+//! @return	returns false if no part of the copy is within both source and destination
+boolean TiledBitmap_ClipCopy(signed int src_width, signed int src_height, signed int* src_x, signed int* src_y, signed int dst_width, signed int dst_height, signed int* dst_x, signed int* dst_y, signed int* width, signed int* height)
+{
+	if (*src_x < 0)
+	{
+		*dst_x -= *src_x;
+		*width += *src_x;
+		*src_x = 0;
+	}
+
+	if (*src_y < 0)
+	{
+		*dst_y -= *src_y;
+		*height += *src_y;
+		*src_y = 0;
+	}
+
+	if (*dst_x < 0)
+	{
+		*src_x -= *dst_x;
+		*width += *dst_x;
+		*dst_x = 0;
+	}
+
+	if (*dst_y < 0)
+	{
+		*src_y -= *dst_y;
+		*height += *dst_y;
+		*dst_y = 0;
+	}
+
+	*width = (*src_x + *width > src_width) ? src_width - *src_x : *width;
+	*width = (*dst_x + *width > dst_width) ? dst_width - *dst_x : *width;
+	*height = (*src_y + *height > src_height) ? src_height - *src_y : *height;
+	*height = (*dst_y + *height > dst_height) ? dst_height - *dst_y : *height;
+
+	return (*width > 0 && *height > 0);
+}
+
+
+//! Fill a box that is entirely on the canvas, one tile at a time
+//! @return	returns false if a tile couldn't be loaded
+boolean TiledBitmap_FillClippedBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	Bitmap*			the_tile_bitmap;
+	signed int		tile_x;
+	signed int		tile_y;
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+
+	// LOGIC:
+	//   fill the part of the box that falls in each tile, one tile at a time
+	//   left/top/right/bottom are canvas coordinates of that part; right and bottom are exclusive
+
+	for (tile_y = y / TILED_BITMAP_TILE_SIZE; tile_y <= (y + height - 1) / TILED_BITMAP_TILE_SIZE; tile_y++)
+	{
+		top = (tile_y * TILED_BITMAP_TILE_SIZE > y) ? tile_y * TILED_BITMAP_TILE_SIZE : y;
+		bottom = ((tile_y + 1) * TILED_BITMAP_TILE_SIZE < y + height) ? (tile_y + 1) * TILED_BITMAP_TILE_SIZE : y + height;
+
+		for (tile_x = x / TILED_BITMAP_TILE_SIZE; tile_x <= (x + width - 1) / TILED_BITMAP_TILE_SIZE; tile_x++)
+		{
+			left = (tile_x * TILED_BITMAP_TILE_SIZE > x) ? tile_x * TILED_BITMAP_TILE_SIZE : x;
+			right = ((tile_x + 1) * TILED_BITMAP_TILE_SIZE < x + width) ? (tile_x + 1) * TILED_BITMAP_TILE_SIZE : x + width;
+
+			if ((the_tile_bitmap = TiledBitmap_GetTile(the_tiled_bitmap, tile_y * the_tiled_bitmap->tiles_across_ + tile_x, true)) == NULL)
+			{
+				return false;
+			}
+
+			Graphics_FillBox(the_tile_bitmap, left % TILED_BITMAP_TILE_SIZE, top % TILED_BITMAP_TILE_SIZE, right - left, bottom - top, the_color);
+		}
+	}
+
+	return true;
+}
+
+
+//! Set a pixel of the canvas, if it is on the canvas. Pixels off the canvas are skipped, so lines and circles can cross its edges.
+//! @return	returns false if the pixel's tile couldn't be loaded
+boolean TiledBitmap_PlotClipped(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, unsigned char the_color)
+{
+	Bitmap*		the_tile_bitmap;
+
+	if (x < 0 || x >= the_tiled_bitmap->width_ || y < 0 || y >= the_tiled_bitmap->height_)
+	{
+		return true;
+	}
+
+	if ((the_tile_bitmap = TiledBitmap_GetTile(the_tiled_bitmap, (y / TILED_BITMAP_TILE_SIZE) * the_tiled_bitmap->tiles_across_ + x / TILED_BITMAP_TILE_SIZE, true)) == NULL)
+	{
+		return false;
+	}
+
+	return Graphics_SetPixelAtXY(the_tile_bitmap, x % TILED_BITMAP_TILE_SIZE, y % TILED_BITMAP_TILE_SIZE, the_color);
+}
+
+//! \endcond
+
+
+
+/*****************************************************************************/
+/*                        Public Function Definitions                        */
+/*****************************************************************************/
+
+// **** CONSTRUCTOR AND DESTRUCTOR *****
+
+// constructor
+
+//! Create a new virtual canvas. No tile memory is allocated until something is drawn.
+//! @param	width, height: size of the canvas in pixels. Can be larger than BITMAP_MAX_WIDTH x BITMAP_MAX_HEIGHT.
+//! @param	backing_file_path: path of a scratch file that tiles will be paged out to when the memory budgets are full. The file will be created or overwritten. Can be NULL if the budgets are big enough to hold every tile.
+//! @param	max_vram_tiles: maximum number of tiles to keep in VRAM. Can be 0.
+//! @param	max_ram_tiles: maximum number of tiles to keep in standard RAM. Can be 0. max_vram_tiles + max_ram_tiles must be at least 1.
+//! @return	returns NULL on any error
+TiledBitmap* TiledBitmap_New(signed int width, signed int height, const char* backing_file_path, signed int max_vram_tiles, signed int max_ram_tiles)
+{
+	TiledBitmap*	the_tiled_bitmap;
+	signed int		num_tiles;
+	signed int		i;
+
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: Illegal width (%i) and/or height (%i)", __func__, __LINE__, width, height));
+		return NULL;
+	}
+
+	if (max_vram_tiles < 0 || max_ram_tiles < 0 || max_vram_tiles + max_ram_tiles < 1)
+	{
+		LOG_ERR(("%s %d: Illegal tile budgets (%i VRAM, %i RAM)", __func__, __LINE__, max_vram_tiles, max_ram_tiles));
+		return NULL;
+	}
+
+	if ((the_tiled_bitmap = f_calloc(1, sizeof(TiledBitmap), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate space for tiled bitmap struct", __func__, __LINE__));
+		goto error;
+	}
+	LOG_ALLOC(("%s %d:	__ALLOC__	the_tiled_bitmap	%p	size	%i", __func__ , __LINE__, the_tiled_bitmap, sizeof(TiledBitmap)));
+
+	the_tiled_bitmap->width_ = width;
+	the_tiled_bitmap->height_ = height;
+	the_tiled_bitmap->tiles_across_ = (width + TILED_BITMAP_TILE_SIZE - 1) / TILED_BITMAP_TILE_SIZE;
+	the_tiled_bitmap->tiles_down_ = (height + TILED_BITMAP_TILE_SIZE - 1) / TILED_BITMAP_TILE_SIZE;
+	the_tiled_bitmap->max_loaded_[TILE_IN_VRAM] = max_vram_tiles;
+	the_tiled_bitmap->max_loaded_[TILE_IN_RAM] = max_ram_tiles;
+	the_tiled_bitmap->last_tile_ = TILED_BITMAP_NO_TILE;
+
+	for (i = 0; i < TILE_NUM_LOCATIONS; i++)
+	{
+		the_tiled_bitmap->lru_newest_[i] = TILED_BITMAP_NO_TILE;
+		the_tiled_bitmap->lru_oldest_[i] = TILED_BITMAP_NO_TILE;
+	}
+
+	num_tiles = the_tiled_bitmap->tiles_across_ * the_tiled_bitmap->tiles_down_;
+
+	if ((the_tiled_bitmap->tile_ = f_calloc(num_tiles, sizeof(TiledBitmapTile), MEM_STANDARD)) == NULL)
+	{
+		LOG_ERR(("%s %d: Couldn't allocate tile table for %i tiles", __func__, __LINE__, num_tiles));
+		goto error;
+	}
+
+	for (i = 0; i < num_tiles; i++)
+	{
+		the_tiled_bitmap->tile_[i].lru_newer_ = TILED_BITMAP_NO_TILE;
+		the_tiled_bitmap->tile_[i].lru_older_ = TILED_BITMAP_NO_TILE;
+	}
+
+	if (backing_file_path)
+	{
+		if ((the_tiled_bitmap->file_ = fopen(backing_file_path, "w+b")) == NULL)
+		{
+			LOG_ERR(("%s %d: Couldn't open backing file '%s'", __func__, __LINE__, backing_file_path));
+			goto error;
+		}
+	}
+	else if (num_tiles > max_vram_tiles + max_ram_tiles)
+	{
+		LOG_WARN(("%s %d: canvas has %i tiles but budgets only hold %i, and there is no backing file: drawing to the whole canvas will fail", __func__, __LINE__, num_tiles, max_vram_tiles + max_ram_tiles));
+	}
+
+	return the_tiled_bitmap;
+
+error:
+	if (the_tiled_bitmap)
+	{
+		TiledBitmap_Destroy(&the_tiled_bitmap);
+	}
+
+	return NULL;
+}
+
+
+// destructor
+// frees all allocated memory associated with the passed object, and the object itself. closes (but does not delete) the backing file.
+boolean TiledBitmap_Destroy(TiledBitmap** the_tiled_bitmap)
+{
+	signed int		num_tiles;
+	signed int		i;
+
+	if (*the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed class object was null", __func__ , __LINE__));
+		return false;
+	}
+
+	if ((*the_tiled_bitmap)->tile_)
+	{
+		num_tiles = (*the_tiled_bitmap)->tiles_across_ * (*the_tiled_bitmap)->tiles_down_;
+
+		for (i = 0; i < num_tiles; i++)
+		{
+			if ((*the_tiled_bitmap)->tile_[i].bitmap_)
+			{
+				Bitmap_Destroy(&(*the_tiled_bitmap)->tile_[i].bitmap_);
+			}
+		}
+
+		f_free((*the_tiled_bitmap)->tile_, MEM_STANDARD);
+	}
+
+	if ((*the_tiled_bitmap)->file_)
+	{
+		fclose((*the_tiled_bitmap)->file_);
+	}
+
+	LOG_ALLOC(("%s %d:	__FREE__	*the_tiled_bitmap	%p	size	%i", __func__ , __LINE__, *the_tiled_bitmap, sizeof(TiledBitmap)));
+	f_free(*the_tiled_bitmap, MEM_STANDARD);
+	*the_tiled_bitmap = NULL;
+
+	return true;
+}
+
+
+
+
+// **** Drawing functions *****
+
+//! Set a pixel at a specified x, y coord of the canvas
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_SetPixelAtXY(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, unsigned char the_color)
+{
+	Bitmap*		the_tile_bitmap;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (x < 0 || x >= the_tiled_bitmap->width_ || y < 0 || y >= the_tiled_bitmap->height_)
+	{
+		LOG_ERR(("%s %d: illegal coordinate", __func__, __LINE__));
+		return false;
+	}
+
+	if ((the_tile_bitmap = TiledBitmap_GetTile(the_tiled_bitmap, (y / TILED_BITMAP_TILE_SIZE) * the_tiled_bitmap->tiles_across_ + x / TILED_BITMAP_TILE_SIZE, true)) == NULL)
+	{
+		return false;
+	}
+
+	return Graphics_SetPixelAtXY(the_tile_bitmap, x % TILED_BITMAP_TILE_SIZE, y % TILED_BITMAP_TILE_SIZE, the_color);
+}
+
+
+//! Get the pixel at a specified x, y coord of the canvas
+//! @return	returns a 1-byte index to the current LUT, or 0 on any error
+unsigned char TiledBitmap_GetPixelAtXY(TiledBitmap* the_tiled_bitmap, signed int x, signed int y)
+{
+	TiledBitmapTile*	the_entry;
+	Bitmap*				the_tile_bitmap;
+	signed int			the_tile;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return 0;
+	}
+
+	if (x < 0 || x >= the_tiled_bitmap->width_ || y < 0 || y >= the_tiled_bitmap->height_)
+	{
+		LOG_ERR(("%s %d: illegal coordinate", __func__, __LINE__));
+		return 0;
+	}
+
+	the_tile = (y / TILED_BITMAP_TILE_SIZE) * the_tiled_bitmap->tiles_across_ + x / TILED_BITMAP_TILE_SIZE;
+	the_entry = &the_tiled_bitmap->tile_[the_tile];
+
+	// a tile that has never been drawn into is blank: no need to load it
+	if (the_entry->location_ == TILE_NOT_LOADED && !the_entry->in_file_)
+	{
+		return 0;
+	}
+
+	if ((the_tile_bitmap = TiledBitmap_GetTile(the_tiled_bitmap, the_tile, false)) == NULL)
+	{
+		return 0;
+	}
+
+	return Graphics_GetPixelAtXY(the_tile_bitmap, x % TILED_BITMAP_TILE_SIZE, y % TILED_BITMAP_TILE_SIZE);
+}
+
+
+//! Fill a width x height box of the canvas with the specified LUT value
+//! The box is clipped to the canvas. Only the tiles it touches are loaded.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input, or if no part of the box was on the canvas.
+boolean TiledBitmap_FillBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color)
+{
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!TiledBitmap_ClipBox(the_tiled_bitmap, &x, &y, &width, &height))
+	{
+		LOG_INFO(("%s %d: No part of the box was on the canvas", __func__, __LINE__));
+		return false;
+	}
+
+	return TiledBitmap_FillClippedBox(the_tiled_bitmap, x, y, width, height, the_color);
+}
+
+
+//! Draw a line between 2 coordinates of the canvas, stepping through the same pixels as Graphics_DrawLine
+//! The line is clipped to the canvas. Horizontal and vertical lines are drawn as fills; other lines pixel by pixel.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input, or if no part of the line was on the canvas.
+boolean TiledBitmap_DrawLine(TiledBitmap* the_tiled_bitmap, signed int x1, signed int y1, signed int x2, signed int y2, unsigned char the_color)
+{
+	signed int dx;
+	signed int sx;
+	signed int dy;
+	signed int sy;
+	signed int err;
+	signed int e2;
+	boolean on_canvas = false;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	dx = abs(x2 - x1);
+	sx = x1 < x2 ? 1 : -1;
+	dy = abs(y2 - y1);
+	sy = y1 < y2 ? 1 : -1;
+
+	// both endpoints are drawn, so a straight line is exactly the box between them
+	if (dx == 0 || dy == 0)
+	{
+		return TiledBitmap_FillBox(the_tiled_bitmap, (x1 < x2) ? x1 : x2, (y1 < y2) ? y1 : y2, dx + 1, dy + 1, the_color);
+	}
+
+	err = (dx > dy ? dx : -dy)/2;
+
+	for(;;)
+	{
+		if (!TiledBitmap_PlotClipped(the_tiled_bitmap, x1, y1, the_color))
+		{
+			return false;
+		}
+
+		on_canvas |= (x1 >= 0 && x1 < the_tiled_bitmap->width_ && y1 >= 0 && y1 < the_tiled_bitmap->height_);
+
+		if (x1==x2 && y1==y2)
+		{
+			break;
+		}
+
+		e2 = err;
+
+		if (e2 >-dx)
+		{
+			err -= dy;
+			x1 += sx;
+		}
+
+		if (e2 < dy)
+		{
+			err += dx;
+			y1 += sy;
+		}
+	}
+
+	// a diagonal line that misses the canvas is reported the same way as a straight one
+	if (!on_canvas)
+	{
+		LOG_INFO(("%s %d: No part of the line was on the canvas", __func__, __LINE__));
+		return false;
+	}
+
+	return true;
+}
+
+
+//! Draw a rectangle on the canvas, as Graphics_DrawBox draws it, and optionally fill it
+//! The rectangle is clipped to the canvas.
+//! @param	width, height: size of the rectangle, in pixels
+//! @param	the_color: a 1-byte index to the current LUT
+//! @param	do_fill: PARAM_DO_FILL or PARAM_DO_NOT_FILL
+//! @return	returns false on any error/invalid input, or if no part of the box was on the canvas.
+boolean TiledBitmap_DrawBox(TiledBitmap* the_tiled_bitmap, signed int x, signed int y, signed int width, signed int height, unsigned char the_color, boolean do_fill)
+{
+	signed int	the_x[4];
+	signed int	the_y[4];
+	signed int	the_width[4];
+	signed int	the_height[4];
+	signed int	i;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (width < 1 || height < 1)
+	{
+		LOG_ERR(("%s %d: invalid size (%i x %i)", __func__, __LINE__, width, height));
+		return false;
+	}
+
+	if (do_fill)
+	{
+		return TiledBitmap_FillBox(the_tiled_bitmap, x, y, width, height, the_color);
+	}
+
+	the_x[0] = x;
+	the_y[0] = y;
+	the_width[0] = width;
+	the_height[0] = height;
+
+	if (!TiledBitmap_ClipBox(the_tiled_bitmap, &the_x[0], &the_y[0], &the_width[0], &the_height[0]))
+	{
+		LOG_INFO(("%s %d: No part of the box was on the canvas", __func__, __LINE__));
+		return false;
+	}
+
+	// LOGIC:
+	//   the outline is 4 fills, in the same order as Graphics_DrawBox: top, right, bottom, left.
+	//   each edge is clipped on its own: some can be on the canvas while others are off it.
+
+	the_x[0] = x;				the_y[0] = y;				the_width[0] = width;	the_height[0] = 1;
+	the_x[1] = x + width - 1;	the_y[1] = y;				the_width[1] = 1;		the_height[1] = height;
+	the_x[2] = x;				the_y[2] = y + height - 1;	the_width[2] = width;	the_height[2] = 1;
+	the_x[3] = x;				the_y[3] = y;				the_width[3] = 1;		the_height[3] = height;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (TiledBitmap_ClipBox(the_tiled_bitmap, &the_x[i], &the_y[i], &the_width[i], &the_height[i]) && !TiledBitmap_FillClippedBox(the_tiled_bitmap, the_x[i], the_y[i], the_width[i], the_height[i], the_color))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! Draw a circle outline on the canvas, stepping through the same pixels as Graphics_DrawCircle
+//! The circle is clipped to the canvas: its center can be off the canvas.
+//! @param	the_color: a 1-byte index to the current LUT
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_DrawCircle(TiledBitmap* the_tiled_bitmap, signed int x1, signed int y1, signed int radius, unsigned char the_color)
+{
+	signed int	f;
+	signed int	ddF_x;
+	signed int	ddF_y;
+	signed int	x;
+	signed int	y;
+	boolean		ok;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (radius < 0)
+	{
+		LOG_ERR(("%s %d: illegal radius (%i)", __func__, __LINE__, radius));
+		return false;
+	}
+
+	f = 1 - radius;
+	ddF_x = 0;
+	ddF_y = -2 * radius;
+	x = 0;
+	y = radius;
+
+	ok = TiledBitmap_PlotClipped(the_tiled_bitmap, x1, y1 + radius, the_color);
+	ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1, y1 - radius, the_color);
+	ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 + radius, y1, the_color);
+	ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 - radius, y1, the_color);
+
+	while (x < y && ok)
+	{
+		if (f >= 0)
+		{
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+
+		x++;
+		ddF_x += 2;
+		f += ddF_x + 1;
+
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 + x, y1 + y, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 + y, y1 + x, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 - x, y1 + y, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 - y, y1 + x, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 + x, y1 - y, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 + y, y1 - x, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 - x, y1 - y, the_color);
+		ok &= TiledBitmap_PlotClipped(the_tiled_bitmap, x1 - y, y1 - x, the_color);
+	}
+
+	return ok;
+}
+
+
+
+
+
+// **** Block copy functions ****
+
+//! Blit a rectangle of pixels from a normal bitmap into the canvas
+//! The copy is clipped to both the source bitmap and the canvas. Only the tiles it touches are loaded.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_BlitFromBitmap(Bitmap* src_bm, signed int src_x, signed int src_y, TiledBitmap* dst_tb, signed int dst_x, signed int dst_y, signed int width, signed int height)
+{
+	Bitmap*			the_tile_bitmap;
+	signed int		tile_x;
+	signed int		tile_y;
+	signed int		left;
+	signed int		top;
+	signed int		right;
+	signed int		bottom;
+
+	if (src_bm == NULL || dst_tb == NULL)
+	{
+		LOG_ERR(("%s %d: passed source or destination was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!TiledBitmap_ClipCopy(src_bm->width_, src_bm->height_, &src_x, &src_y, dst_tb->width_, dst_tb->height_, &dst_x, &dst_y, &width, &height))
+	{
+		LOG_INFO(("%s %d: No part of the copy was within both source and destination", __func__, __LINE__));
+		return false;
+	}
+
+	// left/top/right/bottom are canvas coordinates of the part of the copy that lands in each tile; right and bottom are exclusive
+	for (tile_y = dst_y / TILED_BITMAP_TILE_SIZE; tile_y <= (dst_y + height - 1) / TILED_BITMAP_TILE_SIZE; tile_y++)
+	{
+		top = (tile_y * TILED_BITMAP_TILE_SIZE > dst_y) ? tile_y * TILED_BITMAP_TILE_SIZE : dst_y;
+		bottom = ((tile_y + 1) * TILED_BITMAP_TILE_SIZE < dst_y + height) ? (tile_y + 1) * TILED_BITMAP_TILE_SIZE : dst_y + height;
+
+		for (tile_x = dst_x / TILED_BITMAP_TILE_SIZE; tile_x <= (dst_x + width - 1) / TILED_BITMAP_TILE_SIZE; tile_x++)
+		{
+			left = (tile_x * TILED_BITMAP_TILE_SIZE > dst_x) ? tile_x * TILED_BITMAP_TILE_SIZE : dst_x;
+			right = ((tile_x + 1) * TILED_BITMAP_TILE_SIZE < dst_x + width) ? (tile_x + 1) * TILED_BITMAP_TILE_SIZE : dst_x + width;
+
+			if ((the_tile_bitmap = TiledBitmap_GetTile(dst_tb, tile_y * dst_tb->tiles_across_ + tile_x, true)) == NULL)
+			{
+				return false;
+			}
+
+			Graphics_BlitBitMap(src_bm, src_x + (left - dst_x), src_y + (top - dst_y), the_tile_bitmap, left % TILED_BITMAP_TILE_SIZE, top % TILED_BITMAP_TILE_SIZE, right - left, bottom - top);
+		}
+	}
+
+	return true;
+}
+
+
+//! Blit a rectangle of pixels from the canvas into a normal bitmap
+//! The copy is clipped to both the canvas and the destination bitmap. Only the tiles it touches are loaded.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_BlitToBitmap(TiledBitmap* src_tb, signed int src_x, signed int src_y, Bitmap* dst_bm, signed int dst_x, signed int dst_y, signed int width, signed int height)
+{
+	TiledBitmapTile*	the_entry;
+	Bitmap*				the_tile_bitmap;
+	signed int			the_tile;
+	signed int			tile_x;
+	signed int			tile_y;
+	signed int			left;
+	signed int			top;
+	signed int			right;
+	signed int			bottom;
+
+	if (src_tb == NULL || dst_bm == NULL)
+	{
+		LOG_ERR(("%s %d: passed source or destination was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (!TiledBitmap_ClipCopy(src_tb->width_, src_tb->height_, &src_x, &src_y, dst_bm->width_, dst_bm->height_, &dst_x, &dst_y, &width, &height))
+	{
+		LOG_INFO(("%s %d: No part of the copy was within both source and destination", __func__, __LINE__));
+		return false;
+	}
+
+	// left/top/right/bottom are canvas coordinates of the part of the copy that comes from each tile; right and bottom are exclusive
+	for (tile_y = src_y / TILED_BITMAP_TILE_SIZE; tile_y <= (src_y + height - 1) / TILED_BITMAP_TILE_SIZE; tile_y++)
+	{
+		top = (tile_y * TILED_BITMAP_TILE_SIZE > src_y) ? tile_y * TILED_BITMAP_TILE_SIZE : src_y;
+		bottom = ((tile_y + 1) * TILED_BITMAP_TILE_SIZE < src_y + height) ? (tile_y + 1) * TILED_BITMAP_TILE_SIZE : src_y + height;
+
+		for (tile_x = src_x / TILED_BITMAP_TILE_SIZE; tile_x <= (src_x + width - 1) / TILED_BITMAP_TILE_SIZE; tile_x++)
+		{
+			left = (tile_x * TILED_BITMAP_TILE_SIZE > src_x) ? tile_x * TILED_BITMAP_TILE_SIZE : src_x;
+			right = ((tile_x + 1) * TILED_BITMAP_TILE_SIZE < src_x + width) ? (tile_x + 1) * TILED_BITMAP_TILE_SIZE : src_x + width;
+
+			the_tile = tile_y * src_tb->tiles_across_ + tile_x;
+			the_entry = &src_tb->tile_[the_tile];
+
+			// a tile that has never been drawn into is blank: fill instead of loading it
+			if (the_entry->location_ == TILE_NOT_LOADED && !the_entry->in_file_)
+			{
+				Graphics_FillBox(dst_bm, dst_x + (left - src_x), dst_y + (top - src_y), right - left, bottom - top, 0);
+				continue;
+			}
+
+			if ((the_tile_bitmap = TiledBitmap_GetTile(src_tb, the_tile, false)) == NULL)
+			{
+				return false;
+			}
+
+			Graphics_BlitBitMap(the_tile_bitmap, left % TILED_BITMAP_TILE_SIZE, top % TILED_BITMAP_TILE_SIZE, dst_bm, dst_x + (left - src_x), dst_y + (top - src_y), right - left, bottom - top);
+		}
+	}
+
+	return true;
+}
+
+
+//! Render the part of the canvas that starts at view_x, view_y into the entire destination bitmap, such as a screen's bitmap
+//! Areas of the destination that fall outside the canvas are not touched.
+//! @return	returns false on any error/invalid input.
+boolean TiledBitmap_RenderViewport(TiledBitmap* the_tiled_bitmap, signed int view_x, signed int view_y, Bitmap* dst_bm)
+{
+	if (dst_bm == NULL)
+	{
+		LOG_ERR(("%s %d: passed destination bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	return TiledBitmap_BlitToBitmap(the_tiled_bitmap, view_x, view_y, dst_bm, 0, 0, dst_bm->width_, dst_bm->height_);
+}
+
+
+//! Write every tile that has changed since it was loaded out to the backing file
+//! Tiles stay loaded. Does nothing if the canvas has no backing file.
+//! @return	returns false on any error
+boolean TiledBitmap_Flush(TiledBitmap* the_tiled_bitmap)
+{
+	signed int		num_tiles;
+	signed int		i;
+
+	if (the_tiled_bitmap == NULL)
+	{
+		LOG_ERR(("%s %d: passed tiled bitmap was NULL", __func__, __LINE__));
+		return false;
+	}
+
+	if (the_tiled_bitmap->file_ == NULL)
+	{
+		return true;
+	}
+
+	num_tiles = the_tiled_bitmap->tiles_across_ * the_tiled_bitmap->tiles_down_;
+
+	for (i = 0; i < num_tiles; i++)
+	{
+		if (the_tiled_bitmap->tile_[i].location_ != TILE_NOT_LOADED && the_tiled_bitmap->tile_[i].dirty_)
+		{
+			if (!TiledBitmap_WriteTile(the_tiled_bitmap, i))
+			{
+				return false;
+			}
+		}
+	}
+
+	return (fflush(the_tiled_bitmap->file_) == 0);
+}